@@ -89,11 +89,13 @@ int main(int argc, char *argv[])
     const int numHops = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
     const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
     const int numActors = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 503;
+    const int workStealing = (argc > 4 && atoi(argv[4]) > 0) ? 1 : 0;
     const int tokenValue((numHops + numActors - 1) / numActors);
 
     printf("Using numHops = %d (use first command line argument to change)\n", numHops);
     printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
     printf("Using numActors = %d (use third command line argument to change)\n", numActors);
+    printf("Using workStealing = %d (use fourth command line argument to change)\n", workStealing);
     printf("Starting %d tokens with initial value %d in a ring of %d actors...\n", numActors, tokenValue, numActors);
 
     // The reported time includes the startup and cleanup cost.
@@ -101,7 +103,13 @@ int main(int argc, char *argv[])
     timer.Start();
 
     {
-        Theron::Framework framework(numThreads);
+        Theron::Framework::Parameters params(numThreads);
+        if (workStealing)
+        {
+            params.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_WORK_STEALING;
+        }
+
+        Theron::Framework framework(params);
         std::vector<Member *> members(numActors);
         Theron::Receiver receiver;
 
@@ -21,6 +21,10 @@
 // n is the initial value of the integer message initially sent to Ping. The latency of the
 // message sending is calculated as the total execution time divided by the number of messages n.
 //
+// The benchmark is run twice, first with the worker threads queuing every actor that receives
+// a message, and then with continuations enabled, in which case each message sent by Ping or
+// Pong is handed directly to the sending worker thread, which processes its partner straight away.
+//
 
 
 #include <stdio.h>
@@ -88,16 +92,12 @@ THERON_DEFINE_REGISTERED_MESSAGE(int);
 THERON_DEFINE_REGISTERED_MESSAGE(PingPong::StartMessage);
 
 
-int main(int argc, char *argv[])
+static double RunPingPong(const int numMessages, const int numThreads, const Theron::uint32_t continuationDepth)
 {
-    const int numMessages = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
-    const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
-
-    printf("Using numMessages = %d (use first command line argument to change)\n", numMessages);
-    printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
-    printf("Starting %d message sends between ping and pong...\n", numMessages);
+    Theron::Framework::Parameters params(numThreads);
+    params.mContinuationDepth = continuationDepth;
 
-    Theron::Framework framework(numThreads);
+    Theron::Framework framework(params);
     Theron::Receiver receiver;
 
     PingPong ping(framework);
@@ -119,9 +119,34 @@ int main(int argc, char *argv[])
     receiver.Wait();
     timer.Stop();
 
-    // The number of full cycles is half the number of messages.
-    printf("Completed %d message response cycles in %.1f seconds\n", numMessages / 2, timer.Seconds());
-    printf("Average response time is %.10f seconds\n", timer.Seconds() / (numMessages / 2));
+    return timer.Seconds();
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int numMessages = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
+    const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
+    const int continuationDepth = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 64;
+
+    printf("Using numMessages = %d (use first command line argument to change)\n", numMessages);
+    printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
+    printf("Using continuationDepth = %d (use third command line argument to change)\n", continuationDepth);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const Theron::uint32_t depth(pass == 0 ? 0 : static_cast<Theron::uint32_t>(continuationDepth));
+
+        printf("Starting %d message sends between ping and pong with continuations %s...\n",
+            numMessages,
+            depth ? "enabled" : "disabled");
+
+        const double seconds(RunPingPong(numMessages, numThreads, depth));
+
+        // The number of full cycles is half the number of messages.
+        printf("Completed %d message response cycles in %.1f seconds\n", numMessages / 2, seconds);
+        printf("Average response time is %.10f seconds\n", seconds / (numMessages / 2));
+    }
 
 #if THERON_ENABLE_DEFAULTALLOCATOR_CHECKS
     Theron::IAllocator *const allocator(Theron::AllocatorManager::GetAllocator());
@@ -0,0 +1,202 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark measures the raw throughput of the shared work queue used by the
+// scheduler, independently of the rest of the actor machinery. The shared queue is
+// the queue to which worker threads push actors that have received messages, and from
+// which idle worker threads pop actors to process. Since every worker thread in a
+// framework pushes to and pops from the same queue, it's a potential point of contention.
+//
+// A number of threads are started, each of which repeatedly pushes an item onto a single
+// shared queue and then pops an item from it. The benchmark is run twice: once with the
+// original intrusive Queue protected by a mutex, and once with the lock-free LockFreeQueue
+// used by the scheduler. For each run the total number of push/pop pairs per second is printed.
+//
+// The benchmark uses internal Theron classes directly, so isn't representative of client code.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+#include <Theron/Theron.h>
+
+#include <Theron/Detail/Containers/LockFreeQueue.h>
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Mutex.h>
+#include <Theron/Detail/Threading/Thread.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+#include "../Common/Timer.h"
+
+
+// Item type pushed through the queues, intrusive so it can be used with Detail::Queue.
+class Item : public Theron::Detail::Queue<Item>::Node
+{
+};
+
+
+// Wraps the intrusive queue with a lock, as in the original shared queue.
+class LockedQueue
+{
+public:
+
+    inline bool Push(Item *const item)
+    {
+        mMutex.Lock();
+        mQueue.Push(item);
+        mMutex.Unlock();
+        return true;
+    }
+
+    inline Item *Pop()
+    {
+        Item *item(0);
+
+        mMutex.Lock();
+        if (!mQueue.Empty())
+        {
+            item = mQueue.Pop();
+        }
+
+        mMutex.Unlock();
+        return item;
+    }
+
+private:
+
+    Theron::Detail::Mutex mMutex;
+    Theron::Detail::Queue<Item> mQueue;
+};
+
+
+typedef Theron::Detail::LockFreeQueue<Item, 1024> LockFreeQueue;
+
+
+// Parameters shared by all the threads in a run.
+template <class QueueType>
+struct Context
+{
+    QueueType *mQueue;
+    Item *mItems;
+    int mNumOperations;
+    Theron::Detail::Atomic::UInt32 *mReadyCount;
+    Theron::Detail::Atomic::UInt32 *mGo;
+};
+
+
+template <class QueueType>
+void ThreadProc(void *const context)
+{
+    Context<QueueType> *const threadContext(reinterpret_cast<Context<QueueType> *>(context));
+    QueueType *const queue(threadContext->mQueue);
+
+    // Wait until all the threads are ready, so they start together.
+    threadContext->mReadyCount->Increment();
+    while (threadContext->mGo->Load() == 0)
+    {
+        Theron::Detail::Utils::YieldToAnyThread();
+    }
+
+    // Each thread pushes and then pops one item, repeatedly.
+    // The popped item isn't necessarily the one the thread pushed.
+    Item *item(threadContext->mItems);
+    for (int count = 0; count < threadContext->mNumOperations; ++count)
+    {
+        // The lock-free queue reports itself full if a popping thread is pre-empted
+        // part way through a pop, so the push is retried until it succeeds.
+        while (!queue->Push(item))
+        {
+            Theron::Detail::Utils::YieldToAnyThread();
+        }
+
+        while ((item = queue->Pop()) == 0)
+        {
+            Theron::Detail::Utils::YieldToAnyThread();
+        }
+    }
+}
+
+
+template <class QueueType>
+double Run(const int numThreads, const int numOperations)
+{
+    // The lock-free queue is cache-line aligned, which plain new doesn't guarantee before C++17.
+    Theron::IAllocator *const allocator(Theron::AllocatorManager::GetCache());
+    void *const queueMemory(allocator->AllocateAligned(sizeof(QueueType), THERON_CACHELINE_ALIGNMENT));
+    THERON_ASSERT_MSG(queueMemory, "Failed to allocate queue");
+
+    QueueType *const queue(new (queueMemory) QueueType);
+    std::vector<Item> items(numThreads);
+    std::vector<Context<QueueType> > contexts(numThreads);
+    std::vector<Theron::Detail::Thread *> threads(numThreads);
+
+    Theron::Detail::Atomic::UInt32 readyCount(0);
+    Theron::Detail::Atomic::UInt32 go(0);
+
+    for (int index = 0; index < numThreads; ++index)
+    {
+        contexts[index].mQueue = queue;
+        contexts[index].mItems = &items[index];
+        contexts[index].mNumOperations = numOperations;
+        contexts[index].mReadyCount = &readyCount;
+        contexts[index].mGo = &go;
+
+        threads[index] = new Theron::Detail::Thread;
+        threads[index]->Start(ThreadProc<QueueType>, &contexts[index]);
+    }
+
+    while (readyCount.Load() < static_cast<Theron::uint32_t>(numThreads))
+    {
+        Theron::Detail::Utils::YieldToAnyThread();
+    }
+
+    Timer timer;
+    timer.Start();
+
+    go.Store(1);
+
+    for (int index = 0; index < numThreads; ++index)
+    {
+        threads[index]->Join();
+        delete threads[index];
+    }
+
+    timer.Stop();
+
+    queue->~QueueType();
+    allocator->Free(queueMemory);
+
+    return timer.Seconds();
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int numOperations = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 100000;
+
+    printf("Using numOperations = %d per thread (use first command line argument to change)\n", numOperations);
+
+    // Thread counts to compare, if one isn't specified on the command line.
+    const int defaultThreadCounts[] = { 16, 64 };
+    const int numRuns = (argc > 2 && atoi(argv[2]) > 0) ? 1 : 2;
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : defaultThreadCounts[run];
+        const double totalOperations(static_cast<double>(numThreads) * static_cast<double>(numOperations));
+
+        const double lockedSeconds(Run<LockedQueue>(numThreads, numOperations));
+        const double lockFreeSeconds(Run<LockFreeQueue>(numThreads, numOperations));
+
+        printf("%d threads: locked Queue %.1f seconds (%.0f push/pops per second)\n",
+            numThreads, lockedSeconds, totalOperations / lockedSeconds);
+        printf("%d threads: LockFreeQueue %.1f seconds (%.0f push/pops per second)\n",
+            numThreads, lockFreeSeconds, totalOperations / lockFreeSeconds);
+    }
+}
+
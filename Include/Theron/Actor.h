@@ -16,13 +16,17 @@ Actor baseclass.
 #include <xs/xs.h>
 #endif // THERON_XS
 
+#include <Theron/ActorPriority.h>
 #include <Theron/Address.h>
+#include <Theron/AddressGroup.h>
 #include <Theron/Align.h>
 #include <Theron/AllocatorManager.h>
 #include <Theron/BasicTypes.h>
 #include <Theron/EndPoint.h>
 #include <Theron/Framework.h>
 #include <Theron/IAllocator.h>
+#include <Theron/OverflowPolicy.h>
+#include <Theron/SharedValue.h>
 
 #include <Theron/Detail/Directory/Directory.h>
 #include <Theron/Detail/Handlers/DefaultHandlerCollection.h>
@@ -35,6 +39,10 @@ Actor baseclass.
 #include <Theron/Detail/Threading/Atomic.h>
 #include <Theron/Detail/Threading/Utils.h>
 
+#if THERON_CPP11
+#include <utility>
+#endif // THERON_CPP11
+
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -99,6 +107,12 @@ public:
     friend class Framework;
     friend class Detail::MailboxProcessor;
 
+    /**
+    \brief Worker thread index value denoting an actor that isn't bound to a worker thread.
+    \see SetWorkerThread
+    */
+    static const uint32_t ANY_WORKER_THREAD = Detail::Mailbox::UNBOUND;
+
     /**
     \brief Explicit constructor.
 
@@ -161,12 +175,26 @@ public:
     the building of complex subsystems of actors using object-like abstraction.
     See the documentation of the \ref GetFramework method for more information.
 
+    The optional priority parameter sets the scheduling priority class of the actor.
+    Actors are \ref ACTOR_PRIORITY_NORMAL "normal priority" by default. See \ref ActorPriority.
+
+    The optional scheduler group parameter assigns the actor to one of the scheduler groups of
+    the framework, which is then processed only by the worker threads of that group. Actors belong
+    to the default group, zero, processed by the framework's main worker threads, by default.
+    See \ref Framework::Parameters::AddSchedulerGroup.
+
     \param framework Reference to a framework within which the actor will be hosted.
     \param name An optional string defining the unique name of the actor object.
+    \param priority An optional scheduling priority class for the actor.
+    \param schedulerGroup An optional index of the scheduler group of the framework to which the actor is assigned.
 
     \note The string name parameter is copied so can be destroyed after the call.
     */
-    explicit Actor(Framework &framework, const char *const name = 0);
+    explicit Actor(
+        Framework &framework,
+        const char *const name = 0,
+        const ActorPriority priority = ACTOR_PRIORITY_NORMAL,
+        const uint32_t schedulerGroup = 0);
 
     /**
     \brief Baseclass virtual destructor.
@@ -280,6 +308,132 @@ public:
     */
     inline uint32_t GetNumQueuedMessages() const;
 
+    /**
+    \brief Gets the scheduling priority class of this actor.
+    \see SetPriority
+    */
+    inline ActorPriority GetPriority() const;
+
+    /**
+    \brief Sets the scheduling priority class of this actor.
+
+    Actors of higher priority classes are preferred by the worker threads of the framework
+    when choosing which actor to process next, so see lower queueing latencies when the
+    framework is busy. See \ref ActorPriority for details.
+
+    The new priority takes effect the next time the actor is scheduled for processing.
+
+    \note This method can safely be called inside an actor message handler,
+    constructor, or destructor.
+    */
+    inline void SetPriority(const ActorPriority priority);
+
+    /**
+    \brief Gets the index of the worker thread to which this actor is bound.
+    \return The index of the bound worker thread, or \ref ANY_WORKER_THREAD if the actor isn't bound.
+    \see SetWorkerThread
+    */
+    inline uint32_t GetWorkerThread() const;
+
+    /**
+    \brief Binds this actor to a single worker thread of its framework.
+
+    By default the messages of an actor are processed by whichever worker thread of the
+    framework happens to take the actor next, so a busy actor can migrate freely between
+    threads, and between the processor cores on which they run. Binding a heavily used
+    actor to a single worker thread instead keeps its state warm in that thread's caches.
+
+    The worker threads of a framework are indexed from zero in the order they are created.
+    Each thread has a private inbox for the actors bound to it, which it serves before any
+    other work. Messages sent to a bound actor, from any thread, schedule it in the inbox of
+    its worker thread rather than in the queue shared by all the threads. The bound thread
+    still processes unbound actors when its inbox is empty.
+
+    While the worker thread with the given index isn't running, for example because the
+    framework has fewer threads, the actor is scheduled as though it were unbound. Passing
+    \ref ANY_WORKER_THREAD unbinds the actor. Actors are unbound by default.
+
+    The new binding takes effect the next time the actor is scheduled for processing.
+
+    \note Worker thread binding is only honored by \ref SCHEDULER_STRATEGY_SHARED and
+    \ref SCHEDULER_STRATEGY_PARTITIONED. With the latter a bound actor joins the partition
+    of its worker thread, and is processed only by that thread.
+
+    \note This method can safely be called inside an actor message handler,
+    constructor, or destructor.
+    */
+    inline void SetWorkerThread(const uint32_t thread);
+
+    /**
+    \brief Returns true if this actor is marked as blocking.
+    \see SetBlocking
+    */
+    inline bool IsBlocking() const;
+
+    /**
+    \brief Marks this actor as blocking, or as non-blocking.
+
+    Actors whose message handlers block, for example while reading files or waiting on sockets,
+    hold up the worker thread executing them for the duration, delaying the processing of other
+    actors in the framework. When the framework is constructed with a non-zero
+    \ref Framework::Parameters::mBlockingThreadCount "mBlockingThreadCount", actors marked as
+    blocking are instead processed by a separate, elastically sized pool of blocking threads, so
+    that the main worker threads remain free to process the remaining, non-blocking actors.
+
+    In frameworks without a blocking thread pool, blocking actors are processed by the main
+    worker threads like any other. Actors are non-blocking by default.
+
+    The change takes effect the next time the actor is scheduled for processing after its
+    currently queued messages have been processed.
+
+    \note This method can safely be called inside an actor message handler,
+    constructor, or destructor.
+    */
+    inline void SetBlocking(const bool blocking);
+
+    /**
+    \brief Gets the index of the scheduler group to which this actor was assigned on construction.
+    \return The index of the group, or zero for the default group.
+    */
+    inline uint32_t GetSchedulerGroup() const;
+
+    /**
+    \brief Gets the maximum number of messages that can be queued at this actor, or zero if unbounded.
+    \see SetMailboxCapacity
+    */
+    inline uint32_t GetMailboxCapacity() const;
+
+    /**
+    \brief Gets the policy applied to messages arriving while the mailbox of this actor is full.
+    \see SetMailboxCapacity
+    */
+    inline OverflowPolicy GetOverflowPolicy() const;
+
+    /**
+    \brief Bounds the number of messages that can be queued at this actor.
+
+    By default the mailbox of an actor is unbounded, so an actor that receives messages faster
+    than it can process them accumulates an ever-growing backlog, and its memory use grows without
+    limit. Bounding the mailbox keeps the memory use flat under overload: messages arriving while
+    the mailbox holds \em capacity messages (including the one being processed, if any) are handled
+    according to the given \ref OverflowPolicy instead of being queued.
+
+    \code
+    // Keep at most 1000 messages, discarding the stalest when overloaded.
+    actor.SetMailboxCapacity(1000, Theron::OVERFLOW_POLICY_DROP_OLDEST);
+    \endcode
+
+    Lowering the capacity below the number of messages already queued doesn't discard any of them.
+    Senders can query how full the mailbox is with \ref Framework::GetMailboxPressure.
+
+    \param capacity The maximum number of queued messages, or zero for an unbounded mailbox.
+    \param policy The policy applied to messages arriving while the mailbox is full.
+
+    \note This method can safely be called inside an actor message handler,
+    constructor, or destructor.
+    */
+    inline void SetMailboxCapacity(const uint32_t capacity, const OverflowPolicy policy = OVERFLOW_POLICY_REJECT);
+
 protected:
 
     /**
@@ -691,6 +845,9 @@ protected:
     When messages by different senders or to mailboxes in other processes (potentially
     on other hosts) the arrival order is not guaranteed.
 
+    Large values sent to many recipients can be wrapped in a \ref SharedValue, which is
+    sent as a message of the wrapped type referencing a single shared copy of the value.
+
     This method can safely be called within the constructor or destructor of a derived
     actor object, as well as (more typically) within its message handler functions.
 
@@ -702,6 +859,149 @@ protected:
     template <class ValueType>
     inline bool Send(const ValueType &value, const Address &address) const;
 
+    /**
+    \brief Sends a message to each of a range of addresses.
+
+    Equivalent to sending the message to each address in turn, but the message value is
+    copied only once, into a payload shared by all the messages (see \ref SharedValue),
+    and the mailboxes made ready by the messages are scheduled together.
+
+    \code
+    void Publish(const Quote &quote, const Theron::Address from)
+    {
+        Send(quote, mSubscribers, mSubscribers + mSubscriberCount);
+    }
+    \endcode
+
+    \tparam ValueType The message type (any copyable class or Plain-Old-Data type).
+    \param value The message value to be sent.
+    \param begin Pointer to the first address to which the message is sent.
+    \param end Pointer one past the last address to which the message is sent.
+    \return The number of entities to which the message was delivered.
+    \see AddressGroup
+    */
+    template <class ValueType>
+    inline uint32_t Send(const ValueType &value, const Address *const begin, const Address *const end) const;
+
+    /**
+    \brief Sends a message to each of the addresses in a group.
+    \return The number of entities to which the message was delivered.
+    */
+    template <class ValueType>
+    inline uint32_t Send(const ValueType &value, const AddressGroup &group) const;
+
+#if THERON_CPP11
+
+    /**
+    \brief Sends a message to the entity at the given address, moving the value into the message.
+
+    Available in C++11 builds (see \ref THERON_CPP11). Chosen in preference to the copying
+    overload for rvalues and non-const lvalues; the message value is move-constructed from
+    rvalues, so large values such as vectors and strings can be sent without being copied.
+
+    \code
+    void Handler(const Batch &batch, const Theron::Address from)
+    {
+        std::vector<Record> records(Parse(batch));
+        Send(std::move(records), mWriter);          // No copy of the records is made.
+    }
+    \endcode
+
+    \see Emplace
+    */
+    template <class ValueType, class MessageValueType = typename Detail::MovedMessageValue<ValueType>::Type>
+    inline bool Send(ValueType &&value, const Address &address) const;
+
+    /**
+    \brief Sends a message to the entity at the given address, constructing its value in place.
+
+    Available in C++11 builds (see \ref THERON_CPP11). The message value is constructed
+    directly in the allocated message from the given constructor arguments, avoiding both
+    the copy made by \ref Send and the construction of a temporary.
+
+    \code
+    Emplace<std::vector<float> >(mMixer, sampleCount, 0.0f);
+    \endcode
+
+    \tparam ValueType The message type, which must be given explicitly.
+    \param address The address of the destination Receiver or Actor mailbox.
+    \param args Arguments forwarded to the constructor of the message value.
+    \return True, if the message was delivered, otherwise false.
+    */
+    template <class ValueType, class... ArgTypes>
+    inline bool Emplace(const Address &address, ArgTypes &&... args) const;
+
+#endif // THERON_CPP11
+
+    /**
+    \brief Sends a message to the entity at the given address after a delay.
+
+    The message value is copied immediately, and a message holding the copy is delivered
+    into the mailbox of the target entity, as if sent by \ref Send, once the delay has
+    elapsed. This is the usual way for an actor to arrange a timeout or a retry without
+    blocking a worker thread:
+
+    \code
+    class Poller : public Theron::Actor
+    {
+    public:
+
+        struct Poll {};
+
+        explicit Poller(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Poller::Handler);
+        }
+
+    private:
+
+        void Handler(const Poll &message, const Theron::Address from)
+        {
+            // Check something, then poll again in ten milliseconds.
+            SendAfter(message, GetAddress(), 10);
+        }
+    };
+    \endcode
+
+    Timers are serviced by the framework's manager thread with a resolution of about a
+    millisecond. Pending timers are discarded when the framework is destroyed.
+
+    \tparam ValueType The message type (any copyable class or Plain-Old-Data type).
+    \param value The message value to be sent.
+    \param address The address of the destination Receiver or Actor mailbox.
+    \param milliseconds The delay in milliseconds after which the message is sent.
+    \return A non-zero handle identifying the timer, for use with \ref CancelTimer, or zero on failure.
+
+    \see SendEvery
+    */
+    template <class ValueType>
+    inline uint32_t SendAfter(const ValueType &value, const Address &address, const uint32_t milliseconds) const;
+
+    /**
+    \brief Sends a message to the entity at the given address repeatedly, at a fixed period.
+
+    The first message is sent after a single period has elapsed, and further messages are
+    sent every period thereafter, until the timer is cancelled with \ref CancelTimer.
+
+    \tparam ValueType The message type (any copyable class or Plain-Old-Data type).
+    \param value The message value to be sent.
+    \param address The address of the destination Receiver or Actor mailbox.
+    \param milliseconds The period in milliseconds at which the message is sent.
+    \return A non-zero handle identifying the timer, for use with \ref CancelTimer, or zero on failure.
+
+    \see SendAfter
+    */
+    template <class ValueType>
+    inline uint32_t SendEvery(const ValueType &value, const Address &address, const uint32_t milliseconds) const;
+
+    /**
+    \brief Cancels a timer started with \ref SendAfter or \ref SendEvery.
+
+    \param timer The handle returned when the timer was started.
+    \return True if the timer was cancelled, or false if its handle is stale or its (last) message has already been sent.
+    */
+    inline bool CancelTimer(const uint32_t timer) const;
+
     /**
     \brief Deprecated.
 
@@ -731,6 +1031,11 @@ private:
         Detail::FallbackHandlerCollection *const fallbackHandlers,
         Detail::IMessage *const message);
 
+    /**
+    Assigns the actor to a scheduler group of its framework.
+    */
+    inline void SetSchedulerGroup(const uint32_t group);
+
     /**
     Handle an unhandled message.
     */
@@ -772,6 +1077,130 @@ THERON_FORCEINLINE uint32_t Actor::GetNumQueuedMessages() const
 }
 
 
+THERON_FORCEINLINE ActorPriority Actor::GetPriority() const
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.GetPriority();
+}
+
+
+THERON_FORCEINLINE void Actor::SetPriority(const ActorPriority priority)
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    mailbox.Lock();
+    mailbox.SetPriority(priority);
+    mailbox.Unlock();
+}
+
+
+THERON_FORCEINLINE uint32_t Actor::GetWorkerThread() const
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.GetWorkerThread();
+}
+
+
+THERON_FORCEINLINE void Actor::SetWorkerThread(const uint32_t thread)
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    mailbox.Lock();
+    mailbox.SetWorkerThread(thread);
+    mailbox.Unlock();
+}
+
+
+THERON_FORCEINLINE bool Actor::IsBlocking() const
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.IsBlocking();
+}
+
+
+THERON_FORCEINLINE void Actor::SetBlocking(const bool blocking)
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    mailbox.Lock();
+    mailbox.SetBlocking(blocking);
+    mailbox.Unlock();
+}
+
+
+THERON_FORCEINLINE uint32_t Actor::GetSchedulerGroup() const
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.GetSchedulerGroup();
+}
+
+
+THERON_FORCEINLINE void Actor::SetSchedulerGroup(const uint32_t group)
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    // Actors assigned to groups the framework doesn't have are left in the default group.
+    THERON_ASSERT_MSG(group <= framework.GetNumSchedulerGroups(), "Actor assigned to unknown scheduler group");
+
+    mailbox.Lock();
+    mailbox.SetSchedulerGroup(group <= framework.GetNumSchedulerGroups() ? group : 0);
+    mailbox.Unlock();
+}
+
+
+THERON_FORCEINLINE uint32_t Actor::GetMailboxCapacity() const
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.GetCapacity();
+}
+
+
+THERON_FORCEINLINE OverflowPolicy Actor::GetOverflowPolicy() const
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.GetOverflowPolicy();
+}
+
+
+THERON_FORCEINLINE void Actor::SetMailboxCapacity(const uint32_t capacity, const OverflowPolicy policy)
+{
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    mailbox.Lock();
+    mailbox.SetCapacity(capacity);
+    mailbox.SetOverflowPolicy(policy);
+    mailbox.Unlock();
+}
+
+
 template <class ActorType, class ValueType>
 inline bool Actor::RegisterHandler(
     ActorType *const /*actor*/,
@@ -863,6 +1292,91 @@ THERON_FORCEINLINE bool Actor::Send(const ValueType &value, const Address &addre
 }
 
 
+template <class ValueType>
+THERON_FORCEINLINE uint32_t Actor::Send(const ValueType &value, const Address *const begin, const Address *const end) const
+{
+    // Use the context of the worker thread if called from a handler, as in Send.
+    Detail::MailboxContext *mailboxContext(mMailboxContext);
+    if (mMailboxContext == 0)
+    {
+        mailboxContext = mFramework->GetMailboxContext();
+    }
+
+    return mFramework->SendMulticast(
+        mailboxContext,
+        value,
+        mAddress,
+        begin,
+        end);
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE uint32_t Actor::Send(const ValueType &value, const AddressGroup &group) const
+{
+    return Send(value, group.Begin(), group.End());
+}
+
+
+#if THERON_CPP11
+
+template <class ValueType, class MessageValueType>
+THERON_FORCEINLINE bool Actor::Send(ValueType &&value, const Address &address) const
+{
+    // The message holds a plain value, whatever the constness and reference type of the argument.
+    return Emplace<MessageValueType>(address, std::forward<ValueType>(value));
+}
+
+
+template <class ValueType, class... ArgTypes>
+THERON_FORCEINLINE bool Actor::Emplace(const Address &address, ArgTypes &&... args) const
+{
+    // Use the context of the worker thread if called from a handler, as in Send.
+    Detail::MailboxContext *mailboxContext(mMailboxContext);
+    if (mMailboxContext == 0)
+    {
+        mailboxContext = mFramework->GetMailboxContext();
+    }
+
+    Detail::IMessage *const message(Detail::MessageCreator::Emplace<ValueType>(
+        mailboxContext->mMessageAllocator,
+        mAddress,
+        std::forward<ArgTypes>(args)...));
+
+    if (message)
+    {
+        return mFramework->SendInternal(
+            mailboxContext,
+            message,
+            address);
+    }
+
+    return false;
+}
+
+#endif // THERON_CPP11
+
+
+template <class ValueType>
+inline uint32_t Actor::SendAfter(const ValueType &value, const Address &address, const uint32_t milliseconds) const
+{
+    return mFramework->SendAfter(value, mAddress, address, milliseconds);
+}
+
+
+template <class ValueType>
+inline uint32_t Actor::SendEvery(const ValueType &value, const Address &address, const uint32_t milliseconds) const
+{
+    return mFramework->SendEvery(value, mAddress, address, milliseconds);
+}
+
+
+inline bool Actor::CancelTimer(const uint32_t timer) const
+{
+    return mFramework->CancelTimer(timer);
+}
+
+
 template <class ValueType>
 THERON_FORCEINLINE bool Actor::TailSend(const ValueType &value, const Address &address) const
 {
@@ -0,0 +1,50 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ACTORPRIORITY_H
+#define THERON_ACTORPRIORITY_H
+
+
+/**
+\file ActorPriority.h
+Defines the ActorPriority enumerated type.
+*/
+
+
+namespace Theron
+{
+
+
+/**
+\brief Enumerates the available actor scheduling priority classes.
+
+Each \ref Theron::Actor belongs to a priority class, which can be set when the actor is
+constructed or changed at runtime via \ref Theron::Actor::SetPriority. Actors are normal
+priority by default.
+
+With the default \ref SCHEDULER_STRATEGY_SHARED scheduler strategy, the shared work queue
+holds a separate queue for each priority class. When worker threads take work from the
+shared queue they prefer higher priority actors, so latency-sensitive actors such as
+control-plane actors handling heartbeats or cancellations aren't queued behind bulk data
+actors when the framework is saturated. The selection is weighted rather than strict:
+a contended lower priority class is still served at least once in every few pops, so it
+can't be starved completely. Worker threads also check for waiting high priority actors
+before continuing with the work in their own local queues.
+
+The queue latency event counters of the framework are split by priority class (see
+\ref Theron::Framework::GetCounterValue), so the latencies seen by each class can be
+compared under load.
+
+\note Priority classes are only honored by SCHEDULER_STRATEGY_SHARED. The other scheduler
+strategies schedule actors of all priority classes alike.
+*/
+enum ActorPriority
+{
+    ACTOR_PRIORITY_LOW = 0,             ///< Actors served after the other classes, such as bulk processing actors.
+    ACTOR_PRIORITY_NORMAL,              ///< The default priority class of actors.
+    ACTOR_PRIORITY_HIGH                 ///< Actors served before the other classes, such as control-plane actors.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_ACTORPRIORITY_H
@@ -0,0 +1,268 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ADDRESSGROUP_H
+#define THERON_ADDRESSGROUP_H
+
+
+/**
+\file AddressGroup.h
+Group of addresses to which messages can be multicast.
+*/
+
+
+#include <new>
+
+#include <Theron/Address.h>
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief A group of addresses to which a message can be sent in a single call.
+
+An address group holds the addresses of the subscribers of a publisher, or of any other
+set of actors and receivers that are sent the same messages. Sending a message to the
+group, with \ref Actor::Send or \ref Framework::Send, copies the value once, however many
+addresses the group contains, and schedules the mailboxes it makes ready together.
+
+\code
+class Publisher : public Theron::Actor
+{
+public:
+
+    explicit Publisher(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Publisher::Subscribe);
+        RegisterHandler(this, &Publisher::Publish);
+    }
+
+private:
+
+    void Subscribe(const Subscription &subscription, const Theron::Address from)
+    {
+        mSubscribers.Add(from);
+    }
+
+    void Publish(const Quote &quote, const Theron::Address from)
+    {
+        Send(quote, mSubscribers);
+    }
+
+    Theron::AddressGroup mSubscribers;
+};
+\endcode
+
+The addresses are kept in the order they're added, and messages are sent to them in
+that order. An address can be added more than once, in which case it's sent a copy of
+each message for each time it was added.
+
+\note Address groups aren't thread-safe, and can't be copied.
+*/
+class AddressGroup
+{
+public:
+
+    /**
+    \brief Default constructor.
+    Constructs an empty group.
+    */
+    inline AddressGroup();
+
+    /**
+    \brief Destructor.
+    */
+    inline ~AddressGroup();
+
+    /**
+    \brief Adds an address to the group.
+    \return False if the group couldn't be grown to hold the address.
+    */
+    inline bool Add(const Address &address);
+
+    /**
+    \brief Removes the first occurrence of an address from the group.
+    The order of the remaining addresses is preserved.
+    \return False if the group doesn't contain the address.
+    */
+    inline bool Remove(const Address &address);
+
+    /**
+    \brief Removes all the addresses from the group.
+    */
+    inline void Clear();
+
+    /**
+    \brief Returns true if the group contains an address.
+    */
+    inline bool Contains(const Address &address) const;
+
+    /**
+    \brief Gets the number of addresses in the group.
+    */
+    inline uint32_t Count() const;
+
+    /**
+    \brief Gets a pointer to the first address in the group.
+    */
+    inline const Address *Begin() const;
+
+    /**
+    \brief Gets a pointer one past the last address in the group.
+    */
+    inline const Address *End() const;
+
+private:
+
+    AddressGroup(const AddressGroup &other);
+    AddressGroup &operator=(const AddressGroup &other);
+
+    /**
+    Moves the addresses to a larger array.
+    */
+    inline bool Grow();
+
+    Address *mAddresses;            ///< Array of addresses, or null if none have been added.
+    uint32_t mCount;                ///< Number of addresses in the group.
+    uint32_t mCapacity;             ///< Number of addresses the array can hold.
+};
+
+
+THERON_FORCEINLINE AddressGroup::AddressGroup() :
+  mAddresses(0),
+  mCount(0),
+  mCapacity(0)
+{
+}
+
+
+inline AddressGroup::~AddressGroup()
+{
+    Clear();
+
+    if (mAddresses)
+    {
+        AllocatorManager::GetCache()->Free(mAddresses, static_cast<uint32_t>(sizeof(Address)) * mCapacity);
+    }
+}
+
+
+inline bool AddressGroup::Add(const Address &address)
+{
+    if (mCount == mCapacity && !Grow())
+    {
+        return false;
+    }
+
+    new (mAddresses + mCount) Address(address);
+    ++mCount;
+
+    return true;
+}
+
+
+inline bool AddressGroup::Remove(const Address &address)
+{
+    for (uint32_t index = 0; index < mCount; ++index)
+    {
+        if (mAddresses[index] == address)
+        {
+            // Shuffle the later addresses down to keep them in order.
+            while (++index < mCount)
+            {
+                mAddresses[index - 1] = mAddresses[index];
+            }
+
+            mAddresses[--mCount].~Address();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+inline void AddressGroup::Clear()
+{
+    while (mCount)
+    {
+        mAddresses[--mCount].~Address();
+    }
+}
+
+
+inline bool AddressGroup::Contains(const Address &address) const
+{
+    for (uint32_t index = 0; index < mCount; ++index)
+    {
+        if (mAddresses[index] == address)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+THERON_FORCEINLINE uint32_t AddressGroup::Count() const
+{
+    return mCount;
+}
+
+
+THERON_FORCEINLINE const Address *AddressGroup::Begin() const
+{
+    return mAddresses;
+}
+
+
+THERON_FORCEINLINE const Address *AddressGroup::End() const
+{
+    return mAddresses + mCount;
+}
+
+
+inline bool AddressGroup::Grow()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    const uint32_t capacity(mCapacity ? mCapacity * 2 : 8);
+    void *const memory(allocator->AllocateAligned(
+        static_cast<uint32_t>(sizeof(Address)) * capacity,
+        static_cast<uint32_t>(THERON_ALIGNOF(Address))));
+
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    Address *const addresses(reinterpret_cast<Address *>(memory));
+    for (uint32_t index = 0; index < mCount; ++index)
+    {
+        new (addresses + index) Address(mAddresses[index]);
+        mAddresses[index].~Address();
+    }
+
+    if (mAddresses)
+    {
+        allocator->Free(mAddresses, static_cast<uint32_t>(sizeof(Address)) * mCapacity);
+    }
+
+    mAddresses = addresses;
+    mCapacity = capacity;
+
+    return true;
+}
+
+
+} // namespace Theron
+
+
+#endif // THERON_ADDRESSGROUP_H
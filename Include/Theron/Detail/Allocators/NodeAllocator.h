@@ -0,0 +1,311 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_NODEALLOCATOR_H
+#define THERON_DETAIL_ALLOCATORS_NODEALLOCATOR_H
+
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A thread-safe allocator that allocates small memory blocks from memory local to a NUMA node.
+
+Each node allocator manages a fixed-size arena of memory allocated on its node via
+Utils::AllocOnNode. The arena is divided into pages, each of which is dedicated to blocks
+of a single power-of-two size class, and freed blocks are kept on per-class free lists for
+reuse. Allocations that are too large, or that can't be satisfied once the arena is used
+up, are passed on to the global allocator.
+
+There is at most one node allocator per node, created on first use and never destroyed,
+since blocks allocated from it may be freed by any thread in any framework. Because other
+allocators can't free blocks allocated from a node allocator, code that frees message blocks
+must first check for an owning node allocator using \ref GetOwner.
+*/
+class NodeAllocator : public IAllocator
+{
+public:
+
+    /**
+    Maximum number of NUMA nodes supported, matching the width of the node masks.
+    */
+    static const uint32_t MAX_NODES = 32;
+
+    /**
+    Gets the allocator for the given NUMA node, creating it if it doesn't exist yet.
+    \return A pointer to the allocator, or zero if memory can't be allocated on the node.
+    */
+    static NodeAllocator *GetAllocator(const uint32_t node);
+
+    /**
+    Returns the node allocator from which the given block was allocated, if any.
+    */
+    inline static IAllocator *GetOwner(const void *const block);
+
+    /**
+    Returns the index of the NUMA node on which this allocator allocates memory.
+    */
+    inline uint32_t GetNode() const;
+
+    /**
+    Allocates a memory block of the given size.
+    */
+    inline virtual void *Allocate(const uint32_t size);
+
+    /**
+    Allocates a memory block of the given size and alignment.
+    */
+    inline virtual void *AllocateAligned(const uint32_t size, const uint32_t alignment);
+
+    /**
+    Frees a previously allocated memory block.
+    */
+    inline virtual void Free(void *const block);
+
+    /**
+    Frees a previously allocated memory block of a known size.
+    */
+    inline virtual void Free(void *const block, const uint32_t size);
+
+private:
+
+    static const uint32_t ARENA_SIZE = 16 * 1024 * 1024;            ///< Size of each node's arena in bytes.
+    static const uint32_t PAGE_SIZE = 4096;                         ///< Size of the arena pages in bytes.
+    static const uint32_t PAGE_COUNT = ARENA_SIZE / PAGE_SIZE;      ///< Number of pages in each arena.
+    static const uint32_t MIN_BLOCK_SIZE = 16;                      ///< Size of the smallest size class in bytes.
+    static const uint32_t MAX_CLASSES = 7;                          ///< Number of size classes, up to 1024 bytes.
+
+    /**
+    Free blocks are linked into free lists via their first word.
+    */
+    struct FreeBlock
+    {
+        FreeBlock *mNext;
+    };
+
+    /**
+    Static data shared by all node allocators.
+    */
+    struct Static
+    {
+        Static();
+
+        SpinLock mLock;                             ///< Serializes creation of node allocators.
+        NodeAllocator *mAllocators[MAX_NODES];      ///< Allocators of the nodes, indexed by node.
+        uint32_t mNodeLimit;                        ///< One more than the highest node with an allocator.
+    };
+
+    /**
+    Constructs a node allocator at the start of its own arena.
+    */
+    inline NodeAllocator(const uint32_t node, uint8_t *const arena);
+
+    NodeAllocator(const NodeAllocator &other);
+    NodeAllocator &operator=(const NodeAllocator &other);
+
+    /**
+    Returns the size class serving blocks of the given size and alignment, or MAX_CLASSES if there is none.
+    */
+    inline static uint32_t GetClass(const uint32_t size, const uint32_t alignment);
+
+    /**
+    Returns true if the given block lies within the arena of this allocator.
+    */
+    inline bool Contains(const void *const block) const;
+
+    static Static mStatic;
+
+    uint32_t mNode;                             ///< Index of the node on which the arena was allocated.
+    uint8_t *mArena;                            ///< Start of the arena, which holds this object.
+    uint8_t *mNextPage;                         ///< Next page of the arena not yet assigned to a size class.
+    uint8_t *mEnd;                              ///< End of the arena.
+    SpinLock mLock;                             ///< Protects the pages and free lists.
+    uint8_t *mCursors[MAX_CLASSES];             ///< Next unused block in the current page of each size class.
+    uint8_t *mLimits[MAX_CLASSES];              ///< End of the current page of each size class.
+    FreeBlock *mFreeLists[MAX_CLASSES];         ///< Lists of freed blocks of each size class.
+    uint8_t mPageClasses[PAGE_COUNT];           ///< Size class of each page in the arena.
+};
+
+
+THERON_FORCEINLINE IAllocator *NodeAllocator::GetOwner(const void *const block)
+{
+    // Blocks can only have been allocated from node allocators created before they were sent,
+    // so reading the limit without the lock is safe. In non-NUMA builds the limit is zero.
+    const uint32_t nodeLimit(mStatic.mNodeLimit);
+    for (uint32_t node = 0; node < nodeLimit; ++node)
+    {
+        NodeAllocator *const allocator(mStatic.mAllocators[node]);
+        if (allocator && allocator->Contains(block))
+        {
+            return allocator;
+        }
+    }
+
+    return 0;
+}
+
+
+inline NodeAllocator::NodeAllocator(const uint32_t node, uint8_t *const arena) :
+  mNode(node),
+  mArena(arena),
+  mNextPage(arena),
+  mEnd(arena + ARENA_SIZE),
+  mLock()
+{
+    for (uint32_t index = 0; index < MAX_CLASSES; ++index)
+    {
+        mCursors[index] = 0;
+        mLimits[index] = 0;
+        mFreeLists[index] = 0;
+    }
+
+    // The first few pages hold this object itself, and are never assigned to a size class.
+    const uint32_t reservedPages((sizeof(NodeAllocator) + PAGE_SIZE - 1) / PAGE_SIZE);
+    for (uint32_t page = 0; page < PAGE_COUNT; ++page)
+    {
+        mPageClasses[page] = static_cast<uint8_t>(MAX_CLASSES);
+    }
+
+    mNextPage += reservedPages * PAGE_SIZE;
+}
+
+
+THERON_FORCEINLINE uint32_t NodeAllocator::GetNode() const
+{
+    return mNode;
+}
+
+
+inline void *NodeAllocator::Allocate(const uint32_t size)
+{
+    return AllocateAligned(size, sizeof(void *));
+}
+
+
+inline void *NodeAllocator::AllocateAligned(const uint32_t size, const uint32_t alignment)
+{
+    const uint32_t sizeClass(GetClass(size, alignment));
+    if (sizeClass < MAX_CLASSES)
+    {
+        void *block(0);
+
+        mLock.Lock();
+
+        if (FreeBlock *const freeBlock = mFreeLists[sizeClass])
+        {
+            mFreeLists[sizeClass] = freeBlock->mNext;
+            block = freeBlock;
+        }
+        else
+        {
+            // Start a new page for the size class if the current one is used up.
+            // Blocks are carved from page-aligned pages so are aligned to their size.
+            if (mCursors[sizeClass] == mLimits[sizeClass] && mNextPage < mEnd)
+            {
+                mPageClasses[(mNextPage - mArena) / PAGE_SIZE] = static_cast<uint8_t>(sizeClass);
+                mCursors[sizeClass] = mNextPage;
+                mLimits[sizeClass] = mNextPage + PAGE_SIZE;
+                mNextPage += PAGE_SIZE;
+            }
+
+            if (mCursors[sizeClass] < mLimits[sizeClass])
+            {
+                block = mCursors[sizeClass];
+                mCursors[sizeClass] += (MIN_BLOCK_SIZE << sizeClass);
+            }
+        }
+
+        mLock.Unlock();
+
+        if (block)
+        {
+            return block;
+        }
+    }
+
+    // Fall back to the global allocator for blocks we can't serve.
+    return AllocatorManager::GetCache()->AllocateAligned(size, alignment);
+}
+
+
+inline void NodeAllocator::Free(void *const block)
+{
+    if (!Contains(block))
+    {
+        AllocatorManager::GetCache()->Free(block);
+        return;
+    }
+
+    const uint32_t sizeClass(mPageClasses[(reinterpret_cast<uint8_t *>(block) - mArena) / PAGE_SIZE]);
+    THERON_ASSERT(sizeClass < MAX_CLASSES);
+
+    FreeBlock *const freeBlock(reinterpret_cast<FreeBlock *>(block));
+
+    mLock.Lock();
+    freeBlock->mNext = mFreeLists[sizeClass];
+    mFreeLists[sizeClass] = freeBlock;
+    mLock.Unlock();
+}
+
+
+inline void NodeAllocator::Free(void *const block, const uint32_t size)
+{
+    if (!Contains(block))
+    {
+        AllocatorManager::GetCache()->Free(block, size);
+        return;
+    }
+
+    // The size class is known from the page, so the size isn't needed.
+    Free(block);
+}
+
+
+THERON_FORCEINLINE uint32_t NodeAllocator::GetClass(const uint32_t size, const uint32_t alignment)
+{
+    const uint32_t minimumSize(size > alignment ? size : alignment);
+
+    uint32_t sizeClass(0);
+    while (sizeClass < MAX_CLASSES && (MIN_BLOCK_SIZE << sizeClass) < minimumSize)
+    {
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
+
+
+THERON_FORCEINLINE bool NodeAllocator::Contains(const void *const block) const
+{
+    const uint8_t *const address(reinterpret_cast<const uint8_t *>(block));
+    return (address >= mArena && address < mEnd);
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_ALLOCATORS_NODEALLOCATOR_H
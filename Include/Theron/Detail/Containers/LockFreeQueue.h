@@ -0,0 +1,237 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_CONTAINERS_LOCKFREEQUEUE_H
+#define THERON_DETAIL_CONTAINERS_LOCKFREEQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A bounded multiple-producer, multiple-consumer queue of item pointers.
+
+The queue is a fixed-size ring buffer of cells, each tagged with a sequence number
+(after Dmitry Vyukov's bounded MPMC queue). Producers and consumers claim cells by
+advancing separate positions with compare-and-exchange, and publish the claimed cells
+by updating their sequence numbers. Pushes and pops therefore never take a lock, and
+producers and consumers only contend with each other when the queue is nearly empty.
+
+Because the queue is bounded, Push fails when the queue is full. Callers are expected
+to provide their own fallback for that case, such as a secondary locked queue.
+
+\note Unlike Queue, LockFreeQueue is not intrusive and simply stores pointers to items.
+\note The capacity must be a power of two.
+*/
+template <class ItemType, uint32_t CAPACITY>
+class LockFreeQueue
+{
+public:
+
+    /**
+    Constructor
+    */
+    inline LockFreeQueue();
+
+    /**
+    Returns true if a call to Pop would return no item.
+    \note The result is only a snapshot, since other threads may push and pop concurrently.
+    */
+    inline bool Empty() const;
+
+    /**
+    Returns the number of items in the queue.
+    \note The result is only an estimate, since other threads may push and pop concurrently.
+    */
+    inline uint32_t Count() const;
+
+    /**
+    Pushes an item onto the queue.
+    \return True, if the item was pushed; false if the queue was full.
+    */
+    inline bool Push(ItemType *const item);
+
+    /**
+    Removes and returns the item at the front of the queue.
+    \return A pointer to the popped item, or zero if the queue was empty.
+    */
+    inline ItemType *Pop();
+
+private:
+
+    static const uint32_t MASK = CAPACITY - 1;
+
+    /**
+    A slot in the ring buffer.
+    */
+    struct Cell
+    {
+        Atomic::UInt32 mSequence;       ///< Position at which the cell can next be pushed or popped.
+        ItemType *mItem;                ///< Item stored in the cell, if any.
+    };
+
+    /**
+    Wrapper that pads a value to a cache line to avoid false sharing.
+    */
+    template <class ValueType>
+    struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Aligned
+    {
+        ValueType mValue;
+
+    } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+    LockFreeQueue(const LockFreeQueue &other);
+    LockFreeQueue &operator=(const LockFreeQueue &other);
+
+    Aligned<Atomic::UInt32> mPushPosition;      ///< Position at which the next item will be pushed.
+    Aligned<Atomic::UInt32> mPopPosition;       ///< Position from which the next item will be popped.
+    Cell mCells[CAPACITY];                      ///< Ring buffer of cells.
+};
+
+
+template <class ItemType, uint32_t CAPACITY>
+inline LockFreeQueue<ItemType, CAPACITY>::LockFreeQueue()
+{
+    // The capacity must be a power of two so that positions can be wrapped by masking.
+    THERON_ASSERT((CAPACITY & MASK) == 0);
+
+    for (uint32_t index = 0; index < CAPACITY; ++index)
+    {
+        mCells[index].mSequence.Store(index);
+        mCells[index].mItem = 0;
+    }
+
+    mPushPosition.mValue.Store(0);
+    mPopPosition.mValue.Store(0);
+}
+
+
+template <class ItemType, uint32_t CAPACITY>
+THERON_FORCEINLINE bool LockFreeQueue<ItemType, CAPACITY>::Empty() const
+{
+    // The cell at the pop position has been published iff its sequence is one ahead.
+    const uint32_t position(mPopPosition.mValue.Load());
+    const Cell &cell(mCells[position & MASK]);
+
+    const int32_t difference(static_cast<int32_t>(cell.mSequence.Load() - (position + 1)));
+    return (difference < 0);
+}
+
+
+template <class ItemType, uint32_t CAPACITY>
+THERON_FORCEINLINE uint32_t LockFreeQueue<ItemType, CAPACITY>::Count() const
+{
+    // Claimed but unpublished cells are counted, and the positions may be read mid-update.
+    const uint32_t popPosition(mPopPosition.mValue.Load());
+    const uint32_t pushPosition(mPushPosition.mValue.Load());
+
+    const int32_t difference(static_cast<int32_t>(pushPosition - popPosition));
+    return (difference > 0 ? static_cast<uint32_t>(difference) : 0);
+}
+
+
+template <class ItemType, uint32_t CAPACITY>
+THERON_FORCEINLINE bool LockFreeQueue<ItemType, CAPACITY>::Push(ItemType *const item)
+{
+    uint32_t position(mPushPosition.mValue.Load());
+    Cell *cell(0);
+
+    while (true)
+    {
+        cell = &mCells[position & MASK];
+
+        // The cell is free to push iff its sequence equals the push position.
+        const int32_t difference(static_cast<int32_t>(cell->mSequence.Load() - position));
+        if (difference == 0)
+        {
+            // Claim the cell. On failure the position is updated to the current value.
+            if (mPushPosition.mValue.CompareExchangeAcquire(position, position + 1))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The cell still holds an item pushed one lap ago, so the queue is full.
+            return false;
+        }
+        else
+        {
+            // Another thread claimed the cell, so try again at the latest position.
+            position = mPushPosition.mValue.Load();
+        }
+    }
+
+    // Store the item and then publish the cell to consumers.
+    cell->mItem = item;
+    cell->mSequence.Store(position + 1);
+
+    return true;
+}
+
+
+template <class ItemType, uint32_t CAPACITY>
+THERON_FORCEINLINE ItemType *LockFreeQueue<ItemType, CAPACITY>::Pop()
+{
+    uint32_t position(mPopPosition.mValue.Load());
+    Cell *cell(0);
+
+    while (true)
+    {
+        cell = &mCells[position & MASK];
+
+        // The cell is ready to pop iff its sequence is one ahead of the pop position.
+        const int32_t difference(static_cast<int32_t>(cell->mSequence.Load() - (position + 1)));
+        if (difference == 0)
+        {
+            // Claim the cell. On failure the position is updated to the current value.
+            if (mPopPosition.mValue.CompareExchangeAcquire(position, position + 1))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The cell hasn't been published yet, so the queue is empty.
+            return 0;
+        }
+        else
+        {
+            // Another thread claimed the cell, so try again at the latest position.
+            position = mPopPosition.mValue.Load();
+        }
+    }
+
+    // Read the item and then release the cell for reuse by producers on the next lap.
+    ItemType *const item(cell->mItem);
+    cell->mSequence.Store(position + MASK + 1);
+
+    return item;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_CONTAINERS_LOCKFREEQUEUE_H
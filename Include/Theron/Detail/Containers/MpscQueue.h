@@ -0,0 +1,209 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_CONTAINERS_MPSCQUEUE_H
+#define THERON_DETAIL_CONTAINERS_MPSCQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+An unbounded multiple-producer, single-consumer intrusive queue.
+
+The queue is a singly-linked list with a stub node (after Dmitry Vyukov's intrusive
+MPSC queue). Producers append items by atomically exchanging the head pointer and then
+linking the previous head to the new item, so a push is a single atomic exchange and
+never waits for other producers or for the consumer. The consumer owns the tail and
+follows the links without any atomic read-modify-write operations.
+
+Between the exchange and the link a pushed item is briefly invisible to the consumer,
+in which case Pop returns zero even though the queue isn't empty. Callers that know an
+item has been pushed, for example because they keep their own count, can simply retry.
+
+\note The queue is intrusive and reuses the links of Queue<ItemType>::Node, so the item
+type is expected to derive from Queue<ItemType>::Node. An item can't be in a Queue and
+an MpscQueue at the same time.
+\note Only one thread at a time may call Pop.
+*/
+template <class ItemType>
+class MpscQueue
+{
+public:
+
+    typedef typename Queue<ItemType>::Node Node;
+
+    /**
+    Constructor
+    */
+    inline MpscQueue();
+
+    /**
+    Destructor
+    */
+    inline ~MpscQueue();
+
+    /**
+    Pushes an item onto the back of the queue.
+    \note This can be called by any number of threads concurrently.
+    */
+    inline void Push(ItemType *const item);
+
+    /**
+    Removes and returns the item at the front of the queue.
+    \return A pointer to the popped item, or zero if the queue was empty or the item
+    at the front is still being pushed.
+    \note This can only be called by one thread at a time.
+    */
+    inline ItemType *Pop();
+
+private:
+
+    MpscQueue(const MpscQueue &other);
+    MpscQueue &operator=(const MpscQueue &other);
+
+    /**
+    Loads the link to the next node, which may be written concurrently by a producer.
+    */
+    inline static Node *LoadNext(Node *const node);
+
+    /**
+    Stores the link to the next node, which may be read concurrently by the consumer.
+    */
+    inline static void StoreNext(Node *const node, Node *const next);
+
+    /**
+    Pushes a node onto the back of the queue.
+    */
+    inline void PushNode(Node *const node);
+
+    Atomic::Pointer<Node> mHead;    ///< Most recently pushed node, shared by the producers.
+    Node *mTail;                    ///< Oldest node, owned by the consumer.
+    Node mStub;                     ///< Dummy node that keeps the list non-empty.
+};
+
+
+template <class ItemType>
+inline MpscQueue<ItemType>::MpscQueue() :
+  mHead(&mStub),
+  mTail(&mStub),
+  mStub()
+{
+}
+
+
+template <class ItemType>
+inline MpscQueue<ItemType>::~MpscQueue()
+{
+    // If the queue hasn't been emptied by the caller we'll leak the nodes.
+    THERON_ASSERT(mTail == &mStub);
+    THERON_ASSERT(mHead.Load() == &mStub);
+}
+
+
+template <class ItemType>
+THERON_FORCEINLINE void MpscQueue<ItemType>::Push(ItemType *const item)
+{
+    THERON_ASSERT(item);
+    PushNode(item);
+}
+
+
+template <class ItemType>
+THERON_FORCEINLINE ItemType *MpscQueue<ItemType>::Pop()
+{
+    Node *tail(mTail);
+    Node *next(LoadNext(tail));
+
+    // Skip the stub node if it's at the front.
+    if (tail == &mStub)
+    {
+        if (next == 0)
+        {
+            return 0;
+        }
+
+        mTail = next;
+        tail = next;
+        next = LoadNext(next);
+    }
+
+    // If the front node is linked to another then it can be popped straight away.
+    if (next)
+    {
+        mTail = next;
+        return static_cast<ItemType *>(tail);
+    }
+
+    // If the front node isn't the last pushed then a producer is midway through linking it.
+    if (tail != mHead.Load())
+    {
+        return 0;
+    }
+
+    // The front node is the only one, so push the stub behind it so it can be unlinked.
+    PushNode(&mStub);
+
+    next = LoadNext(tail);
+    if (next)
+    {
+        mTail = next;
+        return static_cast<ItemType *>(tail);
+    }
+
+    // Another producer pushed between the stub and the front node and is still linking.
+    return 0;
+}
+
+
+template <class ItemType>
+THERON_FORCEINLINE typename MpscQueue<ItemType>::Node *MpscQueue<ItemType>::LoadNext(Node *const node)
+{
+    return *static_cast<Node *volatile *>(&node->mNext);
+}
+
+
+template <class ItemType>
+THERON_FORCEINLINE void MpscQueue<ItemType>::StoreNext(Node *const node, Node *const next)
+{
+    *static_cast<Node *volatile *>(&node->mNext) = next;
+}
+
+
+template <class ItemType>
+THERON_FORCEINLINE void MpscQueue<ItemType>::PushNode(Node *const node)
+{
+    StoreNext(node, 0);
+
+    // The exchange is a full barrier, so the node's contents are visible before it's linked.
+    Node *const previous(mHead.Exchange(node));
+    StoreNext(previous, node);
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_CONTAINERS_MPSCQUEUE_H
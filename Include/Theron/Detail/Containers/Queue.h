@@ -39,7 +39,7 @@ public:
     Baseclass that adds link members to node types that derive from it.
     In order to be used with the queue, item classes must derive from Node.
     */
-    class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Node
+    class Node
     {
     public:
 
@@ -54,8 +54,7 @@ public:
 
         Node(const Node &other);
         Node &operator=(const Node &other);
-
-    } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+    };
 
     /**
     Constructor
@@ -90,6 +89,12 @@ public:
     */
     inline ItemType *Pop();
 
+    /**
+    Removes and returns the item at the back of the queue, ie. the most recently pushed item.
+    \note It's illegal to call PopBack when the queue is empty.
+    */
+    inline ItemType *PopBack();
+
 private:
 
     Queue(const Queue &other);
@@ -178,6 +183,22 @@ THERON_FORCEINLINE ItemType *Queue<ItemType>::Pop()
 }
 
 
+template <class ItemType>
+THERON_FORCEINLINE ItemType *Queue<ItemType>::PopBack()
+{
+    Node *const item(mTail.mNext);
+
+    // It's illegal to call PopBack when the queue is empty.
+    THERON_ASSERT(item != &mHead);
+
+    // Doubly-linked list remove from back, ie. in front of the dummy tail.
+    item->mNext->mPrev = &mTail;
+    mTail.mNext = item->mNext;
+
+    return static_cast<ItemType *>(item);
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
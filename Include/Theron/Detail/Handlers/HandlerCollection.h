@@ -7,6 +7,7 @@
 
 #include <Theron/Address.h>
 #include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 #include <Theron/IAllocator.h>
@@ -34,6 +35,10 @@ namespace Detail
 
 /**
 A collection of handlers for messages of different types.
+
+The registered handlers are indexed by the type of message they accept, so each message
+is passed directly to the handlers registered for its type, without visiting the others.
+The index is rebuilt whenever the registered handlers change.
 */
 class HandlerCollection
 {
@@ -85,6 +90,16 @@ private:
 
     typedef List<IMessageHandler> MessageHandlerList;
 
+    /**
+    Entry in the index of the registered handlers by message type.
+    */
+    struct TypeEntry
+    {
+        uint32_t mTypeId;               ///< Integer ID of the message type, or zero if the entry is unused.
+        uint32_t mFirst;                ///< Index of the first handler for the type in the indexed handler array.
+        uint32_t mCount;                ///< Number of handlers registered for the type.
+    };
+
     HandlerCollection(const HandlerCollection &other);
     HandlerCollection &operator=(const HandlerCollection &other);
 
@@ -94,9 +109,27 @@ private:
     */
     void UpdateHandlers();
 
+    /**
+    Rebuilds the index of the registered handlers by message type.
+    */
+    void BuildIndex();
+
+    /**
+    Frees the index of the registered handlers.
+    */
+    void FreeIndex();
+
+    /**
+    Finds the index entry for a message type, or the unused entry at which it would be added.
+    */
+    inline TypeEntry *FindEntry(const uint32_t typeId) const;
+
     MessageHandlerList mHandlers;       ///< List of handlers in the collection.
     MessageHandlerList mNewHandlers;    ///< List of handlers added since last update.
     bool mHandlersDirty;                ///< Flag indicating that the handlers are out of date.
+    TypeEntry *mTypeEntries;            ///< Open-addressed hash table of message types, or null if no handlers are registered.
+    uint32_t mTypeEntryMask;            ///< One less than the number of entries in the hash table, which is a power of two.
+    IMessageHandler **mIndexedHandlers; ///< Registered handlers grouped by message type, in registration order within each type.
 };
 
 
@@ -252,6 +285,8 @@ THERON_FORCEINLINE bool HandlerCollection::Clear()
         allocator->Free(handler);
     }
 
+    FreeIndex();
+
     mHandlersDirty = false;
     return true;
 }
@@ -275,11 +310,26 @@ THERON_FORCEINLINE bool HandlerCollection::Handle(
         UpdateHandlers();
     }
 
-    // Give each registered handler a chance to handle this message.
-    MessageHandlerList::Iterator handlers(mHandlers.GetIterator());
-    while (handlers.Next())
+    if (mTypeEntries == 0)
     {
-        IMessageHandler *const messageHandler(handlers.Get());
+        return false;
+    }
+
+    // Look up the handlers registered for the type of the message; there may be none.
+    const TypeEntry *const entry(FindEntry(message->TypeId()));
+    if (entry->mTypeId == 0)
+    {
+        return false;
+    }
+
+    // Give each handler registered for the type a chance to handle this message.
+    // Handlers deregistered by earlier handlers are only marked, so remain valid until the next update.
+    IMessageHandler *const *handlers(mIndexedHandlers + entry->mFirst);
+    IMessageHandler *const *const handlersEnd(handlers + entry->mCount);
+
+    while (handlers != handlersEnd)
+    {
+        IMessageHandler *const messageHandler(*handlers++);
 
         // We notify the scheduler, which acts as an observer.
         scheduler->BeginHandler(mailboxContext, messageHandler);
@@ -291,6 +341,25 @@ THERON_FORCEINLINE bool HandlerCollection::Handle(
 }
 
 
+THERON_FORCEINLINE HandlerCollection::TypeEntry *HandlerCollection::FindEntry(const uint32_t typeId) const
+{
+    THERON_ASSERT(mTypeEntries);
+    THERON_ASSERT(typeId);
+
+    // The type IDs are dense, so the table is indexed by the low bits of the ID directly.
+    // Only types whose IDs differ by a multiple of the table size collide.
+    uint32_t index(typeId & mTypeEntryMask);
+
+    // The table is never more than half full, so probing always ends at the entry or an unused one.
+    while (mTypeEntries[index].mTypeId != typeId && mTypeEntries[index].mTypeId != 0)
+    {
+        index = (index + 1) & mTypeEntryMask;
+    }
+
+    return mTypeEntries + index;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
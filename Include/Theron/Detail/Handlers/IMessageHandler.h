@@ -29,9 +29,15 @@ class IMessageHandler : public List<IMessageHandler>::Node
 public:
 
     /**
-    Default constructor.
+    Constructor.
+    \param messageTypeId Integer ID of the message type handled by the handler.
+    \param handlerTypeId Integer ID of the type of the handler itself.
     */
-    THERON_FORCEINLINE IMessageHandler() : mMarked(false), mPredictedSendCount(0)
+    THERON_FORCEINLINE IMessageHandler(const uint32_t messageTypeId, const uint32_t handlerTypeId) :
+      mMarked(false),
+      mPredictedSendCount(0),
+      mMessageTypeId(messageTypeId),
+      mHandlerTypeId(handlerTypeId)
     {
     }
 
@@ -67,6 +73,16 @@ public:
     */
     virtual const char *GetMessageTypeName() const = 0;
 
+    /**
+    Returns the integer ID of the message type handled by this handler.
+    */
+    inline uint32_t GetMessageTypeId() const;
+
+    /**
+    Returns the integer ID of the type of this handler, which identifies both the actor and message types.
+    */
+    inline uint32_t GetHandlerTypeId() const;
+
     /**
     Handles the given message, if it's of the type accepted by the handler.
     \return True, if the handler handled the message.
@@ -80,6 +96,8 @@ private:
 
     bool mMarked;                   ///< Flag used to mark the handler for deletion.
     uint32_t mPredictedSendCount;   ///< Number of messages that are predicted to be sent by the handler.
+    const uint32_t mMessageTypeId;  ///< Integer ID of the message type handled by the handler.
+    const uint32_t mHandlerTypeId;  ///< Integer ID of the type of the handler.
 };
 
 
@@ -111,6 +129,18 @@ THERON_FORCEINLINE uint32_t IMessageHandler::GetPredictedSendCount() const
 }
 
 
+THERON_FORCEINLINE uint32_t IMessageHandler::GetMessageTypeId() const
+{
+    return mMessageTypeId;
+}
+
+
+THERON_FORCEINLINE uint32_t IMessageHandler::GetHandlerTypeId() const
+{
+    return mHandlerTypeId;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
@@ -24,9 +24,10 @@ class IReceiverHandler : public List<IReceiverHandler>::Node
 public:
 
     /**
-    Default constructor.
+    Constructor.
+    \param handlerTypeId Integer ID of the type of the handler itself.
     */
-    THERON_FORCEINLINE IReceiverHandler()
+    THERON_FORCEINLINE explicit IReceiverHandler(const uint32_t handlerTypeId) : mHandlerTypeId(handlerTypeId)
     {
     }
 
@@ -42,6 +43,11 @@ public:
     */
     virtual const char *GetMessageTypeName() const = 0;
 
+    /**
+    Returns the integer ID of the type of this handler, which identifies both the object and message types.
+    */
+    inline uint32_t GetHandlerTypeId() const;
+
     /**
     Handles the given message, if it's of the type accepted by the handler.
     \return True, if the handler handled the message.
@@ -52,9 +58,17 @@ private:
 
     IReceiverHandler(const IReceiverHandler &other);
     IReceiverHandler &operator=(const IReceiverHandler &other);
+
+    const uint32_t mHandlerTypeId;  ///< Integer ID of the type of the handler.
 };
 
 
+THERON_FORCEINLINE uint32_t IReceiverHandler::GetHandlerTypeId() const
+{
+    return mHandlerTypeId;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
@@ -12,6 +12,7 @@
 #include <Theron/Detail/Messages/Message.h>
 #include <Theron/Detail/Messages/MessageCast.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
 
 
 namespace Theron
@@ -33,9 +34,8 @@ handler for messages that match.
 
 Incoming messages are cast at runtime to the type of message handled by the
 stored handler, and the handler is executed only if the cast succeeds (returns
-a non-zero pointer). The dynamic cast operation is specialized to use either
-C++ dynamic_cast or a hand-rolled runtime type information (RTTI) system
-that avoids introducing the type information into types other than messages.
+a non-zero pointer). The cast compares the integer type ID carried by each
+message with that of the handled type, so doesn't need C++ RTTI.
 
 \tparam ActorType The type of actor whose message handlers are considered.
 \tparam ValueType The type of message handled by this message handler.
@@ -54,7 +54,9 @@ public:
     /**
     Constructor.
     */
-    inline explicit MessageHandler(HandlerFunction function) : mHandlerFunction(function)
+    inline explicit MessageHandler(HandlerFunction function) :
+      IMessageHandler(MessageTypeId<ValueType>::Get(), MessageTypeId<MessageHandler<ActorType, ValueType> >::Get()),
+      mHandlerFunction(function)
     {
     }
 
@@ -9,6 +9,7 @@
 #include <Theron/Detail/Handlers/IMessageHandler.h>
 #include <Theron/Detail/Handlers/MessageHandler.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
 
 
 namespace Theron
@@ -25,17 +26,11 @@ If the unknown message handler is of the target type then the cast succeeds and
 to the typecast message handler is returned, otherwise a null pointer is returned.
 
 This utility roughly mimics the functionality of dynamic_cast, but includes
-two alternate implementations: one that uses dynamic_cast directly and another
-that rolls its own runtime type information only for message handler classes. The
-advantage of the second implementation is that the storage overhead of the extra
-runtime type information is not imposed on \em all classes, as with the C++ RTTI.
-If the second implementation is used consistently then dynamic_cast is not
-called at all, using a partial template specialization trick, and the C++ RTTI
-functionality can be turned off (usually by means of a compiler option).
-
-\note Partial template specialization is used here as a device to avoid
-introducing a hardcoded dependency on C++ RTTI. The dependency can be avoided
-by defining non-zero type names for all message types used in the application.
+two alternate implementations: one that compares the registered names of the
+message types, and another that compares the integer type IDs generated for
+the handler types by \ref MessageTypeId. Neither uses dynamic_cast, so the
+C++ RTTI functionality can be turned off (usually by means of a compiler option)
+whether or not the message types are registered.
 
 \tparam ActorType The actor class for which the handler is registered.
 \tparam HAS_TYPE_NAME A flag indicating whether the message type has a name.
@@ -74,7 +69,7 @@ public:
 
 
 // Specialization of the MessageHandlerCast for the case where the message type has no type name.
-// This specialization uses C++ built-in RTTI instead of explicitly stored type names.
+// This specialization compares generated handler type IDs instead of explicitly stored type names.
 template <class ActorType>
 class MessageHandlerCast<ActorType, false>
 {
@@ -92,9 +87,14 @@ public:
         // Explicit type names must be defined for all message types or none at all.
         THERON_ASSERT_MSG(handler->GetMessageTypeName() == 0, "Type names specified for only some message types!");
 
-        // Try to convert the given message handler to this type.
+        // Compare the handlers using generated type IDs, which also distinguish actor types.
         typedef MessageHandler<ActorType, ValueType> HandlerType;
-        return dynamic_cast<const HandlerType *>(handler);
+        if (handler->GetHandlerTypeId() != MessageTypeId<HandlerType>::Get())
+        {
+            return 0;
+        }
+
+        return static_cast<const HandlerType *>(handler);
     }
 };
 
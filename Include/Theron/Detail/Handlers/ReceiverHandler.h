@@ -12,6 +12,7 @@
 #include <Theron/Detail/Messages/Message.h>
 #include <Theron/Detail/Messages/MessageCast.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
 
 
 namespace Theron
@@ -28,9 +29,8 @@ handler for messages that match.
 
 Incoming messages are cast at runtime to the type of message handled by the
 stored handler, and the handler is executed only if the cast succeeds (returns
-a non-zero pointer). The dynamic cast operation is specialized to use either
-C++ dynamic_cast or a hand-rolled runtime type information (RTTI) system
-that avoids introducing the type information into types other than messages.
+a non-zero pointer). The cast compares the integer type ID carried by each
+message with that of the handled type, so doesn't need C++ RTTI.
 
 \tparam ObjectType The class on which the handler function is a method.
 \tparam ValueType The type of message handled by the message handler.
@@ -50,6 +50,7 @@ public:
     Constructor.
     */
     inline ReceiverHandler(ObjectType *const object, HandlerFunction function) :
+      IReceiverHandler(MessageTypeId<ReceiverHandler<ObjectType, ValueType> >::Get()),
       mObject(object),
       mHandlerFunction(function)
     {
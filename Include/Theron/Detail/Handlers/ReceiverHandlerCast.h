@@ -9,6 +9,7 @@
 #include <Theron/Detail/Handlers/IReceiverHandler.h>
 #include <Theron/Detail/Handlers/ReceiverHandler.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
 
 
 namespace Theron
@@ -50,7 +51,7 @@ public:
 
 
 // Specialization of the ReceiverHandlerCast for the case where the message type has no type name.
-// This specialization uses C++ built-in RTTI instead of explicitly stored type names.
+// This specialization compares generated handler type IDs instead of explicitly stored type names.
 template <class ObjectType>
 class ReceiverHandlerCast<ObjectType, false>
 {
@@ -68,9 +69,14 @@ public:
         // Explicit type names must be defined for all message types or none at all.
         THERON_ASSERT_MSG(handler->GetMessageTypeName() == 0, "Type names specified for only some message types!");
 
-        // Try to convert the given message handler to this type.
+        // Compare the handlers using generated type IDs, which also distinguish object types.
         typedef ReceiverHandler<ObjectType, ValueType> HandlerType;
-        return dynamic_cast<const HandlerType *>(handler);
+        if (handler->GetHandlerTypeId() != MessageTypeId<HandlerType>::Get())
+        {
+            return 0;
+        }
+
+        return static_cast<const HandlerType *>(handler);
     }
 };
 
@@ -6,12 +6,17 @@
 #include <Theron/Align.h>
 #include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
+#include <Theron/ActorPriority.h>
 #include <Theron/Defines.h>
+#include <Theron/OverflowPolicy.h>
 
+#include <Theron/Detail/Containers/MpscQueue.h>
 #include <Theron/Detail/Containers/Queue.h>
 #include <Theron/Detail/Messages/IMessage.h>
 #include <Theron/Detail/Strings/String.h>
+#include <Theron/Detail/Threading/Atomic.h>
 #include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
 
 
 #ifdef _MSC_VER
@@ -33,11 +38,25 @@ namespace Detail
 
 /**
 An individual mailbox with a specific address.
+
+Messages are pushed into the mailbox by any number of sending threads without locking,
+and popped by the single worker thread processing the mailbox. The atomic message count
+doubles as the scheduled state of the mailbox: the sender whose push takes the count
+from zero to one schedules the mailbox, and the mailbox stays scheduled or being processed
+until the worker thread retires the last counted message. The registered actor is
+guarded by pinning, and the lock otherwise only protects the name and options of the mailbox.
+The exception is bounded mailboxes that drop their oldest messages, whose senders can remove
+queued messages, so their messages are only pushed and popped under the lock.
 */
 class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Mailbox : public Queue<Mailbox>::Node
 {
 public:
 
+    /**
+    Worker thread index of mailboxes that aren't bound to a worker thread.
+    */
+    static const uint32_t UNBOUND = 0xFFFFFFFF;
+
     /**
     Default constructor.
     */
@@ -72,27 +91,86 @@ public:
 
     /**
     Pushes a message into the mailbox.
+    \return True if the mailbox was previously empty, in which case the caller must schedule it.
+    */
+    inline bool Push(IMessage *const message);
+
+    /**
+    Reserves a place for a message in the mailbox, unless it already holds the given number of messages.
+    A successful reservation must be followed by a call to \ref PushReserved.
+    \param limit The number of counted messages at which the reservation fails.
+    \param schedule Set to true if the mailbox was previously empty and must be scheduled by the caller.
+    \return True if a place was reserved.
+    */
+    inline bool Reserve(const uint32_t limit, bool &schedule);
+
+    /**
+    Pushes a message into a place previously reserved with \ref Reserve.
     */
-    inline void Push(IMessage *const message);
+    inline void PushReserved(IMessage *const message);
 
     /**
-    Peeks at the first message in the mailbox.
-    The message is inspected without actually being removed from the mailbox.
-    \note It's illegal to call this method when the mailbox is empty.
+    Claims the mailbox for the calling thread if it's empty, holding the given message in it
+    without queuing it. The held message is popped before any messages pushed later.
+    \return True if the mailbox was empty and has been claimed, in which case the caller must schedule or process it.
     */
-    inline IMessage *Front() const;
+    inline bool Claim(IMessage *const message);
 
     /**
-    Pops the first message from the mailbox.
-    \note It's illegal to call this method when the mailbox is empty.
+    Pops the oldest message from the mailbox.
+    The popped message remains counted until it's retired.
+    \note It's illegal to call this method unless the mailbox holds a counted message that
+    hasn't been popped. Only the worker thread processing the mailbox may call it.
     */
     inline IMessage *Pop();
 
+    /**
+    Retires a popped message, after it's been processed or discarded.
+    \return The number of messages still counted, which are left for the worker thread to pop.
+    */
+    inline uint32_t Retire();
+
     /**
     Returns the number of messages currently queued in the mailbox.
+    This includes the message being processed, if any.
     */
     inline uint32_t Count() const;
 
+    /**
+    Returns true if the mailbox is bounded and drops its oldest messages when full.
+    The messages of such mailboxes are only pushed and popped under the lock.
+    */
+    inline bool DropsOldest() const;
+
+    /**
+    Removes the oldest queued message, to make room for an arriving message that takes its place.
+    The removed message stays counted, for the arriving message, which must be pushed
+    with \ref PushReserved. A message that's already popped, for processing, isn't removed.
+    \return The removed message, or zero if no message is queued.
+    \note The caller must hold the lock, and the mailbox must drop its oldest messages.
+    */
+    inline IMessage *PopOldest();
+
+    /**
+    Gets the maximum number of messages queued in the mailbox, or zero if unbounded.
+    */
+    inline uint32_t GetCapacity() const;
+
+    /**
+    Sets the maximum number of messages queued in the mailbox, or zero for no limit.
+    */
+    inline void SetCapacity(const uint32_t capacity);
+
+    /**
+    Gets the policy applied to messages arriving while the mailbox is full.
+    */
+    inline OverflowPolicy GetOverflowPolicy() const;
+
+    /**
+    Sets the policy applied to messages arriving while the mailbox is full.
+    */
+    inline void SetOverflowPolicy(const OverflowPolicy policy);
+
     /**
     Registers an actor with this mailbox.
     \note This can't be called while the mailbox is pinned.
@@ -101,7 +179,8 @@ public:
 
     /**
     Deregisters the actor registered with this mailbox.
-    \note This can't be called while the mailbox is pinned.
+    \note Worker threads that pinned the mailbox beforehand may still be using the actor,
+    so the caller must wait for the mailbox to be unpinned before destroying it.
     */
     inline void DeregisterActor();
 
@@ -113,6 +192,8 @@ public:
 
     /**
     Pins the mailbox, preventing the registered actor from being changed.
+    \note Pinning is a full memory barrier, so a thread that pins the mailbox and then gets the
+    actor either sees the actor deregistered or is seen as pinned by the deregistering thread.
     */
     inline void Pin();
 
@@ -126,6 +207,56 @@ public:
     */
     inline bool IsPinned() const;
 
+    /**
+    Gets the scheduling priority class of the mailbox.
+    */
+    inline ActorPriority GetPriority() const;
+
+    /**
+    Sets the scheduling priority class of the mailbox.
+    */
+    inline void SetPriority(const ActorPriority priority);
+
+    /**
+    Gets the index of the worker thread to which the mailbox is bound, or UNBOUND.
+    */
+    inline uint32_t GetWorkerThread() const;
+
+    /**
+    Binds the mailbox to the worker thread with the given index, or unbinds it if UNBOUND.
+    */
+    inline void SetWorkerThread(const uint32_t thread);
+
+    /**
+    Gets the index of the mailbox within its framework.
+    */
+    inline uint32_t GetIndex() const;
+
+    /**
+    Sets the index of the mailbox within its framework.
+    */
+    inline void SetIndex(const uint32_t index);
+
+    /**
+    Returns true if the mailbox is scheduled in the blocking thread pool of its framework.
+    */
+    inline bool IsBlocking() const;
+
+    /**
+    Sets whether the mailbox is scheduled in the blocking thread pool of its framework.
+    */
+    inline void SetBlocking(const bool blocking);
+
+    /**
+    Gets the index of the scheduler group of its framework in which the mailbox is scheduled.
+    */
+    inline uint32_t GetSchedulerGroup() const;
+
+    /**
+    Sets the index of the scheduler group of its framework in which the mailbox is scheduled.
+    */
+    inline void SetSchedulerGroup(const uint32_t group);
+
     /**
     Gets a reference to the timestamp value stored in the mailbox.
     */
@@ -138,14 +269,22 @@ public:
 
 private:
 
-    typedef Queue<IMessage> MessageQueue;
+    typedef MpscQueue<IMessage> MessageQueue;
 
     MessageQueue mQueue;                        ///< Queue of messages in this mailbox.
+    IMessage *mHeldMessage;                     ///< Message held by the thread that claimed the mailbox, if any.
     String mName;                               ///< Name of this mailbox.
-    Actor *mActor;                              ///< Pointer to the actor registered with this mailbox, if any.
-    mutable SpinLock mSpinLock;                 ///< Thread synchronization object protecting the mailbox.
-    uint32_t mMessageCount;                     ///< Size of the message queue.
-    uint32_t mPinCount;                         ///< Pinning a mailboxes prevents the actor from being deregistered.
+    Atomic::Pointer<Actor> mActor;              ///< Pointer to the actor registered with this mailbox, if any.
+    mutable SpinLock mSpinLock;                 ///< Thread synchronization object protecting the name and options.
+    Atomic::UInt32 mMessageCount;               ///< Number of messages pushed and not yet retired.
+    Atomic::UInt32 mPinCount;                   ///< Pinning a mailboxes prevents the actor from being deregistered.
+    uint32_t mCapacity;                         ///< Maximum number of queued messages, or zero if unbounded.
+    OverflowPolicy mOverflowPolicy;             ///< Policy applied to messages arriving while the mailbox is full.
+    ActorPriority mPriority;                    ///< Priority class with which the mailbox is scheduled.
+    uint32_t mWorkerThread;                     ///< Index of the worker thread to which the mailbox is bound.
+    uint32_t mIndex;                            ///< Index of the mailbox within its framework.
+    bool mBlocking;                             ///< Whether the mailbox is scheduled in the blocking thread pool.
+    uint32_t mSchedulerGroup;                   ///< Index of the scheduler group in which the mailbox is scheduled.
     uint64_t mTimestamp;                        ///< Used for measuring mailbox scheduling latencies.
 
 } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
@@ -153,11 +292,19 @@ private:
 
 inline Mailbox::Mailbox() :
   mQueue(),
+  mHeldMessage(0),
   mName(),
   mActor(0),
   mSpinLock(),
   mMessageCount(0),
   mPinCount(0),
+  mCapacity(0),
+  mOverflowPolicy(OVERFLOW_POLICY_REJECT),
+  mPriority(ACTOR_PRIORITY_NORMAL),
+  mWorkerThread(UNBOUND),
+  mIndex(0),
+  mBlocking(false),
+  mSchedulerGroup(0),
   mTimestamp(0)
 {
 }
@@ -189,79 +336,239 @@ THERON_FORCEINLINE void Mailbox::Unlock() const
 
 THERON_FORCEINLINE bool Mailbox::Empty() const
 {
-    return mQueue.Empty();
+    return (mMessageCount.Load() == 0);
+}
+
+
+THERON_FORCEINLINE bool Mailbox::Push(IMessage *const message)
+{
+    // The message is linked before it's counted, so a counted message is never missing
+    // from the queue, though it may still be midway through being linked.
+    mQueue.Push(message);
+    return (mMessageCount.Increment() == 1);
+}
+
+
+THERON_FORCEINLINE bool Mailbox::Reserve(const uint32_t limit, bool &schedule)
+{
+    // Reserve a place for the message by counting it first, so the count never exceeds the limit.
+    uint32_t count(mMessageCount.Load());
+    while (true)
+    {
+        if (count >= limit)
+        {
+            return false;
+        }
+
+        // On failure the count is updated to the current value.
+        if (mMessageCount.CompareExchangeAcquire(count, count + 1))
+        {
+            break;
+        }
+    }
+
+    schedule = (count == 0);
+    return true;
 }
 
 
-THERON_FORCEINLINE void Mailbox::Push(IMessage *const message)
+THERON_FORCEINLINE void Mailbox::PushReserved(IMessage *const message)
 {
     mQueue.Push(message);
-    ++mMessageCount;
 }
 
 
-THERON_FORCEINLINE IMessage *Mailbox::Front() const
+THERON_FORCEINLINE bool Mailbox::Claim(IMessage *const message)
 {
-    return mQueue.Front();
+    // Only a sender that takes the count from zero can claim the mailbox, and nothing else
+    // touches the held message until the claiming thread schedules or processes the mailbox.
+    uint32_t count(0);
+    if (mMessageCount.CompareExchangeAcquire(count, 1))
+    {
+        mHeldMessage = message;
+        return true;
+    }
+
+    return false;
 }
 
 
 THERON_FORCEINLINE IMessage *Mailbox::Pop()
 {
-    --mMessageCount;
-    return mQueue.Pop();
+    // A message held by a thread that claimed the mailbox was counted before any queued ones.
+    if (IMessage *const message = mHeldMessage)
+    {
+        mHeldMessage = 0;
+        return message;
+    }
+
+    // A counted message may still be being linked by its sender, which takes moments.
+    uint32_t backoff(0);
+    while (true)
+    {
+        if (IMessage *const message = mQueue.Pop())
+        {
+            return message;
+        }
+
+        Utils::Backoff(backoff);
+    }
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::Retire()
+{
+    THERON_ASSERT(mMessageCount.Load() > 0);
+    return mMessageCount.Decrement();
 }
 
 
 THERON_FORCEINLINE uint32_t Mailbox::Count() const
 {
-    return mMessageCount;
+    return mMessageCount.Load();
+}
+
+
+THERON_FORCEINLINE bool Mailbox::DropsOldest() const
+{
+    return (mCapacity != 0 && mOverflowPolicy == OVERFLOW_POLICY_DROP_OLDEST);
+}
+
+
+THERON_FORCEINLINE IMessage *Mailbox::PopOldest()
+{
+    // Bounded mailboxes are never claimed, so there's no held message. The lock makes the
+    // caller the only consumer of the queue, and ensures no push is midway through linking.
+    return mQueue.Pop();
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::GetCapacity() const
+{
+    return mCapacity;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetCapacity(const uint32_t capacity)
+{
+    mCapacity = capacity;
+}
+
+
+THERON_FORCEINLINE OverflowPolicy Mailbox::GetOverflowPolicy() const
+{
+    return mOverflowPolicy;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetOverflowPolicy(const OverflowPolicy policy)
+{
+    mOverflowPolicy = policy;
 }
 
 
 THERON_FORCEINLINE void Mailbox::RegisterActor(Actor *const actor)
 {
     // Can't register actors while the mailbox is pinned.
-    THERON_ASSERT(mPinCount == 0);
-    THERON_ASSERT(mActor == 0);
+    THERON_ASSERT(mPinCount.Load() == 0);
+    THERON_ASSERT(mActor.Load() == 0);
     THERON_ASSERT(actor);
 
-    mActor = actor;
+    mActor.Store(actor);
 }
 
 
 THERON_FORCEINLINE void Mailbox::DeregisterActor()
 {
-    // Can't deregister actors while the mailbox is pinned.
-    THERON_ASSERT(mPinCount == 0);
-    THERON_ASSERT(mActor != 0);
+    THERON_ASSERT(mActor.Load() != 0);
 
-    mActor = 0;
+    // The store is a full memory barrier, so it's ordered before any later check of the pin count.
+    mActor.Store(0);
 }
 
 
 THERON_FORCEINLINE Actor *Mailbox::GetActor() const
 {
-    return mActor;
+    return mActor.Load();
 }
 
 
 THERON_FORCEINLINE void Mailbox::Pin()
 {
-    ++mPinCount;
+    mPinCount.Increment();
 }
 
 
 THERON_FORCEINLINE void Mailbox::Unpin()
 {
-    THERON_ASSERT(mPinCount > 0);
-    --mPinCount;
+    THERON_ASSERT(mPinCount.Load() > 0);
+    mPinCount.Decrement();
 }
 
 
 THERON_FORCEINLINE bool Mailbox::IsPinned() const
 {
-    return (mPinCount > 0);
+    return (mPinCount.Load() > 0);
+}
+
+
+THERON_FORCEINLINE ActorPriority Mailbox::GetPriority() const
+{
+    return mPriority;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetPriority(const ActorPriority priority)
+{
+    mPriority = priority;
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::GetWorkerThread() const
+{
+    return mWorkerThread;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetWorkerThread(const uint32_t thread)
+{
+    mWorkerThread = thread;
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::GetIndex() const
+{
+    return mIndex;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetIndex(const uint32_t index)
+{
+    mIndex = index;
+}
+
+
+THERON_FORCEINLINE bool Mailbox::IsBlocking() const
+{
+    return mBlocking;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetBlocking(const bool blocking)
+{
+    mBlocking = blocking;
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::GetSchedulerGroup() const
+{
+    return mSchedulerGroup;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetSchedulerGroup(const uint32_t group)
+{
+    mSchedulerGroup = group;
 }
 
 
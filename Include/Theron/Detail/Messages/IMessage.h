@@ -53,11 +53,12 @@ public:
 
     /**
     Returns the message value as blind data.
+    \note The value is usually at the start of the message's own block, but may be shared with other messages.
     */
     THERON_FORCEINLINE const void *GetMessageData() const
     {
-        THERON_ASSERT(mBlock);
-        return mBlock;
+        THERON_ASSERT(mData);
+        return mData;
     }
 
     /**
@@ -72,6 +73,15 @@ public:
     */
     virtual const char *TypeName() const = 0;
 
+    /**
+    Returns the integer ID of the message type.
+    Unlike the type name the ID is always defined, whether or not the type is registered.
+    */
+    THERON_FORCEINLINE uint32_t TypeId() const
+    {
+        return mTypeId;
+    }
+
     /**
     Allows the message instance to destruct its constructed value object before being freed.
     */
@@ -91,15 +101,20 @@ protected:
     \param from The address from which the message was sent.
     \param block The memory block containing the message.
     \param blockSize The size of the memory block containing the message.
-    \param typeName String identifier uniquely identifying the type of the message value.
+    \param data Pointer to the message value.
+    \param typeId Integer ID uniquely identifying the type of the message value.
     */
     THERON_FORCEINLINE IMessage(
         const Address &from,
         void *const block,
-        const uint32_t blockSize) :
+        const uint32_t blockSize,
+        const void *const data,
+        const uint32_t typeId) :
       mFrom(from),
       mBlock(block),
-      mBlockSize(blockSize)
+      mData(data),
+      mBlockSize(blockSize),
+      mTypeId(typeId)
     {
     }
 
@@ -110,7 +125,9 @@ private:
 
     const Address mFrom;            ///< The address from which the message was sent.
     void *const mBlock;             ///< Pointer to the memory block containing the message.
+    const void *const mData;        ///< Pointer to the message value, in the block or shared with other messages.
     const uint32_t mBlockSize;      ///< Total size of the message memory block in bytes.
+    const uint32_t mTypeId;         ///< Integer ID of the type of the message value.
 };
 
 
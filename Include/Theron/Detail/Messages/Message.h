@@ -14,6 +14,11 @@
 #include <Theron/Detail/Messages/IMessage.h>
 #include <Theron/Detail/Messages/MessageSize.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
+
+#if THERON_CPP11
+#include <utility>
+#endif // THERON_CPP11
 
 
 namespace Theron
@@ -77,6 +82,28 @@ public:
         return new (pObject) ThisType(pValue, from);
     }
 
+#if THERON_CPP11
+
+    /**
+    Initializes a message of this type in the provided memory block, constructing the
+    value in place from the given constructor arguments rather than copying it.
+    The block is allocated and freed by the caller.
+    */
+    template <class... ArgTypes>
+    THERON_FORCEINLINE static ThisType *Emplace(void *const block, const Address &from, ArgTypes &&... args)
+    {
+        THERON_ASSERT(block);
+
+        // Construct the value at the start of the buffer, forwarding the arguments so that
+        // values passed as rvalues are moved into the message instead of copied.
+        ValueType *const pValue = new (block) ValueType(std::forward<ArgTypes>(args)...);
+
+        char *const pObject(reinterpret_cast<char *>(pValue) + MessageSize<ValueType>::GetSize());
+        return new (pObject) ThisType(pValue, from);
+    }
+
+#endif // THERON_CPP11
+
     /**
     Returns the name of the message type.
     This uniquely identifies the type of the message value.
@@ -113,8 +140,24 @@ public:
     */
     THERON_FORCEINLINE const ValueType &Value() const
     {
-        // The value is stored at the start of the memory block.
-        return *reinterpret_cast<const ValueType *>(GetBlock());
+        // The value is usually stored at the start of the memory block, but may be shared.
+        return *reinterpret_cast<const ValueType *>(GetMessageData());
+    }
+
+protected:
+
+    /**
+    Constructor used by derived message kinds whose values aren't stored in their own blocks.
+    */
+    THERON_FORCEINLINE Message(
+        void *const block,
+        const uint32_t blockSize,
+        const ValueType *const value,
+        const Address &from) :
+      IMessage(from, block, blockSize, value, MessageTypeId<ValueType>::Get())
+    {
+        THERON_ASSERT(block);
+        THERON_ASSERT(value);
     }
 
 private:
@@ -123,7 +166,7 @@ private:
     Private constructor.
     */
     THERON_FORCEINLINE Message(void *const block, const Address &from) :
-      IMessage(from, block, ThisType::GetSize())
+      IMessage(from, block, ThisType::GetSize(), block, MessageTypeId<ValueType>::Get())
     {
         THERON_ASSERT(block);
     }
@@ -9,6 +9,7 @@
 #include <Theron/Detail/Messages/IMessage.h>
 #include <Theron/Detail/Messages/Message.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
 
 
 namespace Theron
@@ -24,18 +25,14 @@ to a message of a known type at runtime, using stored runtime type information.
 If the unknown message is of the target type then the cast succeeds and a pointer
 to the typecast message is returned, otherwise a null pointer is returned.
 
-This utility roughly mimics the functionality of dynamic_cast, but includes
-two alternate implementations: one that uses dynamic_cast directly and another
-that rolls its own runtime type information only for message classes. The
-advantage of the second implementation is that the storage overhead of the extra
-runtime type information is not imposed on \em all classes, as with the C++ RTTI.
-If the second implementation is used consistently then dynamic_cast is not
-called at all, using a partial template specialization trick, and the C++ RTTI
-functionality can be turned off (usually by means of a compiler option).
+This utility roughly mimics the functionality of dynamic_cast. Every message
+carries the integer ID generated for its value type by \ref MessageTypeId, and
+the cast succeeds if the ID matches that of the target type. So the cast is a
+single integer comparison, and doesn't rely on C++ RTTI whether or not the
+message type has a registered name.
 
-\note Partial template specialization is used here as a device to avoid
-introducing a hardcoded dependency on C++ RTTI. The dependency can be avoided
-by defining non-zero type IDs for all message types used in the application.
+\note The two specializations differ only in the consistency checks they make
+on the registered names, which must be defined for all message types or none.
 
 \tparam HAS_TYPE_ID A flag indicating whether the message type has a name.
 */
@@ -59,8 +56,8 @@ public:
         // If explicit type names are used then they must be defined for all message types.
         THERON_ASSERT_MSG(message->TypeName(), "Message type has null type name");
 
-        // Check the type of the message using the type name it carries, which was set on creation.
-        if (message->TypeName() == MessageTraits<ValueType>::TYPE_NAME)
+        // Check the type of the message using the type ID it carries, which was set on creation.
+        if (message->TypeId() == MessageTypeId<ValueType>::Get())
         {
             // Hard-convert the given message to the indicated type.
             return reinterpret_cast<const Message<ValueType> *>(message);
@@ -72,7 +69,6 @@ public:
 
 
 // Specialization of MessageCast for the case where the message has no type name.
-// This specialization uses C++ built-in RTTI instead of the explicitly stored type names.
 template <>
 class MessageCast<false>
 {
@@ -96,14 +92,13 @@ public:
         // Explicit type IDs must be defined for all message types or none at all.
         THERON_ASSERT_MSG(message->TypeName() == 0, "Only some message types are registered!");
 
-        // Try to convert the given message to a message of the expected type.
-        // The dynamic_cast used here requires Runtime Type Information (RTTI) support.
-        // If you see a failure here then check RTTI is enabled in your build,
-        // or if you actually intend to turn it off then register your message type name
-        // with THERON_REGISTER_MESSAGE() -- see the RegisteringMessages sample.
-        // That causes the default (unspecialized) version of this class to be used,
-        // which doesn't try to use dynamic_cast so doesn't require RTTI.
-        return dynamic_cast<const Message<ValueType> *>(message);
+        // The generated type ID identifies unregistered types too, so no dynamic_cast is needed.
+        if (message->TypeId() == MessageTypeId<ValueType>::Get())
+        {
+            return reinterpret_cast<const Message<ValueType> *>(message);
+        }
+
+        return 0;
     }
 };
 
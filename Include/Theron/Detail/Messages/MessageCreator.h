@@ -7,9 +7,16 @@
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 #include <Theron/IAllocator.h>
+#include <Theron/SharedValue.h>
 
+#include <Theron/Detail/Allocators/NodeAllocator.h>
 #include <Theron/Detail/Messages/IMessage.h>
 #include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/SharedMessage.h>
+
+#if THERON_CPP11
+#include <utility>
+#endif // THERON_CPP11
 
 
 namespace Theron
@@ -34,6 +41,28 @@ public:
         const ValueType &value,
         const Address &from);
 
+    /**
+    Allocates and constructs a message referencing the payload of a shared value, without copying the value.
+    */
+    template <class ValueType>
+    inline static Message<ValueType> *Create(
+        IAllocator *const messageAllocator,
+        const SharedValue<ValueType> &value,
+        const Address &from);
+
+#if THERON_CPP11
+
+    /**
+    Allocates and constructs a message whose value is constructed in place from the given arguments.
+    */
+    template <class ValueType, class... ArgTypes>
+    inline static Message<ValueType> *Emplace(
+        IAllocator *const messageAllocator,
+        const Address &from,
+        ArgTypes &&... args);
+
+#endif // THERON_CPP11
+
     /**
     Destructs and frees a message of unknown type referenced by an interface pointer.
     */
@@ -68,6 +97,56 @@ THERON_FORCEINLINE Message<ValueType> *MessageCreator::Create(
 }
 
 
+template <class ValueType>
+THERON_FORCEINLINE Message<ValueType> *MessageCreator::Create(
+    IAllocator *const messageAllocator,
+    const SharedValue<ValueType> &value,
+    const Address &from)
+{
+    typedef SharedMessage<ValueType> MessageType;
+
+    if (value.mPayload == 0)
+    {
+        return 0;
+    }
+
+    // Only the message object is allocated; it references the payload, which holds the value.
+    // The message is destroyed like any other, releasing its reference to the payload.
+    void *const block = messageAllocator->AllocateAligned(MessageType::GetSize(), MessageType::GetAlignment());
+    if (block)
+    {
+        return MessageType::Initialize(block, value.mPayload, from);
+    }
+
+    return 0;
+}
+
+
+#if THERON_CPP11
+
+template <class ValueType, class... ArgTypes>
+THERON_FORCEINLINE Message<ValueType> *MessageCreator::Emplace(
+    IAllocator *const messageAllocator,
+    const Address &from,
+    ArgTypes &&... args)
+{
+    typedef Message<ValueType> MessageType;
+
+    const uint32_t blockSize(MessageType::GetSize());
+    const uint32_t blockAlignment(MessageType::GetAlignment());
+
+    void *const block = messageAllocator->AllocateAligned(blockSize, blockAlignment);
+    if (block)
+    {
+        return MessageType::Emplace(block, from, std::forward<ArgTypes>(args)...);
+    }
+
+    return 0;
+}
+
+#endif // THERON_CPP11
+
+
 THERON_FORCEINLINE void MessageCreator::Destroy(
     IAllocator *const messageAllocator,
     IMessage *const message)
@@ -79,8 +158,17 @@ THERON_FORCEINLINE void MessageCreator::Destroy(
     // This calls the derived Message class destructor by virtual function magic.
     message->~IMessage();
 
+    // Blocks allocated from node-local memory are returned to the node they came from,
+    // since they can't be freed by any other allocator.
+    void *const block(message->GetBlock());
+    if (IAllocator *const nodeAllocator = NodeAllocator::GetOwner(block))
+    {
+        nodeAllocator->Free(block, message->GetBlockSize());
+        return;
+    }
+
     // Return the block to the global free list.
-    messageAllocator->Free(message->GetBlock(), message->GetBlockSize());
+    messageAllocator->Free(block, message->GetBlockSize());
 }
 
 
@@ -20,9 +20,11 @@ registered in the receiving actor.
 
 The default implementation defines a null pointer (no name) for all types.
 The null pointer is a reserved value and implies that the type has no explicit name.
-Types with null names are matched by means of dynamic_cast, which
-relies on RTTI (Runtime Type Information - the automatic storing of a
-type identifier in every class). By default Theron uses RTTI exclusively.
+Messages are matched to handlers by an integer ID generated for every type,
+named or not, and registered handlers for types with null names are found
+by the generated IDs of the handler types when they're deregistered or queried.
+So neither relies on RTTI (Runtime Type Information - the automatic storing
+of a type identifier in every class).
 
 The availability of RTTI is a compilation option, usually on by default
 and disabled by means of an optional compiler flag. It introduces a small
@@ -30,7 +32,8 @@ size overhead into every class due to the need to store a hidden identifier to
 identify the class's type. Note that this overhead is applied to all classes
 and not just messages within Theron. The overhead is not normally a problem,
 however in applications with tightly constrained memory requirements (such as
-embedded environments and games consoles) it is undesirable.
+embedded environments and games consoles) it is undesirable, and Theron can
+be built with it disabled.
 
 The dependency on RTTI can be avoided by specifying non-null names
 for all message types used in the application. Users can define
@@ -58,8 +61,7 @@ struct MessageTraits
     /**
     \brief Indicates whether the message type has an explicit name.
     Message types for which have valid type names are identified
-    using their names rather than with built-in C++ Runtime Type Information
-    (RTTI) via dynamic_cast.
+    using their names rather than with generated integer type IDs.
     */
     static const bool HAS_TYPE_NAME = false;
     
@@ -0,0 +1,85 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_MESSAGETYPEID_H
+#define THERON_DETAIL_MESSAGES_MESSAGETYPEID_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Mutex.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Non-template baseclass of \ref MessageTypeId, which allocates the IDs.
+*/
+class MessageTypeIdBase
+{
+protected:
+
+    /**
+    Allocates the next free ID to a type, unless another thread has already done so.
+    \param id The ID of the type, which is zero until allocated.
+    \return The ID allocated to the type.
+    */
+    static uint32_t Allocate(volatile uint32_t &id);
+
+private:
+
+    static Mutex smMutex;               ///< Synchronization object protecting allocation.
+    static uint32_t smCount;            ///< Number of IDs allocated so far.
+};
+
+
+/**
+\brief Generates a small integer uniquely identifying a message value type.
+
+The IDs are allocated on first use, counting up from one, so unlike the names in
+\ref MessageTraits they need neither registration nor C++ RTTI. Every message carries
+the ID of its value type, so matching a message to a handler is an integer comparison,
+and since the IDs are dense they can be used to index tables.
+
+\note Two types have the same ID only if they're the same type, which matches the
+exact-type semantics of dynamic_cast applied to \ref Message. The IDs are unique within
+the process, but may differ between runs and between processes. Message handler types
+draw their IDs from the same sequence, so handlers can be matched without RTTI too.
+*/
+template <class ValueType>
+class MessageTypeId : public MessageTypeIdBase
+{
+public:
+
+    /**
+    Gets the ID of the value type, allocating it on first use.
+    */
+    THERON_FORCEINLINE static uint32_t Get()
+    {
+        const uint32_t id(smId);
+        if (id != 0)
+        {
+            return id;
+        }
+
+        return Allocate(smId);
+    }
+
+private:
+
+    static volatile uint32_t smId;      ///< ID of the type, or zero if not yet allocated.
+};
+
+
+template <class ValueType>
+volatile uint32_t MessageTypeId<ValueType>::smId = 0;
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_MESSAGETYPEID_H
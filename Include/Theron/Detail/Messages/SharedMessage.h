@@ -0,0 +1,108 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_SHAREDMESSAGE_H
+#define THERON_DETAIL_MESSAGES_SHAREDMESSAGE_H
+
+
+#include <new>
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/MessageSize.h>
+#include <Theron/Detail/Messages/SharedPayload.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Message whose value is a reference-counted payload shared with other messages.
+
+The block of a shared message holds only the message object, which references the
+payload. Since it's a \ref Message of the value type, handlers receive the value exactly
+as they would the value of an ordinary message.
+*/
+template <class ValueType>
+class SharedMessage : public Message<ValueType>
+{
+public:
+
+    typedef SharedMessage<ValueType> ThisType;
+
+    /**
+    Returns the memory block size required to initialize a message of this type.
+    */
+    THERON_FORCEINLINE static uint32_t GetSize()
+    {
+        return static_cast<uint32_t>(sizeof(ThisType));
+    }
+
+    /**
+    Returns the memory block alignment required to initialize a message of this type.
+    */
+    THERON_FORCEINLINE static uint32_t GetAlignment()
+    {
+        return static_cast<uint32_t>(sizeof(void *));
+    }
+
+    /**
+    Initializes a message of this type in the provided memory block, adding a reference to the payload.
+    The block is allocated and freed by the caller.
+    */
+    THERON_FORCEINLINE static ThisType *Initialize(
+        void *const block,
+        SharedPayload<ValueType> *const payload,
+        const Address &from)
+    {
+        THERON_ASSERT(block);
+        THERON_ASSERT(payload);
+
+        payload->Reference();
+        return new (block) ThisType(block, payload, from);
+    }
+
+    /**
+    Releases the message's reference to the payload, which is destroyed with the last reference.
+    */
+    virtual void Release()
+    {
+        mPayload->Release();
+    }
+
+    /**
+    Returns the size in bytes of the message value.
+    */
+    virtual uint32_t GetMessageSize() const
+    {
+        return MessageSize<ValueType>::GetSize();
+    }
+
+private:
+
+    THERON_FORCEINLINE SharedMessage(
+        void *const block,
+        SharedPayload<ValueType> *const payload,
+        const Address &from) :
+      Message<ValueType>(block, ThisType::GetSize(), &payload->Value(), from),
+      mPayload(payload)
+    {
+    }
+
+    SharedMessage(const SharedMessage &other);
+    SharedMessage &operator=(const SharedMessage &other);
+
+    SharedPayload<ValueType> *const mPayload;       ///< The shared payload holding the message value.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_SHAREDMESSAGE_H
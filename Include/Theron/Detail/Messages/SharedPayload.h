@@ -0,0 +1,182 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_SHAREDPAYLOAD_H
+#define THERON_DETAIL_MESSAGES_SHAREDPAYLOAD_H
+
+
+#include <new>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Alignment/MessageAlignment.h>
+#include <Theron/Detail/Messages/MessageSize.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+#if THERON_CPP11
+#include <utility>
+#endif // THERON_CPP11
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Reference-counted, immutable message value shared by any number of messages.
+
+The value and the payload object that counts the references to it are allocated
+together in a single block, laid out like the block of a \ref Message, with the value
+first. The block is freed when the last reference is released.
+*/
+template <class ValueType>
+class SharedPayload
+{
+public:
+
+    typedef SharedPayload<ValueType> ThisType;
+
+    /**
+    Allocates a payload holding a copy of the given value, with a single reference.
+    \return A pointer to the payload, or null if the allocation failed.
+    */
+    inline static ThisType *Create(const ValueType &value);
+
+#if THERON_CPP11
+
+    /**
+    Allocates a payload whose value is constructed in place from the given arguments, with a single reference.
+    \return A pointer to the payload, or null if the allocation failed.
+    */
+    template <class... ArgTypes>
+    inline static ThisType *Emplace(ArgTypes &&... args);
+
+#endif // THERON_CPP11
+
+    /**
+    Adds a reference to the payload.
+    */
+    inline void Reference();
+
+    /**
+    Releases a reference to the payload, destroying the value and freeing the payload if it was the last.
+    */
+    inline void Release();
+
+    /**
+    Gets the shared value.
+    */
+    inline const ValueType &Value() const;
+
+private:
+
+    THERON_FORCEINLINE SharedPayload() : mReferenceCount(1)
+    {
+    }
+
+    SharedPayload(const SharedPayload &other);
+    SharedPayload &operator=(const SharedPayload &other);
+
+    /**
+    Allocates the block holding a payload and its value.
+    */
+    inline static void *Allocate();
+
+    Atomic::UInt32 mReferenceCount;     ///< Number of references to the payload, including from messages.
+};
+
+
+template <class ValueType>
+THERON_FORCEINLINE void *SharedPayload<ValueType>::Allocate()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    // Payloads outlive the messages that reference them, and are released by whichever
+    // thread drops the last reference, so they're allocated from the thread-safe global cache.
+    return allocator->AllocateAligned(
+        MessageSize<ValueType>::GetSize() + static_cast<uint32_t>(sizeof(ThisType)),
+        MessageAlignment<ValueType>::ALIGNMENT);
+}
+
+
+template <class ValueType>
+inline SharedPayload<ValueType> *SharedPayload<ValueType>::Create(const ValueType &value)
+{
+    void *const block(Allocate());
+    if (block == 0)
+    {
+        return 0;
+    }
+
+    // The value is copied once, here, however many messages it's sent in.
+    ValueType *const pValue = new (block) ValueType(value);
+    char *const pObject(reinterpret_cast<char *>(pValue) + MessageSize<ValueType>::GetSize());
+
+    return new (pObject) ThisType();
+}
+
+
+#if THERON_CPP11
+
+template <class ValueType>
+template <class... ArgTypes>
+inline SharedPayload<ValueType> *SharedPayload<ValueType>::Emplace(ArgTypes &&... args)
+{
+    void *const block(Allocate());
+    if (block == 0)
+    {
+        return 0;
+    }
+
+    ValueType *const pValue = new (block) ValueType(std::forward<ArgTypes>(args)...);
+    char *const pObject(reinterpret_cast<char *>(pValue) + MessageSize<ValueType>::GetSize());
+
+    return new (pObject) ThisType();
+}
+
+#endif // THERON_CPP11
+
+
+template <class ValueType>
+THERON_FORCEINLINE void SharedPayload<ValueType>::Reference()
+{
+    mReferenceCount.Increment();
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE void SharedPayload<ValueType>::Release()
+{
+    if (mReferenceCount.Decrement() == 0)
+    {
+        IAllocator *const allocator(AllocatorManager::GetCache());
+
+        void *const block(const_cast<ValueType *>(&Value()));
+        const uint32_t blockSize(MessageSize<ValueType>::GetSize() + static_cast<uint32_t>(sizeof(ThisType)));
+
+        Value().~ValueType();
+        this->~SharedPayload();
+
+        allocator->Free(block, blockSize);
+    }
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE const ValueType &SharedPayload<ValueType>::Value() const
+{
+    // The value is stored at the start of the block, immediately before the payload object.
+    const char *const pObject(reinterpret_cast<const char *>(this));
+    return *reinterpret_cast<const ValueType *>(pObject - MessageSize<ValueType>::GetSize());
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_SHAREDPAYLOAD_H
@@ -43,6 +43,14 @@ enum Counter
     COUNTER_QUEUE_LATENCY_LOCAL_MAX,    ///< Maximum recorded local queue latency in microseconds.
     COUNTER_QUEUE_LATENCY_SHARED_MIN,   ///< Minimum recorded shared queue latency in microseconds.
     COUNTER_QUEUE_LATENCY_SHARED_MAX,   ///< Maximum recorded shared queue latency in microseconds.
+    COUNTER_STEALS,                     ///< Number of times a mailbox was stolen from another thread's local queue.
+    COUNTER_MAILBOX_VISITS,             ///< Number of times a worker thread popped a mailbox and processed its messages.
+    COUNTER_MESSAGES_PER_VISIT_MAX,     ///< Maximum number of messages processed in a single visit to a mailbox.
+    COUNTER_NODE_STEALS,                ///< Number of times a mailbox was taken from the work queue of another NUMA node.
+    COUNTER_QUEUE_LATENCY_LOW_MAX,      ///< Maximum recorded queue latency of low priority actors in microseconds.
+    COUNTER_QUEUE_LATENCY_NORMAL_MAX,   ///< Maximum recorded queue latency of normal priority actors in microseconds.
+    COUNTER_QUEUE_LATENCY_HIGH_MAX,     ///< Maximum recorded queue latency of high priority actors in microseconds.
+    COUNTER_INBOX_PUSHES,               ///< Number of times a mailbox was pushed to the inbox of its bound worker thread.
     MAX_COUNTERS                        ///< Number of counters available for querying.
 };
 
@@ -59,6 +67,7 @@ public:
 
     inline static void Reset(Atomic::UInt32 &counter, const uint32_t id);
     inline static void Increment(Atomic::UInt32 &counter);
+    inline static void Add(Atomic::UInt32 &counter, const uint32_t n);
     inline static void Raise(Atomic::UInt32 &counter, const uint32_t n);
     inline static void Lower(Atomic::UInt32 &counter, const uint32_t n);
     inline static void Accumulate(const Atomic::UInt32 &counter, const uint32_t id, uint32_t &n);
@@ -123,6 +132,22 @@ THERON_FORCEINLINE void Counting::Increment(Atomic::UInt32 & THERON_COUNTER_ARG(
 }
 
 
+THERON_FORCEINLINE void Counting::Add(Atomic::UInt32 & THERON_COUNTER_ARG(counter), const uint32_t THERON_COUNTER_ARG(n))
+{
+#if THERON_ENABLE_COUNTERS
+
+    uint32_t currentValue(counter.Load());
+    uint32_t backoff(0);
+
+    while (!counter.CompareExchangeAcquire(currentValue, currentValue + n))
+    {
+        Utils::Backoff(backoff);
+    }
+
+#endif
+}
+
+
 THERON_FORCEINLINE void Counting::Raise(Atomic::UInt32 & THERON_COUNTER_ARG(counter), const uint32_t THERON_COUNTER_ARG(n))
 {
 #if THERON_ENABLE_COUNTERS
@@ -179,6 +204,10 @@ THERON_FORCEINLINE void Counting::Accumulate(
         case COUNTER_MAILBOX_QUEUE_MAX:
         case COUNTER_QUEUE_LATENCY_LOCAL_MAX:
         case COUNTER_QUEUE_LATENCY_SHARED_MAX:
+        case COUNTER_MESSAGES_PER_VISIT_MAX:
+        case COUNTER_QUEUE_LATENCY_LOW_MAX:
+        case COUNTER_QUEUE_LATENCY_NORMAL_MAX:
+        case COUNTER_QUEUE_LATENCY_HIGH_MAX:
         {
             if (val > n)
             {
@@ -21,6 +21,7 @@ namespace Detail
 
 class FallbackHandlerCollection;
 class MailboxContext;
+class Timer;
 
 
 /**
@@ -73,6 +74,44 @@ public:
     */
     virtual void Schedule(MailboxContext *const mailboxContext, Mailbox *const mailbox) = 0;
 
+    /**
+    Schedules for processing a batch of mailboxes that have received messages, such as the
+    recipients of a multicast message, pushing them to the work queues together.
+    */
+    virtual void ScheduleBatch(MailboxContext *const mailboxContext, Mailbox *const *const mailboxes, const uint32_t count) = 0;
+
+    /**
+    Notifies the scheduler that a worker thread has processed a number of messages from a mailbox in one visit.
+    */
+    virtual void EndVisit(MailboxContext *const mailboxContext, const uint32_t messageCount) = 0;
+
+    /**
+    Starts a timer, taking ownership of it.
+    \return A non-zero handle identifying the timer, or zero if it couldn't be started.
+    */
+    virtual uint32_t StartTimer(Timer *const timer) = 0;
+
+    /**
+    Cancels a pending timer.
+    \return True if the timer was cancelled before its message was delivered.
+    */
+    virtual bool CancelTimer(const uint32_t handle) = 0;
+
+    /**
+    Discards any pending timers and stops accepting new ones, so no more messages are sent by them.
+    */
+    virtual void StopTimers() = 0;
+
+    /**
+    Gets the total number of messages sent to local mailboxes via the contexts of the worker threads.
+    */
+    virtual uint32_t GetMessagesSent() const = 0;
+
+    /**
+    Gets the total number of messages processed or discarded via the contexts of the worker threads.
+    */
+    virtual uint32_t GetMessagesRetired() const = 0;
+
     /**
     Sets a maximum limit on the number of worker threads enabled in the scheduler.
     */
@@ -121,6 +160,14 @@ public:
         uint32_t *const perThreadCounts,
         const uint32_t maxCounts) const = 0;
 
+    /**
+    Gets the current value of a specified event counter, accumulated for the worker threads of each NUMA node.
+    */
+    virtual uint32_t GetPerNodeCounterValues(
+        const uint32_t counter,
+        uint32_t *const perNodeCounts,
+        const uint32_t maxCounts) const = 0;
+
 private:
 
     IScheduler(const IScheduler &other);
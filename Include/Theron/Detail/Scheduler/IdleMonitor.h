@@ -0,0 +1,120 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_IDLEMONITOR_H
+#define THERON_DETAIL_SCHEDULER_IDLEMONITOR_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Condition.h>
+#include <Theron/Detail/Threading/Lock.h>
+#include <Theron/Detail/Threading/Mutex.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Condition on which threads wait for a framework to become idle.
+
+Waiting threads arm the monitor before checking whether the framework is idle, and then
+wait on it if it's still armed. Worker threads wake the monitor each time they
+empty a mailbox, but only the first to find it armed disarms it and takes the lock, so
+while no threads are waiting the cost to the worker threads is a single load.
+
+\note A worker thread must retire its messages with a full memory barrier before waking
+the monitor, so that either the waiting thread sees the retirement or the worker thread
+sees the monitor armed.
+*/
+class IdleMonitor
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline IdleMonitor() : mArmed(0), mCondition()
+    {
+    }
+
+    /**
+    Returns a reference to the mutex that waiting threads lock.
+    */
+    THERON_FORCEINLINE Mutex &GetMutex()
+    {
+        return mCondition.GetMutex();
+    }
+
+    /**
+    Arms the monitor, so that the next worker thread to empty a mailbox wakes the waiting threads.
+    \note The calling thread must hold a lock on the mutex of the monitor.
+    */
+    THERON_FORCEINLINE void Arm()
+    {
+        mArmed.Store(1);
+    }
+
+    /**
+    Checks whether the monitor is still armed, and so hasn't been woken since it was armed.
+    */
+    THERON_FORCEINLINE bool IsArmed() const
+    {
+        return (mArmed.Load() != 0);
+    }
+
+    /**
+    Suspends the calling thread until the monitor is woken, or until the given time has elapsed.
+    \note The calling thread must hold a lock on the mutex of the monitor.
+    */
+    THERON_FORCEINLINE void Wait(Lock &lock, const uint32_t milliseconds)
+    {
+        mCondition.Wait(lock, milliseconds);
+    }
+
+    /**
+    Wakes any threads waiting on the monitor, if it's armed.
+    Called by worker threads after emptying a mailbox.
+    */
+    THERON_FORCEINLINE void Wake()
+    {
+        uint32_t armed(1);
+        if (mArmed.Load() && mArmed.CompareExchangeAcquire(armed, 0))
+        {
+            // Taking the lock ensures a thread that armed the monitor is already waiting on it.
+            Lock lock(mCondition.GetMutex());
+            mCondition.PulseAll();
+        }
+    }
+
+private:
+
+    IdleMonitor(const IdleMonitor &other);
+    IdleMonitor &operator=(const IdleMonitor &other);
+
+    Atomic::UInt32 mArmed;          ///< Set while threads are waiting for the framework to become idle.
+    Condition mCondition;           ///< Condition on which the waiting threads sleep.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_IDLEMONITOR_H
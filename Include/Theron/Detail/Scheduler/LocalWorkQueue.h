@@ -0,0 +1,137 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_LOCALWORKQUEUE_H
+#define THERON_DETAIL_SCHEDULER_LOCALWORKQUEUE_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A small bounded work queue private to a single worker thread.
+
+The queue has a LIFO 'next' slot holding the most recently pushed item, backed by a FIFO ring
+of older items. Pop returns the item in the next slot first, so the last mailbox scheduled
+by a handler is processed next, while its data is still warm in the cache. Items displaced
+from the next slot wait in the ring in the order they were pushed.
+
+When the ring is full, pushing displaces the oldest item in the ring, which is returned to
+the caller so it can be pushed to a shared queue instead.
+
+\note The queue isn't thread-safe and should only be accessed by the thread that owns it.
+\note The capacity of the ring must be a power of two.
+*/
+template <class ItemType, uint32_t CAPACITY>
+class LocalWorkQueue
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline LocalWorkQueue() : mNext(0), mHead(0), mCount(0)
+    {
+        THERON_ASSERT((CAPACITY & MASK) == 0);
+    }
+
+    /**
+    Returns true if the queue contains no items.
+    */
+    inline bool Empty() const
+    {
+        return (mNext == 0 && mCount == 0);
+    }
+
+    /**
+    Returns the number of items waiting in the ring, excluding the next slot.
+    */
+    inline uint32_t RingCount() const
+    {
+        return mCount;
+    }
+
+    /**
+    Pushes an item into the next slot, moving any previous occupant into the ring.
+    \return The oldest item in the ring if it was displaced because the ring was full, otherwise zero.
+    */
+    inline ItemType *Push(ItemType *const item)
+    {
+        ItemType *const previous(mNext);
+        ItemType *displaced(0);
+
+        mNext = item;
+
+        if (previous)
+        {
+            if (mCount == CAPACITY)
+            {
+                displaced = PopOldest();
+            }
+
+            mItems[(mHead + mCount) & MASK] = previous;
+            ++mCount;
+        }
+
+        return displaced;
+    }
+
+    /**
+    Pops the item in the next slot, or the oldest item in the ring if the next slot is empty.
+    \return The popped item, or zero if the queue is empty.
+    */
+    inline ItemType *Pop()
+    {
+        if (mNext)
+        {
+            ItemType *const item(mNext);
+            mNext = 0;
+            return item;
+        }
+
+        return PopOldest();
+    }
+
+    /**
+    Pops the oldest item in the ring, leaving the next slot untouched.
+    \return The popped item, or zero if the ring is empty.
+    */
+    inline ItemType *PopOldest()
+    {
+        if (mCount == 0)
+        {
+            return 0;
+        }
+
+        ItemType *const item(mItems[mHead]);
+        mHead = (mHead + 1) & MASK;
+        --mCount;
+
+        return item;
+    }
+
+private:
+
+    static const uint32_t MASK = CAPACITY - 1;
+
+    LocalWorkQueue(const LocalWorkQueue &other);
+    LocalWorkQueue &operator=(const LocalWorkQueue &other);
+
+    ItemType *mNext;                ///< Most recently pushed item, popped first.
+    uint32_t mHead;                 ///< Index of the oldest item in the ring.
+    uint32_t mCount;                ///< Number of items in the ring.
+    ItemType *mItems[CAPACITY];     ///< Ring of items displaced from the next slot.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_SCHEDULER_LOCALWORKQUEUE_H
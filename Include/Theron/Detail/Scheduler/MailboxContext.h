@@ -9,7 +9,9 @@
 
 #include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
 #include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/IdleMonitor.h>
 #include <Theron/Detail/Scheduler/IScheduler.h>
+#include <Theron/Detail/Threading/Atomic.h>
 
 
 namespace Theron
@@ -21,8 +23,10 @@ namespace Detail
 /**
 Context structure holding data used by a worker thread to process mailboxes.
 
-\note The members of a single context are all accessed only by one worker thread
-so we don't need to worry about shared writes, including false sharing.
+\note The members of a single context are all written only by one worker thread
+so we don't need to worry about shared writes, including false sharing. The message
+counts are read by other threads, when checking whether the framework is idle, so
+they're atomics, stored with release semantics and loaded with acquire semantics.
 */
 class MailboxContext
 {
@@ -37,8 +41,14 @@ public:
       mFallbackHandlers(0),
       mMessageAllocator(0),
       mMailbox(0),
+      mMessagesPerVisit(1),
       mPredictedSendCount(0),
-      mSendCount(0)
+      mSendCount(0),
+      mContinuation(0),
+      mContinuationDepth(0),
+      mIdleMonitor(0),
+      mMessagesSent(0),
+      mMessagesRetired(0)
     {
     }
 
@@ -47,8 +57,14 @@ public:
     FallbackHandlerCollection *mFallbackHandlers;       ///< Pointer to fallback handlers for undelivered messages.
     IAllocator *mMessageAllocator;                      ///< Pointer to message memory block allocator.
     Mailbox *mMailbox;                                  ///< Pointer to the mailbox that is being processed.
+    uint32_t mMessagesPerVisit;                         ///< Maximum number of messages processed per visit to a mailbox.
     uint32_t mPredictedSendCount;                       ///< Number of messages predicted to be sent by the handler.
     uint32_t mSendCount;                                ///< Messages sent so far by the handler being executed.
+    Mailbox *mContinuation;                             ///< Mailbox to be processed directly after the current one, if any.
+    uint32_t mContinuationDepth;                        ///< Maximum number of mailboxes processed in succession by continuation.
+    IdleMonitor *mIdleMonitor;                          ///< Pointer to the monitor woken when a mailbox is emptied.
+    Atomic::UInt32 mMessagesSent;                       ///< Total messages sent to local mailboxes via this context.
+    Atomic::UInt32 mMessagesRetired;                    ///< Total messages processed or discarded via this context.
 
 private:
 
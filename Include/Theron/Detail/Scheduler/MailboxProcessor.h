@@ -11,7 +11,9 @@
 #include <Theron/Detail/Mailboxes/Mailbox.h>
 #include <Theron/Detail/Messages/IMessage.h>
 #include <Theron/Detail/Messages/MessageCreator.h>
+#include <Theron/Detail/Scheduler/MailboxContext.h>
 #include <Theron/Detail/Scheduler/WorkerContext.h>
+#include <Theron/Detail/Threading/Clock.h>
 
 
 namespace Theron
@@ -36,15 +38,84 @@ public:
     
 private:
 
+    /**
+    Maximum time in microseconds for which a worker thread processes mailboxes in succession
+    by continuation, before queuing the next one instead.
+    */
+    static const uint32_t CONTINUATION_TIME_BUDGET = 100;
+
+    /**
+    Number of continuations between checks of the time budget, since reading the clock
+    costs about as much as a continuation itself.
+    */
+    static const uint32_t CONTINUATION_CLOCK_INTERVAL = 16;
+
     MailboxProcessor(const MailboxProcessor &other);
     MailboxProcessor &operator=(const MailboxProcessor &other);
+
+    /**
+    Processes up to the per-visit quota of messages from a mailbox.
+    */
+    inline static void Visit(MailboxContext *const mailboxContext, Mailbox *const mailbox);
 };
 
 
 THERON_FORCEINLINE void MailboxProcessor::Process(WorkerContext *const workerContext, Mailbox *const mailbox)
 {
-    // Load the context data from the worker thread's mailbox context.
     MailboxContext *const mailboxContext(&workerContext->mMailboxContext);
+
+    Visit(mailboxContext, mailbox);
+
+    // The last empty mailbox messaged by the handlers executed in the visit may have been
+    // claimed as a continuation, to be processed directly by this thread without being queued.
+    // Continuations are followed up to a maximum depth and time, so that a chain of actors
+    // messaging each other can't monopolize the thread. Once the budget is spent the pending
+    // continuation is scheduled as usual.
+    Mailbox *continuation(mailboxContext->mContinuation);
+    if (continuation == 0)
+    {
+        return;
+    }
+
+    const uint32_t maxDepth(mailboxContext->mContinuationDepth);
+    uint64_t deadline(0);
+    uint32_t depth(0);
+
+    while (continuation)
+    {
+        mailboxContext->mContinuation = 0;
+
+        bool expired(depth == maxDepth);
+        if ((depth % CONTINUATION_CLOCK_INTERVAL) == 0)
+        {
+            const uint64_t now(Clock::GetTicks());
+            if (depth == 0)
+            {
+                deadline = now + CONTINUATION_TIME_BUDGET * Clock::GetFrequency() / 1000000;
+            }
+            else if (now >= deadline)
+            {
+                expired = true;
+            }
+        }
+
+        ++depth;
+
+        if (expired)
+        {
+            mailboxContext->mScheduler->Schedule(mailboxContext, continuation);
+            return;
+        }
+
+        Visit(mailboxContext, continuation);
+        continuation = mailboxContext->mContinuation;
+    }
+}
+
+
+THERON_FORCEINLINE void MailboxProcessor::Visit(MailboxContext *const mailboxContext, Mailbox *const mailbox)
+{
+    // Load the context data from the worker thread's mailbox context.
     FallbackHandlerCollection *const fallbackHandlers(mailboxContext->mFallbackHandlers);
     IAllocator *const messageAllocator(mailboxContext->mMessageAllocator);
 
@@ -54,44 +125,91 @@ THERON_FORCEINLINE void MailboxProcessor::Process(WorkerContext *const workerCon
     // Remember the mailbox we're processing in the context so we can query it.
     mailboxContext->mMailbox = mailbox;
 
-    // Pin the mailbox and get the registered actor and the first queued message.
+    // Pin the mailbox and get the registered actor. Pinning is a full memory barrier, so either
+    // we see the actor deregistered or the deregistering thread sees the mailbox pinned and waits.
+    // Neither the senders nor the worker threads lock the mailbox.
     // At this point the mailbox shouldn't be enqueued in any other work items,
     // even if it contains more than one unprocessed message. This ensures that
     // each mailbox is only processed by one worker thread at a time.
-    mailbox->Lock();
     mailbox->Pin();
     Actor *const actor(mailbox->GetActor());
-    IMessage *const message(mailbox->Front());
-    mailbox->Unlock();
 
-    // If an actor is registered at the mailbox then process it.
-    if (actor)
-    {
-        actor->ProcessMessage(mailboxContext, fallbackHandlers, message);
-    }
-    else
+    // Process up to the per-visit quota of messages before rescheduling the mailbox.
+    // The mailbox stays pinned for the whole visit, so the registered actor can't change.
+    const uint32_t messagesPerVisit(mailboxContext->mMessagesPerVisit);
+    uint32_t messageCount(0);
+    uint32_t remaining(0);
+
+    while (true)
     {
-        fallbackHandlers->Handle(message);
+        // The mailbox is only scheduled while it has counted messages, so there's one to pop.
+        // Senders to mailboxes that drop their oldest messages remove queued messages under
+        // the lock, so we pop those under the lock too. The policy is checked for each message,
+        // since the actor may change it in its handlers.
+        IMessage *message(0);
+        if (mailbox->DropsOldest())
+        {
+            mailbox->Lock();
+            message = mailbox->Pop();
+            mailbox->Unlock();
+        }
+        else
+        {
+            message = mailbox->Pop();
+        }
+
+        // If an actor is registered at the mailbox then process it.
+        if (actor)
+        {
+            actor->ProcessMessage(mailboxContext, fallbackHandlers, message);
+        }
+        else
+        {
+            fallbackHandlers->Handle(message);
+        }
+
+        ++messageCount;
+
+        // Destroy the message and then retire it from the mailbox count. If messages remain,
+        // and the quota isn't used up, we carry on and process the next message without
+        // rescheduling the mailbox. Messages pushed after the count reaches zero cause
+        // their senders to schedule the mailbox afresh. The message is also counted as
+        // retired in the context, for threads waiting for the framework to become idle.
+        // The release store publishes the sender's count of the message along with it.
+        MessageCreator::Destroy(messageAllocator, message);
+        mailboxContext->mMessagesRetired.StoreRelease(mailboxContext->mMessagesRetired.LoadAcquire() + 1);
+        remaining = mailbox->Retire();
+
+        if (remaining == 0 || messageCount >= messagesPerVisit)
+        {
+            break;
+        }
     }
 
-    // Pop the message we just processed from the mailbox, then check whether the
-    // mailbox is now empty, and reschedule the mailbox if it's not.
-    // The locking of the mailbox here and in the main scheduling ensures that
-    // mailboxes are always enqueued if they have unprocessed messages, but at most
-    // once at any time.
-    mailbox->Lock();
+    // Reschedule the mailbox if it still has unprocessed messages.
+    // The count ensures that mailboxes are always enqueued if they have unprocessed
+    // messages, but at most once at any time: no sender schedules the mailbox while
+    // the count is non-zero, so that's left to us.
     mailbox->Unpin();
-    mailbox->Pop();
 
-    if (!mailbox->Empty())
+    if (remaining)
     {
         mailboxContext->mScheduler->Schedule(mailboxContext, mailbox);
     }
+    else
+    {
+        // The framework can only become idle when a mailbox is emptied, so wake any threads
+        // waiting for it to do so. Retiring the message was a full memory barrier, so either
+        // they see it retired or we see them waiting. This is a single load if none are waiting.
+        mailboxContext->mIdleMonitor->Wake();
+    }
+
+#if THERON_ENABLE_COUNTERS
 
-    mailbox->Unlock();
+    // Report the number of messages processed in this visit, for the event counters.
+    mailboxContext->mScheduler->EndVisit(mailboxContext, messageCount);
 
-    // Destroy the message, but only after we've popped it from the queue.
-    MessageCreator::Destroy(messageAllocator, message);
+#endif // THERON_ENABLE_COUNTERS
 }
 
 
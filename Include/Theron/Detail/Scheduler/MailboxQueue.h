@@ -3,18 +3,24 @@
 #define THERON_DETAIL_SCHEDULER_MAILBOXQUEUE_H
 
 
+#include <Theron/ActorPriority.h>
 #include <Theron/Align.h>
 #include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
 #include <Theron/YieldStrategy.h>
 
+#include <Theron/Detail/Containers/LockFreeQueue.h>
 #include <Theron/Detail/Containers/Queue.h>
 #include <Theron/Detail/Mailboxes/Mailbox.h>
 #include <Theron/Detail/Scheduler/Counting.h>
+#include <Theron/Detail/Scheduler/LocalWorkQueue.h>
+#include <Theron/Detail/Scheduler/QueueCounters.h>
+#include <Theron/Detail/Scheduler/QueueWaker.h>
 #include <Theron/Detail/Scheduler/SchedulerHints.h>
 #include <Theron/Detail/Threading/Atomic.h>
-#include <Theron/Detail/Threading/Clock.h>
+#include <Theron/Detail/Threading/SpinLock.h>
 #include <Theron/Detail/Threading/Utils.h>
 
 
@@ -32,6 +38,30 @@ namespace Detail
 
 /**
 \brief Generic mailbox queue implementation with specialized per-thread local queues.
+
+The queue shared by all worker threads is a lock-free ring buffer, so pushing and popping
+mailboxes doesn't serialize on the monitor lock. The monitor is only used to put idle worker
+threads to sleep and to wake them. If the ring buffer fills up, further mailboxes are pushed
+to a secondary locked overflow queue until the overflow has drained.
+
+Each worker thread also has a small private local queue, holding mailboxes scheduled by the
+handlers it executes. The most recently scheduled mailbox is popped first, so it's processed
+while still warm in the cache, and older ones wait in a bounded FIFO ring behind it. Handlers
+that send to several actors can therefore keep all of the work local, rather than spilling
+to the shared queue. To keep mailboxes in the shared queue from being starved, a thread with
+local work still yields to the shared queue once every LOCAL_POP_BUDGET pops. While other
+threads are idle, surplus local work is handed back to the shared queue so they can take it.
+
+The shared queue is split by actor priority class. Threads pop from the highest priority class
+with work, except that every PRIORITY_WEIGHT pops a lower class is tried first, so that busy
+high priority actors can't starve the others. Threads with local work still take waiting high
+priority mailboxes first.
+
+Mailboxes can also be bound to a single worker thread, indexed in the order the threads are
+first started. Each thread has a private locked inbox, into which mailboxes bound to it are
+always pushed, bypassing both the local and shared queues so they never migrate to other
+threads. Threads serve their inboxes before any other work. While a bound thread isn't
+running, mailboxes bound to it are pushed to the shared queue as normal.
 */
 template <class MonitorType>
 class MailboxQueue
@@ -43,6 +73,26 @@ public:
     */
     typedef Mailbox ItemType;
 
+    /**
+    Capacity of the ring of each worker thread's local queue, beyond which mailboxes go to the shared queue.
+    */
+    static const uint32_t LOCAL_QUEUE_CAPACITY = 16;
+
+    /**
+    Number of consecutive pops from a thread's local queue after which it yields to the shared queue.
+    */
+    static const uint32_t LOCAL_POP_BUDGET = 64;
+
+    /**
+    Number of pops from the shared queue in which each lower priority class is tried first once.
+    */
+    static const uint32_t PRIORITY_WEIGHT = 8;
+
+    /**
+    Maximum number of worker threads to which mailboxes can be bound.
+    */
+    static const uint32_t MAX_BOUND_THREADS = 64;
+
     /**
     Context structure used to access the queue.
     */
@@ -55,24 +105,31 @@ public:
         inline ContextType() :
           mRunning(false),
           mShared(false),
-          mLocalWorkQueue(0)
+          mWaiting(false),
+          mLocalPops(0),
+          mSharedPops(0),
+          mIndex(MAX_BOUND_THREADS),
+          mLocalWorkQueue(),
+          mInboxCount(0),
+          mInboxLock(),
+          mInbox()
         {
         }
 
     private:
 
-        template <class ValueType>
-        struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Aligned
-        {
-            ValueType mValue;
-
-        } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
-
         bool mRunning;                                      ///< Used to signal the thread to terminate.
         bool mShared;                                       ///< Indicates whether this is the 'shared' context.
-        Mailbox *mLocalWorkQueue;                           ///< Local thread-specific single-item work queue.
+        bool mWaiting;                                      ///< Indicates whether the thread is waiting on the monitor.
+        uint32_t mLocalPops;                                ///< Number of consecutive pops from the local queue.
+        uint32_t mSharedPops;                               ///< Number of pops from the shared queue, for weighting priorities.
+        uint32_t mIndex;                                    ///< Index by which mailboxes are bound to the thread.
+        LocalWorkQueue<Mailbox, LOCAL_QUEUE_CAPACITY> mLocalWorkQueue;  ///< Local thread-specific work queue.
+        Atomic::UInt32 mInboxCount;                         ///< Number of mailboxes in the inbox.
+        mutable SpinLock mInboxLock;                        ///< Protects the inbox.
+        Queue<Mailbox> mInbox;                              ///< Holds mailboxes bound to the thread.
         typename MonitorType::Context mMonitorContext;      ///< Per-thread monitor primitive context.
-        Aligned<Atomic::UInt32> mCounters[MAX_COUNTERS];    ///< Array of per-context event counters.
+        QueueCounters mCounters;                            ///< Per-context event counters.
     };
 
     /**
@@ -100,6 +157,26 @@ public:
     */
     inline void ReleaseWorkerContext(ContextType *const context);
 
+    /**
+    Binds a worker thread context to a NUMA node. This queue isn't partitioned by node.
+    \param bound Set to false, since threads aren't bound to particular nodes.
+    \return The node mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignNode(ContextType *const context, const uint32_t nodeMask, bool &bound);
+
+    /**
+    Restricts a worker thread context to a subset of the processors in the given processor mask.
+    This queue doesn't pin threads to processors.
+    \return The processor mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignProcessors(ContextType *const context, const uint32_t processorMask);
+
+    /**
+    Restricts a worker thread context to a subset of the processors in the given processor set.
+    This queue doesn't pin threads to processors, so leaves the set unchanged.
+    */
+    inline void AssignProcessors(ContextType *const context, ProcessorSet &processorSet);
+
     /**
     Resets to zero the given counter for the given thread context.
     */
@@ -128,6 +205,16 @@ public:
     */
     inline bool Running(const ContextType *const context) const;
 
+    /**
+    Returns an estimate of the number of mailboxes waiting in the shared work queue.
+    */
+    inline uint32_t GetQueueDepth() const;
+
+    /**
+    Returns the number of worker threads currently waiting for work.
+    */
+    inline uint32_t GetIdleThreadCount() const;
+
     /**
     Wakes any worker threads which are blocked waiting for the queue to become non-empty.
     */
@@ -138,28 +225,119 @@ public:
     */
     inline void Push(ContextType *const context, Mailbox *mailbox, const SchedulerHints &hints);
 
+    /**
+    Pushes a batch of mailboxes into the queue, scheduling them for processing.
+    */
+    inline void PushBatch(ContextType *const context, Mailbox *const *const mailboxes, const uint32_t count, const SchedulerHints &hints);
+
     /**
     Pops a previously pushed mailbox from the queue for processing.
     */
     inline Mailbox *Pop(ContextType *const context);
 
+    /**
+    Records that a number of messages were processed from a popped mailbox.
+    */
+    inline void EndVisit(ContextType *const context, const uint32_t messageCount);
+
 private:
 
     MailboxQueue(const MailboxQueue &other);
     MailboxQueue &operator=(const MailboxQueue &other);
 
-    inline static bool PreferLocalQueue(
+    /**
+    Capacity of the lock-free shared work queue, beyond which mailboxes go to the overflow queue.
+    */
+    static const uint32_t SHARED_QUEUE_CAPACITY = 1024;
+
+    /**
+    Number of actor priority classes, each with its own shared work queue.
+    */
+    static const uint32_t PRIORITY_COUNT = ACTOR_PRIORITY_HIGH + 1;
+
+    /**
+    Lock-free shared work queue for a single priority class, with a locked overflow queue.
+    */
+    struct SharedQueue
+    {
+        inline SharedQueue() : mWorkQueue(), mOverflowCount(0), mOverflowLock(), mOverflowQueue()
+        {
+        }
+
+        LockFreeQueue<Mailbox, SHARED_QUEUE_CAPACITY> mWorkQueue;   ///< Lock-free work queue shared by all the threads.
+        Atomic::UInt32 mOverflowCount;                              ///< Number of mailboxes in the overflow queue.
+        mutable SpinLock mOverflowLock;                             ///< Protects the overflow queue.
+        Queue<Mailbox> mOverflowQueue;                              ///< Holds mailboxes pushed while the work queue is full.
+    };
+
+    inline bool PreferLocalQueue(
         const ContextType *const context,
-        const SchedulerHints &hints);
+        const SchedulerHints &hints) const;
+
+    /**
+    Moves a surplus mailbox from a thread's local queue to the shared queue, if other threads are idle.
+    */
+    inline void ShareLocalWork(ContextType *const context);
 
-    mutable MonitorType mMonitor;           ///< Synchronizes access to the shared queue.
-    Queue<Mailbox> mSharedWorkQueue;        ///< Work queue shared by all the threads in a scheduler.
+    /**
+    Returns the context of the running worker thread to which a mailbox is bound, if any.
+    */
+    inline ContextType *GetBoundContext(const Mailbox *const mailbox) const;
+
+    /**
+    Pushes a mailbox onto the inbox of the worker thread to which it is bound, waking the thread if it's waiting.
+    \return False if the thread has been stopped, in which case the mailbox wasn't pushed.
+    */
+    inline bool PushInbox(ContextType *const boundContext, Mailbox *const mailbox);
+
+    /**
+    Pops a mailbox from the inbox of the given worker thread, if it is non-empty.
+    */
+    inline static Mailbox *PopInbox(ContextType *const context);
+
+    /**
+    Returns true if the shared work queues of all priority classes, including their overflows, are empty.
+    */
+    inline bool SharedEmpty() const;
+
+    /**
+    Returns true if the shared work queue of the given priority class, including its overflow, is empty.
+    */
+    inline static bool SharedEmpty(const SharedQueue &queue);
+
+    /**
+    Pushes a mailbox onto the shared work queue of its priority class, or the overflow queue if it is full.
+    */
+    inline void PushShared(Mailbox *const mailbox);
+
+    /**
+    Pops a mailbox from the shared work queues, choosing between the priority classes by weight.
+    */
+    inline Mailbox *PopShared(ContextType *const context);
+
+    /**
+    Pops a mailbox from the shared work queue of a single priority class or its overflow queue.
+    */
+    inline static Mailbox *PopShared(SharedQueue &queue);
+
+    mutable MonitorType mMonitor;                   ///< Used by idle threads to wait for the shared queue to become non-empty.
+    SharedQueue mSharedQueues[PRIORITY_COUNT];      ///< Work queues shared by all the threads in a scheduler, one per priority class.
+    Atomic::UInt32 mWaitingThreads;                 ///< Number of worker threads waiting on the monitor.
+    Atomic::UInt32 mBoundThreadCount;               ///< Number of worker thread contexts registered for binding.
+    ContextType *mBoundContexts[MAX_BOUND_THREADS]; ///< Worker thread contexts to which mailboxes can be bound, by index.
 };
 
 
 template <class MonitorType>
-inline MailboxQueue<MonitorType>::MailboxQueue(const YieldStrategy yieldStrategy) : mMonitor(yieldStrategy)
+inline MailboxQueue<MonitorType>::MailboxQueue(const YieldStrategy yieldStrategy) :
+  mMonitor(yieldStrategy),
+  mWaitingThreads(0),
+  mBoundThreadCount(0)
 {
+    for (uint32_t index = 0; index < MAX_BOUND_THREADS; ++index)
+    {
+        mBoundContexts[index] = 0;
+    }
 }
 
 
@@ -175,13 +353,26 @@ inline void MailboxQueue<MonitorType>::InitializeWorkerContext(ContextType *cons
 {
     // Only worker threads should call this method.
     context->mShared = false;
+    context->mWaiting = false;
+
+    // Register the context on its first start, so mailboxes can be bound to it by index.
+    // Contexts are only started by the manager thread, so there are no competing registrations.
+    // The pointer is stored before the count is raised, so pushing threads never see a null entry.
+    if (context->mIndex >= MAX_BOUND_THREADS && mBoundThreadCount.Load() < MAX_BOUND_THREADS)
+    {
+        context->mIndex = mBoundThreadCount.Load();
+        mBoundContexts[context->mIndex] = context;
+        mBoundThreadCount.Increment();
+    }
+
+    context->mInboxLock.Lock();
     context->mRunning = true;
+    context->mInboxLock.Unlock();
 
     mMonitor.InitializeWorkerContext(&context->mMonitorContext);
 
     // The minimum counters need to be initialized to maxint.
-    Counting::Reset(context->mCounters[COUNTER_QUEUE_LATENCY_LOCAL_MIN].mValue, COUNTER_QUEUE_LATENCY_LOCAL_MIN);
-    Counting::Reset(context->mCounters[COUNTER_QUEUE_LATENCY_SHARED_MIN].mValue, COUNTER_QUEUE_LATENCY_SHARED_MIN);
+    context->mCounters.Initialize();
 }
 
 
@@ -195,21 +386,47 @@ template <class MonitorType>
 inline void MailboxQueue<MonitorType>::ReleaseWorkerContext(ContextType *const context)
 {
     typename MonitorType::LockType lock(mMonitor);
+
+    // Clearing the flag under the inbox lock ensures no mailboxes are pushed to the inbox
+    // after the thread has drained it and terminated.
+    context->mInboxLock.Lock();
     context->mRunning = false;
+    context->mInboxLock.Unlock();
+}
+
+
+template <class MonitorType>
+inline uint32_t MailboxQueue<MonitorType>::AssignNode(ContextType *const /*context*/, const uint32_t nodeMask, bool &bound)
+{
+    bound = false;
+    return nodeMask;
+}
+
+
+template <class MonitorType>
+inline uint32_t MailboxQueue<MonitorType>::AssignProcessors(ContextType *const /*context*/, const uint32_t processorMask)
+{
+    return processorMask;
+}
+
+
+template <class MonitorType>
+inline void MailboxQueue<MonitorType>::AssignProcessors(ContextType *const /*context*/, ProcessorSet &/*processorSet*/)
+{
 }
 
 
 template <class MonitorType>
 inline void MailboxQueue<MonitorType>::ResetCounter(ContextType *const context, const uint32_t counter) const
 {
-    Counting::Reset(context->mCounters[counter].mValue, counter);
+    context->mCounters.Reset(counter);
 }
 
 
 template <class MonitorType>
 THERON_FORCEINLINE uint32_t MailboxQueue<MonitorType>::GetCounterValue(const ContextType *const context, const uint32_t counter) const
 {
-    return Counting::Get(context->mCounters[counter].mValue);
+    return context->mCounters.Get(counter);
 }
 
 
@@ -219,7 +436,7 @@ THERON_FORCEINLINE void MailboxQueue<MonitorType>::AccumulateCounterValue(
     const uint32_t counter,
     uint32_t &accumulator) const
 {
-    Counting::Accumulate(context->mCounters[counter].mValue, counter, accumulator);
+    context->mCounters.Accumulate(counter, accumulator);
 }
 
 
@@ -228,21 +445,42 @@ THERON_FORCEINLINE bool MailboxQueue<MonitorType>::Empty(const ContextType *cons
 {
     // Check the context's local queue.
     // If the provided context is the shared context then it doesn't have a local queue.
-    if (!context->mShared && context->mLocalWorkQueue)
+    if (!context->mShared && (!context->mLocalWorkQueue.Empty() || context->mInboxCount.Load() != 0))
     {
         return false;
     }
 
     // Check the shared work queue.
-    typename MonitorType::LockType lock(mMonitor);
-    return mSharedWorkQueue.Empty();
+    return SharedEmpty();
 }
 
 
 template <class MonitorType>
 THERON_FORCEINLINE bool MailboxQueue<MonitorType>::Running(const ContextType *const context) const
 {
-    return context->mRunning;
+    // A stopped thread keeps running until it has drained its local queue and inbox, so no work is stranded.
+    return (context->mRunning || !context->mLocalWorkQueue.Empty() || context->mInboxCount.Load() != 0);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t MailboxQueue<MonitorType>::GetQueueDepth() const
+{
+    // Mailboxes held in the local queues are handed back to the shared queue when threads are idle.
+    uint32_t depth(0);
+    for (uint32_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+    {
+        depth += mSharedQueues[priority].mWorkQueue.Count() + mSharedQueues[priority].mOverflowCount.Load();
+    }
+
+    return depth;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t MailboxQueue<MonitorType>::GetIdleThreadCount() const
+{
+    return mWaitingThreads.Load();
 }
 
 
@@ -259,55 +497,101 @@ THERON_FORCEINLINE void MailboxQueue<MonitorType>::Push(
     Mailbox *mailbox,
     const SchedulerHints &hints)
 {
-#if THERON_ENABLE_COUNTERS
-    
-    // Timestamp the mailbox on entry.
-    mailbox->Timestamp() = Clock::GetTicks();
-
-#endif // THERON_ENABLE_COUNTERS
+    // Timestamp the mailbox and update the maximum mailbox queue length seen by this thread.
+    context->mCounters.CountPush(mailbox);
 
-    // Update the maximum mailbox queue length seen by this thread.
-    Counting::Raise(context->mCounters[COUNTER_MAILBOX_QUEUE_MAX].mValue, mailbox->Count());
+    // Mailboxes bound to a running worker thread always go to its inbox, even when it's the
+    // calling thread, so that they can't be handed on to other threads from the local queue.
+    if (ContextType *const boundContext = GetBoundContext(mailbox))
+    {
+        if (PushInbox(boundContext, mailbox))
+        {
+            context->mCounters.Increment(COUNTER_INBOX_PUSHES);
+            return;
+        }
+    }
 
     // Choose whether to push the scheduled mailbox to the calling thread's
     // local queue (if the calling thread is a worker thread executing a message
     // handler) or the shared queue contended by all worker threads in the framework.
     if (PreferLocalQueue(context, hints))
     {
-        // If there's already a mailbox in the local queue then
-        // swap it with the new mailbox. Effectively we promote the
-        // previously pushed mailbox to the shared queue. This ensures we
-        // never have more than one mailbox serialized on the local queue.
-        // Promoting the earlier mailbox helps to promote fairness.
-        // Also we now know that the earlier mailbox wasn't the last mailbox
-        // messaged by this actor, whereas the new one might be. It's best
-        // to push to the local queue only the last mailbox messaged by an
-        // actor - ideally one messaged right at the end or 'tail' of the handler.
-        // This constitutes a kind of tail recursion optimization.
-        Mailbox *const previous(context->mLocalWorkQueue);
-        context->mLocalWorkQueue = mailbox;
-
-        Counting::Increment(context->mCounters[COUNTER_LOCAL_PUSHES].mValue);
-
-        if (previous == 0)
+        // The new mailbox goes in the 'next' slot of the local queue, so is processed next.
+        // We now know that any earlier mailbox in the slot wasn't the last mailbox messaged by
+        // the handler, whereas the new one might be, so the earlier one waits in the ring.
+        // This constitutes a kind of tail recursion optimization. If the ring is full then
+        // its oldest mailbox is displaced to the shared queue.
+        mailbox = context->mLocalWorkQueue.Push(mailbox);
+
+        context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+
+        if (mailbox == 0)
         {
             return;
         }
-
-        mailbox = previous;
     }
 
     // Push the mailbox onto the shared work queue.
-    // Because the shared queue is accessed by multiple threads we have to protect it.
+    // The shared queue is lock-free so we don't need to hold the monitor lock to push.
+    PushShared(mailbox);
+
+    // If any worker threads are waiting then pulse the condition to wake one of them.
+    QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, 1);
+
+    context->mCounters.Increment(COUNTER_SHARED_PUSHES);
+}
+
+
+template <class MonitorType>
+inline void MailboxQueue<MonitorType>::PushBatch(
+    ContextType *const context,
+    Mailbox *const *const mailboxes,
+    const uint32_t count,
+    const SchedulerHints &hints)
+{
+    uint32_t sharedCount(0);
+
+    for (uint32_t index = 0; index < count; ++index)
     {
-        typename MonitorType::LockType lock(mMonitor);
-        mSharedWorkQueue.Push(mailbox);
+        Mailbox *mailbox(mailboxes[index]);
+
+        context->mCounters.CountPush(mailbox);
+
+        if (ContextType *const boundContext = GetBoundContext(mailbox))
+        {
+            if (PushInbox(boundContext, mailbox))
+            {
+                context->mCounters.Increment(COUNTER_INBOX_PUSHES);
+                continue;
+            }
+        }
+
+        // Only the last mailbox of the batch can be the last one messaged by the handler,
+        // so only it is considered for the 'next' slot of the local queue.
+        if (index + 1 == count && PreferLocalQueue(context, hints))
+        {
+            mailbox = context->mLocalWorkQueue.Push(mailbox);
+            context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+
+            if (mailbox == 0)
+            {
+                continue;
+            }
+        }
+
+        PushShared(mailbox);
+        ++sharedCount;
     }
 
-    // Pulse the condition associated with the shared queue to wake a worker thread.
-    // It's okay to release the lock before calling Pulse.
-    mMonitor.Pulse();
-    Counting::Increment(context->mCounters[COUNTER_SHARED_PUSHES].mValue);
+    if (sharedCount == 0)
+    {
+        return;
+    }
+
+    // Wake a waiting thread for each mailbox pushed to the shared queue.
+    QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, sharedCount);
+
+    context->mCounters.Add(COUNTER_SHARED_PUSHES, sharedCount);
 }
 
 
@@ -315,88 +599,228 @@ template <class MonitorType>
 THERON_FORCEINLINE Mailbox *MailboxQueue<MonitorType>::Pop(ContextType *const context)
 {
     Mailbox *mailbox(0);
-    uint32_t counterOffset(0);
+    bool shared(false);
 
     // The shared context is never used to call Pop, only to Push
     // messages sent outside the context of a worker thread.
     THERON_ASSERT(context->mShared == false);
 
-    // Try to pop a mailbox off the calling thread's local work queue.
-    // We only check the shared queue once the local queue is empty.
-    // Note that the local queue contains at most one item.
-    if (context->mLocalWorkQueue)
-    {
-        mailbox = context->mLocalWorkQueue;
-        context->mLocalWorkQueue = 0;
-    }
-    else
+    // Mailboxes bound to the calling thread are served before any other work.
+    mailbox = PopInbox(context);
+
+    // Otherwise try to pop a mailbox off the calling thread's local work queue.
+    // We only wait on the shared queue once the local queue is empty.
+    if (mailbox == 0 && !context->mLocalWorkQueue.Empty())
     {
-        // Wait on the shared queue until we pop a mailbox from it.
-        // Because the shared queue is accessed by multiple threads we have to protect it.
-        typename MonitorType::LockType lock(mMonitor);
-        while (mSharedWorkQueue.Empty() && context->mRunning == true)
+        // Waiting high priority mailboxes are taken before local work.
+        SharedQueue &highQueue(mSharedQueues[ACTOR_PRIORITY_HIGH]);
+        if (!SharedEmpty(highQueue) && (mailbox = PopShared(highQueue)) != 0)
         {
-            Counting::Increment(context->mCounters[COUNTER_YIELDS].mValue);
-            mMonitor.Wait(&context->mMonitorContext, lock);
+            shared = true;
         }
 
-        if (!mSharedWorkQueue.Empty())
+        // Once the budget of local pops is spent, yield the next local mailbox to the back
+        // of the shared queue and take one from the front instead, so that handlers repeatedly
+        // scheduling each other on this thread can't starve the mailboxes in the shared queue.
+        else if (++context->mLocalPops >= LOCAL_POP_BUDGET)
         {
-            mailbox = static_cast<Mailbox *>(mSharedWorkQueue.Pop());
-            mMonitor.ResetYield(&context->mMonitorContext);
+            context->mLocalPops = 0;
+            if (!SharedEmpty() && (mailbox = PopShared(context)) != 0)
+            {
+                PushShared(context->mLocalWorkQueue.Pop());
+                context->mCounters.Increment(COUNTER_SHARED_PUSHES);
+                shared = true;
+            }
         }
 
-        counterOffset = 2;
+        if (mailbox == 0)
+        {
+            mailbox = context->mLocalWorkQueue.Pop();
+            ShareLocalWork(context);
+        }
     }
-
-    if (mailbox)
+    else if (mailbox == 0)
     {
-        Counting::Increment(context->mCounters[COUNTER_MESSAGES_PROCESSED].mValue);
-
-#if THERON_ENABLE_COUNTERS
+        context->mLocalPops = 0;
 
-        // Compute the latency and update the maximum queue latency seen by this thread.
-        const uint64_t timestamp(Clock::GetTicks());
-        const uint64_t ticks(timestamp - mailbox->Timestamp());
-        const uint64_t ticksPerSecond(Clock::GetFrequency());
-        const uint64_t usec(ticks * 1000000 / ticksPerSecond);
+        // Try to pop a mailbox from the shared queue without taking the monitor lock.
+        mailbox = PopShared(context);
 
-        Atomic::UInt32 &maxCounter(context->mCounters[COUNTER_QUEUE_LATENCY_LOCAL_MAX + counterOffset].mValue);
-        Atomic::UInt32 &minCounter(context->mCounters[COUNTER_QUEUE_LATENCY_LOCAL_MIN + counterOffset].mValue);
+        if (mailbox == 0)
+        {
+            // Wait on the shared queue until we pop a mailbox from it.
+            // We register as a waiting thread under the lock before re-checking the queue,
+            // so that threads pushing to the queue know to pulse the monitor.
+            // The waiting flag tells threads pushing to our inbox that we need to be woken.
+            typename MonitorType::LockType lock(mMonitor);
+            mWaitingThreads.Increment();
+            context->mWaiting = true;
+
+            while ((mailbox = PopInbox(context)) == 0 &&
+                (mailbox = PopShared(context)) == 0 &&
+                context->mRunning == true)
+            {
+                context->mCounters.Increment(COUNTER_YIELDS);
+                mMonitor.Wait(&context->mMonitorContext, lock);
+            }
+
+            context->mWaiting = false;
+            mWaitingThreads.Decrement();
+        }
 
-        Counting::Raise(maxCounter, static_cast<uint32_t>(usec));
-        Counting::Lower(minCounter, static_cast<uint32_t>(usec));
+        if (mailbox)
+        {
+            mMonitor.ResetYield(&context->mMonitorContext);
+        }
 
-#endif // THERON_ENABLE_COUNTERS
+        shared = true;
+    }
 
+    if (mailbox)
+    {
+        context->mCounters.CountPop(mailbox, shared);
     }
 
     return mailbox;
 }
 
 
+template <class MonitorType>
+THERON_FORCEINLINE void MailboxQueue<MonitorType>::EndVisit(ContextType *const context, const uint32_t messageCount)
+{
+    context->mCounters.CountVisit(messageCount);
+}
+
+
 template <class MonitorType>
 THERON_FORCEINLINE bool MailboxQueue<MonitorType>::PreferLocalQueue(
     const ContextType *const context,
-    const SchedulerHints &hints)
+    const SchedulerHints &hints) const
 {
     // The shared context doesn't have (or doesn't use) a local queue.
-    if (context->mShared)
+    // Stopped threads only drain their local queues, so don't add to them.
+    if (context->mShared || !context->mRunning)
     {
         return false;
     }
 
     if (hints.mSend)
     {
-        // If this send isn't predicted to be the last then push it to the shared queue.
-        if (hints.mSendIndex + 1 < hints.mPredictedSendCount)
+        // If the sending mailbox still has unprocessed messages then it will be pushed to
+        // the local queue and processed next, so push this mailbox to the shared queue.
+        if (hints.mMessageCount > 1)
         {
             return false;
         }
 
-        // If the sending mailbox still has unprocessed messages then it will
-        // be pushed to the local queue, so push this mailbox to the shared queue.
-        if (hints.mMessageCount > 1)
+        // While other threads are idle, send only the mailbox predicted to be processed
+        // next by this thread to the local queue, and share the rest with the idle threads.
+        if (hints.mSendIndex + 1 < hints.mPredictedSendCount && mWaitingThreads.Load() != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void MailboxQueue<MonitorType>::ShareLocalWork(ContextType *const context)
+{
+    // Keep the 'next' slot for ourselves and share the oldest mailbox in the ring.
+    // If the shared queue isn't empty then the idle threads already have work to wake for.
+    if (mWaitingThreads.Load() == 0 || context->mLocalWorkQueue.RingCount() == 0 || !SharedEmpty())
+    {
+        return;
+    }
+
+    PushShared(context->mLocalWorkQueue.PopOldest());
+    QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, 1);
+    context->mCounters.Increment(COUNTER_SHARED_PUSHES);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE typename MailboxQueue<MonitorType>::ContextType *MailboxQueue<MonitorType>::GetBoundContext(const Mailbox *const mailbox) const
+{
+    // Unbound mailboxes have an index beyond the end of the registered contexts.
+    const uint32_t index(mailbox->GetWorkerThread());
+    if (index < mBoundThreadCount.Load())
+    {
+        return mBoundContexts[index];
+    }
+
+    return 0;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool MailboxQueue<MonitorType>::PushInbox(ContextType *const boundContext, Mailbox *const mailbox)
+{
+    boundContext->mInboxLock.Lock();
+
+    if (!boundContext->mRunning)
+    {
+        boundContext->mInboxLock.Unlock();
+        return false;
+    }
+
+    boundContext->mInbox.Push(mailbox);
+    boundContext->mInboxCount.Increment();
+    boundContext->mInboxLock.Unlock();
+
+    // Only the bound thread can take the mailbox, so it must be woken if it's waiting.
+    // It registers as waiting under the monitor lock before checking its inbox, so checking
+    // the flag under the lock ensures the wake can't be lost. The monitor can only wake
+    // arbitrary threads, so we wake all of them, but only when the bound thread is waiting.
+    if (mWaitingThreads.Load() != 0)
+    {
+        bool waiting(false);
+
+        {
+            typename MonitorType::LockType lock(mMonitor);
+            waiting = boundContext->mWaiting;
+        }
+
+        if (waiting)
+        {
+            mMonitor.PulseAll();
+        }
+    }
+
+    return true;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *MailboxQueue<MonitorType>::PopInbox(ContextType *const context)
+{
+    Mailbox *mailbox(0);
+
+    if (context->mInboxCount.Load() != 0)
+    {
+        context->mInboxLock.Lock();
+
+        if (!context->mInbox.Empty())
+        {
+            mailbox = context->mInbox.Pop();
+            context->mInboxCount.Decrement();
+        }
+
+        context->mInboxLock.Unlock();
+    }
+
+    return mailbox;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool MailboxQueue<MonitorType>::SharedEmpty() const
+{
+    for (uint32_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+    {
+        if (!SharedEmpty(mSharedQueues[priority]))
         {
             return false;
         }
@@ -406,6 +830,91 @@ THERON_FORCEINLINE bool MailboxQueue<MonitorType>::PreferLocalQueue(
 }
 
 
+template <class MonitorType>
+THERON_FORCEINLINE bool MailboxQueue<MonitorType>::SharedEmpty(const SharedQueue &queue)
+{
+    return (queue.mWorkQueue.Empty() && queue.mOverflowCount.Load() == 0);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void MailboxQueue<MonitorType>::PushShared(Mailbox *const mailbox)
+{
+    SharedQueue &queue(mSharedQueues[mailbox->GetPriority()]);
+
+    // While the overflow queue is non-empty we push to it rather than the ring buffer.
+    // Since the ring buffer is drained first, this keeps the shared queue roughly FIFO.
+    if (queue.mOverflowCount.Load() == 0 && queue.mWorkQueue.Push(mailbox))
+    {
+        return;
+    }
+
+    queue.mOverflowLock.Lock();
+    queue.mOverflowQueue.Push(mailbox);
+    queue.mOverflowCount.Increment();
+    queue.mOverflowLock.Unlock();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *MailboxQueue<MonitorType>::PopShared(ContextType *const context)
+{
+    // Usually the highest priority class is tried first. Every PRIORITY_WEIGHT pops the normal
+    // class is tried first instead, and every PRIORITY_WEIGHT of those, the low class.
+    uint32_t first(ACTOR_PRIORITY_HIGH);
+    if (++context->mSharedPops % PRIORITY_WEIGHT == 0)
+    {
+        first = ACTOR_PRIORITY_NORMAL;
+        if (context->mSharedPops % (PRIORITY_WEIGHT * PRIORITY_WEIGHT) == 0)
+        {
+            first = ACTOR_PRIORITY_LOW;
+        }
+    }
+
+    if (Mailbox *const mailbox = PopShared(mSharedQueues[first]))
+    {
+        return mailbox;
+    }
+
+    // Fall back to the other classes in order of priority.
+    uint32_t priority(PRIORITY_COUNT);
+    while (priority-- > 0)
+    {
+        if (priority != first)
+        {
+            if (Mailbox *const mailbox = PopShared(mSharedQueues[priority]))
+            {
+                return mailbox;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *MailboxQueue<MonitorType>::PopShared(SharedQueue &queue)
+{
+    Mailbox *mailbox(queue.mWorkQueue.Pop());
+
+    if (mailbox == 0 && queue.mOverflowCount.Load() != 0)
+    {
+        queue.mOverflowLock.Lock();
+
+        if (!queue.mOverflowQueue.Empty())
+        {
+            mailbox = queue.mOverflowQueue.Pop();
+            queue.mOverflowCount.Decrement();
+        }
+
+        queue.mOverflowLock.Unlock();
+    }
+
+    return mailbox;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
@@ -0,0 +1,777 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_NUMAQUEUE_H
+#define THERON_DETAIL_SCHEDULER_NUMAQUEUE_H
+
+
+#include <new>
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
+#include <Theron/YieldStrategy.h>
+
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/Counting.h>
+#include <Theron/Detail/Scheduler/QueueCounters.h>
+#include <Theron/Detail/Scheduler/QueueWaker.h>
+#include <Theron/Detail/Scheduler/SchedulerHints.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Mailbox queue implementation partitioned by NUMA node.
+
+The queue contains one shared work queue per NUMA processor node, allocated in memory local
+to the node. Each worker thread is bound to a single node, and mailboxes scheduled by a worker
+thread are pushed to the queue of its own node. Mailboxes scheduled from outside the worker
+threads are pushed to the queue of the node on which the sending thread is executing.
+Worker threads pop from the queue of their own node, and only take work from the queues of
+other nodes once the queue of their own node runs dry. Each worker thread also has a
+single-item local queue holding the last mailbox scheduled by the handler it is executing.
+
+In builds or on systems without NUMA support there is only a single node, and the queue
+behaves much like the plain shared queue.
+*/
+template <class MonitorType>
+class NumaQueue
+{
+public:
+
+    /**
+    The item type which is queued by the queue.
+    */
+    typedef Mailbox ItemType;
+
+    /**
+    Context structure used to access the queue.
+    */
+    class ContextType
+    {
+    public:
+
+        friend class NumaQueue;
+
+        inline ContextType() :
+          mRunning(false),
+          mShared(false),
+          mNode(0),
+          mLocalWorkQueue(0)
+        {
+        }
+
+    private:
+
+        bool mRunning;                                      ///< Used to signal the thread to terminate.
+        bool mShared;                                       ///< Indicates whether this is the 'shared' context.
+        uint32_t mNode;                                     ///< Index of the NUMA node to which the thread is bound.
+        Mailbox *mLocalWorkQueue;                           ///< Local thread-specific single-item work queue.
+        typename MonitorType::Context mMonitorContext;      ///< Per-thread monitor primitive context.
+        QueueCounters mCounters;                            ///< Per-context event counters.
+    };
+
+    /**
+    Constructor.
+    */
+    inline explicit NumaQueue(const YieldStrategy yieldStrategy);
+
+    /**
+    Destructor.
+    */
+    inline ~NumaQueue();
+
+    /**
+    Initializes a user-allocated context as the 'shared' context common to all threads.
+    */
+    inline void InitializeSharedContext(ContextType *const context);
+
+    /**
+    Initializes a user-allocated context as the context associated with the calling thread.
+    */
+    inline void InitializeWorkerContext(ContextType *const context);
+
+    /**
+    Releases a previously initialized shared context.
+    */
+    inline void ReleaseSharedContext(ContextType *const context);
+
+    /**
+    Releases a previously initialized worker thread context.
+    */
+    inline void ReleaseWorkerContext(ContextType *const context);
+
+    /**
+    Binds a worker thread context to one of the NUMA nodes in the given node mask.
+    \param bound Set to true if the thread was bound to a single node, false if it keeps the given mask.
+    \return The node mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignNode(ContextType *const context, const uint32_t nodeMask, bool &bound);
+
+    /**
+    Restricts a worker thread context to a subset of the processors in the given processor mask.
+    This queue doesn't pin threads to processors.
+    \return The processor mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignProcessors(ContextType *const context, const uint32_t processorMask);
+
+    /**
+    Restricts a worker thread context to a subset of the processors in the given processor set.
+    This queue doesn't pin threads to processors, so leaves the set unchanged.
+    */
+    inline void AssignProcessors(ContextType *const context, ProcessorSet &processorSet);
+
+    /**
+    Resets to zero the given counter for the given thread context.
+    */
+    inline void ResetCounter(ContextType *const context, const uint32_t counter) const;
+
+    /**
+    Gets the value of the given counter for the given thread context.
+    */
+    inline uint32_t GetCounterValue(const ContextType *const context, const uint32_t counter) const;
+
+    /**
+    Accumulates the value of the given counter for the given thread context.
+    */
+    inline void AccumulateCounterValue(
+        const ContextType *const context,
+        const uint32_t counter,
+        uint32_t &accumulator) const;
+
+    /**
+    Returns true if a call to Pop would return no mailbox, for the given context.
+    */
+    inline bool Empty(const ContextType *const context) const;
+
+    /**
+    Returns true if the thread with the given context is still enabled.
+    */
+    inline bool Running(const ContextType *const context) const;
+
+    /**
+    Returns an estimate of the number of mailboxes waiting in the work queues of the nodes.
+    */
+    inline uint32_t GetQueueDepth() const;
+
+    /**
+    Returns the number of worker threads currently waiting for work.
+    */
+    inline uint32_t GetIdleThreadCount() const;
+
+    /**
+    Wakes any worker threads which are blocked waiting for the queue to become non-empty.
+    */
+    inline void WakeAll();
+
+    /**
+    Pushes a mailbox into the queue, scheduling it for processing.
+    */
+    inline void Push(ContextType *const context, Mailbox *mailbox, const SchedulerHints &hints);
+
+    /**
+    Pushes a batch of mailboxes into the queue, scheduling them for processing.
+    */
+    inline void PushBatch(ContextType *const context, Mailbox *const *const mailboxes, const uint32_t count, const SchedulerHints &hints);
+
+    /**
+    Pops a previously pushed mailbox from the queue for processing.
+    */
+    inline Mailbox *Pop(ContextType *const context);
+
+    /**
+    Records that a number of messages were processed from a popped mailbox.
+    */
+    inline void EndVisit(ContextType *const context, const uint32_t messageCount);
+
+private:
+
+    /**
+    Maximum number of NUMA nodes, matching the width of the node masks.
+    */
+    static const uint32_t MAX_NODES = 32;
+
+    /**
+    Work queue of a single NUMA node, allocated in memory local to the node.
+    */
+    struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Partition
+    {
+        inline Partition() : mLock(), mCount(0), mWorkQueue()
+        {
+        }
+
+        SpinLock mLock;                     ///< Protects the work queue.
+        Atomic::UInt32 mCount;              ///< Number of mailboxes in the work queue.
+        Queue<Mailbox> mWorkQueue;          ///< Mailboxes scheduled on the node.
+
+    } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+    NumaQueue(const NumaQueue &other);
+    NumaQueue &operator=(const NumaQueue &other);
+
+    inline static bool PreferLocalQueue(
+        const ContextType *const context,
+        const SchedulerHints &hints);
+
+    /**
+    Returns the node whose queue should receive mailboxes pushed via the given context.
+    */
+    inline uint32_t GetPushNode(const ContextType *const context) const;
+
+    /**
+    Returns true if the work queues of all the nodes are empty.
+    */
+    inline bool NodesEmpty() const;
+
+    /**
+    Pops a mailbox from the queue of the context's own node, or failing that from another node.
+    */
+    inline Mailbox *PopNodes(ContextType *const context);
+
+    /**
+    Pops a mailbox from the queue of the given node, if it is non-empty.
+    */
+    inline Mailbox *PopNode(const uint32_t node);
+
+    mutable MonitorType mMonitor;           ///< Used by idle threads to wait for the queues to become non-empty.
+    Atomic::UInt32 mWaitingThreads;         ///< Number of worker threads waiting on the monitor.
+    Atomic::UInt32 mServedNodes;            ///< Mask of the nodes to which worker threads have been bound.
+    uint32_t mNextNode;                     ///< Node to which the next worker thread is preferentially bound.
+    uint32_t mNodeCount;                    ///< Number of NUMA nodes, and hence of node work queues.
+    Partition *mPartitions[MAX_NODES];      ///< Work queues of the nodes, indexed by node.
+    bool mAllocatedOnNode[MAX_NODES];       ///< Indicates which work queues were allocated in node-local memory.
+};
+
+
+template <class MonitorType>
+inline NumaQueue<MonitorType>::NumaQueue(const YieldStrategy yieldStrategy) :
+  mMonitor(yieldStrategy),
+  mWaitingThreads(0),
+  mServedNodes(0),
+  mNextNode(0),
+  mNodeCount(1)
+{
+    uint32_t nodeCount(0);
+    if (Utils::GetNodeCount(nodeCount) && nodeCount > 1)
+    {
+        mNodeCount = (nodeCount < MAX_NODES ? nodeCount : MAX_NODES);
+    }
+
+    // Allocate the work queue of each node in memory local to the node, if we can.
+    for (uint32_t node = 0; node < MAX_NODES; ++node)
+    {
+        mPartitions[node] = 0;
+        mAllocatedOnNode[node] = false;
+
+        if (node < mNodeCount)
+        {
+            void *memory(Utils::AllocOnNode(node, sizeof(Partition)));
+            if (memory)
+            {
+                mAllocatedOnNode[node] = true;
+            }
+            else
+            {
+                memory = AllocatorManager::GetCache()->AllocateAligned(sizeof(Partition), THERON_CACHELINE_ALIGNMENT);
+            }
+
+            THERON_ASSERT_MSG(memory, "Failed to allocate node work queue");
+            mPartitions[node] = new (memory) Partition();
+        }
+    }
+}
+
+
+template <class MonitorType>
+inline NumaQueue<MonitorType>::~NumaQueue()
+{
+    for (uint32_t node = 0; node < mNodeCount; ++node)
+    {
+        Partition *const partition(mPartitions[node]);
+        THERON_ASSERT(partition->mWorkQueue.Empty());
+
+        partition->~Partition();
+
+        if (mAllocatedOnNode[node])
+        {
+            Utils::FreeOnNode(partition, sizeof(Partition));
+        }
+        else
+        {
+            AllocatorManager::GetCache()->Free(partition, sizeof(Partition));
+        }
+    }
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::InitializeSharedContext(ContextType *const context)
+{
+    context->mShared = true;
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::InitializeWorkerContext(ContextType *const context)
+{
+    // Only worker threads should call this method.
+    context->mShared = false;
+    context->mRunning = true;
+
+    mMonitor.InitializeWorkerContext(&context->mMonitorContext);
+
+    // The minimum counters need to be initialized to maxint.
+    context->mCounters.Initialize();
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::ReleaseSharedContext(ContextType *const /*context*/)
+{
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::ReleaseWorkerContext(ContextType *const context)
+{
+    typename MonitorType::LockType lock(mMonitor);
+    context->mRunning = false;
+}
+
+
+template <class MonitorType>
+inline uint32_t NumaQueue<MonitorType>::AssignNode(ContextType *const context, const uint32_t nodeMask, bool &bound)
+{
+    // Without multiple nodes all threads share node zero, and keep the requested affinity.
+    const uint32_t availableMask(mNodeCount < MAX_NODES ? (1UL << mNodeCount) - 1 : 0xFFFFFFFF);
+    const uint32_t enabledMask(nodeMask & availableMask);
+
+    uint32_t node(0);
+    uint32_t threadNodeMask(nodeMask);
+    bound = false;
+
+    if (mNodeCount > 1 && enabledMask != 0)
+    {
+        // Bind successive threads to successive enabled nodes in round-robin order.
+        node = mNextNode;
+        while ((enabledMask & (1UL << node)) == 0)
+        {
+            node = (node + 1) % mNodeCount;
+        }
+
+        mNextNode = (node + 1) % mNodeCount;
+        threadNodeMask = (1UL << node);
+        bound = true;
+    }
+
+    context->mNode = node;
+
+    // Remember which nodes have worker threads bound to them.
+    uint32_t servedNodes(mServedNodes.Load());
+    while (!mServedNodes.CompareExchangeAcquire(servedNodes, servedNodes | (1UL << node)))
+    {
+    }
+
+    return threadNodeMask;
+}
+
+
+template <class MonitorType>
+inline uint32_t NumaQueue<MonitorType>::AssignProcessors(ContextType *const /*context*/, const uint32_t processorMask)
+{
+    return processorMask;
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::AssignProcessors(ContextType *const /*context*/, ProcessorSet &/*processorSet*/)
+{
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::ResetCounter(ContextType *const context, const uint32_t counter) const
+{
+    context->mCounters.Reset(counter);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t NumaQueue<MonitorType>::GetCounterValue(const ContextType *const context, const uint32_t counter) const
+{
+    return context->mCounters.Get(counter);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void NumaQueue<MonitorType>::AccumulateCounterValue(
+    const ContextType *const context,
+    const uint32_t counter,
+    uint32_t &accumulator) const
+{
+    context->mCounters.Accumulate(counter, accumulator);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool NumaQueue<MonitorType>::Empty(const ContextType *const context) const
+{
+    // Check the context's local queue.
+    // If the provided context is the shared context then it doesn't have a local queue.
+    if (!context->mShared && context->mLocalWorkQueue)
+    {
+        return false;
+    }
+
+    return NodesEmpty();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool NumaQueue<MonitorType>::Running(const ContextType *const context) const
+{
+    return context->mRunning;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t NumaQueue<MonitorType>::GetQueueDepth() const
+{
+    uint32_t depth(0);
+    for (uint32_t node = 0; node < mNodeCount; ++node)
+    {
+        depth += mPartitions[node]->mCount.Load();
+    }
+
+    return depth;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t NumaQueue<MonitorType>::GetIdleThreadCount() const
+{
+    return mWaitingThreads.Load();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void NumaQueue<MonitorType>::WakeAll()
+{
+    mMonitor.PulseAll();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void NumaQueue<MonitorType>::Push(
+    ContextType *const context,
+    Mailbox *mailbox,
+    const SchedulerHints &hints)
+{
+    // Timestamp the mailbox and update the maximum mailbox queue length seen by this thread.
+    context->mCounters.CountPush(mailbox);
+
+    // Hold back the last mailbox scheduled by a handler in the thread's local queue,
+    // promoting any previously held mailbox to the node queue.
+    if (PreferLocalQueue(context, hints))
+    {
+        Mailbox *const previous(context->mLocalWorkQueue);
+        context->mLocalWorkQueue = mailbox;
+
+        context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+
+        if (previous == 0)
+        {
+            return;
+        }
+
+        mailbox = previous;
+    }
+
+    // Push the mailbox onto the work queue of the pushing thread's node.
+    Partition *const partition(mPartitions[GetPushNode(context)]);
+
+    partition->mLock.Lock();
+    partition->mWorkQueue.Push(mailbox);
+    partition->mCount.Increment();
+    partition->mLock.Unlock();
+
+    // If any worker threads are waiting then pulse the condition to wake one of them.
+    QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, 1);
+
+    context->mCounters.Increment(COUNTER_SHARED_PUSHES);
+}
+
+
+template <class MonitorType>
+inline void NumaQueue<MonitorType>::PushBatch(
+    ContextType *const context,
+    Mailbox *const *const mailboxes,
+    const uint32_t count,
+    const SchedulerHints &hints)
+{
+    uint32_t sharedCount(count);
+    Mailbox *heldMailbox(0);
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        context->mCounters.CountPush(mailboxes[index]);
+    }
+
+    // Only the last mailbox of the batch can be the last one scheduled by the handler,
+    // so only it is considered for holding back in the local queue.
+    if (PreferLocalQueue(context, hints))
+    {
+        heldMailbox = context->mLocalWorkQueue;
+        context->mLocalWorkQueue = mailboxes[count - 1];
+        --sharedCount;
+
+        context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+    }
+
+    const uint32_t pushCount(sharedCount + (heldMailbox ? 1 : 0));
+    if (pushCount == 0)
+    {
+        return;
+    }
+
+    // Push the rest of the batch, and any mailbox it displaced from the local queue, onto
+    // the work queue of the pushing thread's node while holding its lock once.
+    Partition *const partition(mPartitions[GetPushNode(context)]);
+
+    partition->mLock.Lock();
+
+    for (uint32_t index = 0; index < sharedCount; ++index)
+    {
+        partition->mWorkQueue.Push(mailboxes[index]);
+        partition->mCount.Increment();
+    }
+
+    if (heldMailbox)
+    {
+        partition->mWorkQueue.Push(heldMailbox);
+        partition->mCount.Increment();
+    }
+
+    partition->mLock.Unlock();
+
+    // Wake a waiting thread for each mailbox pushed to the node queue.
+    QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, pushCount);
+
+    context->mCounters.Add(COUNTER_SHARED_PUSHES, pushCount);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *NumaQueue<MonitorType>::Pop(ContextType *const context)
+{
+    Mailbox *mailbox(0);
+    bool shared(false);
+
+    // The shared context is never used to call Pop, only to Push
+    // messages sent outside the context of a worker thread.
+    THERON_ASSERT(context->mShared == false);
+
+    if (context->mLocalWorkQueue)
+    {
+        mailbox = context->mLocalWorkQueue;
+        context->mLocalWorkQueue = 0;
+    }
+    else
+    {
+        // Try to pop a mailbox from the node queues without taking the monitor lock.
+        mailbox = PopNodes(context);
+
+        if (mailbox == 0)
+        {
+            // Wait until we pop a mailbox from one of the node queues.
+            // We register as a waiting thread under the lock before re-checking the queues,
+            // so that threads pushing to the queues know to pulse the monitor.
+            typename MonitorType::LockType lock(mMonitor);
+            mWaitingThreads.Increment();
+
+            while ((mailbox = PopNodes(context)) == 0 && context->mRunning == true)
+            {
+                context->mCounters.Increment(COUNTER_YIELDS);
+                mMonitor.Wait(&context->mMonitorContext, lock);
+            }
+
+            mWaitingThreads.Decrement();
+        }
+
+        if (mailbox)
+        {
+            mMonitor.ResetYield(&context->mMonitorContext);
+        }
+
+        shared = true;
+    }
+
+    if (mailbox)
+    {
+        context->mCounters.CountPop(mailbox, shared);
+    }
+
+    return mailbox;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void NumaQueue<MonitorType>::EndVisit(ContextType *const context, const uint32_t messageCount)
+{
+    context->mCounters.CountVisit(messageCount);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool NumaQueue<MonitorType>::PreferLocalQueue(
+    const ContextType *const context,
+    const SchedulerHints &hints)
+{
+    // The shared context doesn't have (or doesn't use) a local queue.
+    if (context->mShared)
+    {
+        return false;
+    }
+
+    if (hints.mSend)
+    {
+        // If this send isn't predicted to be the last then push it to the node queue.
+        if (hints.mSendIndex + 1 < hints.mPredictedSendCount)
+        {
+            return false;
+        }
+
+        // If the sending mailbox still has unprocessed messages then it will
+        // be pushed to the local queue, so push this mailbox to the node queue.
+        if (hints.mMessageCount > 1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t NumaQueue<MonitorType>::GetPushNode(const ContextType *const context) const
+{
+    if (!context->mShared)
+    {
+        return context->mNode;
+    }
+
+    if (mNodeCount == 1)
+    {
+        return 0;
+    }
+
+    // Mailboxes scheduled from outside the worker threads go to the node of the sending thread,
+    // unless no worker threads are bound to that node, in which case we pick one that has some.
+    const uint32_t servedNodes(mServedNodes.Load());
+
+    uint32_t node(0);
+    if (Utils::GetCurrentNode(node) && node < mNodeCount && (servedNodes & (1UL << node)) != 0)
+    {
+        return node;
+    }
+
+    node = 0;
+    while (node + 1 < mNodeCount && (servedNodes & (1UL << node)) == 0)
+    {
+        ++node;
+    }
+
+    return node;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool NumaQueue<MonitorType>::NodesEmpty() const
+{
+    for (uint32_t node = 0; node < mNodeCount; ++node)
+    {
+        if (mPartitions[node]->mCount.Load() != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *NumaQueue<MonitorType>::PopNodes(ContextType *const context)
+{
+    // Prefer the queue of the thread's own node.
+    if (Mailbox *const mailbox = PopNode(context->mNode))
+    {
+        return mailbox;
+    }
+
+    // Only cross to other nodes once the thread's own node has run dry.
+    // Visit the other nodes in order starting from the next one, to spread the load.
+    for (uint32_t offset = 1; offset < mNodeCount; ++offset)
+    {
+        if (Mailbox *const mailbox = PopNode((context->mNode + offset) % mNodeCount))
+        {
+            context->mCounters.Increment(COUNTER_NODE_STEALS);
+            return mailbox;
+        }
+    }
+
+    return 0;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *NumaQueue<MonitorType>::PopNode(const uint32_t node)
+{
+    Partition *const partition(mPartitions[node]);
+    Mailbox *mailbox(0);
+
+    // Check the count first to avoid taking the lock of an empty queue.
+    if (partition->mCount.Load() != 0)
+    {
+        partition->mLock.Lock();
+
+        if (!partition->mWorkQueue.Empty())
+        {
+            mailbox = partition->mWorkQueue.Pop();
+            partition->mCount.Decrement();
+        }
+
+        partition->mLock.Unlock();
+    }
+
+    return mailbox;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_NUMAQUEUE_H
@@ -0,0 +1,283 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_PARKINGMONITOR_H
+#define THERON_DETAIL_SCHEDULER_PARKINGMONITOR_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/YieldStrategy.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Parker.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Blocking monitor thread synchronization primitive based on per-thread parking.
+
+Waiting threads register themselves in an intrusive list of waiters and then park on
+their own private \ref Parker. A pulse unparks one specific registered waiter, rather than
+signalling a shared condition variable, and costs nothing when no threads are waiting.
+Waiters are woken in LIFO order, so the most recently idled thread (whose cache is warmest)
+is woken first. Where the NUMA node of the pulsing thread is known, a waiter last run on
+the same node is preferred.
+*/
+class ParkingMonitor
+{
+public:
+
+    struct Context
+    {
+        Parker mParker;             ///< Private parker on which the thread sleeps.
+        Context *mNext;             ///< Next waiter in the list of registered waiters.
+        uint32_t mNode;             ///< NUMA node on which the thread last waited.
+    };
+
+    class LockType
+    {
+    public:
+
+        THERON_FORCEINLINE explicit LockType(ParkingMonitor &monitor) : mSpinLock(monitor.mSpinLock)
+        {
+            mSpinLock.Lock();
+        }
+
+        THERON_FORCEINLINE ~LockType()
+        {
+            mSpinLock.Unlock();
+        }
+
+        THERON_FORCEINLINE void Unlock()
+        {
+            mSpinLock.Unlock();
+        }
+
+        THERON_FORCEINLINE void Relock()
+        {
+            mSpinLock.Lock();
+        }
+
+    private:
+
+        LockType(const LockType &other);
+        LockType &operator=(const LockType &other);
+
+        SpinLock &mSpinLock;
+    };
+
+    friend class LockType;
+
+    /**
+    Constructs a monitor with the given yield strategy hint.
+    */
+    inline explicit ParkingMonitor(const YieldStrategy yieldStrategy);
+
+    /**
+    Initializes the context structure of a worker thread.
+    \note The calling thread must be a worker thread.
+    */
+    inline void InitializeWorkerContext(Context *const context);
+
+    /**
+    Resets the yield backoff following a successful acquire.
+    \note The calling thread should not hold a lock.
+    */
+    inline void ResetYield(Context *const context);
+
+    /**
+    Wakes at most one waiting thread.
+    \note The calling thread should hold a lock while changing the protected state but should release it before calling Pulse.
+    */
+    inline void Pulse();
+
+    /**
+    Wakes all waiting threads.
+    \note The calling thread should hold a lock while changing the protected state but should release it before calling PulseAll.
+    */
+    inline void PulseAll();
+
+    /**
+    Puts the calling thread to sleep until it is woken by a pulse.
+    \note The calling thread should hold a lock and should pass the lock as a parameter.
+    */
+    inline void Wait(Context *const context, LockType &lock);
+
+private:
+
+    ParkingMonitor(const ParkingMonitor &other);
+    ParkingMonitor &operator=(const ParkingMonitor &other);
+
+    /**
+    Unlinks and returns the waiter to wake next, preferring one on the given node.
+    \note The calling thread should hold the spinlock.
+    */
+    inline Context *RemoveWaiter(const bool hasNode, const uint32_t node);
+
+    mutable SpinLock mSpinLock;     ///< Protects the waiter list, and the state guarded by the monitor.
+    Context *mWaiters;              ///< List of registered waiters, most recently registered first.
+    Atomic::UInt32 mWaiterCount;    ///< Number of registered waiters, read without the lock by Pulse.
+};
+
+
+inline ParkingMonitor::ParkingMonitor(const YieldStrategy /*yieldStrategy*/) :
+  mSpinLock(),
+  mWaiters(0),
+  mWaiterCount(0)
+{
+}
+
+
+inline void ParkingMonitor::InitializeWorkerContext(Context *const context)
+{
+    context->mNext = 0;
+    context->mNode = 0;
+}
+
+
+THERON_FORCEINLINE void ParkingMonitor::ResetYield(Context *const /*context*/)
+{
+}
+
+
+THERON_FORCEINLINE void ParkingMonitor::Pulse()
+{
+    // Don't touch the lock if no threads are waiting. Waiters register under the lock,
+    // which the pulsing thread held while changing the protected state, so none are missed.
+    if (mWaiterCount.Load() == 0)
+    {
+        return;
+    }
+
+    uint32_t node(0);
+    const bool hasNode(Utils::GetCurrentNode(node));
+
+    Context *waiter(0);
+
+    {
+        mSpinLock.Lock();
+        waiter = RemoveWaiter(hasNode, node);
+        mSpinLock.Unlock();
+    }
+
+    if (waiter)
+    {
+        waiter->mParker.Unpark();
+    }
+}
+
+
+THERON_FORCEINLINE void ParkingMonitor::PulseAll()
+{
+    if (mWaiterCount.Load() == 0)
+    {
+        return;
+    }
+
+    Context *waiter(0);
+
+    {
+        mSpinLock.Lock();
+        waiter = mWaiters;
+        mWaiters = 0;
+        mWaiterCount.Store(0);
+        mSpinLock.Unlock();
+    }
+
+    while (waiter)
+    {
+        // Read the link before unparking, after which the waiter may register again.
+        Context *const next(waiter->mNext);
+        waiter->mParker.Unpark();
+        waiter = next;
+    }
+}
+
+
+THERON_FORCEINLINE void ParkingMonitor::Wait(Context *const context, LockType &lock)
+{
+    // Remember where we're waiting so pulsing threads on the same node can prefer us.
+    Utils::GetCurrentNode(context->mNode);
+
+    // Register as a waiter under the lock, then park once the lock is released.
+    // A pulse that unlinks us before we park leaves a permit, so Park returns immediately.
+    context->mNext = mWaiters;
+    mWaiters = context;
+    mWaiterCount.Increment();
+
+    lock.Unlock();
+    context->mParker.Park();
+    lock.Relock();
+}
+
+
+THERON_FORCEINLINE ParkingMonitor::Context *ParkingMonitor::RemoveWaiter(const bool hasNode, const uint32_t node)
+{
+    Context *previous(0);
+    Context *waiter(mWaiters);
+
+    if (waiter == 0)
+    {
+        return 0;
+    }
+
+    // Search for the most recent waiter on the same node, defaulting to the most recent waiter.
+    if (hasNode)
+    {
+        Context *candidate(waiter);
+        while (candidate && candidate->mNode != node)
+        {
+            previous = candidate;
+            candidate = candidate->mNext;
+        }
+
+        if (candidate)
+        {
+            waiter = candidate;
+        }
+        else
+        {
+            previous = 0;
+        }
+    }
+
+    if (previous)
+    {
+        previous->mNext = waiter->mNext;
+    }
+    else
+    {
+        mWaiters = waiter->mNext;
+    }
+
+    waiter->mNext = 0;
+    mWaiterCount.Decrement();
+
+    return waiter;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_PARKINGMONITOR_H
@@ -0,0 +1,782 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_PARTITIONEDQUEUE_H
+#define THERON_DETAIL_SCHEDULER_PARTITIONEDQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
+#include <Theron/YieldStrategy.h>
+
+#include <Theron/Detail/Containers/MpscQueue.h>
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/QueueCounters.h>
+#include <Theron/Detail/Scheduler/SchedulerHints.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Parker.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Mailbox queue implementation in which each worker thread owns a fixed partition of the mailboxes.
+
+Each worker thread is assigned a partition index when it is first started, and each mailbox
+belongs to the partition given by its index modulo the number of partitions, or to the partition
+of the worker thread to which it's bound. A mailbox is only ever processed by the worker thread
+owning its partition, so the actors of a partition, and the messages they exchange, stay in the
+caches of a single processor.
+
+Mailboxes scheduled by a worker thread in its own partition are pushed to its private work queue,
+which no other thread touches. Mailboxes scheduled in other partitions are pushed through a
+single-producer, single-consumer ring per pair of partitions, drained by the destination thread.
+Mailboxes scheduled from outside the worker threads, and those that don't fit in a full ring,
+are pushed to a lock-free inbox per partition. None of these paths take a lock.
+
+Each partition has a single owning thread, so an idle thread parks on its own \ref Parker rather
+than waiting on a shared monitor, and a pushing thread unparks only the thread owning the
+destination partition, and only if it's waiting. The monitor type is therefore unused.
+
+There is no load balancing between the partitions, so the number of worker threads must stay
+fixed while the queue is in use.
+
+\note Worker threads beyond the maximum number of partitions are given no partition, and stay idle.
+*/
+template <class MonitorType>
+class PartitionedQueue
+{
+public:
+
+    /**
+    The item type which is queued by the queue.
+    */
+    typedef Mailbox ItemType;
+
+    /**
+    Maximum number of partitions, and hence of worker threads that process mailboxes.
+    */
+    static const uint32_t MAX_PARTITIONS = 64;
+
+    /**
+    Number of slots in each ring between a pair of partitions. Must be a power of two.
+    */
+    static const uint32_t RING_SIZE = 64;
+
+    /**
+    Context structure used to access the queue.
+    */
+    class ContextType
+    {
+    public:
+
+        friend class PartitionedQueue;
+
+        inline ContextType() :
+          mRunning(0),
+          mShared(false),
+          mPartition(MAX_PARTITIONS),
+          mSlot(0),
+          mNextRing(0),
+          mLocalPops(0),
+          mWaiting(0),
+          mInboxCount(0),
+          mLocalWorkQueue(),
+          mInbox()
+        {
+        }
+
+    private:
+
+        template <class ValueType>
+        struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Aligned
+        {
+            ValueType mValue;
+
+        } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+        /**
+        Single-producer, single-consumer ring carrying mailboxes from one partition to another.
+        The head is written only by the destination thread and the tail only by the source thread.
+        */
+        struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Ring
+        {
+            Aligned<Atomic::UInt32> mHead;                  ///< Count of mailboxes popped by the destination thread.
+            Aligned<Atomic::UInt32> mTail;                  ///< Count of mailboxes pushed by the source thread.
+            Mailbox *mItems[RING_SIZE];                     ///< Slots holding the pushed mailboxes.
+
+        } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+        Atomic::UInt32 mRunning;                            ///< Used to signal the thread to terminate.
+        bool mShared;                                       ///< Indicates whether this is the 'shared' context.
+        uint32_t mPartition;                                ///< Index of the partition owned by the thread.
+        uint32_t mSlot;                                     ///< Index of the thread among those sharing its node.
+        uint32_t mNextRing;                                 ///< Index of the ring the thread checks first.
+        uint32_t mLocalPops;                                ///< Number of successive pops from the local queue.
+        Atomic::UInt32 mWaiting;                            ///< Set while the thread is waiting for work.
+        Atomic::UInt32 mInboxCount;                         ///< Number of mailboxes in the inbox.
+        Queue<Mailbox> mLocalWorkQueue;                     ///< Mailboxes scheduled by the thread in its own partition.
+        MpscQueue<Mailbox> mInbox;                          ///< Mailboxes scheduled from outside the partitions.
+        Parker mParker;                                     ///< Private parker on which the thread waits for work.
+        QueueCounters mCounters;                            ///< Per-context event counters.
+        Ring mRings[MAX_PARTITIONS];                        ///< Rings from each other partition, by source partition.
+    };
+
+    /**
+    Constructor.
+    */
+    inline explicit PartitionedQueue(const YieldStrategy yieldStrategy);
+
+    /**
+    Initializes a user-allocated context as the 'shared' context common to all threads.
+    */
+    inline void InitializeSharedContext(ContextType *const context);
+
+    /**
+    Initializes a user-allocated context as the context associated with the calling thread.
+    */
+    inline void InitializeWorkerContext(ContextType *const context);
+
+    /**
+    Releases a previously initialized shared context.
+    */
+    inline void ReleaseSharedContext(ContextType *const context);
+
+    /**
+    Releases a previously initialized worker thread context.
+    */
+    inline void ReleaseWorkerContext(ContextType *const context);
+
+    /**
+    Assigns a partition to a worker thread context, and binds it to one of the NUMA nodes in the given node mask.
+    \param bound Set to true if the thread was bound to a single node, false if it keeps the given mask.
+    \return The node mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignNode(ContextType *const context, const uint32_t nodeMask, bool &bound);
+
+    /**
+    Pins a worker thread context to a single processor of those in the given processor mask,
+    distinct from those of the other threads bound to the same node.
+    \return The processor mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignProcessors(ContextType *const context, const uint32_t processorMask);
+
+    /**
+    Pins a worker thread context to a single processor of those in the given processor set,
+    distinct from those of the other threads bound to the same node.
+    */
+    inline void AssignProcessors(ContextType *const context, ProcessorSet &processorSet);
+
+    /**
+    Resets to zero the given counter for the given thread context.
+    */
+    inline void ResetCounter(ContextType *const context, const uint32_t counter) const;
+
+    /**
+    Gets the value of the given counter for the given thread context.
+    */
+    inline uint32_t GetCounterValue(const ContextType *const context, const uint32_t counter) const;
+
+    /**
+    Accumulates the value of the given counter for the given thread context.
+    */
+    inline void AccumulateCounterValue(
+        const ContextType *const context,
+        const uint32_t counter,
+        uint32_t &accumulator) const;
+
+    /**
+    Returns true if a call to Pop would return no mailbox, for the given context.
+    */
+    inline bool Empty(const ContextType *const context) const;
+
+    /**
+    Returns true if the thread with the given context is still enabled.
+    */
+    inline bool Running(const ContextType *const context) const;
+
+    /**
+    Returns an estimate of the number of mailboxes waiting in the partitions.
+    */
+    inline uint32_t GetQueueDepth() const;
+
+    /**
+    Returns the number of worker threads currently waiting for work.
+    */
+    inline uint32_t GetIdleThreadCount() const;
+
+    /**
+    Wakes any worker threads which are blocked waiting for the queue to become non-empty.
+    */
+    inline void WakeAll();
+
+    /**
+    Pushes a mailbox into the queue, scheduling it for processing.
+    */
+    inline void Push(ContextType *const context, Mailbox *mailbox, const SchedulerHints &hints);
+
+    /**
+    Pushes a batch of mailboxes into the queue, scheduling them for processing.
+    */
+    inline void PushBatch(ContextType *const context, Mailbox *const *const mailboxes, const uint32_t count, const SchedulerHints &hints);
+
+    /**
+    Pops a previously pushed mailbox from the queue for processing.
+    */
+    inline Mailbox *Pop(ContextType *const context);
+
+    /**
+    Records that a number of messages were processed from a popped mailbox.
+    */
+    inline void EndVisit(ContextType *const context, const uint32_t messageCount);
+
+private:
+
+    /**
+    Number of successive pops from the local queue after which a thread checks its rings and inbox,
+    so that actors repeatedly scheduling each other within a partition can't starve the others.
+    */
+    static const uint32_t LOCAL_POP_BUDGET = 16;
+
+    /**
+    Maximum number of NUMA nodes over which the partitions are spread.
+    */
+    static const uint32_t MAX_NODES = 32;
+
+    PartitionedQueue(const PartitionedQueue &other);
+    PartitionedQueue &operator=(const PartitionedQueue &other);
+
+    /**
+    Pushes a mailbox to the ring from the source partition to the destination context.
+    \return False if the ring is full.
+    */
+    inline static bool PushRing(ContextType *const destination, const uint32_t source, Mailbox *const mailbox);
+
+    /**
+    Pops a mailbox from the inbox or rings of the given context.
+    */
+    inline Mailbox *PopRemote(ContextType *const context);
+
+    /**
+    Places a mailbox in the local queue, a ring or the inbox of the partition to which it belongs.
+    \return The context of the partition, if its thread needs waking, otherwise null.
+    */
+    inline ContextType *Place(ContextType *const context, Mailbox *const mailbox);
+
+    /**
+    Wakes the thread owning the given context, if it's waiting.
+    */
+    inline static void Wake(ContextType *const context);
+
+    Atomic::UInt32 mWaitingThreads;                 ///< Number of worker threads waiting on the monitor.
+    Atomic::UInt32 mPartitionCount;                 ///< Number of worker thread contexts that own partitions.
+    ContextType *mPartitions[MAX_PARTITIONS];       ///< Worker thread contexts owning the partitions, by index.
+    uint32_t mNodeCount;                            ///< Number of NUMA nodes over which the partitions can be spread.
+};
+
+
+template <class MonitorType>
+inline PartitionedQueue<MonitorType>::PartitionedQueue(const YieldStrategy /*yieldStrategy*/) :
+  mWaitingThreads(0),
+  mPartitionCount(0),
+  mNodeCount(1)
+{
+    for (uint32_t index = 0; index < MAX_PARTITIONS; ++index)
+    {
+        mPartitions[index] = 0;
+    }
+
+    uint32_t nodeCount(0);
+    if (Utils::GetNodeCount(nodeCount) && nodeCount > 1)
+    {
+        mNodeCount = (nodeCount < MAX_NODES ? nodeCount : MAX_NODES);
+    }
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::InitializeSharedContext(ContextType *const context)
+{
+    context->mShared = true;
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::InitializeWorkerContext(ContextType *const context)
+{
+    // Only worker threads should call this method.
+    context->mShared = false;
+    context->mLocalPops = 0;
+    context->mRunning.Store(1);
+
+    // The minimum counters need to be initialized to maxint.
+    context->mCounters.Initialize();
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::ReleaseSharedContext(ContextType *const /*context*/)
+{
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::ReleaseWorkerContext(ContextType *const context)
+{
+    // The context keeps its partition, so a restarted thread serves the same mailboxes.
+    // The thread checks the flag before parking, so the unpark can't be missed.
+    context->mRunning.Store(0);
+    context->mParker.Unpark();
+}
+
+
+template <class MonitorType>
+inline uint32_t PartitionedQueue<MonitorType>::AssignNode(ContextType *const context, const uint32_t nodeMask, bool &bound)
+{
+    // Contexts are given partitions on their first start, since stopped threads are restarted with
+    // the same context. Only the manager thread starts threads, so there are no competing registrations.
+    // The pointer is stored before the count is raised, so pushing threads never see a null entry.
+    const uint32_t partitionCount(mPartitionCount.Load());
+    if (context->mPartition >= MAX_PARTITIONS && partitionCount < MAX_PARTITIONS)
+    {
+        context->mPartition = partitionCount;
+        mPartitions[partitionCount] = context;
+        mPartitionCount.Increment();
+    }
+
+    // Spread the partitions over the enabled nodes in turn, if there are several.
+    const uint32_t availableMask(mNodeCount < MAX_NODES ? (1UL << mNodeCount) - 1 : 0xFFFFFFFF);
+    const uint32_t enabledMask(nodeMask & availableMask);
+
+    uint32_t enabledCount(0);
+    for (uint32_t node = 0; node < mNodeCount; ++node)
+    {
+        if (enabledMask & (1UL << node))
+        {
+            ++enabledCount;
+        }
+    }
+
+    const uint32_t partition(context->mPartition < MAX_PARTITIONS ? context->mPartition : 0);
+    context->mSlot = partition;
+    bound = false;
+
+    if (mNodeCount > 1 && enabledCount > 1)
+    {
+        // Threads sharing a node are numbered in turn, so each is given a different processor.
+        context->mSlot = partition / enabledCount;
+
+        uint32_t skipped(partition % enabledCount);
+        for (uint32_t node = 0; node < mNodeCount; ++node)
+        {
+            if ((enabledMask & (1UL << node)) && skipped-- == 0)
+            {
+                bound = true;
+                return (1UL << node);
+            }
+        }
+    }
+
+    return nodeMask;
+}
+
+
+template <class MonitorType>
+inline uint32_t PartitionedQueue<MonitorType>::AssignProcessors(ContextType *const context, const uint32_t processorMask)
+{
+    uint32_t processorCount(0);
+    for (uint32_t processor = 0; processor < 32; ++processor)
+    {
+        if (processorMask & (1UL << processor))
+        {
+            ++processorCount;
+        }
+    }
+
+    if (processorCount == 0)
+    {
+        return processorMask;
+    }
+
+    // Pick the processor for the thread's slot, wrapping if there are more threads than processors.
+    uint32_t skipped(context->mSlot % processorCount);
+    for (uint32_t processor = 0; processor < 32; ++processor)
+    {
+        if ((processorMask & (1UL << processor)) && skipped-- == 0)
+        {
+            return (1UL << processor);
+        }
+    }
+
+    return processorMask;
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::AssignProcessors(ContextType *const context, ProcessorSet &processorSet)
+{
+    const uint32_t processorCount(processorSet.Count());
+    if (processorCount == 0)
+    {
+        return;
+    }
+
+    // Pick the processor for the thread's slot, wrapping if there are more threads than processors.
+    uint32_t skipped(context->mSlot % processorCount);
+    for (uint32_t processor = 0; processor < ProcessorSet::MAX_PROCESSORS; ++processor)
+    {
+        if (processorSet.Contains(processor) && skipped-- == 0)
+        {
+            processorSet.Clear();
+            processorSet.Add(processor);
+            return;
+        }
+    }
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::ResetCounter(ContextType *const context, const uint32_t counter) const
+{
+    context->mCounters.Reset(counter);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t PartitionedQueue<MonitorType>::GetCounterValue(const ContextType *const context, const uint32_t counter) const
+{
+    return context->mCounters.Get(counter);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void PartitionedQueue<MonitorType>::AccumulateCounterValue(
+    const ContextType *const context,
+    const uint32_t counter,
+    uint32_t &accumulator) const
+{
+    context->mCounters.Accumulate(counter, accumulator);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool PartitionedQueue<MonitorType>::Empty(const ContextType *const context) const
+{
+    // The shared context doesn't own a partition.
+    if (context->mShared || context->mPartition >= MAX_PARTITIONS)
+    {
+        return true;
+    }
+
+    if (!context->mLocalWorkQueue.Empty() || context->mInboxCount.Load() != 0)
+    {
+        return false;
+    }
+
+    const uint32_t partitionCount(mPartitionCount.Load());
+    for (uint32_t source = 0; source < partitionCount; ++source)
+    {
+        const typename ContextType::Ring &ring(context->mRings[source]);
+        if (ring.mHead.mValue.Load() != ring.mTail.mValue.Load())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool PartitionedQueue<MonitorType>::Running(const ContextType *const context) const
+{
+    return (context->mRunning.Load() != 0);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t PartitionedQueue<MonitorType>::GetQueueDepth() const
+{
+    // Only the inboxes are counted, since the rings and local queues are owned by their threads.
+    uint32_t depth(0);
+
+    const uint32_t partitionCount(mPartitionCount.Load());
+    for (uint32_t partition = 0; partition < partitionCount; ++partition)
+    {
+        depth += mPartitions[partition]->mInboxCount.Load();
+    }
+
+    return depth;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t PartitionedQueue<MonitorType>::GetIdleThreadCount() const
+{
+    return mWaitingThreads.Load();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void PartitionedQueue<MonitorType>::WakeAll()
+{
+    const uint32_t partitionCount(mPartitionCount.Load());
+    for (uint32_t partition = 0; partition < partitionCount; ++partition)
+    {
+        mPartitions[partition]->mParker.Unpark();
+    }
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void PartitionedQueue<MonitorType>::Push(
+    ContextType *const context,
+    Mailbox *mailbox,
+    const SchedulerHints &/*hints*/)
+{
+    if (ContextType *const destination = Place(context, mailbox))
+    {
+        Wake(destination);
+    }
+}
+
+
+template <class MonitorType>
+inline void PartitionedQueue<MonitorType>::PushBatch(
+    ContextType *const context,
+    Mailbox *const *const mailboxes,
+    const uint32_t count,
+    const SchedulerHints &/*hints*/)
+{
+    // The mailboxes of a batch belong to different partitions, so are placed one at a time,
+    // and the thread of each destination partition is woken if it's waiting. Waking a thread
+    // that's already been woken is cheap, since it only sleeps again once it finds no work.
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        if (ContextType *const destination = Place(context, mailboxes[index]))
+        {
+            Wake(destination);
+        }
+    }
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE typename PartitionedQueue<MonitorType>::ContextType *PartitionedQueue<MonitorType>::Place(
+    ContextType *const context,
+    Mailbox *const mailbox)
+{
+    // Timestamp the mailbox and update the maximum mailbox queue length seen by this thread.
+    context->mCounters.CountPush(mailbox);
+
+    // The framework waits for all its worker threads to start before any messages can be sent.
+    const uint32_t partitionCount(mPartitionCount.Load());
+    THERON_ASSERT(partitionCount);
+
+    // Bound mailboxes belong to the partition of their thread, if it has one, and others by their index.
+    uint32_t partition(mailbox->GetWorkerThread());
+    if (partition >= partitionCount)
+    {
+        partition = mailbox->GetIndex() % partitionCount;
+    }
+
+    ContextType *const destination(mPartitions[partition]);
+    const uint32_t source(context->mPartition);
+
+    if (!context->mShared && source < partitionCount)
+    {
+        // Mailboxes scheduled within the calling thread's own partition stay in its private queue.
+        if (destination == context)
+        {
+            context->mLocalWorkQueue.Push(mailbox);
+            context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+            return 0;
+        }
+
+        if (PushRing(destination, source, mailbox))
+        {
+            context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+            return destination;
+        }
+    }
+
+    // Mailboxes scheduled from outside the partitions, or overflowing a full ring, go to the inbox.
+    destination->mInbox.Push(mailbox);
+    destination->mInboxCount.Increment();
+
+    context->mCounters.Increment(COUNTER_SHARED_PUSHES);
+    return destination;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *PartitionedQueue<MonitorType>::Pop(ContextType *const context)
+{
+    Mailbox *mailbox(0);
+    bool shared(false);
+
+    // The shared context is never used to call Pop, only to Push
+    // messages sent outside the context of a worker thread.
+    THERON_ASSERT(context->mShared == false);
+
+    // Serve the local queue first, but check the rings and inbox once its budget is spent.
+    if (!context->mLocalWorkQueue.Empty() && ++context->mLocalPops < LOCAL_POP_BUDGET)
+    {
+        mailbox = context->mLocalWorkQueue.Pop();
+    }
+    else
+    {
+        context->mLocalPops = 0;
+        shared = true;
+
+        if (context->mPartition < MAX_PARTITIONS)
+        {
+            mailbox = PopRemote(context);
+        }
+
+        if (mailbox == 0 && !context->mLocalWorkQueue.Empty())
+        {
+            mailbox = context->mLocalWorkQueue.Pop();
+            shared = false;
+        }
+
+        if (mailbox == 0)
+        {
+            // Wait until a mailbox is pushed to the partition, or the thread is stopped.
+            // The waiting flag is raised, with a full barrier, before the partition is re-checked,
+            // and pushing threads check it after pushing, so either we see the pushed mailbox
+            // or the pushing thread sees us waiting and unparks us. An unpark that arrives
+            // before we park leaves a permit, so the park returns straight away.
+            mWaitingThreads.Increment();
+            context->mWaiting.Store(1);
+
+            while ((context->mPartition >= MAX_PARTITIONS || (mailbox = PopRemote(context)) == 0) &&
+                context->mRunning.Load() != 0)
+            {
+                context->mCounters.Increment(COUNTER_YIELDS);
+                context->mParker.Park();
+            }
+
+            context->mWaiting.Store(0);
+            mWaitingThreads.Decrement();
+        }
+    }
+
+    if (mailbox)
+    {
+        context->mCounters.CountPop(mailbox, shared);
+    }
+
+    return mailbox;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void PartitionedQueue<MonitorType>::EndVisit(ContextType *const context, const uint32_t messageCount)
+{
+    context->mCounters.CountVisit(messageCount);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool PartitionedQueue<MonitorType>::PushRing(
+    ContextType *const destination,
+    const uint32_t source,
+    Mailbox *const mailbox)
+{
+    typename ContextType::Ring &ring(destination->mRings[source]);
+
+    const uint32_t tail(ring.mTail.mValue.Load());
+    if (tail - ring.mHead.mValue.Load() >= RING_SIZE)
+    {
+        return false;
+    }
+
+    // Storing the tail publishes the slot, and is a full barrier before the waiting flag is checked.
+    ring.mItems[tail & (RING_SIZE - 1)] = mailbox;
+    ring.mTail.mValue.Store(tail + 1);
+
+    return true;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *PartitionedQueue<MonitorType>::PopRemote(ContextType *const context)
+{
+    // The inbox can briefly appear empty while a mailbox is being pushed, in which case
+    // it's picked up on a later call; the count keeps the thread from waiting meanwhile.
+    if (context->mInboxCount.Load() != 0)
+    {
+        if (Mailbox *const mailbox = context->mInbox.Pop())
+        {
+            context->mInboxCount.Decrement();
+            return mailbox;
+        }
+    }
+
+    // Check the rings in turn, starting after the last one popped, so that no source is starved.
+    const uint32_t partitionCount(mPartitionCount.Load());
+    uint32_t source(context->mNextRing);
+
+    for (uint32_t visited = 0; visited < partitionCount; ++visited)
+    {
+        if (source >= partitionCount)
+        {
+            source = 0;
+        }
+
+        typename ContextType::Ring &ring(context->mRings[source]);
+        const uint32_t head(ring.mHead.mValue.Load());
+
+        if (head != ring.mTail.mValue.Load())
+        {
+            Mailbox *const mailbox(ring.mItems[head & (RING_SIZE - 1)]);
+            ring.mHead.mValue.Store(head + 1);
+
+            context->mNextRing = source + 1;
+            return mailbox;
+        }
+
+        ++source;
+    }
+
+    return 0;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void PartitionedQueue<MonitorType>::Wake(ContextType *const context)
+{
+    // The mailbox was pushed with a full barrier, so if the thread isn't seen waiting here
+    // then it'll see the mailbox when it re-checks its partition after raising the flag.
+    // Only the owning thread parks on the parker, so only that thread is woken.
+    if (context->mWaiting.Load())
+    {
+        context->mParker.Unpark();
+    }
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_PARTITIONEDQUEUE_H
@@ -0,0 +1,224 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_POOLSCHEDULER_H
+#define THERON_DETAIL_SCHEDULER_POOLSCHEDULER_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/Counting.h>
+#include <Theron/Detail/Scheduler/IScheduler.h>
+#include <Theron/Detail/Scheduler/MailboxContext.h>
+#include <Theron/Detail/Scheduler/TimerWheel.h>
+#include <Theron/Detail/Scheduler/WorkerContext.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+
+
+class WorkerPool;
+
+
+namespace Detail
+{
+
+
+/**
+Scheduler of a framework attached to a shared \ref Theron::WorkerPool.
+
+The scheduler owns no threads. It holds a work queue of the framework's mailboxes, which the
+worker threads of the pool visit in turn with those of the other attached frameworks, and a
+worker context for each thread of the pool. The contexts point at the framework's own
+fallback handlers and message allocator, so the frameworks stay isolated from each other
+although their actors are processed by the same threads.
+
+The thread limits of the framework are those of the pool, and can't be changed through the
+framework. Actors bound to worker threads aren't bound within the pool, and actor priorities
+aren't distinguished; both are ordinary mailboxes in the framework's work queue.
+*/
+class PoolScheduler : public IScheduler
+{
+public:
+
+    /**
+    Constructor.
+    \param pool The pool whose worker threads process the framework's mailboxes.
+    \param threadCount Number of worker threads in the pool.
+    \param nodeMask NUMA node mask of the worker threads of the pool.
+    \param weight Number of mailboxes a worker thread processes from the framework before moving on to the next.
+    */
+    PoolScheduler(
+        WorkerPool *const pool,
+        FallbackHandlerCollection *const fallbackHandlers,
+        IAllocator *const messageAllocator,
+        MailboxContext *const sharedMailboxContext,
+        const uint32_t threadCount,
+        const uint32_t nodeMask,
+        const uint32_t weight,
+        const uint32_t messagesPerVisit,
+        const uint32_t continuationDepth);
+
+    /**
+    Destructor.
+    */
+    virtual ~PoolScheduler();
+
+    /**
+    Returns the number of mailboxes a worker thread processes from the framework in each turn.
+    */
+    inline uint32_t GetWeight() const;
+
+    /**
+    Returns true if the work queue of the framework may hold no mailboxes.
+    */
+    inline bool Empty() const;
+
+    /**
+    Pops a mailbox from the work queue of the framework, on behalf of a worker thread of the pool.
+    \return A pointer to a mailbox, or zero if the queue is empty.
+    */
+    Mailbox *Pop(const uint32_t thread);
+
+    /**
+    Processes a popped mailbox using the context of the given worker thread of the pool.
+    */
+    void Process(const uint32_t thread, Mailbox *const mailbox);
+
+    /**
+    Returns true if timers of the framework are pending.
+    */
+    inline bool TimersPending() const;
+
+    /**
+    Delivers the messages of any expired timers of the framework.
+    */
+    inline void ServiceTimers();
+
+    virtual void Initialize(const uint32_t threadCount);
+    virtual void Release();
+    virtual void BeginHandler(MailboxContext *const mailboxContext, IMessageHandler *const messageHandler);
+    virtual void EndHandler(MailboxContext *const mailboxContext, IMessageHandler *const messageHandler);
+    virtual void Schedule(MailboxContext *const mailboxContext, Mailbox *const mailbox);
+    virtual void ScheduleBatch(MailboxContext *const mailboxContext, Mailbox *const *const mailboxes, const uint32_t count);
+    virtual void EndVisit(MailboxContext *const mailboxContext, const uint32_t messageCount);
+    virtual uint32_t StartTimer(Timer *const timer);
+    virtual bool CancelTimer(const uint32_t handle);
+    virtual void StopTimers();
+    virtual uint32_t GetMessagesSent() const;
+    virtual uint32_t GetMessagesRetired() const;
+    virtual void SetMaxThreads(const uint32_t count);
+    virtual void SetMinThreads(const uint32_t count);
+    virtual uint32_t GetMaxThreads() const;
+    virtual uint32_t GetMinThreads() const;
+    virtual uint32_t GetNumThreads() const;
+    virtual uint32_t GetPeakThreads() const;
+    virtual void ResetCounters();
+    virtual uint32_t GetCounterValue(const uint32_t counter) const;
+    virtual uint32_t GetPerThreadCounterValues(
+        const uint32_t counter,
+        uint32_t *const perThreadCounts,
+        const uint32_t maxCounts) const;
+    virtual uint32_t GetPerNodeCounterValues(
+        const uint32_t counter,
+        uint32_t *const perNodeCounts,
+        const uint32_t maxCounts) const;
+
+private:
+
+    template <class ValueType>
+    struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Aligned
+    {
+        ValueType mValue;
+
+    } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+    typedef Aligned<Atomic::UInt32> Counters[MAX_COUNTERS];
+
+    /**
+    Context used by one worker thread of the pool to process the framework's mailboxes.
+    The mailbox context of the worker context points at the counters, as its queue context.
+    */
+    struct WorkerSlot
+    {
+        WorkerContext mWorkerContext;           ///< Message cache and mailbox context of the thread.
+        Counters mCounters;                     ///< Event counters of the thread.
+    };
+
+    PoolScheduler(const PoolScheduler &other);
+    PoolScheduler &operator=(const PoolScheduler &other);
+
+    inline static Aligned<Atomic::UInt32> *GetCounters(MailboxContext *const mailboxContext);
+
+    WorkerPool *const mPool;                            ///< Pool whose worker threads process the mailboxes.
+    FallbackHandlerCollection *const mFallbackHandlers; ///< Fallback handlers of the framework.
+    IAllocator *const mMessageAllocator;                ///< Message allocator of the framework.
+    MailboxContext *const mSharedMailboxContext;        ///< Context used by threads that aren't worker threads.
+    const uint32_t mThreadCount;                        ///< Number of worker threads in the pool.
+    const uint32_t mNodeMask;                           ///< NUMA node mask of the worker threads.
+    const uint32_t mWeight;                             ///< Mailboxes processed by a worker thread in each turn.
+    const uint32_t mMessagesPerVisit;                   ///< Maximum messages processed per mailbox visit.
+    const uint32_t mContinuationDepth;                  ///< Maximum depth of continuations.
+    WorkerSlot *mSlots;                                 ///< Array of per-thread contexts, one for each thread of the pool.
+    Counters mSharedCounters;                           ///< Event counters of the shared context.
+    Aligned<Atomic::UInt32> mQueueDepth;                ///< Number of mailboxes in the work queue.
+    SpinLock mQueueLock;                                ///< Protects the work queue.
+    Queue<Mailbox> mQueue;                              ///< Work queue of the framework's mailboxes.
+    TimerWheel mTimers;                                 ///< Pending timers of the framework.
+};
+
+
+THERON_FORCEINLINE uint32_t PoolScheduler::GetWeight() const
+{
+    return mWeight;
+}
+
+
+THERON_FORCEINLINE bool PoolScheduler::Empty() const
+{
+    return (mQueueDepth.mValue.Load() == 0);
+}
+
+
+THERON_FORCEINLINE bool PoolScheduler::TimersPending() const
+{
+    return !mTimers.Empty();
+}
+
+
+THERON_FORCEINLINE void PoolScheduler::ServiceTimers()
+{
+    mTimers.Service();
+}
+
+
+THERON_FORCEINLINE PoolScheduler::Aligned<Atomic::UInt32> *PoolScheduler::GetCounters(MailboxContext *const mailboxContext)
+{
+    return reinterpret_cast<Aligned<Atomic::UInt32> *>(mailboxContext->mQueueContext);
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_POOLSCHEDULER_H
@@ -0,0 +1,193 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_QUEUECOUNTERS_H
+#define THERON_DETAIL_SCHEDULER_QUEUECOUNTERS_H
+
+
+#include <Theron/Align.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/Counting.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Clock.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Event counters of a single mailbox queue context.
+
+Implements the counting of pushed, popped and processed mailboxes common to the queues,
+so the queues only decide which events to count.
+*/
+class QueueCounters
+{
+public:
+
+    /**
+    Initializes the minimum counters to maxint, ready for a worker thread to start.
+    */
+    inline void Initialize();
+
+    /**
+    Resets the given counter.
+    */
+    inline void Reset(const uint32_t counter);
+
+    /**
+    Gets the value of the given counter.
+    */
+    inline uint32_t Get(const uint32_t counter) const;
+
+    /**
+    Accumulates the value of the given counter.
+    */
+    inline void Accumulate(const uint32_t counter, uint32_t &accumulator) const;
+
+    /**
+    Increments the given counter.
+    */
+    inline void Increment(const uint32_t counter);
+
+    /**
+    Adds a number of events to the given counter.
+    */
+    inline void Add(const uint32_t counter, const uint32_t count);
+
+    /**
+    Records a mailbox entering the queue, timestamping it so its queue latency can be measured.
+    */
+    inline void CountPush(Mailbox *const mailbox);
+
+    /**
+    Records a mailbox popped from the queue, and its latency in the local or shared queue.
+    */
+    inline void CountPop(const Mailbox *const mailbox, const bool shared);
+
+    /**
+    Records that a number of messages were processed from a popped mailbox.
+    */
+    inline void CountVisit(const uint32_t messageCount);
+
+private:
+
+    struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Aligned
+    {
+        Atomic::UInt32 mValue;
+
+    } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+    Aligned mCounters[MAX_COUNTERS];        ///< Array of event counters, each in its own cache line.
+};
+
+
+inline void QueueCounters::Initialize()
+{
+    Counting::Reset(mCounters[COUNTER_QUEUE_LATENCY_LOCAL_MIN].mValue, COUNTER_QUEUE_LATENCY_LOCAL_MIN);
+    Counting::Reset(mCounters[COUNTER_QUEUE_LATENCY_SHARED_MIN].mValue, COUNTER_QUEUE_LATENCY_SHARED_MIN);
+}
+
+
+inline void QueueCounters::Reset(const uint32_t counter)
+{
+    Counting::Reset(mCounters[counter].mValue, counter);
+}
+
+
+THERON_FORCEINLINE uint32_t QueueCounters::Get(const uint32_t counter) const
+{
+    return Counting::Get(mCounters[counter].mValue);
+}
+
+
+THERON_FORCEINLINE void QueueCounters::Accumulate(const uint32_t counter, uint32_t &accumulator) const
+{
+    Counting::Accumulate(mCounters[counter].mValue, counter, accumulator);
+}
+
+
+THERON_FORCEINLINE void QueueCounters::Increment(const uint32_t counter)
+{
+    Counting::Increment(mCounters[counter].mValue);
+}
+
+
+THERON_FORCEINLINE void QueueCounters::Add(const uint32_t counter, const uint32_t count)
+{
+    Counting::Add(mCounters[counter].mValue, count);
+}
+
+
+THERON_FORCEINLINE void QueueCounters::CountPush(Mailbox *const mailbox)
+{
+#if THERON_ENABLE_COUNTERS
+
+    // Timestamp the mailbox on entry.
+    mailbox->Timestamp() = Clock::GetTicks();
+
+#endif // THERON_ENABLE_COUNTERS
+
+    // Update the maximum mailbox queue length seen by this thread.
+    Counting::Raise(mCounters[COUNTER_MAILBOX_QUEUE_MAX].mValue, mailbox->Count());
+}
+
+
+THERON_FORCEINLINE void QueueCounters::CountPop(const Mailbox *const mailbox, const bool shared)
+{
+    Counting::Increment(mCounters[COUNTER_MESSAGES_PROCESSED].mValue);
+
+#if THERON_ENABLE_COUNTERS
+
+    // Compute the latency and update the maximum queue latency seen by this thread.
+    const uint64_t timestamp(Clock::GetTicks());
+    const uint64_t ticks(timestamp - mailbox->Timestamp());
+    const uint64_t ticksPerSecond(Clock::GetFrequency());
+    const uint32_t usec(static_cast<uint32_t>(ticks * 1000000 / ticksPerSecond));
+
+    const uint32_t maxCounter(shared ? COUNTER_QUEUE_LATENCY_SHARED_MAX : COUNTER_QUEUE_LATENCY_LOCAL_MAX);
+    const uint32_t minCounter(shared ? COUNTER_QUEUE_LATENCY_SHARED_MIN : COUNTER_QUEUE_LATENCY_LOCAL_MIN);
+    const uint32_t priorityCounter(COUNTER_QUEUE_LATENCY_LOW_MAX + mailbox->GetPriority());
+
+    Counting::Raise(mCounters[maxCounter].mValue, usec);
+    Counting::Lower(mCounters[minCounter].mValue, usec);
+    Counting::Raise(mCounters[priorityCounter].mValue, usec);
+
+#else
+
+    (void) mailbox;
+    (void) shared;
+
+#endif // THERON_ENABLE_COUNTERS
+}
+
+
+THERON_FORCEINLINE void QueueCounters::CountVisit(const uint32_t messageCount)
+{
+    // The first message of each visit was counted when the mailbox was popped.
+    Counting::Add(mCounters[COUNTER_MESSAGES_PROCESSED].mValue, messageCount - 1);
+    Counting::Increment(mCounters[COUNTER_MAILBOX_VISITS].mValue);
+    Counting::Raise(mCounters[COUNTER_MESSAGES_PER_VISIT_MAX].mValue, messageCount);
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_QUEUECOUNTERS_H
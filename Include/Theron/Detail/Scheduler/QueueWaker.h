@@ -0,0 +1,65 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_QUEUEWAKER_H
+#define THERON_DETAIL_SCHEDULER_QUEUEWAKER_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Static helper that wakes worker threads waiting on the monitor of a mailbox queue.
+
+Waiting threads are expected to register themselves in the count of waiting threads under
+the monitor lock, before checking the queues for work and waiting on the monitor.
+*/
+template <class MonitorType>
+class QueueWaker
+{
+public:
+
+    /**
+    Wakes a waiting thread for each of a number of newly pushed mailboxes, if any are waiting.
+    The mailboxes must have been pushed before calling, with a full memory barrier.
+    */
+    inline static void Wake(MonitorType &monitor, const Atomic::UInt32 &waitingThreads, const uint32_t count);
+};
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void QueueWaker<MonitorType>::Wake(MonitorType &monitor, const Atomic::UInt32 &waitingThreads, const uint32_t count)
+{
+    // Acquiring the lock ensures the pulse can't be lost between a waiting thread's check
+    // of the queues and its wait. It's okay to release the lock before calling Pulse.
+    // The lock is taken once for the whole batch rather than once per mailbox.
+    const uint32_t waitingCount(waitingThreads.Load());
+    if (count == 0 || waitingCount == 0)
+    {
+        return;
+    }
+
+    {
+        typename MonitorType::LockType lock(monitor);
+    }
+
+    const uint32_t wakeCount(count < waitingCount ? count : waitingCount);
+    for (uint32_t wake = 0; wake < wakeCount; ++wake)
+    {
+        monitor.Pulse();
+    }
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_SCHEDULER_QUEUEWAKER_H
@@ -11,8 +11,10 @@
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 #include <Theron/IAllocator.h>
+#include <Theron/ProcessorSet.h>
 #include <Theron/YieldStrategy.h>
 
+#include <Theron/Detail/Allocators/NodeAllocator.h>
 #include <Theron/Detail/Containers/List.h>
 #include <Theron/Detail/Directory/Directory.h>
 #include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
@@ -22,9 +24,12 @@
 #include <Theron/Detail/Scheduler/MailboxProcessor.h>
 #include <Theron/Detail/Scheduler/SchedulerHints.h>
 #include <Theron/Detail/Scheduler/ThreadPool.h>
+#include <Theron/Detail/Scheduler/TimerWheel.h>
 #include <Theron/Detail/Scheduler/WorkerContext.h>
 #include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Clock.h>
 #include <Theron/Detail/Threading/Condition.h>
+#include <Theron/Detail/Threading/Lock.h>
 #include <Theron/Detail/Threading/Mutex.h>
 #include <Theron/Detail/Threading/Thread.h>
 
@@ -52,6 +57,8 @@ public:
 
     /**
     Constructor.
+    Worker threads are pinned to the processors of the placement order, if it isn't empty, in turn
+    from the given offset. The placement order is owned by the caller and must outlive the scheduler.
     */
     inline explicit Scheduler(
         Directory<Mailbox> *const mailboxes,
@@ -60,8 +67,15 @@ public:
         MailboxContext *const sharedMailboxContext,
         const uint32_t nodeMask,
         const uint32_t processorMask,
+        const ProcessorSet &processorSet,
         const float threadPriority,
-        const YieldStrategy yieldStrategy);
+        const uint32_t *const placementOrder,
+        const uint32_t placementCount,
+        const uint32_t placementOffset,
+        const YieldStrategy yieldStrategy,
+        const uint32_t messagesPerVisit,
+        const uint32_t continuationDepth,
+        const bool autoScaling);
 
     /**
     Virtual destructor.
@@ -93,6 +107,34 @@ public:
     */
     inline virtual void Schedule(MailboxContext *const mailboxContext, Mailbox *const mailbox);
 
+    /**
+    Schedules for processing a batch of mailboxes that have received messages.
+    */
+    inline virtual void ScheduleBatch(MailboxContext *const mailboxContext, Mailbox *const *const mailboxes, const uint32_t count);
+
+    /**
+    Notifies the scheduler that a worker thread has processed a number of messages from a mailbox in one visit.
+    */
+    inline virtual void EndVisit(MailboxContext *const mailboxContext, const uint32_t messageCount);
+
+    /**
+    Starts a timer, taking ownership of it.
+    */
+    inline virtual uint32_t StartTimer(Timer *const timer);
+
+    /**
+    Cancels a pending timer.
+    */
+    inline virtual bool CancelTimer(const uint32_t handle);
+
+    /**
+    Discards any pending timers, so no more messages are sent by them.
+    */
+    inline virtual void StopTimers();
+
+    inline virtual uint32_t GetMessagesSent() const;
+    inline virtual uint32_t GetMessagesRetired() const;
+
     inline virtual void SetMaxThreads(const uint32_t count);
     inline virtual void SetMinThreads(const uint32_t count);
     inline virtual uint32_t GetMaxThreads() const;
@@ -107,6 +149,11 @@ public:
         uint32_t *const perThreadCounts,
         const uint32_t maxCounts) const;
 
+    inline virtual uint32_t GetPerNodeCounterValues(
+        const uint32_t counter,
+        uint32_t *const perNodeCounts,
+        const uint32_t maxCounts) const;
+
 private:
 
     typedef typename QueueType::ContextType QueueContext;
@@ -114,13 +161,67 @@ private:
     typedef typename ThreadPool::ThreadContext ThreadContext;
     typedef List<ThreadContext> ContextList;
 
+    /**
+    Interval in milliseconds at which the manager thread samples the load when scaling automatically.
+    */
+    static const uint32_t SCALING_INTERVAL = 10;
+
+    /**
+    Number of successive busy samples after which the thread count is increased.
+    */
+    static const uint32_t SCALE_UP_SAMPLES = 2;
+
+    /**
+    Number of successive quiet samples after which the thread count is decreased.
+    Shrinking is deliberately much slower than growing, so the pool doesn't oscillate with bursty loads.
+    */
+    static const uint32_t SCALE_DOWN_SAMPLES = 100;
+
+    /**
+    Shared queue latency in microseconds above which a rise in the maximum latency counts as busy.
+    */
+    static const uint32_t SCALING_LATENCY_THRESHOLD = 1000;
+
     Scheduler(const Scheduler &other);
     Scheduler &operator=(const Scheduler &other);
 
     /**
-    Checks whether all work queues are empty.
+    Samples the load on the worker threads and moves the target thread count between its limits.
+    Called periodically by the manager thread when automatic scaling is enabled.
+    */
+    inline void UpdateTargetThreadCount();
+
+    /**
+    Starts a created or previously stopped worker thread, binding it to a NUMA node if the queue is partitioned by node,
+    and to particular processors if the queue pins its threads or the thread is pinned to the given processor.
+    */
+    inline bool StartWorkerThread(ThreadContext *const threadContext, const uint32_t processor);
+
+    /**
+    Returns the processor to which the worker thread with the given creation index is pinned, if any.
+    */
+    inline uint32_t GetPinnedProcessor(const uint32_t threadIndex) const;
+
+    /**
+    Returns the given pinned processor if it's one of the given processors, or otherwise the next
+    processor in the placement order which is, or ANY_PROCESSOR if the order contains none of them.
+    */
+    inline uint32_t GetPinnedProcessor(const uint32_t processor, const ProcessorSet &processors) const;
+
+    /**
+    Returns the index of the lowest NUMA node in the given node mask.
+    */
+    inline static uint32_t GetLowestNode(const uint32_t nodeMask);
+
+    /**
+    Sleeps the manager thread for the given interval, waking each tick to service the timers while any are pending.
+    */
+    inline void ServiceTimers(const uint32_t interval);
+
+    /**
+    Wakes the manager thread early from its sleep.
     */
-    inline bool QueuesEmpty() const;
+    inline void WakeManagerThread();
 
     /**
     Static entry point function for the manager thread.
@@ -142,8 +243,15 @@ private:
     // Construction parameters.
     uint32_t mNodeMask;                                 ///< NUMA node affinity mask.
     uint32_t mProcessorMask;                            ///< Processor affinity mask with each NUMA node.
+    ProcessorSet mProcessorSet;                         ///< Processors on which the worker threads execute, overriding the masks if not empty.
     float mThreadPriority;                              ///< Relative scheduling priority of the worker threads.
+    uint32_t mMessagesPerVisit;                         ///< Maximum number of messages processed per visit to a mailbox.
+    uint32_t mContinuationDepth;                        ///< Maximum number of mailboxes processed in succession by continuation.
+    bool mAutoScaling;                                  ///< Whether the thread count is scaled automatically with the load.
 
+    const uint32_t *mPlacementOrder;                    ///< Processors to which worker threads are pinned, in order, if pinned.
+    uint32_t mPlacementCount;                           ///< Number of processors in the placement order.
+    uint32_t mPlacementOffset;                          ///< Position in the placement order of the processor of the first thread.
     QueueContext mSharedQueueContext;                   ///< Per-framework queue context shared by all worker threads.
     QueueType mQueue;                                   ///< Instantiation of the work queue implementation.
 
@@ -151,10 +259,22 @@ private:
     Thread mManagerThread;                              ///< Dynamically creates and destroys the worker threads.
     bool mRunning;                                      ///< Flag used to terminate the manager thread.
     Atomic::UInt32 mTargetThreadCount;                  ///< Desired number of worker threads.
+    Atomic::UInt32 mMinThreadCount;                     ///< Lower limit on the target thread count.
+    Atomic::UInt32 mMaxThreadCount;                     ///< Upper limit on the target thread count.
     Atomic::UInt32 mPeakThreadCount;                    ///< Peak number of worker threads.
     Atomic::UInt32 mThreadCount;                        ///< Actual number of worker threads.
     ContextList mThreadContexts;                        ///< List of worker thread context objects.
     mutable Mutex mThreadContextLock;                   ///< Protects the thread context list.
+    Condition mManagerCondition;                        ///< Condition on which the manager thread sleeps.
+    bool mManagerWoken;                                 ///< Set when the manager thread is woken early.
+
+    TimerWheel mTimers;                                 ///< Timers whose messages are delivered by the manager thread.
+
+    // Automatic scaling state, accessed only by the manager thread.
+    uint32_t mBusySamples;                              ///< Number of successive samples in which the threads were busy.
+    uint32_t mQuietSamples;                             ///< Number of successive samples in which the threads were quiet.
+    uint32_t mLastYieldCount;                           ///< Value of the yield counter at the last sample.
+    uint32_t mLastLatencyMax;                           ///< Value of the maximum shared queue latency counter at the last sample.
 };
 
 
@@ -166,24 +286,47 @@ inline Scheduler<QueueType>::Scheduler(
     MailboxContext *const sharedMailboxContext,
     const uint32_t nodeMask,
     const uint32_t processorMask,
+    const ProcessorSet &processorSet,
     const float threadPriority,
-    const YieldStrategy yieldStrategy) :
+    const uint32_t *const placementOrder,
+    const uint32_t placementCount,
+    const uint32_t placementOffset,
+    const YieldStrategy yieldStrategy,
+    const uint32_t messagesPerVisit,
+    const uint32_t continuationDepth,
+    const bool autoScaling) :
   mMailboxes(mailboxes),
   mFallbackHandlers(fallbackHandlers),
   mMessageAllocator(messageAllocator),
   mSharedMailboxContext(sharedMailboxContext),
   mNodeMask(nodeMask),
   mProcessorMask(processorMask),
+  mProcessorSet(processorSet),
   mThreadPriority(threadPriority),
+  mMessagesPerVisit(messagesPerVisit ? messagesPerVisit : 1),
+  mContinuationDepth(continuationDepth),
+  mAutoScaling(autoScaling),
+  mPlacementOrder(placementOrder),
+  mPlacementCount(placementCount),
+  mPlacementOffset(placementOffset),
   mSharedQueueContext(),
   mQueue(yieldStrategy),
   mManagerThread(),
   mRunning(false),
   mTargetThreadCount(0),
+  mMinThreadCount(0),
+  mMaxThreadCount(0),
   mPeakThreadCount(0),
   mThreadCount(0),
   mThreadContexts(),
-  mThreadContextLock()
+  mThreadContextLock(),
+  mManagerCondition(),
+  mManagerWoken(false),
+  mTimers(),
+  mBusySamples(0),
+  mQuietSamples(0),
+  mLastYieldCount(0),
+  mLastLatencyMax(0)
 {
 }
 
@@ -205,12 +348,17 @@ inline void Scheduler<QueueType>::Initialize(const uint32_t threadCount)
     mSharedMailboxContext->mFallbackHandlers = mFallbackHandlers;
     mSharedMailboxContext->mScheduler = this;
     mSharedMailboxContext->mQueueContext = &mSharedQueueContext;
+    mSharedMailboxContext->mMessagesPerVisit = mMessagesPerVisit;
 
     mQueue.InitializeSharedContext(&mSharedQueueContext);
 
     // Set the initial thread count and affinity masks.
+    // When scaling automatically the pool may shrink to a single thread when idle, and grows
+    // no larger than its initial size unless the upper limit is raised with SetMaxThreads.
     mThreadCount.Store(0);
     mTargetThreadCount.Store(threadCount);
+    mMinThreadCount.Store(mAutoScaling ? 1 : threadCount);
+    mMaxThreadCount.Store(threadCount);
 
     // Start the manager thread.
     mRunning = true;
@@ -228,18 +376,21 @@ inline void Scheduler<QueueType>::Initialize(const uint32_t threadCount)
 template <class QueueType>
 inline void Scheduler<QueueType>::Release()
 {
-    // Wait for the work queue to drain, to avoid memory leaks.
-    uint32_t backoff(0);
-    while (!QueuesEmpty())
-    {
-        Utils::Backoff(backoff);
-    }
+    // The timers should have been stopped, and the framework should have waited for all the
+    // messages in flight to be processed, before the scheduler is released. Closing the
+    // timers again here is harmless.
+    mTimers.Close();
 
     // Reset the target thread count so the manager thread will kill all the threads.
+    // The limits are reset too, so that automatic scaling doesn't raise it again.
+    // The manager thread is woken so it doesn't wait out the rest of its sleep first.
+    mMinThreadCount.Store(0);
+    mMaxThreadCount.Store(0);
     mTargetThreadCount.Store(0);
+    WakeManagerThread();
 
     // Wait for all the running threads to be stopped.
-    backoff = 0;
+    uint32_t backoff(0);
     while (mThreadCount.Load() > 0)
     {
         // Pulse any threads that are waiting so they can terminate.
@@ -249,6 +400,7 @@ inline void Scheduler<QueueType>::Release()
 
     // Kill the manager thread and wait for it to terminate.
     mRunning = false;
+    WakeManagerThread();
     mManagerThread.Join();
 
     mQueue.ReleaseSharedContext(&mSharedQueueContext);
@@ -309,9 +461,120 @@ inline void Scheduler<QueueType>::Schedule(MailboxContext *const mailboxContext,
 }
 
 
+template <class QueueType>
+inline void Scheduler<QueueType>::ScheduleBatch(MailboxContext *const mailboxContext, Mailbox *const *const mailboxes, const uint32_t count)
+{
+    QueueContext *const queueContext(reinterpret_cast<QueueContext *>(mailboxContext->mQueueContext));
+    Mailbox *const sendingMailbox(mailboxContext->mMailbox);
+
+    THERON_ASSERT(count);
+
+    // The hints describe the last send of the batch, which is the only one of its mailboxes
+    // that the queuing policy may keep for the calling thread. The rest are shared.
+    SchedulerHints hints;
+    hints.mSend = true;
+    hints.mPredictedSendCount = mailboxContext->mPredictedSendCount;
+    hints.mSendIndex = mailboxContext->mSendCount + count - 1;
+
+    hints.mMessageCount = 0;
+    if (sendingMailbox)
+    {
+        hints.mMessageCount = sendingMailbox->Count();
+    }
+
+    mQueue.PushBatch(queueContext, mailboxes, count, hints);
+    mailboxContext->mSendCount += count;
+}
+
+
+template <class QueueType>
+inline void Scheduler<QueueType>::EndVisit(MailboxContext *const mailboxContext, const uint32_t messageCount)
+{
+    QueueContext *const queueContext(reinterpret_cast<QueueContext *>(mailboxContext->mQueueContext));
+    mQueue.EndVisit(queueContext, messageCount);
+}
+
+
+template <class QueueType>
+inline uint32_t Scheduler<QueueType>::StartTimer(Timer *const timer)
+{
+    bool wasEmpty(false);
+    const uint32_t handle(mTimers.Start(timer, wasEmpty));
+
+    // The manager thread only wakes every tick while timers are pending.
+    if (handle && wasEmpty)
+    {
+        WakeManagerThread();
+    }
+
+    return handle;
+}
+
+
+template <class QueueType>
+inline bool Scheduler<QueueType>::CancelTimer(const uint32_t handle)
+{
+    return mTimers.Cancel(handle);
+}
+
+
+template <class QueueType>
+inline void Scheduler<QueueType>::StopTimers()
+{
+    mTimers.Close();
+}
+
+
+template <class QueueType>
+inline uint32_t Scheduler<QueueType>::GetMessagesSent() const
+{
+    uint32_t count(0);
+
+    // The lock only protects the list of contexts, since the worker threads don't take it to
+    // update their counts. The acquire loads order the reads with later reads by the caller.
+    mThreadContextLock.Lock();
+
+    typename ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        count += contexts.Get()->mUserContext.mMailboxContext.mMessagesSent.LoadAcquire();
+    }
+
+    mThreadContextLock.Unlock();
+
+    return count;
+}
+
+
+template <class QueueType>
+inline uint32_t Scheduler<QueueType>::GetMessagesRetired() const
+{
+    uint32_t count(0);
+
+    mThreadContextLock.Lock();
+
+    typename ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        count += contexts.Get()->mUserContext.mMailboxContext.mMessagesRetired.LoadAcquire();
+    }
+
+    mThreadContextLock.Unlock();
+
+    return count;
+}
+
+
 template <class QueueType>
 inline void Scheduler<QueueType>::SetMaxThreads(const uint32_t count)
 {
+    // The later of conflicting limits wins.
+    mMaxThreadCount.Store(count);
+    if (mMinThreadCount.Load() > count)
+    {
+        mMinThreadCount.Store(count);
+    }
+
     if (mTargetThreadCount.Load() > count)
     {
         mTargetThreadCount.Store(count);
@@ -322,6 +585,13 @@ inline void Scheduler<QueueType>::SetMaxThreads(const uint32_t count)
 template <class QueueType>
 inline void Scheduler<QueueType>::SetMinThreads(const uint32_t count)
 {
+    // The later of conflicting limits wins.
+    mMinThreadCount.Store(count);
+    if (mMaxThreadCount.Load() < count)
+    {
+        mMaxThreadCount.Store(count);
+    }
+
     if (mTargetThreadCount.Load() < count)
     {
         mTargetThreadCount.Store(count);
@@ -332,6 +602,12 @@ inline void Scheduler<QueueType>::SetMinThreads(const uint32_t count)
 template <class QueueType>
 inline uint32_t Scheduler<QueueType>::GetMaxThreads() const
 {
+    // Without automatic scaling the limits only serve to move the target thread count.
+    if (mAutoScaling)
+    {
+        return mMaxThreadCount.Load();
+    }
+
     return mTargetThreadCount.Load();
 }
 
@@ -339,6 +615,11 @@ inline uint32_t Scheduler<QueueType>::GetMaxThreads() const
 template <class QueueType>
 inline uint32_t Scheduler<QueueType>::GetMinThreads() const
 {
+    if (mAutoScaling)
+    {
+        return mMinThreadCount.Load();
+    }
+
     return mTargetThreadCount.Load();
 }
 
@@ -357,37 +638,6 @@ inline uint32_t Scheduler<QueueType>::GetPeakThreads() const
 }
 
 
-template <class QueueType>
-inline bool Scheduler<QueueType>::QueuesEmpty() const
-{
-    // Check the shared queue context.
-    if (!mQueue.Empty(&mSharedQueueContext))
-    {
-        return false;
-    }
-
-    bool empty(true);
-
-    mThreadContextLock.Lock();
-    
-    // Check the worker thread queue contexts.
-    typename ContextList::Iterator contexts(mThreadContexts.GetIterator());
-    while (contexts.Next())
-    {
-        ThreadContext *const threadContext(contexts.Get());
-        if (!mQueue.Empty(&threadContext->mQueueContext))
-        {
-            empty = false;
-            break;
-        }
-    }
-
-    mThreadContextLock.Unlock();
-
-    return empty;
-}
-
-
 template <class QueueType>
 inline void Scheduler<QueueType>::ResetCounters()
 {
@@ -470,6 +720,378 @@ inline uint32_t Scheduler<QueueType>::GetPerThreadCounterValues(
 }
 
 
+template <class QueueType>
+inline uint32_t Scheduler<QueueType>::GetPerNodeCounterValues(
+    const uint32_t counter,
+    uint32_t *const perNodeCounts,
+    const uint32_t maxCounts) const
+{
+    // Tracks which nodes have had values accumulated, so minimum counters aren't lowered to zero.
+    bool accumulated[32];
+    uint32_t nodeCount(0);
+
+    for (uint32_t node = 0; node < 32; ++node)
+    {
+        accumulated[node] = false;
+    }
+
+    mThreadContextLock.Lock();
+
+    // Accumulate the values of the running worker threads into the entries for their nodes.
+    // Threads not bound to a single node are counted against the lowest node they may run on.
+    typename ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadContext *const threadContext(contexts.Get());
+        if (ThreadPool::IsRunning(threadContext))
+        {
+            const uint32_t node(GetLowestNode(threadContext->mNodeMask));
+            if (node < maxCounts)
+            {
+                if (accumulated[node])
+                {
+                    mQueue.AccumulateCounterValue(&threadContext->mQueueContext, counter, perNodeCounts[node]);
+                }
+                else
+                {
+                    perNodeCounts[node] = mQueue.GetCounterValue(&threadContext->mQueueContext, counter);
+                    accumulated[node] = true;
+                }
+
+                if (node >= nodeCount)
+                {
+                    nodeCount = node + 1;
+                }
+            }
+        }
+    }
+
+    mThreadContextLock.Unlock();
+
+    // Nodes without running worker threads read as zero.
+    for (uint32_t node = 0; node < nodeCount; ++node)
+    {
+        if (!accumulated[node])
+        {
+            perNodeCounts[node] = 0;
+        }
+    }
+
+    return nodeCount;
+}
+
+
+template <class QueueType>
+inline void Scheduler<QueueType>::UpdateTargetThreadCount()
+{
+    const uint32_t minThreadCount(mMinThreadCount.Load());
+    const uint32_t maxThreadCount(mMaxThreadCount.Load());
+    uint32_t targetThreadCount(mTargetThreadCount.Load());
+
+    // The queue tracks how many mailboxes are waiting and how many threads are waiting for them.
+    const uint32_t queueDepth(mQueue.GetQueueDepth());
+    const uint32_t idleThreads(mQueue.GetIdleThreadCount());
+
+    // The yield and latency counters sharpen the picture, where counters are enabled.
+    // The counters may have been reset since the last sample, in which case we start afresh.
+    const uint32_t yieldCount(GetCounterValue(COUNTER_YIELDS));
+    const uint32_t latencyMax(GetCounterValue(COUNTER_QUEUE_LATENCY_SHARED_MAX));
+
+    const uint32_t yields(yieldCount >= mLastYieldCount ? yieldCount - mLastYieldCount : yieldCount);
+    const bool latencyRising(latencyMax > mLastLatencyMax && latencyMax >= SCALING_LATENCY_THRESHOLD);
+
+    mLastYieldCount = yieldCount;
+    mLastLatencyMax = latencyMax;
+
+    // The threads are busy if more mailboxes are waiting than there are idle threads to take them,
+    // or if no threads are idle and mailboxes are newly waiting longer than we'd like.
+    // They are quiet if nothing is waiting and some threads are idle, or have been yielding
+    // more than once each since the last sample.
+    const bool busy(queueDepth > idleThreads || (idleThreads == 0 && latencyRising));
+    const bool quiet(queueDepth == 0 && (idleThreads > 0 || yields > targetThreadCount));
+
+    if (busy)
+    {
+        mQuietSamples = 0;
+        if (++mBusySamples >= SCALE_UP_SAMPLES)
+        {
+            // Grow by the backlog, but by no more than doubling the pool at a time.
+            uint32_t step(queueDepth > idleThreads ? queueDepth - idleThreads : 1);
+            if (step > targetThreadCount)
+            {
+                step = targetThreadCount ? targetThreadCount : 1;
+            }
+
+            targetThreadCount += step;
+            mBusySamples = 0;
+        }
+    }
+    else if (quiet)
+    {
+        mBusySamples = 0;
+        if (++mQuietSamples >= SCALE_DOWN_SAMPLES)
+        {
+            // Shrink by half the idle threads, leaving some slack for the next burst.
+            const uint32_t step(idleThreads > 1 ? idleThreads / 2 : 1);
+            targetThreadCount = (targetThreadCount > step ? targetThreadCount - step : 0);
+            mQuietSamples = 0;
+        }
+    }
+    else
+    {
+        mBusySamples = 0;
+        mQuietSamples = 0;
+    }
+
+    // Apply the limits last, since they may have been changed by other threads since the last sample.
+    if (targetThreadCount > maxThreadCount)
+    {
+        targetThreadCount = maxThreadCount;
+    }
+
+    if (targetThreadCount < minThreadCount)
+    {
+        targetThreadCount = minThreadCount;
+    }
+
+    mTargetThreadCount.Store(targetThreadCount);
+}
+
+
+template <class QueueType>
+inline bool Scheduler<QueueType>::StartWorkerThread(ThreadContext *const threadContext, const uint32_t processor)
+{
+    // Let the queue bind the thread to a node, if it's partitioned by node.
+    bool bound(false);
+    const uint32_t nodeMask(mQueue.AssignNode(&threadContext->mQueueContext, mNodeMask, bound));
+
+    // Threads the queue bound to a node allocate message memory local to the node, where possible.
+    // Otherwise they allocate via their per-thread cache of the framework's message allocator,
+    // even if the node mask happens to hold a single node.
+    IAllocator *messageAllocator(&threadContext->mUserContext.mMessageCache);
+    if (bound)
+    {
+        if (NodeAllocator *const nodeAllocator = NodeAllocator::GetAllocator(GetLowestNode(nodeMask)))
+        {
+            messageAllocator = nodeAllocator;
+        }
+    }
+
+    threadContext->mUserContext.mMailboxContext.mMessageAllocator = messageAllocator;
+
+    // Let the queue pin the thread to particular processors, if it pins threads.
+    const uint32_t processorMask(mQueue.AssignProcessors(&threadContext->mQueueContext, mProcessorMask));
+
+    // A processor set overrides the masks. Threads the queue bound to a node are
+    // restricted to the processors of the set within that node, where there are any.
+    ProcessorSet processorSet(mProcessorSet);
+    if (!processorSet.Empty())
+    {
+        if (bound)
+        {
+            ProcessorSet nodeProcessors;
+            ProcessorSet nodeSet;
+
+            for (uint32_t node = 0; node < 32; ++node)
+            {
+                if ((nodeMask & (1UL << node)) && Utils::GetNodeProcessors(node, nodeProcessors))
+                {
+                    nodeProcessors.Intersect(mProcessorSet);
+                    nodeSet.Add(nodeProcessors);
+                }
+            }
+
+            if (!nodeSet.Empty())
+            {
+                processorSet = nodeSet;
+            }
+        }
+
+        mQueue.AssignProcessors(&threadContext->mQueueContext, processorSet);
+    }
+
+    // Pinned threads stay within the placement chosen by the queue. If the queue bound the thread
+    // to a node, or restricted it to particular processors, it's pinned to the next processor of
+    // the placement order within them, falling back to the queue's placement if there are none.
+    uint32_t pinnedProcessor(processor);
+    if (processor != ThreadPool::ANY_PROCESSOR)
+    {
+        ProcessorSet queueProcessors;
+        bool restricted(false);
+
+        if (!processorSet.Empty())
+        {
+            // The set was intersected with the processors of the thread's node, if bound.
+            queueProcessors = processorSet;
+            restricted = (bound || processorSet.Count() != mProcessorSet.Count());
+        }
+        else
+        {
+            if (bound)
+            {
+                ProcessorSet nodeProcessors;
+                for (uint32_t node = 0; node < 32; ++node)
+                {
+                    if ((nodeMask & (1UL << node)) && Utils::GetNodeProcessors(node, nodeProcessors))
+                    {
+                        queueProcessors.Add(nodeProcessors);
+                        restricted = true;
+                    }
+                }
+            }
+
+            if (processorMask != mProcessorMask)
+            {
+                ProcessorSet maskProcessors;
+                for (uint32_t maskProcessor = 0; maskProcessor < 32; ++maskProcessor)
+                {
+                    if (processorMask & (1UL << maskProcessor))
+                    {
+                        maskProcessors.Add(maskProcessor);
+                    }
+                }
+
+                if (restricted)
+                {
+                    queueProcessors.Intersect(maskProcessors);
+                }
+                else
+                {
+                    queueProcessors = maskProcessors;
+                    restricted = true;
+                }
+            }
+        }
+
+        if (restricted)
+        {
+            pinnedProcessor = GetPinnedProcessor(processor, queueProcessors);
+        }
+    }
+
+    return ThreadPool::StartThread(
+        threadContext,
+        nodeMask,
+        processorMask,
+        processorSet,
+        pinnedProcessor,
+        mThreadPriority);
+}
+
+
+template <class QueueType>
+THERON_FORCEINLINE uint32_t Scheduler<QueueType>::GetPinnedProcessor(const uint32_t threadIndex) const
+{
+    // With more threads than processors the order is reused from the start.
+    if (mPlacementCount == 0)
+    {
+        return ThreadPool::ANY_PROCESSOR;
+    }
+
+    return mPlacementOrder[(mPlacementOffset + threadIndex) % mPlacementCount];
+}
+
+
+template <class QueueType>
+inline uint32_t Scheduler<QueueType>::GetPinnedProcessor(const uint32_t processor, const ProcessorSet &processors) const
+{
+    if (processors.Contains(processor))
+    {
+        return processor;
+    }
+
+    // Search the order from the position of the given processor, so threads spread over the processors.
+    uint32_t start(0);
+    while (start < mPlacementCount && mPlacementOrder[start] != processor)
+    {
+        ++start;
+    }
+
+    for (uint32_t offset = 1; offset <= mPlacementCount; ++offset)
+    {
+        const uint32_t candidate(mPlacementOrder[(start + offset) % mPlacementCount]);
+        if (processors.Contains(candidate))
+        {
+            return candidate;
+        }
+    }
+
+    return ThreadPool::ANY_PROCESSOR;
+}
+
+
+template <class QueueType>
+THERON_FORCEINLINE uint32_t Scheduler<QueueType>::GetLowestNode(const uint32_t nodeMask)
+{
+    uint32_t node(0);
+    while (node < 31 && (nodeMask & (1UL << node)) == 0)
+    {
+        ++node;
+    }
+
+    return node;
+}
+
+
+template <class QueueType>
+inline void Scheduler<QueueType>::ServiceTimers(const uint32_t interval)
+{
+    const uint64_t frequency(Clock::GetFrequency());
+    const uint64_t end(Clock::GetTicks() + interval * frequency / 1000);
+
+    while (mRunning)
+    {
+        const uint64_t now(Clock::GetTicks());
+        if (now >= end)
+        {
+            break;
+        }
+
+        // Sleep out the rest of the interval, or just until the next tick if timers are pending.
+        uint32_t remaining(static_cast<uint32_t>((end - now) * 1000 / frequency));
+        if (remaining == 0)
+        {
+            remaining = 1;
+        }
+
+        if (!mTimers.Empty() && remaining > TimerWheel::TICK_MILLISECONDS)
+        {
+            remaining = TimerWheel::TICK_MILLISECONDS;
+        }
+
+        bool woken(false);
+
+        {
+            Lock lock(mManagerCondition.GetMutex());
+            if (!mManagerWoken)
+            {
+                mManagerCondition.Wait(lock, remaining);
+            }
+
+            woken = mManagerWoken;
+            mManagerWoken = false;
+        }
+
+        mTimers.Service();
+
+        // When woken early, return so the caller can respond straight away.
+        if (woken)
+        {
+            break;
+        }
+    }
+}
+
+
+template <class QueueType>
+inline void Scheduler<QueueType>::WakeManagerThread()
+{
+    Lock lock(mManagerCondition.GetMutex());
+    mManagerWoken = true;
+    mManagerCondition.Pulse();
+}
+
+
 template <class QueueType>
 inline void Scheduler<QueueType>::ManagerThreadEntryPoint(void *const context)
 {
@@ -486,6 +1108,13 @@ inline void Scheduler<QueueType>::ManagerThreadProc()
 
     while (mRunning)
     {
+        // Move the target thread count with the load, if enabled. The counters are read
+        // under the thread context lock so this must be done before we take it.
+        if (mAutoScaling && mThreadCount.Load() != 0)
+        {
+            UpdateTargetThreadCount();
+        }
+
         mThreadContextLock.Lock();
 
         // Re-start stopped worker threads while the thread count is too low.
@@ -495,11 +1124,8 @@ inline void Scheduler<QueueType>::ManagerThreadProc()
             ThreadContext *const threadContext(contexts.Get());
             if (!ThreadPool::IsRunning(threadContext))
             {
-                if (!ThreadPool::StartThread(
-                    threadContext,
-                    mNodeMask,
-                    mProcessorMask,
-                    mThreadPriority))
+                // Restarted threads go back to the processors they were pinned to before.
+                if (!StartWorkerThread(threadContext, threadContext->mProcessor))
                 {
                     break;
                 }
@@ -521,10 +1147,12 @@ inline void Scheduler<QueueType>::ManagerThreadProc()
             // The mailbox context holds pointers to the scheduler and queue context.
             // These are used to push mailboxes that still need further processing.
             threadContext->mUserContext.mMessageCache.SetAllocator(mMessageAllocator);
-            threadContext->mUserContext.mMailboxContext.mMessageAllocator = &threadContext->mUserContext.mMessageCache;
             threadContext->mUserContext.mMailboxContext.mFallbackHandlers = mFallbackHandlers;
             threadContext->mUserContext.mMailboxContext.mScheduler = this;
             threadContext->mUserContext.mMailboxContext.mQueueContext = &threadContext->mQueueContext;
+            threadContext->mUserContext.mMailboxContext.mMessagesPerVisit = mMessagesPerVisit;
+            threadContext->mUserContext.mMailboxContext.mContinuationDepth = mContinuationDepth;
+            threadContext->mUserContext.mMailboxContext.mIdleMonitor = mSharedMailboxContext->mIdleMonitor;
 
             // Create a worker thread with the created context.
             if (!ThreadPool::CreateThread(threadContext))
@@ -533,11 +1161,8 @@ inline void Scheduler<QueueType>::ManagerThreadProc()
             }
 
             // Start the thread on the given node and processors.
-            if (!ThreadPool::StartThread(
-                threadContext,
-                mNodeMask,
-                mProcessorMask,
-                mThreadPriority))
+            // Each new thread is pinned to the next processor in the placement order, if pinned.
+            if (!StartWorkerThread(threadContext, GetPinnedProcessor(mThreadContexts.Size())))
             {
                 THERON_FAIL_MSG("Failed to start worker thread");
             }
@@ -574,7 +1199,8 @@ inline void Scheduler<QueueType>::ManagerThreadProc()
         mThreadContextLock.Unlock();
 
         // The manager thread spends most of its time asleep.
-        Utils::SleepThread(100);
+        // When scaling automatically it wakes more often, so it can respond to bursts of work.
+        ServiceTimers(mAutoScaling ? SCALING_INTERVAL : 100);
     }
 
     // Free all the allocated thread context objects.
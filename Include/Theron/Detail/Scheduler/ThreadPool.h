@@ -9,6 +9,7 @@
 #include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
 
 #include <Theron/Detail/Containers/List.h>
 #include <Theron/Detail/Threading/Thread.h>
@@ -32,6 +33,11 @@ public:
     typedef typename QueueType::ItemType ItemType;
     typedef typename QueueType::ContextType QueueContext;
 
+    /**
+    Value of the processor passed to StartThread for threads not pinned to a single processor.
+    */
+    static const uint32_t ANY_PROCESSOR = 0xFFFFFFFF;
+
     /**
     User-allocated per-thread context structure.
     The client must allocate one of these for each thread it creates.
@@ -47,6 +53,8 @@ public:
         inline explicit ThreadContext(QueueType *const queue) :
           mNodeMask(0),
           mProcessorMask(0),
+          mProcessorSet(),
+          mProcessor(ANY_PROCESSOR),
           mThreadPriority(0.0f),
           mStarted(false),
           mThread(0),
@@ -59,6 +67,8 @@ public:
         // Internal
         uint32_t mNodeMask;                     ///< Bit-field NUMA node affinity mask for the created thread.
         uint32_t mProcessorMask;                ///< Bit-field processor affinity mask within specified nodes.
+        ProcessorSet mProcessorSet;             ///< Set of processors on which the thread executes, overriding the masks if not empty.
+        uint32_t mProcessor;                    ///< Logical processor to which the thread is pinned, if any.
         float mThreadPriority;                  ///< Relative scheduling priority of the thread.
         bool mStarted;                          ///< Indicates whether the thread has started.
         Thread *mThread;                        ///< Pointer to the thread object.
@@ -86,12 +96,16 @@ public:
     \param workQueue Pointer to the shared work queue that the thread will service.
     \param nodeMask Bit-mask specifying on which NUMA processor nodes the thread may execute.
     \param processorMask Bit-mask specifying a subset of the processors in each indicated NUMA processor node.
+    \param processorSet Set of logical processors on which the thread may execute, overriding the masks if not empty.
+    \param processor Logical processor to which the thread is pinned, overriding the masks, or ANY_PROCESSOR.
     \param threadPriority Relative scheduling priority of the thread.
     */
     inline static bool StartThread(
         ThreadContext *const threadContext,
         const uint32_t nodeMask,
         const uint32_t processorMask,
+        const ProcessorSet &processorSet,
+        const uint32_t processor,
         const float threadPriority);
 
     /**
@@ -160,6 +174,8 @@ inline bool ThreadPool<QueueType, ContextType, ProcessorType>::StartThread(
     ThreadContext *const threadContext,
     const uint32_t nodeMask,
     const uint32_t processorMask,
+    const ProcessorSet &processorSet,
+    const uint32_t processor,
     const float threadPriority)
 {
     THERON_ASSERT(threadContext->mThread);
@@ -167,6 +183,8 @@ inline bool ThreadPool<QueueType, ContextType, ProcessorType>::StartThread(
 
     threadContext->mNodeMask = nodeMask;
     threadContext->mProcessorMask = processorMask;
+    threadContext->mProcessorSet = processorSet;
+    threadContext->mProcessor = processor;
     threadContext->mThreadPriority = threadPriority;
 
     // Register the worker's queue context with the queue.
@@ -248,7 +266,20 @@ inline void ThreadPool<QueueType, ContextType, ProcessorType>::ThreadEntryPoint(
     ContextType *const userContext(&threadContext->mUserContext);
 
     // Set the thread's scheduling priority, NUMA node affinity and processor affinity.
-    Utils::SetThreadAffinity(threadContext->mNodeMask, threadContext->mProcessorMask);
+    // Threads pinned to a single processor ignore the affinity masks, as do threads given a processor set.
+    if (threadContext->mProcessor != ANY_PROCESSOR)
+    {
+        Utils::SetThreadProcessor(threadContext->mProcessor);
+    }
+    else if (!threadContext->mProcessorSet.Empty())
+    {
+        Utils::SetThreadProcessors(threadContext->mProcessorSet);
+    }
+    else
+    {
+        Utils::SetThreadAffinity(threadContext->mNodeMask, threadContext->mProcessorMask);
+    }
+
     Utils::SetThreadRelativePriority(threadContext->mThreadPriority);
 
     // Mark the thread as started so the caller knows they can start issuing work.
@@ -0,0 +1,676 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_TIMERWHEEL_H
+#define THERON_DETAIL_SCHEDULER_TIMERWHEEL_H
+
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/Clock.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Doubly-linked list node from which timers derive.
+The slots of the timer wheel are circular lists with a node of this type as the sentinel.
+*/
+class TimerLink
+{
+public:
+
+    TimerLink *mPrev;                   ///< Previous node in the circular list.
+    TimerLink *mNext;                   ///< Next node in the circular list.
+};
+
+
+/**
+Base class of the timers held in a timer wheel.
+Derived classes hold the message value and know how to deliver it when the timer expires.
+*/
+class Timer : public TimerLink
+{
+public:
+
+    friend class TimerWheel;
+
+    /**
+    Constructor.
+    \param size The size in bytes of the memory block holding the derived timer object.
+    \param delay Delay in milliseconds until the first expiry.
+    \param period Period in milliseconds between subsequent expiries, or zero for a one-shot timer.
+    */
+    inline Timer(const uint32_t size, const uint32_t delay, const uint32_t period) :
+      mSize(size),
+      mDelay(delay),
+      mPeriod(period),
+      mHandle(0),
+      mExpiry(0),
+      mFiring(false),
+      mCancelled(false)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~Timer()
+    {
+    }
+
+    /**
+    Delivers the message sent by the timer.
+    Called by the servicing thread, without the wheel locked, each time the timer expires.
+    */
+    virtual void Fire() = 0;
+
+private:
+
+    Timer(const Timer &other);
+    Timer &operator=(const Timer &other);
+
+    uint32_t mSize;                     ///< Size of the memory block holding the derived timer object.
+    uint32_t mDelay;                    ///< Delay in milliseconds until the first expiry.
+    uint32_t mPeriod;                   ///< Period in milliseconds between expiries, or zero for a one-shot timer.
+    uint32_t mHandle;                   ///< Handle identifying the timer to the user.
+    uint64_t mExpiry;                   ///< Tick at which the timer next expires.
+    bool mFiring;                       ///< Whether the timer is out of the wheel being delivered.
+    bool mCancelled;                    ///< Whether a periodic timer was cancelled while being delivered.
+};
+
+
+/**
+Hierarchical timing wheel holding the pending timers of a scheduler.
+
+The wheel has a small number of levels of slots, each level covering a range of expiry times
+256 times coarser than the level below it. Timers are placed in the slot of the lowest level
+whose range covers their remaining delay, and are cascaded down a level each time the level
+below wraps around, so inserting and cancelling a timer are constant-time operations and
+each timer is touched at most once per level before it expires.
+
+Timers are identified to the user by handles which combine the index of an entry in a paged
+table with a generation count, so stale handles of expired timers can't cancel their successors.
+The wheel is thread-safe, and is serviced periodically by a single thread calling \ref Service.
+*/
+class TimerWheel
+{
+public:
+
+    /**
+    Duration of a single tick of the wheel, in milliseconds.
+    */
+    static const uint32_t TICK_MILLISECONDS = 1;
+
+    /**
+    Default constructor.
+    */
+    inline TimerWheel();
+
+    /**
+    Destructor.
+    */
+    inline ~TimerWheel();
+
+    /**
+    Adds a timer to the wheel, taking ownership of it.
+    The timer must have been allocated with the allocator returned by AllocatorManager::GetCache.
+    \param timer The timer to start.
+    \param wasEmpty Set to true if the wheel held no pending timers before this one.
+    \return A non-zero handle identifying the timer, or zero if it couldn't be started.
+    */
+    inline uint32_t Start(Timer *const timer, bool &wasEmpty);
+
+    /**
+    Cancels a pending timer.
+    \return True if the timer was cancelled, false if the handle is stale or the message is already being delivered.
+    */
+    inline bool Cancel(const uint32_t handle);
+
+    /**
+    Returns true if the wheel holds no pending timers.
+    */
+    inline bool Empty() const;
+
+    /**
+    Advances the wheel to the current time and delivers the messages of any expired timers.
+    \return The number of timers that expired.
+    */
+    inline uint32_t Service();
+
+    /**
+    Destroys all pending timers and refuses new ones, waiting for any being delivered.
+    */
+    inline void Close();
+
+private:
+
+    static const uint32_t LEVELS = 4;                           ///< Number of levels of slots.
+    static const uint32_t SLOT_BITS = 8;                        ///< Log2 of the number of slots per level.
+    static const uint32_t SLOTS = 1 << SLOT_BITS;               ///< Number of slots per level.
+    static const uint32_t SLOT_MASK = SLOTS - 1;                ///< Mask selecting a slot index.
+    static const uint32_t MAX_DELAY = 0xFFFFFFFF;               ///< Longest delay in ticks covered by the levels.
+
+    static const uint32_t INDEX_BITS = 20;                      ///< Number of handle bits holding the table index.
+    static const uint32_t INDEX_MASK = (1 << INDEX_BITS) - 1;   ///< Mask selecting the table index of a handle.
+    static const uint32_t GENERATION_MASK = 0xFFF;              ///< Mask selecting the generation count of a handle.
+    static const uint32_t ENTRIES_PER_PAGE = 1024;              ///< Number of entries in each page of the table.
+    static const uint32_t MAX_PAGES = (1 << INDEX_BITS) / ENTRIES_PER_PAGE;
+    static const uint32_t NO_ENTRY = 0xFFFFFFFF;                ///< Terminates the free list of table entries.
+
+    /**
+    Entry in the table mapping handles to timers.
+    */
+    struct Entry
+    {
+        Timer *mTimer;                                          ///< Timer using the entry, if any.
+        uint32_t mGeneration;                                   ///< Generation count, advanced each time the entry is freed.
+        uint32_t mNextFree;                                     ///< Index of the next free entry, when the entry is free.
+    };
+
+    struct Page
+    {
+        Entry mEntries[ENTRIES_PER_PAGE];                       ///< Array of entries making up this page.
+    };
+
+    TimerWheel(const TimerWheel &other);
+    TimerWheel &operator=(const TimerWheel &other);
+
+    inline uint64_t GetCurrentTick() const;
+    inline void Place(Timer *const timer);
+    inline void Cascade(const uint32_t level, const uint32_t slot);
+    inline void Advance(const uint64_t tick, TimerLink *const expired);
+    inline Entry *GetEntry(const uint32_t handle);
+    inline uint32_t AllocateHandle(Timer *const timer);
+    inline void FreeHandle(const uint32_t handle);
+    inline static void Destroy(Timer *const timer);
+    inline static void InitializeList(TimerLink *const list);
+    inline static void Link(TimerLink *const list, TimerLink *const node);
+    inline static void Unlink(TimerLink *const node);
+
+    mutable SpinLock mLock;                                     ///< Protects all the state of the wheel.
+    TimerLink mSlots[LEVELS][SLOTS];                            ///< Circular lists of timers expiring within each slot.
+    uint64_t mStartTicks;                                       ///< Clock ticks at construction, the origin of the wheel ticks.
+    uint64_t mClockTicksPerTick;                                ///< Clock ticks per wheel tick.
+    uint64_t mCurrentTick;                                      ///< The last tick processed by the wheel.
+    uint32_t mCount;                                            ///< Number of timers pending in the slots.
+    uint32_t mFiringCount;                                      ///< Number of expired timers being delivered.
+    bool mClosed;                                               ///< Whether the wheel has been closed.
+    uint32_t mEntryCount;                                       ///< Number of table entries ever used.
+    uint32_t mFreeEntry;                                        ///< Index of the first free table entry.
+    Page *mPages[MAX_PAGES];                                    ///< Pointers to allocated pages of the table.
+};
+
+
+inline TimerWheel::TimerWheel() :
+  mLock(),
+  mStartTicks(Clock::GetTicks()),
+  mClockTicksPerTick(Clock::GetFrequency() * TICK_MILLISECONDS / 1000),
+  mCurrentTick(0),
+  mCount(0),
+  mFiringCount(0),
+  mClosed(false),
+  mEntryCount(0),
+  mFreeEntry(NO_ENTRY)
+{
+    if (mClockTicksPerTick == 0)
+    {
+        mClockTicksPerTick = 1;
+    }
+
+    for (uint32_t level = 0; level < LEVELS; ++level)
+    {
+        for (uint32_t slot = 0; slot < SLOTS; ++slot)
+        {
+            InitializeList(&mSlots[level][slot]);
+        }
+    }
+
+    for (uint32_t page = 0; page < MAX_PAGES; ++page)
+    {
+        mPages[page] = 0;
+    }
+}
+
+
+inline TimerWheel::~TimerWheel()
+{
+    Close();
+
+    IAllocator *const allocator(AllocatorManager::GetCache());
+    for (uint32_t page = 0; page < MAX_PAGES; ++page)
+    {
+        if (mPages[page])
+        {
+            allocator->Free(mPages[page], sizeof(Page));
+        }
+    }
+}
+
+
+inline uint32_t TimerWheel::Start(Timer *const timer, bool &wasEmpty)
+{
+    const uint64_t now(GetCurrentTick());
+    uint32_t handle(0);
+
+    mLock.Lock();
+
+    wasEmpty = (mCount == 0);
+
+    if (!mClosed)
+    {
+        handle = AllocateHandle(timer);
+    }
+
+    if (handle)
+    {
+        // An empty wheel may not have been advanced for a while, but can safely jump forward.
+        if (mCount == 0 && now > mCurrentTick)
+        {
+            mCurrentTick = now;
+        }
+
+        // The delay is measured from now, but the wheel may lag slightly behind the clock.
+        // Timers always expire at the earliest on the next tick.
+        const uint32_t delay(timer->mDelay >= TICK_MILLISECONDS ? timer->mDelay / TICK_MILLISECONDS : 1);
+        timer->mHandle = handle;
+        timer->mExpiry = (now > mCurrentTick ? now : mCurrentTick) + delay;
+
+        Place(timer);
+        ++mCount;
+    }
+
+    mLock.Unlock();
+
+    if (handle == 0)
+    {
+        Destroy(timer);
+    }
+
+    return handle;
+}
+
+
+inline bool TimerWheel::Cancel(const uint32_t handle)
+{
+    bool cancelled(false);
+    Timer *timer(0);
+
+    mLock.Lock();
+
+    if (Entry *const entry = GetEntry(handle))
+    {
+        timer = entry->mTimer;
+        if (timer->mFiring)
+        {
+            // The message is already being delivered, but a periodic timer can still be stopped.
+            // The servicing thread destroys the timer when it has finished delivering it.
+            if (timer->mPeriod && !timer->mCancelled)
+            {
+                timer->mCancelled = true;
+                cancelled = true;
+            }
+
+            timer = 0;
+        }
+        else
+        {
+            Unlink(timer);
+            FreeHandle(handle);
+            --mCount;
+            cancelled = true;
+        }
+    }
+
+    mLock.Unlock();
+
+    if (timer)
+    {
+        Destroy(timer);
+    }
+
+    return cancelled;
+}
+
+
+inline bool TimerWheel::Empty() const
+{
+    mLock.Lock();
+    const bool empty(mCount == 0);
+    mLock.Unlock();
+
+    return empty;
+}
+
+
+inline uint32_t TimerWheel::Service()
+{
+    const uint64_t now(GetCurrentTick());
+    uint32_t count(0);
+
+    TimerLink expired;
+    InitializeList(&expired);
+
+    mLock.Lock();
+    Advance(now, &expired);
+    mLock.Unlock();
+
+    // Deliver the expired timers without the wheel locked, so actors can start and cancel timers meanwhile.
+    while (expired.mNext != &expired)
+    {
+        Timer *const timer(static_cast<Timer *>(expired.mNext));
+        Unlink(timer);
+
+        timer->Fire();
+        ++count;
+
+        Timer *destroyed(timer);
+
+        mLock.Lock();
+
+        timer->mFiring = false;
+        --mFiringCount;
+
+        if (timer->mPeriod && !timer->mCancelled && !mClosed)
+        {
+            // Periodic timers are rescheduled relative to their last expiry, so they don't drift.
+            // If the wheel has fallen more than a period behind then the missed expiries are skipped.
+            const uint32_t period(timer->mPeriod >= TICK_MILLISECONDS ? timer->mPeriod / TICK_MILLISECONDS : 1);
+            timer->mExpiry += period;
+            if (timer->mExpiry <= mCurrentTick)
+            {
+                timer->mExpiry = mCurrentTick + 1;
+            }
+
+            Place(timer);
+            ++mCount;
+            destroyed = 0;
+        }
+        else
+        {
+            FreeHandle(timer->mHandle);
+        }
+
+        mLock.Unlock();
+
+        if (destroyed)
+        {
+            Destroy(destroyed);
+        }
+    }
+
+    return count;
+}
+
+
+inline void TimerWheel::Close()
+{
+    mLock.Lock();
+
+    mClosed = true;
+
+    for (uint32_t level = 0; level < LEVELS; ++level)
+    {
+        for (uint32_t slot = 0; slot < SLOTS; ++slot)
+        {
+            TimerLink *const list(&mSlots[level][slot]);
+            while (list->mNext != list)
+            {
+                Timer *const timer(static_cast<Timer *>(list->mNext));
+                Unlink(timer);
+                FreeHandle(timer->mHandle);
+                Destroy(timer);
+            }
+        }
+    }
+
+    mCount = 0;
+
+    // Wait for the servicing thread to finish delivering any expired timers.
+    uint32_t backoff(0);
+    while (mFiringCount)
+    {
+        mLock.Unlock();
+        Utils::Backoff(backoff);
+        mLock.Lock();
+    }
+
+    mLock.Unlock();
+}
+
+
+THERON_FORCEINLINE uint64_t TimerWheel::GetCurrentTick() const
+{
+    return (Clock::GetTicks() - mStartTicks) / mClockTicksPerTick;
+}
+
+
+THERON_FORCEINLINE void TimerWheel::Place(Timer *const timer)
+{
+    THERON_ASSERT(timer->mExpiry >= mCurrentTick);
+
+    // Delays beyond the range of the top level are clamped.
+    uint64_t delta(timer->mExpiry - mCurrentTick);
+    if (delta > MAX_DELAY)
+    {
+        delta = MAX_DELAY;
+        timer->mExpiry = mCurrentTick + delta;
+    }
+
+    // Find the lowest level whose range covers the delay.
+    uint32_t level(0);
+    while (level < LEVELS - 1 && delta >= (static_cast<uint64_t>(1) << ((level + 1) * SLOT_BITS)))
+    {
+        ++level;
+    }
+
+    const uint32_t slot(static_cast<uint32_t>(timer->mExpiry >> (level * SLOT_BITS)) & SLOT_MASK);
+    Link(&mSlots[level][slot], timer);
+}
+
+
+THERON_FORCEINLINE void TimerWheel::Cascade(const uint32_t level, const uint32_t slot)
+{
+    // Move the timers in the slot to lower levels, now that they're due within their ranges.
+    TimerLink list;
+    InitializeList(&list);
+
+    TimerLink *const source(&mSlots[level][slot]);
+    if (source->mNext != source)
+    {
+        list.mNext = source->mNext;
+        list.mPrev = source->mPrev;
+        list.mNext->mPrev = &list;
+        list.mPrev->mNext = &list;
+        InitializeList(source);
+    }
+
+    while (list.mNext != &list)
+    {
+        Timer *const timer(static_cast<Timer *>(list.mNext));
+        Unlink(timer);
+        Place(timer);
+    }
+}
+
+
+inline void TimerWheel::Advance(const uint64_t tick, TimerLink *const expired)
+{
+    while (mCurrentTick < tick)
+    {
+        // An empty wheel jumps straight to the current tick.
+        if (mCount == 0)
+        {
+            mCurrentTick = tick;
+            break;
+        }
+
+        const uint64_t current(++mCurrentTick);
+
+        // Each time a level wraps around, cascade the next slot of the level above.
+        for (uint32_t level = 1; level < LEVELS; ++level)
+        {
+            const uint64_t mask((static_cast<uint64_t>(1) << (level * SLOT_BITS)) - 1);
+            if (current & mask)
+            {
+                break;
+            }
+
+            Cascade(level, static_cast<uint32_t>(current >> (level * SLOT_BITS)) & SLOT_MASK);
+        }
+
+        // Collect the timers expiring on this tick.
+        TimerLink *const list(&mSlots[0][static_cast<uint32_t>(current) & SLOT_MASK]);
+        while (list->mNext != list)
+        {
+            Timer *const timer(static_cast<Timer *>(list->mNext));
+            Unlink(timer);
+            Link(expired, timer);
+
+            timer->mFiring = true;
+            ++mFiringCount;
+            --mCount;
+        }
+    }
+}
+
+
+THERON_FORCEINLINE TimerWheel::Entry *TimerWheel::GetEntry(const uint32_t handle)
+{
+    const uint32_t index(handle & INDEX_MASK);
+    const uint32_t generation(handle >> INDEX_BITS);
+
+    if (index < mEntryCount)
+    {
+        Entry *const entry(&mPages[index / ENTRIES_PER_PAGE]->mEntries[index % ENTRIES_PER_PAGE]);
+        if (entry->mTimer && entry->mGeneration == generation)
+        {
+            return entry;
+        }
+    }
+
+    return 0;
+}
+
+
+inline uint32_t TimerWheel::AllocateHandle(Timer *const timer)
+{
+    uint32_t index(mFreeEntry);
+    Entry *entry(0);
+
+    if (index != NO_ENTRY)
+    {
+        entry = &mPages[index / ENTRIES_PER_PAGE]->mEntries[index % ENTRIES_PER_PAGE];
+        mFreeEntry = entry->mNextFree;
+    }
+    else
+    {
+        // Extend the table, allocating a new page if necessary.
+        index = mEntryCount;
+        const uint32_t page(index / ENTRIES_PER_PAGE);
+        if (page >= MAX_PAGES)
+        {
+            return 0;
+        }
+
+        if (mPages[page] == 0)
+        {
+            void *const memory(AllocatorManager::GetCache()->Allocate(sizeof(Page)));
+            if (memory == 0)
+            {
+                return 0;
+            }
+
+            mPages[page] = reinterpret_cast<Page *>(memory);
+            for (uint32_t offset = 0; offset < ENTRIES_PER_PAGE; ++offset)
+            {
+                mPages[page]->mEntries[offset].mTimer = 0;
+                mPages[page]->mEntries[offset].mGeneration = 1;
+                mPages[page]->mEntries[offset].mNextFree = NO_ENTRY;
+            }
+        }
+
+        entry = &mPages[page]->mEntries[index % ENTRIES_PER_PAGE];
+        ++mEntryCount;
+    }
+
+    entry->mTimer = timer;
+    return (entry->mGeneration << INDEX_BITS) | index;
+}
+
+
+THERON_FORCEINLINE void TimerWheel::FreeHandle(const uint32_t handle)
+{
+    const uint32_t index(handle & INDEX_MASK);
+    Entry *const entry(&mPages[index / ENTRIES_PER_PAGE]->mEntries[index % ENTRIES_PER_PAGE]);
+
+    // Generation zero is skipped so that valid handles are never zero.
+    entry->mTimer = 0;
+    entry->mGeneration = (entry->mGeneration + 1) & GENERATION_MASK;
+    if (entry->mGeneration == 0)
+    {
+        entry->mGeneration = 1;
+    }
+
+    entry->mNextFree = mFreeEntry;
+    mFreeEntry = index;
+}
+
+
+THERON_FORCEINLINE void TimerWheel::Destroy(Timer *const timer)
+{
+    const uint32_t size(timer->mSize);
+    timer->~Timer();
+    AllocatorManager::GetCache()->Free(timer, size);
+}
+
+
+THERON_FORCEINLINE void TimerWheel::InitializeList(TimerLink *const list)
+{
+    list->mPrev = list;
+    list->mNext = list;
+}
+
+
+THERON_FORCEINLINE void TimerWheel::Link(TimerLink *const list, TimerLink *const node)
+{
+    node->mPrev = list->mPrev;
+    node->mNext = list;
+    list->mPrev->mNext = node;
+    list->mPrev = node;
+}
+
+
+THERON_FORCEINLINE void TimerWheel::Unlink(TimerLink *const node)
+{
+    node->mPrev->mNext = node->mNext;
+    node->mNext->mPrev = node->mPrev;
+    node->mPrev = node;
+    node->mNext = node;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_TIMERWHEEL_H
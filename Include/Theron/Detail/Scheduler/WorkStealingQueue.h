@@ -0,0 +1,720 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_SCHEDULER_WORKSTEALINGQUEUE_H
+#define THERON_DETAIL_SCHEDULER_WORKSTEALINGQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
+#include <Theron/YieldStrategy.h>
+
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/QueueCounters.h>
+#include <Theron/Detail/Scheduler/QueueWaker.h>
+#include <Theron/Detail/Scheduler/SchedulerHints.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Mailbox queue implementation with per-thread work queues and work stealing.
+
+Each worker thread context owns a double-ended work queue. Mailboxes scheduled by a worker
+thread are pushed to its own queue, and popped by the same thread in last-in-first-out order,
+so that recently messaged actors are processed while their data is still hot in the caches.
+Every \ref FIFO_POP_INTERVAL local pops the oldest mailbox is taken instead, so that a handler
+that keeps messaging fresh actors can't starve older local work.
+Worker threads that run out of work steal mailboxes, in first-in-first-out order, from the
+other ends of the queues of other worker threads. The shared queue is only used for mailboxes
+scheduled from outside the worker threads, via the shared context.
+*/
+template <class MonitorType>
+class WorkStealingQueue
+{
+public:
+
+    /**
+    The item type which is queued by the queue.
+    */
+    typedef Mailbox ItemType;
+
+    /**
+    Context structure used to access the queue.
+    */
+    class ContextType
+    {
+    public:
+
+        friend class WorkStealingQueue;
+
+        inline ContextType() :
+          mRunning(false),
+          mShared(false),
+          mRegistered(false),
+          mVictim(0),
+          mLocalPops(0),
+          mLock(),
+          mCount(0),
+          mWorkQueue()
+        {
+        }
+
+    private:
+
+        bool mRunning;                                      ///< Used to signal the thread to terminate.
+        bool mShared;                                       ///< Indicates whether this is the 'shared' context.
+        bool mRegistered;                                   ///< Indicates whether the context is visible to stealing threads.
+        uint32_t mVictim;                                   ///< Index of the context from which this thread last stole work.
+        uint32_t mLocalPops;                                ///< Number of mailboxes popped from the local work queue.
+        SpinLock mLock;                                     ///< Protects the local work queue from stealing threads.
+        Atomic::UInt32 mCount;                              ///< Number of mailboxes in the local work queue.
+        Queue<Mailbox> mWorkQueue;                          ///< Local thread-specific double-ended work queue.
+        typename MonitorType::Context mMonitorContext;      ///< Per-thread monitor primitive context.
+        QueueCounters mCounters;                            ///< Per-context event counters.
+    };
+
+    /**
+    Constructor.
+    */
+    inline explicit WorkStealingQueue(const YieldStrategy yieldStrategy);
+
+    /**
+    Initializes a user-allocated context as the 'shared' context common to all threads.
+    */
+    inline void InitializeSharedContext(ContextType *const context);
+
+    /**
+    Initializes a user-allocated context as the context associated with the calling thread.
+    */
+    inline void InitializeWorkerContext(ContextType *const context);
+
+    /**
+    Releases a previously initialized shared context.
+    */
+    inline void ReleaseSharedContext(ContextType *const context);
+
+    /**
+    Releases a previously initialized worker thread context.
+    */
+    inline void ReleaseWorkerContext(ContextType *const context);
+
+    /**
+    Binds a worker thread context to a NUMA node. This queue isn't partitioned by node.
+    \param bound Set to false, since threads aren't bound to particular nodes.
+    \return The node mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignNode(ContextType *const context, const uint32_t nodeMask, bool &bound);
+
+    /**
+    Restricts a worker thread context to a subset of the processors in the given processor mask.
+    This queue doesn't pin threads to processors.
+    \return The processor mask with which the worker thread should be started.
+    */
+    inline uint32_t AssignProcessors(ContextType *const context, const uint32_t processorMask);
+
+    /**
+    Restricts a worker thread context to a subset of the processors in the given processor set.
+    This queue doesn't pin threads to processors, so leaves the set unchanged.
+    */
+    inline void AssignProcessors(ContextType *const context, ProcessorSet &processorSet);
+
+    /**
+    Resets to zero the given counter for the given thread context.
+    */
+    inline void ResetCounter(ContextType *const context, const uint32_t counter) const;
+
+    /**
+    Gets the value of the given counter for the given thread context.
+    */
+    inline uint32_t GetCounterValue(const ContextType *const context, const uint32_t counter) const;
+
+    /**
+    Accumulates the value of the given counter for the given thread context.
+    */
+    inline void AccumulateCounterValue(
+        const ContextType *const context,
+        const uint32_t counter,
+        uint32_t &accumulator) const;
+
+    /**
+    Returns true if a call to Pop would return no mailbox, for the given context.
+    */
+    inline bool Empty(const ContextType *const context) const;
+
+    /**
+    Returns true if the thread with the given context is still enabled.
+    */
+    inline bool Running(const ContextType *const context) const;
+
+    /**
+    Returns an estimate of the number of mailboxes waiting in the shared and per-thread work queues.
+    */
+    inline uint32_t GetQueueDepth() const;
+
+    /**
+    Returns the number of worker threads currently waiting for work.
+    */
+    inline uint32_t GetIdleThreadCount() const;
+
+    /**
+    Wakes any worker threads which are blocked waiting for the queue to become non-empty.
+    */
+    inline void WakeAll();
+
+    /**
+    Pushes a mailbox into the queue, scheduling it for processing.
+    */
+    inline void Push(ContextType *const context, Mailbox *mailbox, const SchedulerHints &hints);
+
+    /**
+    Pushes a batch of mailboxes into the queue, scheduling them for processing.
+    */
+    inline void PushBatch(ContextType *const context, Mailbox *const *const mailboxes, const uint32_t count, const SchedulerHints &hints);
+
+    /**
+    Pops a previously pushed mailbox from the queue for processing.
+    */
+    inline Mailbox *Pop(ContextType *const context);
+
+    /**
+    Records that a number of messages were processed from a popped mailbox.
+    */
+    inline void EndVisit(ContextType *const context, const uint32_t messageCount);
+
+private:
+
+    /**
+    Maximum number of worker thread contexts that can have their work stolen.
+    Contexts beyond this limit push all their work to the shared queue.
+    */
+    static const uint32_t MAX_CONTEXTS = 256;
+
+    /**
+    Number of local pops after which the oldest local mailbox is popped instead of the newest.
+    */
+    static const uint32_t FIFO_POP_INTERVAL = 16;
+
+    WorkStealingQueue(const WorkStealingQueue &other);
+    WorkStealingQueue &operator=(const WorkStealingQueue &other);
+
+    /**
+    Steals a mailbox from the front of the work queue of some other worker thread.
+    */
+    inline Mailbox *Steal(ContextType *const context);
+
+    /**
+    Returns true if the work queue of any worker thread other than the given one holds mailboxes.
+    */
+    inline bool StealableWork(const ContextType *const context) const;
+
+    mutable MonitorType mMonitor;               ///< Synchronizes access to the shared queue.
+    Queue<Mailbox> mSharedWorkQueue;            ///< Work queue shared by all the threads in a scheduler.
+    Atomic::UInt32 mSharedCount;                ///< Number of mailboxes in the shared queue.
+    Atomic::UInt32 mWaitingThreads;             ///< Number of worker threads waiting on the monitor.
+    Atomic::UInt32 mContextCount;               ///< Number of worker thread contexts registered for stealing.
+    ContextType *mContexts[MAX_CONTEXTS];       ///< Worker thread contexts registered for stealing.
+};
+
+
+template <class MonitorType>
+inline WorkStealingQueue<MonitorType>::WorkStealingQueue(const YieldStrategy yieldStrategy) :
+  mMonitor(yieldStrategy),
+  mSharedWorkQueue(),
+  mSharedCount(0),
+  mWaitingThreads(0),
+  mContextCount(0)
+{
+    for (uint32_t index = 0; index < MAX_CONTEXTS; ++index)
+    {
+        mContexts[index] = 0;
+    }
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::InitializeSharedContext(ContextType *const context)
+{
+    context->mShared = true;
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::InitializeWorkerContext(ContextType *const context)
+{
+    // Only worker threads should call this method.
+    context->mShared = false;
+
+    context->mLock.Lock();
+    context->mRunning = true;
+    context->mLock.Unlock();
+
+    mMonitor.InitializeWorkerContext(&context->mMonitorContext);
+
+    // Contexts are registered only once, since stopped threads are restarted with the same context.
+    // Only the manager thread initializes contexts, so registration doesn't need to be synchronized.
+    // The context pointer is written before the count is raised, so thieves never see a null entry.
+    if (!context->mRegistered)
+    {
+        const uint32_t contextCount(mContextCount.Load());
+        if (contextCount < MAX_CONTEXTS)
+        {
+            mContexts[contextCount] = context;
+            context->mRegistered = true;
+            mContextCount.Increment();
+        }
+    }
+
+    // The minimum counters need to be initialized to maxint.
+    context->mCounters.Initialize();
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::ReleaseSharedContext(ContextType *const /*context*/)
+{
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::ReleaseWorkerContext(ContextType *const context)
+{
+    // The thread may still be executing a handler, so may still push work to its local queue.
+    // Once we've cleared the running flag under the local lock all its pushes go to the shared queue.
+    // Any work left in the local queue is moved to the shared queue so it isn't stranded.
+    context->mLock.Lock();
+
+    {
+        typename MonitorType::LockType lock(mMonitor);
+        context->mRunning = false;
+
+        while (!context->mWorkQueue.Empty())
+        {
+            mSharedWorkQueue.Push(context->mWorkQueue.Pop());
+            mSharedCount.Increment();
+        }
+
+        context->mCount.Store(0);
+    }
+
+    context->mLock.Unlock();
+
+    mMonitor.PulseAll();
+}
+
+
+template <class MonitorType>
+inline uint32_t WorkStealingQueue<MonitorType>::AssignNode(ContextType *const /*context*/, const uint32_t nodeMask, bool &bound)
+{
+    bound = false;
+    return nodeMask;
+}
+
+
+template <class MonitorType>
+inline uint32_t WorkStealingQueue<MonitorType>::AssignProcessors(ContextType *const /*context*/, const uint32_t processorMask)
+{
+    return processorMask;
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::AssignProcessors(ContextType *const /*context*/, ProcessorSet &/*processorSet*/)
+{
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::ResetCounter(ContextType *const context, const uint32_t counter) const
+{
+    context->mCounters.Reset(counter);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t WorkStealingQueue<MonitorType>::GetCounterValue(const ContextType *const context, const uint32_t counter) const
+{
+    return context->mCounters.Get(counter);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void WorkStealingQueue<MonitorType>::AccumulateCounterValue(
+    const ContextType *const context,
+    const uint32_t counter,
+    uint32_t &accumulator) const
+{
+    context->mCounters.Accumulate(counter, accumulator);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool WorkStealingQueue<MonitorType>::Empty(const ContextType *const context) const
+{
+    // Check the context's local queue.
+    // If the provided context is the shared context then it doesn't have a local queue.
+    if (!context->mShared)
+    {
+        ContextType *const mutableContext(const_cast<ContextType *>(context));
+
+        mutableContext->mLock.Lock();
+        const bool localEmpty(context->mWorkQueue.Empty());
+        mutableContext->mLock.Unlock();
+
+        if (!localEmpty)
+        {
+            return false;
+        }
+    }
+
+    // Check the shared work queue.
+    typename MonitorType::LockType lock(mMonitor);
+    return mSharedWorkQueue.Empty();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool WorkStealingQueue<MonitorType>::Running(const ContextType *const context) const
+{
+    return context->mRunning;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t WorkStealingQueue<MonitorType>::GetQueueDepth() const
+{
+    uint32_t depth(mSharedCount.Load());
+
+    // The contexts are only ever added, so reading them without a lock is safe.
+    const uint32_t contextCount(mContextCount.Load());
+    for (uint32_t index = 0; index < contextCount; ++index)
+    {
+        depth += mContexts[index]->mCount.Load();
+    }
+
+    return depth;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE uint32_t WorkStealingQueue<MonitorType>::GetIdleThreadCount() const
+{
+    return mWaitingThreads.Load();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void WorkStealingQueue<MonitorType>::WakeAll()
+{
+    mMonitor.PulseAll();
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void WorkStealingQueue<MonitorType>::Push(
+    ContextType *const context,
+    Mailbox *mailbox,
+    const SchedulerHints &/*hints*/)
+{
+    // Timestamp the mailbox and update the maximum mailbox queue length seen by this thread.
+    context->mCounters.CountPush(mailbox);
+
+    // Worker threads push to their own local queues, where the work can be stolen by idle threads.
+    // Unlike the single-item local queue of the shared strategy, no prediction is needed.
+    if (!context->mShared && context->mRegistered)
+    {
+        context->mLock.Lock();
+
+        if (context->mRunning)
+        {
+            // If the queue already held work then the pushed mailbox is available for stealing.
+            const bool stealable(!context->mWorkQueue.Empty());
+            context->mWorkQueue.Push(mailbox);
+            context->mCount.Increment();
+
+            context->mLock.Unlock();
+
+            context->mCounters.Increment(COUNTER_LOCAL_PUSHES);
+
+            // Wake a waiting thread, if there is one, so it can steal the surplus work.
+            if (stealable)
+            {
+                QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, 1);
+            }
+
+            return;
+        }
+
+        context->mLock.Unlock();
+    }
+
+    // Push the mailbox onto the shared work queue.
+    // Because the shared queue is accessed by multiple threads we have to protect it.
+    {
+        typename MonitorType::LockType lock(mMonitor);
+        mSharedWorkQueue.Push(mailbox);
+        mSharedCount.Increment();
+    }
+
+    // Pulse the condition associated with the shared queue to wake a worker thread.
+    // It's okay to release the lock before calling Pulse.
+    mMonitor.Pulse();
+    context->mCounters.Increment(COUNTER_SHARED_PUSHES);
+}
+
+
+template <class MonitorType>
+inline void WorkStealingQueue<MonitorType>::PushBatch(
+    ContextType *const context,
+    Mailbox *const *const mailboxes,
+    const uint32_t count,
+    const SchedulerHints &/*hints*/)
+{
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        context->mCounters.CountPush(mailboxes[index]);
+    }
+
+    // Worker threads push the whole batch to their own local queues under a single lock.
+    if (!context->mShared && context->mRegistered)
+    {
+        context->mLock.Lock();
+
+        if (context->mRunning)
+        {
+            // All but one of the pushed mailboxes are surplus work available for stealing,
+            // or all of them if the queue already held work.
+            const uint32_t stealable(context->mWorkQueue.Empty() ? count - 1 : count);
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                context->mWorkQueue.Push(mailboxes[index]);
+                context->mCount.Increment();
+            }
+
+            context->mLock.Unlock();
+
+            context->mCounters.Add(COUNTER_LOCAL_PUSHES, count);
+
+            // Wake a waiting thread for each stealable mailbox, if there are any waiting.
+            QueueWaker<MonitorType>::Wake(mMonitor, mWaitingThreads, stealable);
+
+            return;
+        }
+
+        context->mLock.Unlock();
+    }
+
+    {
+        typename MonitorType::LockType lock(mMonitor);
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            mSharedWorkQueue.Push(mailboxes[index]);
+            mSharedCount.Increment();
+        }
+    }
+
+    // Wake a thread for each mailbox if enough are waiting, and always at least one, as for a single push.
+    const uint32_t waitingThreads(mWaitingThreads.Load());
+    const uint32_t wakeCount(count < waitingThreads ? count : (waitingThreads ? waitingThreads : 1));
+    for (uint32_t wake = 0; wake < wakeCount; ++wake)
+    {
+        mMonitor.Pulse();
+    }
+
+    context->mCounters.Add(COUNTER_SHARED_PUSHES, count);
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE Mailbox *WorkStealingQueue<MonitorType>::Pop(ContextType *const context)
+{
+    Mailbox *mailbox(0);
+    bool shared(false);
+
+    // The shared context is never used to call Pop, only to Push
+    // messages sent outside the context of a worker thread.
+    THERON_ASSERT(context->mShared == false);
+
+    // Pop the most recently pushed mailbox off the calling thread's local work queue,
+    // or periodically the oldest, so the LIFO order can't starve older work indefinitely.
+    context->mLock.Lock();
+
+    if (!context->mWorkQueue.Empty())
+    {
+        if (++context->mLocalPops % FIFO_POP_INTERVAL == 0)
+        {
+            mailbox = context->mWorkQueue.Pop();
+        }
+        else
+        {
+            mailbox = context->mWorkQueue.PopBack();
+        }
+
+        context->mCount.Decrement();
+    }
+
+    context->mLock.Unlock();
+
+    if (mailbox == 0)
+    {
+        shared = true;
+
+        // Check the shared queue before stealing, since nobody else will process its items
+        // if all the threads are busy, whereas the work queues of other threads are also
+        // serviced by their owners.
+        {
+            typename MonitorType::LockType lock(mMonitor);
+            if (!mSharedWorkQueue.Empty())
+            {
+                mailbox = mSharedWorkQueue.Pop();
+                mSharedCount.Decrement();
+            }
+        }
+
+        if (mailbox == 0)
+        {
+            mailbox = Steal(context);
+        }
+
+        if (mailbox == 0)
+        {
+            // Wait on the shared queue once, then return so that the caller retries.
+            // We return rather than looping here because we may be woken to steal work,
+            // which is pushed to the queues of other threads rather than the shared queue.
+            typename MonitorType::LockType lock(mMonitor);
+
+            // Register as waiting before the final check of all the queues. A thread pushing
+            // stealable work counts it before checking for waiting threads, so either we see
+            // its work here or it sees us waiting, and its pulse waits for the lock we hold.
+            mWaitingThreads.Increment();
+
+            if (mSharedWorkQueue.Empty() && !StealableWork(context) && context->mRunning == true)
+            {
+                context->mCounters.Increment(COUNTER_YIELDS);
+                mMonitor.Wait(&context->mMonitorContext, lock);
+            }
+
+            mWaitingThreads.Decrement();
+
+            if (!mSharedWorkQueue.Empty())
+            {
+                mailbox = mSharedWorkQueue.Pop();
+                mSharedCount.Decrement();
+            }
+        }
+
+        if (mailbox)
+        {
+            mMonitor.ResetYield(&context->mMonitorContext);
+        }
+    }
+
+    if (mailbox)
+    {
+        context->mCounters.CountPop(mailbox, shared);
+    }
+
+    return mailbox;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE void WorkStealingQueue<MonitorType>::EndVisit(ContextType *const context, const uint32_t messageCount)
+{
+    context->mCounters.CountVisit(messageCount);
+}
+
+
+template <class MonitorType>
+inline Mailbox *WorkStealingQueue<MonitorType>::Steal(ContextType *const context)
+{
+    const uint32_t contextCount(mContextCount.Load());
+    uint32_t index(context->mVictim);
+
+    // Visit the other contexts in turn, starting after the last successful victim.
+    for (uint32_t visited = 0; visited < contextCount; ++visited)
+    {
+        if (++index >= contextCount)
+        {
+            index = 0;
+        }
+
+        ContextType *const victim(mContexts[index]);
+        if (victim == context)
+        {
+            continue;
+        }
+
+        // Peek at the atomic count without the lock first, to avoid needlessly contending idle queues.
+        // The queue itself can only be read under the lock, since its owner changes it concurrently.
+        if (victim->mCount.Load() == 0)
+        {
+            continue;
+        }
+
+        Mailbox *mailbox(0);
+
+        victim->mLock.Lock();
+
+        if (!victim->mWorkQueue.Empty())
+        {
+            mailbox = victim->mWorkQueue.Pop();
+            victim->mCount.Decrement();
+        }
+
+        victim->mLock.Unlock();
+
+        if (mailbox)
+        {
+            context->mVictim = index;
+            context->mCounters.Increment(COUNTER_STEALS);
+            return mailbox;
+        }
+    }
+
+    return 0;
+}
+
+
+template <class MonitorType>
+THERON_FORCEINLINE bool WorkStealingQueue<MonitorType>::StealableWork(const ContextType *const context) const
+{
+    const uint32_t contextCount(mContextCount.Load());
+    for (uint32_t index = 0; index < contextCount; ++index)
+    {
+        const ContextType *const victim(mContexts[index]);
+        if (victim != context && victim->mCount.Load() != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_SCHEDULER_WORKSTEALINGQUEUE_H
@@ -23,7 +23,7 @@
 #elif THERON_CPP11
 
 #if THERON_GCC
-#if __GNUC__ >= 4 && __GNUC_MINOR__ > 4
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ > 4)
 #include <atomic>
 #else
 #include <cstdatomic>
@@ -54,6 +54,15 @@
 #endif //_MSC_VER
 
 
+// With POSIX threads we use the GCC atomic builtins, where available, rather than emulating atomics with spinlocks.
+// The builtins follow the C++11 memory model so their use mirrors the C++11 implementation.
+#if !THERON_WINDOWS && !THERON_BOOST && !THERON_CPP11 && THERON_POSIX && defined(__ATOMIC_SEQ_CST)
+#define THERON_GCC_ATOMICS 1
+#else
+#define THERON_GCC_ATOMICS 0
+#endif
+
+
 namespace Theron
 {
 namespace Detail
@@ -77,6 +86,7 @@ public:
 #if THERON_WINDOWS
 #elif THERON_BOOST
 #elif THERON_CPP11
+#elif THERON_GCC_ATOMICS
 #elif THERON_POSIX
 
         pthread_spin_init(&mSpinLock, 0);
@@ -92,6 +102,7 @@ public:
 #if THERON_WINDOWS
 #elif THERON_BOOST
 #elif THERON_CPP11
+#elif THERON_GCC_ATOMICS
 #elif THERON_POSIX
 
         pthread_spin_init(&mSpinLock, 0);
@@ -107,6 +118,7 @@ public:
 #if THERON_WINDOWS
 #elif THERON_BOOST
 #elif THERON_CPP11
+#elif THERON_GCC_ATOMICS
 #elif THERON_POSIX
 
         pthread_spin_destroy(&mSpinLock);
@@ -143,6 +155,16 @@ public:
             newValue,
             std::memory_order_acquire);
 
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_compare_exchange_n(
+            &mValue,
+            &currentValue,
+            newValue,
+            true,
+            __ATOMIC_ACQUIRE,
+            __ATOMIC_ACQUIRE);
+
 #elif THERON_POSIX
 
         bool success(false);
@@ -192,6 +214,16 @@ public:
             newValue,
             std::memory_order_release);
 
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_compare_exchange_n(
+            &mValue,
+            &currentValue,
+            newValue,
+            true,
+            __ATOMIC_RELEASE,
+            __ATOMIC_RELAXED);
+
 #elif THERON_POSIX
 
         bool success(false);
@@ -214,53 +246,67 @@ public:
 
     /**
     Atomic increment.
+    \return The new value.
     */
-    THERON_FORCEINLINE void Increment()
+    THERON_FORCEINLINE uint32_t Increment()
     {
 #if THERON_WINDOWS
 
-        InterlockedIncrement(reinterpret_cast<volatile LONG *>(&mValue));
+        return static_cast<uint32_t>(InterlockedIncrement(reinterpret_cast<volatile LONG *>(&mValue)));
 
 #elif THERON_BOOST
 
-        ++mValue;
+        return ++mValue;
 
 #elif THERON_CPP11
 
-        ++mValue;
+        return ++mValue;
+
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_add_fetch(&mValue, 1, __ATOMIC_SEQ_CST);
 
 #elif THERON_POSIX
 
         pthread_spin_lock(&mSpinLock);
-        ++mValue;
+        const uint32_t value(++mValue);
         pthread_spin_unlock(&mSpinLock);
 
+        return value;
+
 #endif
     }
 
     /**
     Atomic decrement.
+    \return The new value.
     */
-    THERON_FORCEINLINE void Decrement()
+    THERON_FORCEINLINE uint32_t Decrement()
     {
 #if THERON_WINDOWS
 
-        InterlockedDecrement(reinterpret_cast<volatile LONG *>(&mValue));
+        return static_cast<uint32_t>(InterlockedDecrement(reinterpret_cast<volatile LONG *>(&mValue)));
 
 #elif THERON_BOOST
 
-        --mValue;
+        return --mValue;
 
 #elif THERON_CPP11
 
-        --mValue;
+        return --mValue;
+
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_sub_fetch(&mValue, 1, __ATOMIC_SEQ_CST);
 
 #elif THERON_POSIX
 
         pthread_spin_lock(&mSpinLock);
-        --mValue;
+        const uint32_t value(--mValue);
         pthread_spin_unlock(&mSpinLock);
 
+        return value;
+
 #endif
     }
 
@@ -281,6 +327,10 @@ public:
 
         return mValue.load();
 
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_load_n(&mValue, __ATOMIC_SEQ_CST);
+
 #elif THERON_POSIX
 
         return mValue;
@@ -307,6 +357,75 @@ public:
 
         mValue.store(val);
 
+#elif THERON_GCC_ATOMICS
+
+        __atomic_store_n(&mValue, val, __ATOMIC_SEQ_CST);
+
+#elif THERON_POSIX
+
+        pthread_spin_lock(&mSpinLock);
+        mValue = val;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically get the current value, with 'acquire' memory ordering semantics.
+    */
+    THERON_FORCEINLINE uint32_t LoadAcquire() const
+    {
+#if THERON_WINDOWS
+
+        // Volatile reads have acquire semantics with the Microsoft compiler.
+        return static_cast<uint32_t>(mValue);
+
+#elif THERON_BOOST
+
+        return mValue.load(boost::memory_order_acquire);
+
+#elif THERON_CPP11
+
+        return mValue.load(std::memory_order_acquire);
+
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_load_n(&mValue, __ATOMIC_ACQUIRE);
+
+#elif THERON_POSIX
+
+        pthread_spin_lock(&mSpinLock);
+        const uint32_t value(mValue);
+        pthread_spin_unlock(&mSpinLock);
+
+        return value;
+
+#endif
+    }
+
+    /**
+    Atomically set the current value, with 'release' memory ordering semantics.
+    Unlike \ref Store this isn't a full memory barrier, so is cheaper for values with a single writer.
+    */
+    THERON_FORCEINLINE void StoreRelease(const uint32_t val)
+    {
+#if THERON_WINDOWS
+
+        // Volatile writes have release semantics with the Microsoft compiler.
+        mValue = static_cast<int32_t>(val);
+
+#elif THERON_BOOST
+
+        mValue.store(val, boost::memory_order_release);
+
+#elif THERON_CPP11
+
+        mValue.store(val, std::memory_order_release);
+
+#elif THERON_GCC_ATOMICS
+
+        __atomic_store_n(&mValue, val, __ATOMIC_RELEASE);
+
 #elif THERON_POSIX
 
         pthread_spin_lock(&mSpinLock);
@@ -333,6 +452,10 @@ private:
 
     volatile std::atomic_uint_least32_t mValue;
 
+#elif THERON_GCC_ATOMICS
+
+    volatile uint32_t mValue;
+
 #elif THERON_POSIX
 
     // With POSIX threads we emulate atomics using a spinlock (ie. slow but works).
@@ -344,6 +467,149 @@ private:
 };
 
 
+/**
+Atomic pointer synchronization primitive.
+*/
+template <class ValueType>
+class Pointer
+{
+public:
+
+    /**
+    Explicit constructor that initializes the value.
+    */
+    inline explicit Pointer(ValueType *const initialValue = 0) : mValue(initialValue)
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif THERON_GCC_ATOMICS
+#elif THERON_POSIX
+
+        pthread_spin_init(&mSpinLock, 0);
+
+#endif
+    }
+
+    /**
+    Destructor.
+    */
+    inline ~Pointer()
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif THERON_GCC_ATOMICS
+#elif THERON_POSIX
+
+        pthread_spin_destroy(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically exchanges the current value with a new value, with full barrier semantics.
+    \return The previous value.
+    */
+    THERON_FORCEINLINE ValueType *Exchange(ValueType *const value)
+    {
+#if THERON_WINDOWS
+
+        return static_cast<ValueType *>(InterlockedExchangePointer(
+            reinterpret_cast<PVOID volatile *>(&mValue),
+            value));
+
+#elif THERON_BOOST
+
+        return mValue.exchange(value);
+
+#elif THERON_CPP11
+
+        return mValue.exchange(value);
+
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_exchange_n(&mValue, value, __ATOMIC_SEQ_CST);
+
+#elif THERON_POSIX
+
+        pthread_spin_lock(&mSpinLock);
+        ValueType *const previousValue(mValue);
+        mValue = value;
+        pthread_spin_unlock(&mSpinLock);
+
+        return previousValue;
+
+#endif
+    }
+
+    /**
+    Atomically get the current value.
+    */
+    THERON_FORCEINLINE ValueType *Load() const
+    {
+#if THERON_WINDOWS
+
+        return mValue;
+
+#elif THERON_BOOST
+
+        return mValue.load();
+
+#elif THERON_CPP11
+
+        return mValue.load();
+
+#elif THERON_GCC_ATOMICS
+
+        return __atomic_load_n(&mValue, __ATOMIC_SEQ_CST);
+
+#elif THERON_POSIX
+
+        return mValue;
+
+#endif
+    }
+
+    /**
+    Atomically set the current value.
+    */
+    THERON_FORCEINLINE void Store(ValueType *const value)
+    {
+        Exchange(value);
+    }
+
+private:
+
+    Pointer(const Pointer &other);
+    Pointer &operator=(const Pointer &other);
+
+#if THERON_WINDOWS
+
+    ValueType *volatile mValue;
+
+#elif THERON_BOOST
+
+    boost::atomic<ValueType *> mValue;
+
+#elif THERON_CPP11
+
+    std::atomic<ValueType *> mValue;
+
+#elif THERON_GCC_ATOMICS
+
+    ValueType *volatile mValue;
+
+#elif THERON_POSIX
+
+    ValueType *volatile mValue;
+    mutable pthread_spinlock_t mSpinLock;
+
+#endif
+
+};
+
+
 } // namespace Atomic
 } // namespace Detail
 } // namespace Theron
@@ -22,14 +22,17 @@
 #elif THERON_POSIX
 
 #include <pthread.h>
+#include <time.h>
 
 #elif THERON_BOOST
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
 
 #elif THERON_CPP11
 
+#include <chrono>
 #include <thread>
 #include <condition_variable>
 
@@ -127,6 +130,47 @@ public:
         THERON_ASSERT(lock.mLock.owns_lock());
         mCondition.wait(lock.mLock);
 
+#endif
+    }
+
+    /**
+    Suspends the calling thread until it is woken by another thread, or until the given time has elapsed.
+    \note The calling thread must hold a lock on the mutex associated with the condition.
+    Spurious wakeups are possible, so callers should check their own state on return.
+    */
+    THERON_FORCEINLINE void Wait(Lock &lock, const uint32_t milliseconds)
+    {
+#if THERON_WINDOWS
+
+        (void) lock;
+        SleepConditionVariableCS(&mCondition, &lock.mMutex.mCriticalSection, milliseconds);
+    
+#elif THERON_POSIX
+
+        // The POSIX timed wait takes an absolute deadline against the realtime clock.
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+
+        deadline.tv_sec += milliseconds / 1000;
+        deadline.tv_nsec += (milliseconds % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        pthread_cond_timedwait(&mCondition, &lock.mMutex.mMutex, &deadline);
+
+#elif THERON_BOOST
+
+        THERON_ASSERT(lock.mLock.owns_lock());
+        mCondition.timed_wait(lock.mLock, boost::posix_time::milliseconds(milliseconds));
+
+#elif THERON_CPP11
+
+        THERON_ASSERT(lock.mLock.owns_lock());
+        mCondition.wait_for(lock.mLock, std::chrono::milliseconds(milliseconds));
+
 #endif
     }
 
@@ -0,0 +1,159 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_THREADING_PARKER_H
+#define THERON_DETAIL_THREADING_PARKER_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+#if THERON_GCC && defined(__linux__)
+#define THERON_FUTEX 1
+#else
+#define THERON_FUTEX 0
+#endif
+
+
+#if THERON_FUTEX
+
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#else
+
+#include <Theron/Detail/Threading/Condition.h>
+#include <Theron/Detail/Threading/Lock.h>
+
+#endif
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Per-thread parking synchronization primitive.
+
+A parker holds at most one wakeup permit. A thread calling Park sleeps until another thread
+calls Unpark, or returns immediately if Unpark was called since the last Park. Each parker
+is owned by a single thread and is only ever parked by that thread, so unlike a condition
+variable, an Unpark wakes exactly the intended thread.
+
+Under Linux the parker is a single futex word, so Unpark only makes a system call if the
+owning thread is actually asleep. Elsewhere it falls back to a private condition variable.
+*/
+class Parker
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline Parker() : mState(STATE_EMPTY)
+    {
+    }
+
+    /**
+    Suspends the calling thread until the parker is unparked, consuming the wakeup permit.
+    \note Only the thread that owns the parker should call Park.
+    */
+    inline void Park()
+    {
+#if THERON_FUTEX
+
+        // Consume a pending permit without sleeping, if there is one.
+        if (__sync_bool_compare_and_swap(&mState, STATE_NOTIFIED, STATE_EMPTY))
+        {
+            return;
+        }
+
+        // Announce that we're about to sleep. If a permit arrived meanwhile then take it.
+        if (__sync_bool_compare_and_swap(&mState, STATE_EMPTY, STATE_PARKED))
+        {
+            // The futex call returns immediately if the state is no longer 'parked'.
+            // Spurious wakeups are possible, so we check the state again each time.
+            while (mState == STATE_PARKED)
+            {
+                syscall(SYS_futex, &mState, FUTEX_WAIT_PRIVATE, STATE_PARKED, 0, 0, 0);
+            }
+        }
+
+        THERON_ASSERT(mState == STATE_NOTIFIED);
+        mState = STATE_EMPTY;
+        __sync_synchronize();
+
+#else
+
+        Lock lock(mCondition.GetMutex());
+        while (mState != STATE_NOTIFIED)
+        {
+            mState = STATE_PARKED;
+            mCondition.Wait(lock);
+        }
+
+        mState = STATE_EMPTY;
+
+#endif
+    }
+
+    /**
+    Wakes the owning thread if it is parked, or otherwise gives it a permit for its next Park.
+    */
+    inline void Unpark()
+    {
+#if THERON_FUTEX
+
+        // Only make the system call if the owning thread is asleep.
+        if (__sync_lock_test_and_set(&mState, STATE_NOTIFIED) == STATE_PARKED)
+        {
+            syscall(SYS_futex, &mState, FUTEX_WAKE_PRIVATE, 1, 0, 0, 0);
+        }
+
+#else
+
+        bool parked(false);
+
+        {
+            Lock lock(mCondition.GetMutex());
+            parked = (mState == STATE_PARKED);
+            mState = STATE_NOTIFIED;
+        }
+
+        if (parked)
+        {
+            mCondition.Pulse();
+        }
+
+#endif
+    }
+
+private:
+
+    enum
+    {
+        STATE_EMPTY = 0,        ///< No permit is available and the owning thread isn't asleep.
+        STATE_NOTIFIED = 1,     ///< A permit is available.
+        STATE_PARKED = 2        ///< The owning thread is asleep, or about to be, waiting for a permit.
+    };
+
+    Parker(const Parker &other);
+    Parker &operator=(const Parker &other);
+
+    volatile int mState;            ///< Current state of the parker, used directly as the futex word.
+
+#if !THERON_FUTEX
+    Condition mCondition;           ///< Condition variable on which the owning thread sleeps.
+#endif
+
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_THREADING_PARKER_H
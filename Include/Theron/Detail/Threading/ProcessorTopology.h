@@ -0,0 +1,106 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_THREADING_PROCESSORTOPOLOGY_H
+#define THERON_DETAIL_THREADING_PROCESSORTOPOLOGY_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Static helper that reads the processor topology reported by the system.
+*/
+class ProcessorTopology
+{
+public:
+
+    /**
+    Maximum number of logical processors considered.
+    */
+    static const uint32_t MAX_PROCESSORS = ProcessorSet::MAX_PROCESSORS;
+
+    /**
+    Builds the order in which worker threads are pinned to logical processors.
+
+    The first logical processor of every physical core is placed before any second hardware
+    thread of a core. Within each of those ranks the cores sharing a last-level cache are placed
+    together, with the caches in the order of their lowest processors. Processors that are
+    offline, reserved, or outside the affinity of the process are left out, as are processors
+    outside the given processor set, if it isn't empty.
+
+    \param processors Array to which the indices of the logical processors are written, in order.
+    \param maxCount Size of the array.
+    \param reserved Set of logical processors that must not be used.
+    \param processorSet Set of logical processors that may be used, or an empty set to allow all.
+    \return The number of processors written, or zero if the topology isn't available.
+    */
+    static uint32_t GetPlacementOrder(
+        uint32_t *const processors,
+        const uint32_t maxCount,
+        const ProcessorSet &reserved,
+        const ProcessorSet &processorSet);
+
+private:
+
+    /**
+    Placement properties of a single logical processor.
+    */
+    struct Processor
+    {
+        uint32_t mIndex;            ///< Index of the logical processor.
+        uint32_t mPackage;          ///< Physical package containing the processor.
+        uint32_t mCore;             ///< Physical core within the package.
+        uint32_t mCache;            ///< Lowest processor sharing the last-level cache.
+        uint32_t mRank;             ///< Index of the processor among the hardware threads of its core.
+        uint32_t mGroup;            ///< Index of the last-level cache in order of first appearance.
+    };
+
+    ProcessorTopology(const ProcessorTopology &other);
+    ProcessorTopology &operator=(const ProcessorTopology &other);
+
+    /**
+    Reads a single unsigned integer from a file.
+    */
+    static bool ReadValue(const char *const path, uint32_t &value);
+
+    /**
+    Reads a list of processors in the kernel's list format (eg. "0-3,8,10-11") from a file.
+    \param processors Array of flags set for the processors in the list.
+    */
+    static bool ReadList(const char *const path, bool *const processors, const uint32_t maxCount);
+
+    /**
+    Returns true if one processor should be placed before another.
+    */
+    inline static bool Precedes(const Processor &first, const Processor &second);
+};
+
+
+THERON_FORCEINLINE bool ProcessorTopology::Precedes(const Processor &first, const Processor &second)
+{
+    if (first.mRank != second.mRank)
+    {
+        return first.mRank < second.mRank;
+    }
+
+    if (first.mGroup != second.mGroup)
+    {
+        return first.mGroup < second.mGroup;
+    }
+
+    return first.mIndex < second.mIndex;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_THREADING_PROCESSORTOPOLOGY_H
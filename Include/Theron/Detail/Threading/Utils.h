@@ -6,6 +6,7 @@
 #include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
 
 
 #ifdef _MSC_VER
@@ -32,6 +33,14 @@
 
 #endif
 
+#if THERON_GCC && defined(__linux__)
+
+// Pinning threads to processors uses the GNU affinity extensions of pthreads.
+#include <pthread.h>
+#include <sched.h>
+
+#endif
+
 #if THERON_NUMA
 #if THERON_WINDOWS
 
@@ -108,6 +117,12 @@ public:
     */
     inline static bool GetNodeCount(uint32_t &nodeCount);
 
+    /**
+    Gets the index of the NUMA processor node on which the calling thread is currently executing.
+    \return True, if NUMA support is detected and the returned node index is valid.
+    */
+    inline static bool GetCurrentNode(uint32_t &node);
+
     /**
     Hints to the OS to run the current thread on the given processors of the given processor nodes of a NUMA system.
 
@@ -117,9 +132,32 @@ public:
     execution opportunities, doing so can have positive effects on overall system
     performance by avoiding contention for the system bus caused by shared writes to the
     same memory from different nodes.
+
+    A processor mask with all bits set selects all the processors of each enabled node, even
+    those beyond the first 32.
     */
     inline static bool SetThreadAffinity(const uint32_t nodeMask, const uint32_t processorMask);
 
+    /**
+    Restricts the current thread to run only on the given set of logical processors.
+    Unlike \ref SetThreadAffinity this can describe processors beyond the first 32 of each node.
+    \return True, if affinity is supported and was set.
+    */
+    inline static bool SetThreadProcessors(const ProcessorSet &processors);
+
+    /**
+    Gets the set of logical processors in a given NUMA node.
+    \return True, if NUMA support is detected and the returned set is valid.
+    */
+    inline static bool GetNodeProcessors(const uint32_t node, ProcessorSet &processors);
+
+    /**
+    Pins the current thread to a single logical processor, identified by its index in the system.
+    Unlike \ref SetThreadAffinity this doesn't depend on NUMA support.
+    \return True, if pinning is supported and the thread was pinned.
+    */
+    inline static bool SetThreadProcessor(const uint32_t processor);
+
     /**
     Hints to the OS the relative priority of the current thread, relative to other threads.
 
@@ -312,6 +350,44 @@ inline bool Utils::GetNodeCount(uint32_t &nodeCount)
 }
 
 
+inline bool Utils::GetCurrentNode(uint32_t &node)
+{
+
+#if THERON_NUMA
+
+#if THERON_WINDOWS && _WIN32_WINNT >= 0x0600
+
+    UCHAR num;
+    if (GetNumaProcessorNode(static_cast<UCHAR>(GetCurrentProcessorNumber()), &num) && num != 0xFF)
+    {
+        node = static_cast<uint32_t>(num);
+        return true;
+    }
+
+#elif THERON_GCC && defined(LIBNUMA_API_VERSION) && (LIBNUMA_API_VERSION > 1)
+
+    if (numa_available() >= 0)
+    {
+        const int cpu(sched_getcpu());
+        if (cpu >= 0)
+        {
+            const int num(numa_node_of_cpu(cpu));
+            if (num >= 0)
+            {
+                node = static_cast<uint32_t>(num);
+                return true;
+            }
+        }
+    }
+
+#endif
+
+#endif // THERON_NUMA
+
+    return false;
+}
+
+
 inline bool Utils::SetThreadAffinity(const uint32_t nodeMask, const uint32_t processorMask)
 {
     // We check this mainly so the arguments are always used.
@@ -348,7 +424,12 @@ inline bool Utils::SetThreadAffinity(const uint32_t nodeMask, const uint32_t pro
             KAFFINITY testMask(groupAffinity.Mask);
             KAFFINITY shiftedMask(static_cast<KAFFINITY>(processorMask));
 
-            while ((testMask & 1) == 0)
+            if (processorMask == 0xFFFFFFFF)
+            {
+                shiftedMask = groupAffinity.Mask;
+            }
+
+            while (testMask && (testMask & 1) == 0)
             {
                 testMask >>= 1;
                 shiftedMask <<= 1;
@@ -384,7 +465,12 @@ inline bool Utils::SetThreadAffinity(const uint32_t nodeMask, const uint32_t pro
             ULONGLONG testMask(nodeAffinity);
             ULONGLONG shiftedMask(static_cast<ULONGLONG>(processorMask));
 
-            while ((testMask & 1) == 0)
+            if (processorMask == 0xFFFFFFFF)
+            {
+                shiftedMask = nodeAffinity;
+            }
+
+            while (testMask && (testMask & 1) == 0)
             {
                 testMask >>= 1;
                 shiftedMask <<= 1;
@@ -426,14 +512,18 @@ inline bool Utils::SetThreadAffinity(const uint32_t nodeMask, const uint32_t pro
         ret = numa_node_to_cpus(node, nodeAffinity);
         if (ret != 0) goto numa_cleanup_and_done;
 
-        // Shift the processor mask to match the node processor mask.
-        // This assumes the processors of a node are contiguous.
+        // Apply the processor mask to the processors of the node, in order. A full mask
+        // also selects the processors beyond the first 32 of the node.
         uint32_t procMaskIndex(0);
         for (uint32_t cpu = 0; cpu < maxCPUs; cpu++)
         {
-            if (numa_bitmask_isbitset(nodeAffinity, cpu) && (processorMask & (1UL << procMaskIndex++)) != 0)
+            if (numa_bitmask_isbitset(nodeAffinity, cpu))
             {
-                numa_bitmask_setbit(accumulatedMask, cpu);
+                const uint32_t index(procMaskIndex++);
+                if (processorMask == 0xFFFFFFFF || (index < 32 && (processorMask & (1UL << index)) != 0))
+                {
+                    numa_bitmask_setbit(accumulatedMask, cpu);
+                }
             }
         }
     }
@@ -477,6 +567,183 @@ numa_cleanup_and_done:
 }
 
 
+inline bool Utils::SetThreadProcessor(const uint32_t processor)
+{
+#if THERON_WINDOWS
+
+    if (processor < sizeof(DWORD_PTR) * 8)
+    {
+        const DWORD_PTR mask(static_cast<DWORD_PTR>(1) << processor);
+        if (SetThreadAffinityMask(GetCurrentThread(), mask))
+        {
+            return true;
+        }
+    }
+
+#elif THERON_GCC && defined(__linux__)
+
+    if (processor < CPU_SETSIZE)
+    {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(processor, &mask);
+
+        if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0)
+        {
+            return true;
+        }
+    }
+
+#else
+
+    (void) processor;
+
+#endif
+
+    return false;
+}
+
+
+inline bool Utils::SetThreadProcessors(const ProcessorSet &processors)
+{
+    if (processors.Empty())
+    {
+        return false;
+    }
+
+#if THERON_NUMA && THERON_GCC && defined(LIBNUMA_API_VERSION) && (LIBNUMA_API_VERSION > 1)
+
+    if (numa_available() >= 0)
+    {
+        const uint32_t maxCPUs(static_cast<uint32_t>(numa_num_possible_cpus()));
+
+        struct bitmask *const mask(numa_allocate_cpumask());
+        numa_bitmask_clearall(mask);
+
+        for (uint32_t cpu = 0; cpu < maxCPUs && cpu < ProcessorSet::MAX_PROCESSORS; ++cpu)
+        {
+            if (processors.Contains(cpu))
+            {
+                numa_bitmask_setbit(mask, cpu);
+            }
+        }
+
+        const int ret(numa_sched_setaffinity(0, mask));
+        numa_free_cpumask(mask);
+
+        return ret == 0;
+    }
+
+#endif
+
+#if THERON_WINDOWS
+
+    // Without processor groups, only the processors of the group of the thread can be described.
+    DWORD_PTR mask(0);
+    for (uint32_t processor = 0; processor < sizeof(DWORD_PTR) * 8; ++processor)
+    {
+        if (processors.Contains(processor))
+        {
+            mask |= (static_cast<DWORD_PTR>(1) << processor);
+        }
+    }
+
+    if (mask && SetThreadAffinityMask(GetCurrentThread(), mask))
+    {
+        return true;
+    }
+
+#elif THERON_GCC && defined(__linux__)
+
+    // Allocate the set dynamically, so it isn't limited by the size of the static cpu_set_t.
+    cpu_set_t *const mask(CPU_ALLOC(ProcessorSet::MAX_PROCESSORS));
+    if (mask == 0)
+    {
+        return false;
+    }
+
+    const size_t size(CPU_ALLOC_SIZE(ProcessorSet::MAX_PROCESSORS));
+    CPU_ZERO_S(size, mask);
+
+    for (uint32_t processor = 0; processor < ProcessorSet::MAX_PROCESSORS; ++processor)
+    {
+        if (processors.Contains(processor))
+        {
+            CPU_SET_S(processor, size, mask);
+        }
+    }
+
+    const bool set(pthread_setaffinity_np(pthread_self(), size, mask) == 0);
+    CPU_FREE(mask);
+
+    return set;
+
+#endif
+
+    return false;
+}
+
+
+inline bool Utils::GetNodeProcessors(const uint32_t node, ProcessorSet &processors)
+{
+    processors.Clear();
+
+#if THERON_NUMA
+
+#if THERON_WINDOWS && _WIN32_WINNT >= 0x0601
+
+    GROUP_AFFINITY groupAffinity;
+    if (GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &groupAffinity))
+    {
+        const uint32_t groupBase(static_cast<uint32_t>(groupAffinity.Group) * static_cast<uint32_t>(sizeof(KAFFINITY) * 8));
+        for (uint32_t processor = 0; processor < sizeof(KAFFINITY) * 8; ++processor)
+        {
+            if (groupAffinity.Mask & (static_cast<KAFFINITY>(1) << processor))
+            {
+                processors.Add(groupBase + processor);
+            }
+        }
+
+        return true;
+    }
+
+#elif THERON_GCC && defined(LIBNUMA_API_VERSION) && (LIBNUMA_API_VERSION > 1)
+
+    if (numa_available() >= 0)
+    {
+        const uint32_t maxCPUs(static_cast<uint32_t>(numa_num_possible_cpus()));
+
+        struct bitmask *const mask(numa_allocate_cpumask());
+        const bool read(numa_node_to_cpus(static_cast<int>(node), mask) == 0);
+
+        for (uint32_t cpu = 0; read && cpu < maxCPUs && cpu < ProcessorSet::MAX_PROCESSORS; ++cpu)
+        {
+            if (numa_bitmask_isbitset(mask, cpu))
+            {
+                processors.Add(cpu);
+            }
+        }
+
+        numa_free_cpumask(mask);
+        return read;
+    }
+
+#else
+
+    (void) node;
+
+#endif
+
+#else
+
+    (void) node;
+
+#endif // THERON_NUMA
+
+    return false;
+}
+
+
 // Implementation based on code from numanuma by guruofquality.
 inline bool Utils::SetThreadRelativePriority(const float priority)
 {
@@ -12,12 +12,18 @@ Framework that hosts and executes actors.
 #include <new>
 
 #include <Theron/Address.h>
+#include <Theron/AddressGroup.h>
 #include <Theron/Align.h>
 #include <Theron/AllocatorManager.h>
 #include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 #include <Theron/IAllocator.h>
+#include <Theron/OverflowPolicy.h>
+#include <Theron/ProcessorSet.h>
+#include <Theron/SchedulerStrategy.h>
+#include <Theron/SharedValue.h>
+#include <Theron/ThreadPlacement.h>
 #include <Theron/YieldStrategy.h>
 
 #include <Theron/Detail/Allocators/CachingAllocator.h>
@@ -29,13 +35,19 @@ Framework that hosts and executes actors.
 #include <Theron/Detail/Mailboxes/Mailbox.h>
 #include <Theron/Detail/Messages/MessageCreator.h>
 #include <Theron/Detail/Scheduler/Counting.h>
+#include <Theron/Detail/Scheduler/IdleMonitor.h>
 #include <Theron/Detail/Scheduler/MailboxContext.h>
 #include <Theron/Detail/Scheduler/IScheduler.h>
+#include <Theron/Detail/Scheduler/TimerWheel.h>
 #include <Theron/Detail/Strings/String.h>
 #include <Theron/Detail/Strings/StringPool.h>
 #include <Theron/Detail/Threading/Atomic.h>
 #include <Theron/Detail/Threading/SpinLock.h>
 
+#if THERON_CPP11
+#include <utility>
+#endif // THERON_CPP11
+
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -50,6 +62,7 @@ namespace Theron
 
 class Actor;
 class EndPoint;
+class WorkerPool;
 
 
 /**
@@ -83,7 +96,23 @@ framework by means of an explicit parameter to the Framework::Framework construc
 Additionally, the number of threads can be increased or decreased at runtime
 by calling \ref SetMinThreads or \ref SetMaxThreads. The utilization of the currently
 enabled threads is measured by performance metrics which can be queried with
-\ref GetCounterValue.
+\ref GetCounterValue. Alternatively, frameworks constructed with
+\ref Theron::Framework::Parameters::mAutoScaling "mAutoScaling" enabled grow and shrink
+their pools of worker threads automatically with the load, within the limits set by
+\ref SetMinThreads and \ref SetMaxThreads.
+
+Frameworks constructed with a non-zero
+\ref Theron::Framework::Parameters::mBlockingThreadCount "mBlockingThreadCount" also contain
+a second, separate pool of blocking threads, which process the actors marked as blocking with
+\ref Actor::SetBlocking. The blocking pool scales automatically with the load, within its own
+limits set by \ref SetMinBlockingThreads and \ref SetMaxBlockingThreads.
+
+Frameworks can also be divided into named \em scheduler \em groups, declared with
+\ref Theron::Framework::Parameters::AddSchedulerGroup "AddSchedulerGroup". Each group has its
+own work queue and its own fixed set of worker threads, optionally restricted to a set of
+processors, and processes only the actors assigned to it on construction. Messages sent
+between actors in different groups of the same framework are delivered as directly as those
+sent within a group, unlike messages sent between frameworks.
 
 The worker threads are created and synchronized using underlying threading
 objects. Different implementations of these threading objects are possible,
@@ -114,6 +143,37 @@ public:
     friend class Actor;
     friend class EndPoint;
 
+    /**
+    Maximum number of scheduler groups that can be declared in a framework, besides the default group.
+    */
+    static const uint32_t MAX_SCHEDULER_GROUPS = 8;
+
+    /**
+    \brief Parameters of a scheduler group, declared with \ref Parameters::AddSchedulerGroup.
+    */
+    struct SchedulerGroupParameters
+    {
+        /**
+        \brief Constructor.
+        \param name Name of the group, by which it can be found with \ref Framework::GetSchedulerGroup.
+        \param threadCount Number of worker threads processing the actors in the group.
+        \param processorSet Set of logical processors on which the worker threads of the group execute, or empty to use those of the framework.
+        */
+        inline explicit SchedulerGroupParameters(
+            const char *const name = 0,
+            const uint32_t threadCount = 1,
+            const ProcessorSet &processorSet = ProcessorSet()) :
+          mName(name),
+          mThreadCount(threadCount),
+          mProcessorSet(processorSet)
+        {
+        }
+
+        const char *mName;              ///< Name of the group, which is copied when the framework is constructed.
+        uint32_t mThreadCount;          ///< The number of worker threads in the group.
+        ProcessorSet mProcessorSet;     ///< Set of logical processors upon which the worker threads of the group execute, if not empty.
+    };
+
     /**
     \brief Parameters structure that can be passed to the Framework constructor.
     
@@ -123,7 +183,7 @@ public:
     The members are mainly concerned with configuring the pool of worker threads that is created
     within the framework, and which is used to execute the actors that are subsequently hosted
     within it. They allow the user to control the number of threads in the pool, their processor
-    affinities, and their yielding behavior.
+    affinities, their yielding behavior, and the organization of the work queues they service.
     
     By choosing appropriate values it's possible to configure specialized frameworks tailored to
     particular uses. For example, users writing real-time systems might choose to create a separate
@@ -174,12 +234,87 @@ public:
     basis. The expectation is that the actors within a single framework will mainly message
     each other, with messages being sent between frameworks far less frequently.
 
+    Where a single framework spans several nodes, the \ref SCHEDULER_STRATEGY_NUMA scheduler strategy
+    binds each worker thread to one of the enabled nodes, and gives each node its own work queue,
+    so that actors and their messages tend to stay within a node.
+
+    The \ref SCHEDULER_STRATEGY_PARTITIONED scheduler strategy goes further, pinning each worker
+    thread to its own processor, taken in turn from \ref mProcessorMask within the enabled nodes.
+
+    Independently of the scheduler strategy, the \ref mThreadPlacement member can pin each worker
+    thread to a distinct logical processor chosen from the processor topology, filling physical
+    cores before their hyperthreads and keeping neighbouring threads within a shared cache. The
+    \ref mReservedProcessors member names processors, such as those handling interrupts, on
+    which no worker threads are pinned, as does the \ref mReservedProcessorMask member for the
+    first 32 processors. See \ref ThreadPlacement.
+
+    The 32-bit masks can't describe machines with more than 32 processors per node. On such
+    machines the \ref mProcessorSet member lists the logical processors on which the worker
+    threads may execute directly, by their indices in the system, and overrides the masks when
+    it isn't empty. Pinned threads are then placed only on processors in the set. With the
+    \ref SCHEDULER_STRATEGY_NUMA and \ref SCHEDULER_STRATEGY_PARTITIONED strategies, \ref mNodeMask
+    still selects the nodes to which threads are bound, and each thread executes on the processors
+    of the set within its node.
+
+    The \ref mContinuationDepth member enables continuations. With continuations enabled, a
+    message handler that sends a message to an actor with an empty mailbox hands the actor directly
+    to the worker thread executing the handler, which processes it straight after the sending
+    actor instead of pushing it onto a work queue. Only the last such actor messaged by each
+    handler is handed on. A chain of actors messaging each other, such as a request and its
+    response, then runs on one thread at little more than the cost of a function call per message.
+    To preserve fairness a thread follows at most \ref mContinuationDepth continuations in
+    succession, and for at most a fraction of a millisecond, before queuing the next actor.
+    Actors bound to worker threads, and actors processed by another thread pool, are always queued.
+    Continuations are disabled in frameworks using \ref SCHEDULER_STRATEGY_PARTITIONED.
+
+    The \ref mWorkerPool member attaches the framework to a \ref WorkerPool shared with other
+    frameworks, instead of creating worker threads of its own. The framework's actors are then
+    processed by the threads of the pool, in weighted turn with the actors of the other attached
+    frameworks, and the thread count, yield strategy, scheduler strategy, affinity masks and
+    thread priority given in the parameters are ignored.
+
+    The \ref AddSchedulerGroup method declares a named scheduler group, with its own work queue
+    and worker threads. Actors are assigned to a group on construction, and otherwise belong to the
+    default group, zero, which is processed by the framework's main worker threads. The threads of a
+    group service a single shared queue, with the framework's yield strategy, thread priority and
+    continuation depth, and their number is fixed. They can be restricted to their own
+    \ref ProcessorSet, so that, for example, ingest actors run on processors 0-3 and analytics
+    actors on processors 4-15 of the same framework:
+
+    \code
+    Theron::ProcessorSet ingestProcessors;
+    Theron::ProcessorSet analyticsProcessors;
+    ingestProcessors.AddList("0-3");
+    analyticsProcessors.AddList("4-15");
+
+    Theron::Framework::Parameters params(2);
+    const uint32_t ingest(params.AddSchedulerGroup(Theron::Framework::SchedulerGroupParameters("ingest", 4, ingestProcessors)));
+    params.AddSchedulerGroup(Theron::Framework::SchedulerGroupParameters("analytics", 12, analyticsProcessors));
+
+    Theron::Framework framework(params);
+    IngestActor ingestActor(framework, 0, Theron::ACTOR_PRIORITY_NORMAL, ingest);
+    AnalyticsActor analyticsActor(framework, 0, Theron::ACTOR_PRIORITY_NORMAL, framework.GetSchedulerGroup("analytics"));
+    \endcode
+
+    With pinned \ref mThreadPlacement, the placement order is built once for the framework. Groups
+    without their own processor set are pinned to the processors following those of the main worker
+    threads, and of earlier such groups, so that each pool of threads has processors of its own until
+    the order runs out and is reused from the start. Groups with their own processor set are pinned
+    in the order of their own processors.
+
+    Actors marked as blocking are processed by the blocking threads, if there are any, whatever
+    their group. Timers are serviced by the main worker threads, and frameworks attached to a
+    \ref WorkerPool still create the threads of their groups themselves.
+
     \note Support for node and processor affinity masks is currently somewhat limited.
     Supported is implemented with Windows NUMA API in windows builds, and with libnuma under linux.
     In GCC builds, NUMA support requires libnuma-dev and must be explicitly enabled via \ref THERON_NUMA
     (or numa=on in the makefile). The \ref mNodeMask member is supported with both version 1 and version 2
     of the libnuma API, but the \ref mProcessorMask member is supported only with version 2. Under Windows
-    both members are supported.
+    both members are supported. A processor mask with all bits set selects all the processors of each
+    enabled node, including any beyond the first 32. The \ref mProcessorSet member is supported under
+    Linux, via libnuma version 2 where enabled and otherwise directly via pthreads, and under Windows
+    for the first 64 processors.
     */
     struct Parameters
     {
@@ -193,19 +328,64 @@ public:
         \param processorMask Bitfield mask specifying the processor affinity of the created worker threads within each enabled NUMA node.
         \param yieldStrategy Enum value specifying how freely worker threads yield to other system threads.
         \param priority Relative scheduling priority of the worker threads (range -1.0 to 1.0, 0.0 means "normal").
+        \param schedulerStrategy Enum value specifying how the work queues serviced by the worker threads are organized.
+        \param messagesPerVisit Maximum number of queued messages a worker thread processes from an actor before rescheduling it.
+        \param autoScaling Whether the number of worker threads is scaled automatically with the load.
+        \param blockingThreadCount Maximum number of threads in the pool processing blocking actors, or zero for no blocking pool.
+        \param continuationDepth Maximum number of actors a worker thread processes in succession by continuation, or zero to disable continuations.
+        \param workerPool Optional pool of worker threads shared with other frameworks, used instead of the framework's own worker threads.
+        \param workerPoolWeight Relative share of the threads of the worker pool given to the framework while other attached frameworks are busy.
+        \param threadPlacement Enum value specifying how the worker threads are placed on processors.
+        \param reservedProcessorMask Bitfield mask specifying logical processors on which pinned worker threads aren't placed.
         */
         inline explicit Parameters(
             const uint32_t threadCount = 16,
             const uint32_t nodeMask = 0x1,
             const uint32_t processorMask = 0xFFFFFFFF,
             const YieldStrategy yieldStrategy = YIELD_STRATEGY_CONDITION,
-            const float priority = 0.0f) :
+            const float priority = 0.0f,
+            const SchedulerStrategy schedulerStrategy = SCHEDULER_STRATEGY_SHARED,
+            const uint32_t messagesPerVisit = 1,
+            const bool autoScaling = false,
+            const uint32_t blockingThreadCount = 0,
+            const uint32_t continuationDepth = 0,
+            WorkerPool *const workerPool = 0,
+            const uint32_t workerPoolWeight = 1,
+            const ThreadPlacement threadPlacement = THREAD_PLACEMENT_SHARED,
+            const uint32_t reservedProcessorMask = 0) :
           mThreadCount(threadCount),
           mNodeMask(nodeMask),
           mProcessorMask(processorMask),
           mYieldStrategy(yieldStrategy),
-          mThreadPriority(priority)
+          mThreadPriority(priority),
+          mSchedulerStrategy(schedulerStrategy),
+          mMessagesPerVisit(messagesPerVisit),
+          mAutoScaling(autoScaling),
+          mBlockingThreadCount(blockingThreadCount),
+          mContinuationDepth(continuationDepth),
+          mWorkerPool(workerPool),
+          mWorkerPoolWeight(workerPoolWeight),
+          mThreadPlacement(threadPlacement),
+          mReservedProcessorMask(reservedProcessorMask),
+          mReservedProcessors(),
+          mProcessorSet(),
+          mSchedulerGroupCount(0)
+        {
+        }
+
+        /**
+        \brief Declares a scheduler group, with its own work queue and worker threads.
+        \return The index of the group, by which actors are assigned to it, or zero if no more groups can be declared.
+        */
+        inline uint32_t AddSchedulerGroup(const SchedulerGroupParameters &group)
         {
+            if (mSchedulerGroupCount == MAX_SCHEDULER_GROUPS)
+            {
+                return 0;
+            }
+
+            mSchedulerGroups[mSchedulerGroupCount++] = group;
+            return mSchedulerGroupCount;
         }
 
         uint32_t mThreadCount;          ///< The initial number of worker threads to create within the framework.
@@ -213,6 +393,19 @@ public:
         uint32_t mProcessorMask;        ///< 32-bit mask specifying the subset of the processors in each NUMA processor node upon which the framework may execute.
         YieldStrategy mYieldStrategy;   ///< Member of \ref YieldStrategy specifying how worker threads yield to other system threads when no work is available.
         float mThreadPriority;          ///< Number between -1.0 and 1.0 indicating the relative scheduling priority of the worker threads.
+        SchedulerStrategy mSchedulerStrategy;   ///< Member of \ref SchedulerStrategy specifying how the work queues serviced by the worker threads are organized.
+        uint32_t mMessagesPerVisit;     ///< Maximum number of queued messages a worker thread processes from an actor each time it is scheduled.
+        bool mAutoScaling;              ///< Whether the number of worker threads is scaled automatically with the load, between the limits set by \ref SetMinThreads and \ref SetMaxThreads.
+        uint32_t mBlockingThreadCount;  ///< Initial and maximum number of threads processing actors marked as blocking, or zero to process them with the worker threads.
+        uint32_t mContinuationDepth;    ///< Maximum number of actors a worker thread processes in succession by continuation, or zero to disable continuations.
+        WorkerPool *mWorkerPool;        ///< Optional pool of worker threads shared with other frameworks, which must outlive the framework.
+        uint32_t mWorkerPoolWeight;     ///< Number of mailboxes the threads of the worker pool process from the framework in each turn.
+        ThreadPlacement mThreadPlacement;   ///< Member of \ref ThreadPlacement specifying how the worker threads are placed on processors.
+        uint32_t mReservedProcessorMask;    ///< 32-bit mask specifying the first 32 logical processors on which pinned worker threads aren't placed.
+        ProcessorSet mReservedProcessors;   ///< Set of logical processors on which pinned worker threads aren't placed, in addition to those in the mask.
+        ProcessorSet mProcessorSet;     ///< Set of logical processors upon which the framework may execute, overriding the node and processor masks if not empty.
+        uint32_t mSchedulerGroupCount;  ///< Number of scheduler groups declared with \ref AddSchedulerGroup.
+        SchedulerGroupParameters mSchedulerGroups[MAX_SCHEDULER_GROUPS];    ///< Parameters of the declared scheduler groups, numbered from one.
     };
 
     /**
@@ -376,6 +569,8 @@ public:
     it is more natural to use \ref Actor::Send, where the address of the sending actor is
     implicit.
 
+    \see SharedValue
+
     \tparam ValueType The message type.
     \param value The message value.
     \param from The address of the sending entity (typically a receiver).
@@ -385,6 +580,208 @@ public:
     template <typename ValueType>
     inline bool Send(const ValueType &value, const Address &from, const Address &address);
 
+    /**
+    \brief Sends a message to each of a range of addresses.
+
+    The message value is copied once into a shared payload, as if wrapped in a \ref SharedValue,
+    and each addressed entity is sent a message referencing it. The mailboxes of local actors
+    made ready by the messages are scheduled together, rather than one by one.
+
+    \code
+    const Theron::Address listeners[] = { logger.GetAddress(), monitor.GetAddress(), archiver.GetAddress() };
+    framework.Send(event, receiver.GetAddress(), listeners, listeners + 3);
+    \endcode
+
+    The messages are sent in the order of the addresses, and a message to each address is
+    ordered after earlier messages sent to that address by the same sender, as if they were
+    sent individually.
+
+    \tparam ValueType The message type.
+    \param value The message value.
+    \param from The address of the sending entity (typically a receiver).
+    \param begin Pointer to the first address to which the message is sent.
+    \param end Pointer one past the last address to which the message is sent.
+    \return The number of entities to which the message was delivered.
+    \see AddressGroup
+    */
+    template <typename ValueType>
+    inline uint32_t Send(const ValueType &value, const Address &from, const Address *const begin, const Address *const end);
+
+    /**
+    \brief Sends a message to each of the addresses in a group.
+    \return The number of entities to which the message was delivered.
+    */
+    template <typename ValueType>
+    inline uint32_t Send(const ValueType &value, const Address &from, const AddressGroup &group);
+
+#if THERON_CPP11
+
+    /**
+    \brief Sends a message to the entity at the given address, moving the value into the message.
+
+    Available in C++11 builds (see \ref THERON_CPP11). Chosen in preference to the copying
+    overload for rvalues and non-const lvalues; the message value is move-constructed from
+    rvalues, so large values such as vectors and strings can be sent without being copied.
+
+    \code
+    std::vector<int> samples(1000000);
+    framework.Send(std::move(samples), receiver.GetAddress(), actor.GetAddress());
+    \endcode
+
+    \see Emplace
+    */
+    template <typename ValueType, typename MessageValueType = typename Detail::MovedMessageValue<ValueType>::Type>
+    inline bool Send(ValueType &&value, const Address &from, const Address &address);
+
+    /**
+    \brief Sends a message to the entity at the given address, constructing its value in place.
+
+    Available in C++11 builds (see \ref THERON_CPP11). The message value is constructed
+    directly in the allocated message from the given constructor arguments, avoiding both
+    the copy made by \ref Send and the construction of a temporary.
+
+    \code
+    framework.Emplace<std::string>(receiver.GetAddress(), actor.GetAddress(), 1024, 'x');
+    \endcode
+
+    \tparam ValueType The message type, which must be given explicitly.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \param args Arguments forwarded to the constructor of the message value.
+    \return True, if the message was delivered to an entity, otherwise false.
+    */
+    template <typename ValueType, typename... ArgTypes>
+    inline bool Emplace(const Address &from, const Address &address, ArgTypes &&... args);
+
+#endif // THERON_CPP11
+
+    /**
+    \brief Sends a message to the entity at the given address after a delay.
+
+    The message value is copied immediately, and a message holding the copy is delivered
+    into the mailbox of the target entity, as if sent by \ref Send, once the delay has
+    elapsed. Timers are serviced by the framework's manager thread with a resolution of
+    about a millisecond, so messages may be delivered slightly later than requested.
+
+    \code
+    Theron::Framework framework;
+    Theron::Receiver receiver;
+
+    // Send a reminder to the receiver in half a second.
+    framework.SendAfter(std::string("Wake up"), receiver.GetAddress(), receiver.GetAddress(), 500);
+    receiver.Wait();
+    \endcode
+
+    Pending timers are discarded, without their messages being sent, when the framework
+    is destroyed.
+
+    \tparam ValueType The message type.
+    \param value The message value.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \param milliseconds The delay in milliseconds after which the message is sent.
+    \return A non-zero handle identifying the timer, for use with \ref CancelTimer, or zero on failure.
+
+    \see SendEvery
+    \see Actor::SendAfter
+    */
+    template <typename ValueType>
+    inline uint32_t SendAfter(
+        const ValueType &value,
+        const Address &from,
+        const Address &address,
+        const uint32_t milliseconds);
+
+    /**
+    \brief Sends a message to the entity at the given address repeatedly, at a fixed period.
+
+    This is the periodic equivalent of \ref SendAfter. The first message is sent after a
+    single period has elapsed, and further messages are sent every period thereafter, until
+    the timer is cancelled with \ref CancelTimer. Each message holds its own copy of the value.
+    Periods are measured from the scheduled time of the last message, so they don't drift.
+
+    \tparam ValueType The message type.
+    \param value The message value.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \param milliseconds The period in milliseconds at which the message is sent.
+    \return A non-zero handle identifying the timer, for use with \ref CancelTimer, or zero on failure.
+
+    \see SendAfter
+    \see Actor::SendEvery
+    */
+    template <typename ValueType>
+    inline uint32_t SendEvery(
+        const ValueType &value,
+        const Address &from,
+        const Address &address,
+        const uint32_t milliseconds);
+
+    /**
+    \brief Cancels a timer started with \ref SendAfter or \ref SendEvery.
+
+    Timers are held in a hierarchical timing wheel, so both starting and cancelling a timer
+    take constant time, however many timers are pending.
+
+    \param timer The handle returned when the timer was started.
+    \return True if the timer was cancelled, or false if its handle is stale or its (last) message has already been sent.
+    */
+    inline bool CancelTimer(const uint32_t timer);
+
+    /**
+    \brief Gets how full the mailbox of the actor at the given address is, as a percentage of its capacity.
+
+    Actors can be given bounded mailboxes using \ref Actor::SetMailboxCapacity, in which case
+    messages arriving while the mailbox is full are handled according to the actor's
+    \ref OverflowPolicy. This method offers senders a cheap way to detect a slow consumer
+    before its mailbox fills, so they can back off or shed load themselves.
+
+    The message count is read without synchronizing with senders, so the result is only a snapshot,
+    but it costs no more than a couple of memory reads.
+
+    \param address The address of an actor in this framework.
+    \return The number of messages queued at the actor as a percentage of its mailbox capacity,
+    limited to 100. Zero if the mailbox is unbounded, or if the address isn't of an actor in this framework.
+    */
+    inline uint32_t GetMailboxPressure(const Address &address);
+
+    /**
+    \brief Waits until no messages are queued at, or being processed by, the actors in this framework.
+
+    This is useful at the end of a batch of work, when the application wants to know that
+    the actors have finished processing all the messages sent to them, including any sent
+    by the actors themselves while processing others.
+
+    \code
+    Theron::Framework framework;
+    Worker worker(framework);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        framework.Send(i, Theron::Address(), worker.GetAddress());
+    }
+
+    // Wait for the worker, and any actors it sends messages to, to finish.
+    framework.WaitIdle();
+    \endcode
+
+    Each worker thread counts the messages it sends and processes, without atomic operations
+    or shared writes, and the counts are only summed when a thread is waiting. The waiting
+    thread sleeps on a condition, and is woken by the worker threads as they empty mailboxes,
+    so it doesn't spin.
+
+    Messages pending in timers started with \ref SendAfter or \ref SendEvery aren't counted
+    until the timers fire. Messages sent to receivers, or to actors in other frameworks,
+    aren't counted either.
+
+    \param milliseconds The maximum time to wait, in milliseconds. By default the wait is unlimited.
+    \return True if the framework was idle, or false if the time elapsed first.
+
+    \note This method mustn't be called from message handlers executed by this framework,
+    since the message being processed by the caller would prevent the framework becoming idle.
+    */
+    bool WaitIdle(const uint32_t milliseconds = 0xFFFFFFFF);
+
     /**
     \brief Specifies a maximum limit on the number of worker threads enabled in this framework.
 
@@ -416,6 +813,13 @@ public:
     is higher than the limit. This means that until some threads are woken by the arrival
     of new messages, the actual thread count will remain unchanged.
 
+    \note In frameworks constructed with \ref Parameters::mAutoScaling enabled, this method
+    sets the upper limit within which the thread count is scaled with the load, and so may
+    also raise the limit. The limit is initially the thread count specified on construction.
+
+    \note Frameworks using \ref SCHEDULER_STRATEGY_PARTITIONED, and frameworks attached to a
+    \ref WorkerPool, have a fixed number of worker threads, and ignore this method.
+
     \param count A positive integer - behavior for zero is undefined.
 
     \see SetMinThreads
@@ -444,6 +848,13 @@ public:
     to that task, which runs asynchronously from other threads as a background task.
     It spends most of its time asleep, only being woken by calls to SetMinThreads.
 
+    \note In frameworks constructed with \ref Parameters::mAutoScaling enabled, this method
+    sets the lower limit within which the thread count is scaled with the load, and so may
+    also lower the limit. The limit is initially one.
+
+    \note Frameworks using \ref SCHEDULER_STRATEGY_PARTITIONED, and frameworks attached to a
+    \ref WorkerPool, have a fixed number of worker threads, and ignore this method.
+
     \param count A positive integer - behavior for zero is undefined.
 
     \see SetMaxThreads
@@ -458,9 +869,10 @@ public:
     returned by this function. The target thread count is negotiated over multiple calls,
     and specifying a higher value than the current maximum may have no effect.
 
-    \note In the current implementation, GetMaxThreads and GetMinThreads return the same
-    value, which is the current target thread count. Note that this may be different from
-    the actual current number of threads, returned by GetNumThreads.
+    \note Unless \ref Parameters::mAutoScaling is enabled, GetMaxThreads and GetMinThreads return
+    the same value, which is the current target thread count. Note that this may be different from
+    the actual current number of threads, returned by GetNumThreads. With automatic scaling enabled
+    they return the limits within which the thread count is scaled.
 
     \see GetMinThreads
     */
@@ -509,6 +921,83 @@ public:
     */
     inline uint32_t GetPeakThreads() const;
 
+    /**
+    \brief Specifies a maximum limit on the number of threads in the blocking thread pool.
+
+    The blocking thread pool processes the actors marked as blocking with \ref Actor::SetBlocking,
+    so that their blocking handlers don't hold up the main worker threads. The pool is scaled
+    automatically with the load, within limits set independently of the limits on the number
+    of main worker threads. The maximum is initially the
+    \ref Parameters::mBlockingThreadCount "mBlockingThreadCount" specified on construction.
+
+    \note This method has no effect in frameworks constructed without a blocking thread pool.
+
+    \param count A positive integer - behavior for zero is undefined.
+
+    \see SetMinBlockingThreads
+    */
+    inline void SetMaxBlockingThreads(const uint32_t count);
+
+    /**
+    \brief Specifies a minimum limit on the number of threads in the blocking thread pool.
+
+    The minimum is initially one. See \ref SetMaxBlockingThreads.
+
+    \note This method has no effect in frameworks constructed without a blocking thread pool.
+
+    \param count A positive integer - behavior for zero is undefined.
+
+    \see SetMaxBlockingThreads
+    */
+    inline void SetMinBlockingThreads(const uint32_t count);
+
+    /**
+    \brief Returns the current maximum limit on the number of threads in the blocking thread pool.
+    \return The maximum limit, or zero if the framework has no blocking thread pool.
+    */
+    inline uint32_t GetMaxBlockingThreads() const;
+
+    /**
+    \brief Returns the current minimum limit on the number of threads in the blocking thread pool.
+    \return The minimum limit, or zero if the framework has no blocking thread pool.
+    */
+    inline uint32_t GetMinBlockingThreads() const;
+
+    /**
+    \brief Gets the actual number of threads currently in the blocking thread pool.
+    \return The number of enabled blocking threads, or zero if the framework has no blocking thread pool.
+    */
+    inline uint32_t GetNumBlockingThreads() const;
+
+    /**
+    \brief Gets the peak number of threads ever active in the blocking thread pool.
+    \return The peak number of blocking threads, or zero if the framework has no blocking thread pool.
+    */
+    inline uint32_t GetPeakBlockingThreads() const;
+
+    /**
+    \brief Gets the index of the scheduler group with the given name.
+
+    Scheduler groups are declared with \ref Parameters::AddSchedulerGroup, and numbered from one
+    in the order in which they were declared. The index is passed to the \ref Actor constructor
+    to assign actors to the group.
+
+    \return The index of the group, or zero, the index of the default group, if there is no group with the name.
+    */
+    uint32_t GetSchedulerGroup(const char *const name) const;
+
+    /**
+    \brief Gets the number of scheduler groups declared in the framework, besides the default group.
+    */
+    inline uint32_t GetNumSchedulerGroups() const;
+
+    /**
+    \brief Gets the number of worker threads processing the actors in a scheduler group.
+    \param group Index of the group, or zero for the framework's main worker threads.
+    \return The number of threads, or zero if there is no group with the index.
+    */
+    inline uint32_t GetNumSchedulerGroupThreads(const uint32_t group) const;
+
     /**
     \brief Returns the number of counters available for querying via GetCounterValue.
 
@@ -556,6 +1045,22 @@ public:
     */
     inline uint32_t GetCounterValue(const uint32_t counter) const;
 
+    /**
+    \brief Gets the current value of a specified event counter in the blocking thread pool.
+
+    The event counters of the blocking thread pool, which processes the actors marked as blocking
+    with \ref Actor::SetBlocking, are kept separately from those of the main worker threads,
+    which are queried with \ref GetCounterValue. Both are reset by \ref ResetCounters.
+
+    \note Counters are only available if \ref THERON_ENABLE_COUNTERS is defined as non-zero.
+
+    \param counter An integer index identifying the counter to be queried.
+    \return Current value of the counter at the time of the call, or zero if the framework has no blocking thread pool.
+
+    \see GetCounterValue
+    */
+    inline uint32_t GetBlockingCounterValue(const uint32_t counter) const;
+
     /**
     \brief Gets the current per-thread values of a specified event counter.
 
@@ -577,6 +1082,30 @@ public:
         uint32_t *const perThreadCounts,
         const uint32_t maxCounts) const;
 
+    /**
+    \brief Gets the current per-node values of a specified event counter.
+
+    This method gets the current value of a specific counter accumulated over the currently
+    active worker threads bound to each NUMA processor node. Worker threads are bound to single
+    nodes when the framework uses \ref SCHEDULER_STRATEGY_NUMA; otherwise each worker thread is
+    counted against the lowest node on which it may execute. Comparing the per-node values of
+    counters such as the number of messages processed, and the number of mailboxes taken from
+    the queues of other nodes, shows how well the work is kept local to the nodes.
+
+    \note Counters are only incremented if \ref THERON_ENABLE_COUNTERS is defined as non-zero.
+
+    \param counter An integer index identifying the counter to be queried.
+    \param perNodeCounts Pointer to an array of uint32_t to be filled with per-node counter values, indexed by node.
+    \param maxCounts The size of the perNodeCounts array and hence the maximum number of values to fetch.
+    \return The number of per-node values fetched, which is one more than the highest node with active worker threads.
+
+    \see GetPerThreadCounterValues
+    */
+    inline uint32_t GetPerNodeCounterValues(
+        const uint32_t counter,
+        uint32_t *const perNodeCounts,
+        const uint32_t maxCounts) const;
+
     /**
     \brief Sets the fallback message handler executed for unhandled messages.
 
@@ -712,9 +1241,80 @@ private:
 
     typedef Detail::CachingAllocator<MessageCacheTraits> MessageCache;
 
+    /**
+    Maximum number of mailboxes made ready by a multicast message that are scheduled in one batch.
+    */
+    static const uint32_t MULTICAST_BATCH_SIZE = 32;
+
+    /**
+    A scheduler group, with its own work queue and worker threads.
+    */
+    struct SchedulerGroup
+    {
+        Detail::String mName;                   ///< Name of the group.
+        Detail::MailboxContext mMailboxContext; ///< Mailbox context shared by the threads of the group.
+        Detail::IScheduler *mScheduler;         ///< Pointer to owned scheduler of the group.
+        uint32_t *mPlacementOrder;              ///< Placement order of the group's own processor set, if it has one and is pinned.
+        uint32_t mPlacementCount;               ///< Number of processors in the group's own placement order.
+    };
+
+    /**
+    Processors to which the worker threads of a scheduler are pinned, taken in turn from an offset.
+    */
+    struct Placement
+    {
+        inline Placement() : mOrder(0), mCount(0), mOffset(0)
+        {
+        }
+
+        inline Placement(const uint32_t *const order, const uint32_t count, const uint32_t offset) :
+          mOrder(order),
+          mCount(count),
+          mOffset(offset)
+        {
+        }
+
+        const uint32_t *mOrder;                 ///< Processors in placement order, or null if the threads aren't pinned.
+        uint32_t mCount;                        ///< Number of processors in the placement order.
+        uint32_t mOffset;                       ///< Position in the order of the processor of the first thread.
+    };
+
     Framework(const Framework &other);
     Framework &operator=(const Framework &other);
 
+    /**
+    Timer that sends a copy of a message value each time it expires.
+    */
+    template <typename ValueType>
+    class TimedMessage : public Detail::Timer
+    {
+    public:
+
+        inline TimedMessage(
+            Framework *const framework,
+            const ValueType &value,
+            const Address &from,
+            const Address &address,
+            const uint32_t delay,
+            const uint32_t period) :
+          Detail::Timer(static_cast<uint32_t>(sizeof(TimedMessage)), delay, period),
+          mFramework(framework),
+          mValue(value),
+          mFrom(from),
+          mAddress(address)
+        {
+        }
+
+        inline virtual void Fire();
+
+    private:
+
+        Framework *mFramework;          ///< Framework whose shared context is used to send the messages.
+        ValueType mValue;               ///< Copy of the message value.
+        Address mFrom;                  ///< Address of the sending entity.
+        Address mAddress;               ///< Address of the target entity.
+    };
+
     /**
     Initializes a framework object at start of day.
     This function is called by the various constructor flavors and avoids repeating the code.
@@ -731,6 +1331,39 @@ private:
     */
     Detail::IScheduler *CreateScheduler();
 
+    /**
+    Allocates and initializes an owned scheduler object using the given monitor type.
+    */
+    template <class MonitorType>
+    Detail::IScheduler *CreateSchedulerWithMonitor();
+
+    /**
+    Allocates and initializes an owned scheduler object using the given queue type.
+    */
+    template <class QueueType>
+    Detail::IScheduler *CreateScheduler(
+        Detail::MailboxContext *const sharedMailboxContext,
+        const YieldStrategy yieldStrategy,
+        const Placement &placement,
+        const ProcessorSet &processorSet,
+        const bool autoScaling,
+        const uint32_t continuationDepth);
+
+    /**
+    Allocates and initializes the scheduler of a scheduler group.
+    */
+    Detail::IScheduler *CreateSchedulerGroupScheduler(
+        Detail::MailboxContext *const sharedMailboxContext,
+        const Placement &placement,
+        const ProcessorSet &processorSet);
+
+    /**
+    Allocates and builds the order in which pinned worker threads are placed on the given processors.
+    
+eturn The placement order, or null if the threads aren't pinned or the topology isn't available.
+    */
+    uint32_t *CreatePlacementOrder(const ProcessorSet &processorSet, uint32_t &count) const;
+
     /**
     Destroys a previously created scheduler object.
     */
@@ -755,35 +1388,114 @@ private:
         Address address);
 
     /**
-    Helper method that sends messages to entities in the local process.
+    Helper method that sends a message to each of a range of addresses.
     */
-    static bool DeliverWithinLocalProcess(
-        Detail::IMessage *const message,
-        const Detail::Index &index);
+    template <typename ValueType>
+    inline uint32_t SendMulticast(
+        Detail::MailboxContext *const mailboxContext,
+        const ValueType &value,
+        const Address &from,
+        const Address *const begin,
+        const Address *const end);
 
     /**
-    Receives a message from another framework.
+    Helper method that starts timers.
     */
-    inline bool FrameworkReceive(
-        Detail::IMessage *const message,
-        const Address &address);
+    template <typename ValueType>
+    inline uint32_t StartTimer(
+        const ValueType &value,
+        const Address &from,
+        const Address &address,
+        const uint32_t delay,
+        const uint32_t period);
 
     /**
-    Returns a pointer to the shared mailbox context not associated with a specific worker thread.
+    Pushes a message into a bounded mailbox, applying its overflow policy if it's full.
     */
-    inline Detail::MailboxContext *GetMailboxContext();
+    bool SendBounded(
+        Detail::MailboxContext *const mailboxContext,
+        Detail::Mailbox &mailbox,
+        const uint32_t capacity,
+        Detail::IMessage *const message);
 
-    Detail::StringPool::Ref mStringPoolRef;                 ///< Ensures that the StringPool is created.
-    EndPoint *const mEndPoint;                              ///< Pointer to the network endpoint, if any, to which this framework is tied.
-    const Parameters mParams;                               ///< Copy of parameters struct provided on construction.
-    uint32_t mIndex;                                        ///< Non-zero index of this framework, unique within the local process.
-    Detail::String mName;                                   ///< Name of this framework.
-    Detail::Directory<Detail::Mailbox> mMailboxes;          ///< Per-framework mailbox array.
+    /**
+    Counts a message sent to a local mailbox, before it's pushed into the mailbox.
+    */
+    inline void CountSent(Detail::MailboxContext *const mailboxContext);
+
+    /**
+    Hands a message sent by a handler to an empty mailbox directly to the sending worker thread.
+    \return True if the message was handed off, or false if it should be pushed as usual.
+    */
+    inline bool HandOff(
+        Detail::MailboxContext *const mailboxContext,
+        Detail::Mailbox &mailbox,
+        Detail::IMessage *const message);
+
+    /**
+    Checks whether every message counted as sent has been processed or discarded.
+    */
+    bool IsIdle() const;
+
+    /**
+    Gets the scheduler of the thread pool that processes a mailbox, and its shared mailbox context.
+    */
+    inline Detail::IScheduler *GetScheduler(
+        const Detail::Mailbox &mailbox,
+        Detail::MailboxContext *&sharedMailboxContext);
+
+    /**
+    Schedules a mailbox in the thread pool that processes it, blocking or otherwise.
+    */
+    inline void Schedule(
+        Detail::MailboxContext *const mailboxContext,
+        Detail::Mailbox *const mailbox);
+
+    /**
+    Schedules a batch of mailboxes in the thread pools that process them.
+    */
+    inline void ScheduleBatch(
+        Detail::MailboxContext *const mailboxContext,
+        Detail::Mailbox *const *const mailboxes,
+        const uint32_t count);
+
+    /**
+    Helper method that sends messages to entities in the local process.
+    */
+    static bool DeliverWithinLocalProcess(
+        Detail::IMessage *const message,
+        const Detail::Index &index);
+
+    /**
+    Receives a message from another framework.
+    */
+    inline bool FrameworkReceive(
+        Detail::IMessage *const message,
+        const Address &address);
+
+    /**
+    Returns a pointer to the shared mailbox context not associated with a specific worker thread.
+    */
+    inline Detail::MailboxContext *GetMailboxContext();
+
+    Detail::StringPool::Ref mStringPoolRef;                 ///< Ensures that the StringPool is created.
+    EndPoint *const mEndPoint;                              ///< Pointer to the network endpoint, if any, to which this framework is tied.
+    const Parameters mParams;                               ///< Copy of parameters struct provided on construction.
+    uint32_t mIndex;                                        ///< Non-zero index of this framework, unique within the local process.
+    Detail::String mName;                                   ///< Name of this framework.
+    Detail::Directory<Detail::Mailbox> mMailboxes;          ///< Per-framework mailbox array.
     Detail::FallbackHandlerCollection mFallbackHandlers;    ///< Registered message handlers run for unhandled messages.
     Detail::DefaultFallbackHandler mDefaultFallbackHandler; ///< Default handler for unhandled messages.
     MessageCache mMessageAllocator;                         ///< Thread-safe per-framework cache of message memory blocks.
     Detail::MailboxContext mSharedMailboxContext;           ///< Shared per-framework mailbox context.
     Detail::IScheduler *mScheduler;                         ///< Pointer to owned scheduler implementation.
+    Detail::MailboxContext mBlockingMailboxContext;         ///< Mailbox context shared by the blocking threads.
+    Detail::IScheduler *mBlockingScheduler;                 ///< Pointer to owned scheduler of the blocking threads, if any.
+    SchedulerGroup *mSchedulerGroups;                       ///< Array of scheduler groups, if any, indexed from zero for group one.
+    uint32_t *mPlacementOrder;                              ///< Order in which pinned worker threads are placed on the framework's processors, if pinned.
+    uint32_t mPlacementCount;                               ///< Number of processors in the placement order.
+    Detail::Atomic::UInt32 mSharedMessagesSent;             ///< Messages sent to local mailboxes via the shared context.
+    Detail::IdleMonitor mIdleMonitor;                       ///< Condition on which threads wait for the framework to become idle.
 };
 
 
@@ -798,7 +1510,14 @@ inline Framework::Framework(const uint32_t threadCount) :
   mDefaultFallbackHandler(),
   mMessageAllocator(AllocatorManager::GetCache()),
   mSharedMailboxContext(),
-  mScheduler(0)
+  mScheduler(0),
+  mBlockingMailboxContext(),
+  mBlockingScheduler(0),
+  mSchedulerGroups(0),
+  mPlacementOrder(0),
+  mPlacementCount(0),
+  mSharedMessagesSent(0),
+  mIdleMonitor()
 {
     Detail::BuildDescriptor::Check();
 
@@ -817,7 +1536,14 @@ inline Framework::Framework(const Parameters &params) :
   mDefaultFallbackHandler(),
   mMessageAllocator(AllocatorManager::GetCache()),
   mSharedMailboxContext(),
-  mScheduler(0)
+  mScheduler(0),
+  mBlockingMailboxContext(),
+  mBlockingScheduler(0),
+  mSchedulerGroups(0),
+  mPlacementOrder(0),
+  mPlacementCount(0),
+  mSharedMessagesSent(0),
+  mIdleMonitor()
 {
     Detail::BuildDescriptor::Check();
 
@@ -836,7 +1562,14 @@ inline Framework::Framework(EndPoint &endPoint, const char *const name, const Pa
   mDefaultFallbackHandler(),
   mMessageAllocator(AllocatorManager::GetCache()),
   mSharedMailboxContext(),
-  mScheduler(0)
+  mScheduler(0),
+  mBlockingMailboxContext(),
+  mBlockingScheduler(0),
+  mSchedulerGroups(0),
+  mPlacementOrder(0),
+  mPlacementCount(0),
+  mSharedMessagesSent(0),
+  mIdleMonitor()
 {
     Detail::BuildDescriptor::Check();
 
@@ -872,15 +1605,167 @@ THERON_FORCEINLINE bool Framework::Send(const ValueType &value, const Address &f
 }
 
 
+template <typename ValueType>
+THERON_FORCEINLINE uint32_t Framework::Send(
+    const ValueType &value,
+    const Address &from,
+    const Address *const begin,
+    const Address *const end)
+{
+    return SendMulticast(&mSharedMailboxContext, value, from, begin, end);
+}
+
+
+template <typename ValueType>
+THERON_FORCEINLINE uint32_t Framework::Send(const ValueType &value, const Address &from, const AddressGroup &group)
+{
+    return SendMulticast(&mSharedMailboxContext, value, from, group.Begin(), group.End());
+}
+
+
+#if THERON_CPP11
+
+template <typename ValueType, typename MessageValueType>
+THERON_FORCEINLINE bool Framework::Send(ValueType &&value, const Address &from, const Address &address)
+{
+    // The message holds a plain value, whatever the constness and reference type of the argument.
+    return Emplace<MessageValueType>(from, address, std::forward<ValueType>(value));
+}
+
+
+template <typename ValueType, typename... ArgTypes>
+THERON_FORCEINLINE bool Framework::Emplace(const Address &from, const Address &address, ArgTypes &&... args)
+{
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    Detail::IMessage *const message(Detail::MessageCreator::Emplace<ValueType>(
+        messageAllocator,
+        from,
+        std::forward<ArgTypes>(args)...));
+
+    if (message == 0)
+    {
+        return false;
+    }
+
+    return SendInternal(
+        &mSharedMailboxContext,
+        message,
+        address);
+}
+
+#endif // THERON_CPP11
+
+
+template <typename ValueType>
+inline uint32_t Framework::SendAfter(
+    const ValueType &value,
+    const Address &from,
+    const Address &address,
+    const uint32_t milliseconds)
+{
+    return StartTimer(value, from, address, milliseconds, 0);
+}
+
+
+template <typename ValueType>
+inline uint32_t Framework::SendEvery(
+    const ValueType &value,
+    const Address &from,
+    const Address &address,
+    const uint32_t milliseconds)
+{
+    return StartTimer(value, from, address, milliseconds, milliseconds ? milliseconds : 1);
+}
+
+
+inline bool Framework::CancelTimer(const uint32_t timer)
+{
+    // Timers are always serviced by the main scheduler, even if they target blocking actors.
+    return mScheduler->CancelTimer(timer);
+}
+
+
+template <typename ValueType>
+inline uint32_t Framework::StartTimer(
+    const ValueType &value,
+    const Address &from,
+    const Address &address,
+    const uint32_t delay,
+    const uint32_t period)
+{
+    typedef TimedMessage<ValueType> TimerType;
+
+    // The timer is freed by the timer wheel, which uses the same allocator.
+    IAllocator *const allocator(AllocatorManager::GetCache());
+    void *const memory(allocator->AllocateAligned(sizeof(TimerType), THERON_CACHELINE_ALIGNMENT));
+    if (memory == 0)
+    {
+        return 0;
+    }
+
+    TimerType *const timer(new (memory) TimerType(this, value, from, address, delay, period));
+    return mScheduler->StartTimer(timer);
+}
+
+
+template <typename ValueType>
+inline void Framework::TimedMessage<ValueType>::Fire()
+{
+    // Timers are serviced by the manager thread, which has no mailbox context of its own.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(
+        &mFramework->mMessageAllocator,
+        mValue,
+        mFrom));
+
+    if (message)
+    {
+        mFramework->SendInternal(
+            &mFramework->mSharedMailboxContext,
+            message,
+            mAddress);
+    }
+}
+
+
+inline uint32_t Framework::GetMailboxPressure(const Address &address)
+{
+    // Mailboxes in other frameworks, and addresses of receivers, aren't bounded by this framework.
+    if (address.mIndex.mUInt32 == 0 || address.mIndex.mComponents.mFramework != mIndex)
+    {
+        return 0;
+    }
+
+    const Detail::Mailbox &mailbox(mMailboxes.GetEntry(address.mIndex.mComponents.mIndex));
+    const uint32_t capacity(mailbox.GetCapacity());
+    const uint32_t count(mailbox.Count());
+
+    if (capacity == 0)
+    {
+        return 0;
+    }
+
+    return (count >= capacity ? 100 : count * 100 / capacity);
+}
+
+
 THERON_FORCEINLINE void Framework::SetMaxThreads(const uint32_t count)
 {
-    mScheduler->SetMaxThreads(count);
+    // Partitioned frameworks keep the threads that own their partitions.
+    // Frameworks attached to worker pools ignore the limits in their schedulers.
+    if (mParams.mSchedulerStrategy != SCHEDULER_STRATEGY_PARTITIONED)
+    {
+        mScheduler->SetMaxThreads(count);
+    }
 }
 
 
 THERON_FORCEINLINE void Framework::SetMinThreads(const uint32_t count)
 {
-    mScheduler->SetMinThreads(count);
+    if (mParams.mSchedulerStrategy != SCHEDULER_STRATEGY_PARTITIONED)
+    {
+        mScheduler->SetMinThreads(count);
+    }
 }
 
 
@@ -908,6 +1793,70 @@ THERON_FORCEINLINE uint32_t Framework::GetPeakThreads() const
 }
 
 
+THERON_FORCEINLINE void Framework::SetMaxBlockingThreads(const uint32_t count)
+{
+    if (mBlockingScheduler)
+    {
+        mBlockingScheduler->SetMaxThreads(count);
+    }
+}
+
+
+THERON_FORCEINLINE void Framework::SetMinBlockingThreads(const uint32_t count)
+{
+    if (mBlockingScheduler)
+    {
+        mBlockingScheduler->SetMinThreads(count);
+    }
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetMaxBlockingThreads() const
+{
+    return mBlockingScheduler ? mBlockingScheduler->GetMaxThreads() : 0;
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetMinBlockingThreads() const
+{
+    return mBlockingScheduler ? mBlockingScheduler->GetMinThreads() : 0;
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetNumBlockingThreads() const
+{
+    return mBlockingScheduler ? mBlockingScheduler->GetNumThreads() : 0;
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetPeakBlockingThreads() const
+{
+    return mBlockingScheduler ? mBlockingScheduler->GetPeakThreads() : 0;
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetNumSchedulerGroups() const
+{
+    return mParams.mSchedulerGroupCount;
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetNumSchedulerGroupThreads(const uint32_t group) const
+{
+    if (group == 0)
+    {
+        return mScheduler->GetNumThreads();
+    }
+
+    if (group <= mParams.mSchedulerGroupCount)
+    {
+        return mSchedulerGroups[group - 1].mScheduler->GetNumThreads();
+    }
+
+    return 0;
+}
+
+
 THERON_FORCEINLINE uint32_t Framework::GetNumCounters() const
 {
 #if THERON_ENABLE_COUNTERS
@@ -934,6 +1883,14 @@ THERON_FORCEINLINE const char *Framework::GetCounterName(const uint32_t counter)
             case Detail::COUNTER_QUEUE_LATENCY_LOCAL_MAX:   return "maximum observed latency of thread-local queue";
             case Detail::COUNTER_QUEUE_LATENCY_SHARED_MIN:  return "minimum observed latency of per-framework queue";
             case Detail::COUNTER_QUEUE_LATENCY_SHARED_MAX:  return "maximum observed latency of per-framework queue";
+            case Detail::COUNTER_STEALS:                    return "mailboxes stolen from other thread-local queues";
+            case Detail::COUNTER_MAILBOX_VISITS:            return "mailboxes popped and processed by worker threads";
+            case Detail::COUNTER_MESSAGES_PER_VISIT_MAX:    return "maximum number of messages processed per mailbox visit";
+            case Detail::COUNTER_NODE_STEALS:               return "mailboxes taken from the queues of other NUMA nodes";
+            case Detail::COUNTER_QUEUE_LATENCY_LOW_MAX:     return "maximum observed queue latency of low priority actors";
+            case Detail::COUNTER_QUEUE_LATENCY_NORMAL_MAX:  return "maximum observed queue latency of normal priority actors";
+            case Detail::COUNTER_QUEUE_LATENCY_HIGH_MAX:    return "maximum observed queue latency of high priority actors";
+            case Detail::COUNTER_INBOX_PUSHES:              return "mailboxes pushed to the inboxes of their bound worker threads";
             default: return "unknown";
         }
 #endif
@@ -947,6 +1904,11 @@ THERON_FORCEINLINE void Framework::ResetCounters()
 {
 #if THERON_ENABLE_COUNTERS
     mScheduler->ResetCounters();
+
+    if (mBlockingScheduler)
+    {
+        mBlockingScheduler->ResetCounters();
+    }
 #endif
 }
 
@@ -964,6 +1926,19 @@ THERON_FORCEINLINE uint32_t Framework::GetCounterValue(const uint32_t counter) c
 }
 
 
+THERON_FORCEINLINE uint32_t Framework::GetBlockingCounterValue(const uint32_t counter) const
+{
+    if (counter < Detail::MAX_COUNTERS && mBlockingScheduler)
+    {
+#if THERON_ENABLE_COUNTERS
+        return mBlockingScheduler->GetCounterValue(counter);
+#endif
+    }
+
+    return 0;
+}
+
+
 THERON_FORCEINLINE uint32_t Framework::GetPerThreadCounterValues(
     const uint32_t counter,
     uint32_t *const perThreadCounts,
@@ -980,6 +1955,22 @@ THERON_FORCEINLINE uint32_t Framework::GetPerThreadCounterValues(
 }
 
 
+THERON_FORCEINLINE uint32_t Framework::GetPerNodeCounterValues(
+    const uint32_t counter,
+    uint32_t *const perNodeCounts,
+    const uint32_t maxCounts) const
+{
+    if (counter < Detail::MAX_COUNTERS && perNodeCounts && maxCounts)
+    {
+#if THERON_ENABLE_COUNTERS
+        return mScheduler->GetPerNodeCounterValues(counter, perNodeCounts, maxCounts);
+#endif
+    }
+
+    return 0;
+}
+
+
 THERON_FORCEINLINE bool Framework::SendInternal(
     Detail::MailboxContext *const mailboxContext,
     Detail::IMessage *const message,
@@ -1013,21 +2004,34 @@ THERON_FORCEINLINE bool Framework::SendInternal(
         // Get a reference to the destination mailbox.
         Detail::Mailbox &mailbox(mMailboxes.GetEntry(address.mIndex.mComponents.mIndex));
 
+        // Bounded mailboxes apply their overflow policy to messages arriving while they're full.
+        // This case is handled out of line so it doesn't bloat the inlined common case.
+        const uint32_t capacity(mailbox.GetCapacity());
+        if (capacity)
+        {
+            return SendBounded(mailboxContext, mailbox, capacity, message);
+        }
+
         // Push the message into the mailbox and schedule the mailbox for processing
         // if it was previously empty, so won't already be scheduled.
+        // The push doesn't lock the mailbox, so senders never wait for each other.
         // The message will be destroyed by the worker thread that does the processing,
         // even if it turns out that no actor is registered with the mailbox.
-        mailbox.Lock();
+        // It's counted as sent first, so it can't be seen processed before it's seen sent.
+        CountSent(mailboxContext);
 
-        const bool schedule(mailbox.Empty());
-        mailbox.Push(message);
-
-        if (schedule)
+        // With continuations enabled, a message sent by a handler to an empty mailbox is handed
+        // directly to the sending worker thread, without being queued. Only worker thread
+        // contexts have a non-zero continuation depth.
+        if (mailboxContext->mContinuationDepth && HandOff(mailboxContext, mailbox, message))
         {
-            mScheduler->Schedule(mailboxContext, &mailbox);
+            return true;
         }
 
-        mailbox.Unlock();
+        if (mailbox.Push(message))
+        {
+            Schedule(mailboxContext, &mailbox);
+        }
 
         return true;
     }
@@ -1047,6 +2051,229 @@ THERON_FORCEINLINE bool Framework::SendInternal(
 }
 
 
+template <typename ValueType>
+inline uint32_t Framework::SendMulticast(
+    Detail::MailboxContext *const mailboxContext,
+    const ValueType &value,
+    const Address &from,
+    const Address *const begin,
+    const Address *const end)
+{
+    typedef Detail::SharedValueOf<ValueType> SharedValueOf;
+    typedef typename SharedValueOf::Type SharedValueType;
+
+    THERON_ASSERT(begin <= end);
+    const uint32_t count(static_cast<uint32_t>(end - begin));
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // A single address is sent an ordinary message.
+    if (count == 1)
+    {
+        Detail::IMessage *const message(Detail::MessageCreator::Create(mailboxContext->mMessageAllocator, value, from));
+        return (message && SendInternal(mailboxContext, message, *begin)) ? 1 : 0;
+    }
+
+    // The value is copied once into a shared payload, referenced by a small message per address.
+    const SharedValueType sharedValue(SharedValueOf::Make(value));
+    if (sharedValue.IsNull())
+    {
+        return 0;
+    }
+
+    Detail::Mailbox *readyMailboxes[MULTICAST_BATCH_SIZE];
+    uint32_t readyCount(0);
+    uint32_t deliveredCount(0);
+
+    for (const Address *address = begin; address != end; ++address)
+    {
+        Detail::IMessage *const message(Detail::MessageCreator::Create(mailboxContext->mMessageAllocator, sharedValue, from));
+        if (message == 0)
+        {
+            continue;
+        }
+
+        // Messages to unbounded mailboxes in this framework are pushed here, and the mailboxes
+        // they make ready are scheduled in batches. Messages aren't handed off as continuations,
+        // since the sending thread can't follow them all. Other messages are sent as usual.
+        const Detail::Index &index(address->mIndex);
+        if (index.mUInt32 != 0 && index.mComponents.mFramework == mIndex)
+        {
+            Detail::Mailbox &mailbox(mMailboxes.GetEntry(index.mComponents.mIndex));
+            if (mailbox.GetCapacity() == 0)
+            {
+                CountSent(mailboxContext);
+                ++deliveredCount;
+
+                if (mailbox.Push(message))
+                {
+                    readyMailboxes[readyCount++] = &mailbox;
+                    if (readyCount == MULTICAST_BATCH_SIZE)
+                    {
+                        ScheduleBatch(mailboxContext, readyMailboxes, readyCount);
+                        readyCount = 0;
+                    }
+                }
+
+                continue;
+            }
+        }
+
+        if (SendInternal(mailboxContext, message, *address))
+        {
+            ++deliveredCount;
+        }
+    }
+
+    if (readyCount)
+    {
+        ScheduleBatch(mailboxContext, readyMailboxes, readyCount);
+    }
+
+    return deliveredCount;
+}
+
+
+THERON_FORCEINLINE void Framework::CountSent(Detail::MailboxContext *const mailboxContext)
+{
+    // The contexts of worker threads are owned by a single thread, so count without atomic
+    // increments. The push that follows publishes the count to the thread that retires the message.
+    if (mailboxContext == &mSharedMailboxContext)
+    {
+        mSharedMessagesSent.Increment();
+    }
+    else
+    {
+        Detail::Atomic::UInt32 &sent(mailboxContext->mMessagesSent);
+        sent.StoreRelease(sent.LoadAcquire() + 1);
+    }
+}
+
+
+THERON_FORCEINLINE bool Framework::HandOff(
+    Detail::MailboxContext *const mailboxContext,
+    Detail::Mailbox &mailbox,
+    Detail::IMessage *const message)
+{
+    Detail::Mailbox *const sendingMailbox(mailboxContext->mMailbox);
+    Detail::MailboxContext *sharedMailboxContext(0);
+
+    // Only messages sent from handlers are handed off, and only to other mailboxes processed by
+    // the sending thread's own pool. Mailboxes bound to worker threads are left to their threads.
+    if (sendingMailbox == 0 ||
+        sendingMailbox == &mailbox ||
+        mailbox.GetWorkerThread() != Detail::Mailbox::UNBOUND ||
+        mailboxContext->mScheduler != GetScheduler(mailbox, sharedMailboxContext))
+    {
+        return false;
+    }
+
+    // Claim the mailbox, holding the message in it, if it's empty.
+    if (!mailbox.Claim(message))
+    {
+        return false;
+    }
+
+    // The claimed mailbox becomes the continuation of the sending thread, processed straight
+    // after the sending mailbox. Only the last mailbox claimed by a handler is continued, since
+    // the handler's thread can't follow them all, so any earlier one is scheduled as usual.
+    // Its held message is popped first, so queuing it doesn't change the order of its messages.
+    Detail::Mailbox *const displacedMailbox(mailboxContext->mContinuation);
+    mailboxContext->mContinuation = &mailbox;
+
+    if (displacedMailbox)
+    {
+        Schedule(mailboxContext, displacedMailbox);
+    }
+
+    return true;
+}
+
+
+THERON_FORCEINLINE Detail::IScheduler *Framework::GetScheduler(
+    const Detail::Mailbox &mailbox,
+    Detail::MailboxContext *&sharedMailboxContext)
+{
+    // Blocking actors are processed by the blocking threads, if there are any.
+    if (mBlockingScheduler && mailbox.IsBlocking())
+    {
+        sharedMailboxContext = &mBlockingMailboxContext;
+        return mBlockingScheduler;
+    }
+
+    // Actors in scheduler groups other than the default are processed by the threads of their group.
+    if (const uint32_t group = mailbox.GetSchedulerGroup())
+    {
+        SchedulerGroup &schedulerGroup(mSchedulerGroups[group - 1]);
+        sharedMailboxContext = &schedulerGroup.mMailboxContext;
+        return schedulerGroup.mScheduler;
+    }
+
+    sharedMailboxContext = &mSharedMailboxContext;
+    return mScheduler;
+}
+
+
+THERON_FORCEINLINE void Framework::Schedule(
+    Detail::MailboxContext *const mailboxContext,
+    Detail::Mailbox *const mailbox)
+{
+    Detail::MailboxContext *sharedMailboxContext(0);
+    Detail::IScheduler *const scheduler(GetScheduler(*mailbox, sharedMailboxContext));
+
+    // The context of the sending thread can only be used to schedule mailboxes in its own
+    // thread pool. Mailboxes scheduled in another pool are pushed via its shared context.
+    if (mailboxContext->mScheduler == scheduler)
+    {
+        scheduler->Schedule(mailboxContext, mailbox);
+    }
+    else
+    {
+        scheduler->Schedule(sharedMailboxContext, mailbox);
+    }
+}
+
+
+THERON_FORCEINLINE void Framework::ScheduleBatch(
+    Detail::MailboxContext *const mailboxContext,
+    Detail::Mailbox *const *const mailboxes,
+    const uint32_t count)
+{
+    // The batch is split into runs of mailboxes processed by the same thread pool. Usually
+    // they all are, unless some of the recipients are blocking actors or in scheduler groups.
+    uint32_t first(0);
+    while (first < count)
+    {
+        Detail::MailboxContext *sharedMailboxContext(0);
+        Detail::IScheduler *const scheduler(GetScheduler(*mailboxes[first], sharedMailboxContext));
+
+        uint32_t last(first + 1);
+        Detail::MailboxContext *otherMailboxContext(0);
+        while (last < count && GetScheduler(*mailboxes[last], otherMailboxContext) == scheduler)
+        {
+            ++last;
+        }
+
+        // As in Schedule, the context of the sending thread is only used within its own pool.
+        Detail::MailboxContext *const context(mailboxContext->mScheduler == scheduler ? mailboxContext : sharedMailboxContext);
+
+        if (last - first == 1)
+        {
+            scheduler->Schedule(context, mailboxes[first]);
+        }
+        else
+        {
+            scheduler->ScheduleBatch(context, mailboxes + first, last - first);
+        }
+
+        first = last;
+    }
+}
+
+
 THERON_FORCEINLINE bool Framework::FrameworkReceive(
     Detail::IMessage *const message,
     const Address &address)
@@ -0,0 +1,46 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_OVERFLOWPOLICY_H
+#define THERON_OVERFLOWPOLICY_H
+
+
+/**
+\file OverflowPolicy.h
+Defines the OverflowPolicy enumerated type.
+*/
+
+
+namespace Theron
+{
+
+
+/**
+\brief Enumerates the available policies for messages sent to full mailboxes.
+
+By default actor mailboxes are unbounded, so a slow actor receiving messages faster than
+it can process them accumulates a growing backlog of queued messages. An actor can instead
+be given a bounded mailbox using \ref Theron::Actor::SetMailboxCapacity, in which case the
+overflow policy of the actor determines what happens to messages that arrive while the
+mailbox is full. The capacity counts all the messages queued in the mailbox, including the
+one currently being processed, if any.
+
+Messages are pushed into mailboxes without locking, except into mailboxes with the
+\ref OVERFLOW_POLICY_DROP_OLDEST policy. Their senders and worker threads take the lock of
+the mailbox to push and pop messages, so a sender can remove the oldest queued message.
+
+Whatever the policy, the memory used by the queued messages stays bounded under overload.
+Senders can check how full a mailbox is before sending, using
+\ref Theron::Framework::GetMailboxPressure, and back off or shed load themselves.
+*/
+enum OverflowPolicy
+{
+    OVERFLOW_POLICY_REJECT = 0,         ///< The arriving message is discarded and Send returns false.
+    OVERFLOW_POLICY_DROP_OLDEST,        ///< The oldest message not yet being processed is discarded to make room.
+    OVERFLOW_POLICY_DROP_NEWEST,        ///< The arriving message is silently discarded, and Send returns true.
+    OVERFLOW_POLICY_FALLBACK            ///< The arriving message is passed to the fallback handler and Send returns false.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_OVERFLOWPOLICY_H
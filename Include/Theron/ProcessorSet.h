@@ -0,0 +1,291 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_PROCESSORSET_H
+#define THERON_PROCESSORSET_H
+
+
+/**
+\file ProcessorSet.h
+Set of logical processors, used to describe thread affinity.
+*/
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief A set of logical processors, identified by their indices in the system.
+
+The 32-bit node and processor masks in \ref Theron::Framework::Parameters "Framework::Parameters"
+can only describe the first 32 processors of each NUMA node. A processor set names any of the
+first \ref MAX_PROCESSORS logical processors of the machine directly, in the manner of a
+Linux cpuset, and can be assigned to the \ref Theron::Framework::Parameters::mProcessorSet "mProcessorSet"
+member of the parameters of a framework or \ref WorkerPool to restrict its worker threads to
+those processors.
+
+\code
+Theron::Framework::Parameters params(96);
+params.mProcessorSet.AddList("0-63,128-159");
+
+Theron::Framework framework(params);
+\endcode
+
+The default-constructed set is empty, which leaves the masks in effect.
+*/
+class ProcessorSet
+{
+public:
+
+    /**
+    Maximum number of logical processors that can be described.
+    */
+    static const uint32_t MAX_PROCESSORS = 1024;
+
+    /**
+    \brief Default constructor.
+    Constructs an empty set.
+    */
+    inline ProcessorSet();
+
+    /**
+    \brief Adds a logical processor to the set.
+    */
+    inline void Add(const uint32_t processor);
+
+    /**
+    \brief Adds an inclusive range of logical processors to the set.
+    */
+    inline void AddRange(const uint32_t first, const uint32_t last);
+
+    /**
+    \brief Adds the logical processors in another set to the set.
+    */
+    inline void Add(const ProcessorSet &other);
+
+    /**
+    \brief Adds the logical processors among the first 32 named in a 32-bit mask.
+    */
+    inline void AddMask(const uint32_t mask);
+
+    /**
+    \brief Adds the logical processors named in a list, in the format used by Linux (eg. "0-3,8,10-11").
+    \return False if the list is malformed, in which case the entries before the error have been added.
+    */
+    inline bool AddList(const char *const list);
+
+    /**
+    \brief Removes a logical processor from the set.
+    */
+    inline void Remove(const uint32_t processor);
+
+    /**
+    \brief Removes all the logical processors from the set.
+    */
+    inline void Clear();
+
+    /**
+    \brief Removes the logical processors that aren't also in another set.
+    */
+    inline void Intersect(const ProcessorSet &other);
+
+    /**
+    \brief Returns true if the set contains a logical processor.
+    */
+    inline bool Contains(const uint32_t processor) const;
+
+    /**
+    \brief Returns true if the set contains no logical processors.
+    */
+    inline bool Empty() const;
+
+    /**
+    \brief Gets the number of logical processors in the set.
+    */
+    inline uint32_t Count() const;
+
+private:
+
+    static const uint32_t WORD_COUNT = MAX_PROCESSORS / 32;
+
+    uint32_t mWords[WORD_COUNT];        ///< One bit per logical processor.
+};
+
+
+THERON_FORCEINLINE ProcessorSet::ProcessorSet()
+{
+    Clear();
+}
+
+
+THERON_FORCEINLINE void ProcessorSet::Add(const uint32_t processor)
+{
+    THERON_ASSERT_MSG(processor < MAX_PROCESSORS, "Processor index out of range");
+    if (processor < MAX_PROCESSORS)
+    {
+        mWords[processor >> 5] |= (1UL << (processor & 31));
+    }
+}
+
+
+inline void ProcessorSet::AddRange(const uint32_t first, const uint32_t last)
+{
+    for (uint32_t processor = first; processor <= last && processor < MAX_PROCESSORS; ++processor)
+    {
+        Add(processor);
+    }
+}
+
+
+THERON_FORCEINLINE void ProcessorSet::Add(const ProcessorSet &other)
+{
+    for (uint32_t index = 0; index < WORD_COUNT; ++index)
+    {
+        mWords[index] |= other.mWords[index];
+    }
+}
+
+
+THERON_FORCEINLINE void ProcessorSet::AddMask(const uint32_t mask)
+{
+    mWords[0] |= mask;
+}
+
+
+inline bool ProcessorSet::AddList(const char *const list)
+{
+    const char *current(list);
+    while (*current)
+    {
+        uint32_t bounds[2] = { 0, 0 };
+        for (uint32_t bound = 0; bound < 2; ++bound)
+        {
+            if (*current < '0' || *current > '9')
+            {
+                return false;
+            }
+
+            while (*current >= '0' && *current <= '9')
+            {
+                bounds[bound] = bounds[bound] * 10 + static_cast<uint32_t>(*current++ - '0');
+                if (bounds[bound] >= MAX_PROCESSORS)
+                {
+                    return false;
+                }
+            }
+
+            if (bound == 0)
+            {
+                if (*current != '-')
+                {
+                    bounds[1] = bounds[0];
+                    break;
+                }
+
+                ++current;
+            }
+        }
+
+        if (bounds[1] < bounds[0])
+        {
+            return false;
+        }
+
+        AddRange(bounds[0], bounds[1]);
+
+        if (*current == ',')
+        {
+            ++current;
+        }
+        else if (*current != '\0' && *current != '\n')
+        {
+            return false;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+THERON_FORCEINLINE void ProcessorSet::Remove(const uint32_t processor)
+{
+    if (processor < MAX_PROCESSORS)
+    {
+        mWords[processor >> 5] &= ~(1UL << (processor & 31));
+    }
+}
+
+
+THERON_FORCEINLINE void ProcessorSet::Clear()
+{
+    for (uint32_t index = 0; index < WORD_COUNT; ++index)
+    {
+        mWords[index] = 0;
+    }
+}
+
+
+THERON_FORCEINLINE void ProcessorSet::Intersect(const ProcessorSet &other)
+{
+    for (uint32_t index = 0; index < WORD_COUNT; ++index)
+    {
+        mWords[index] &= other.mWords[index];
+    }
+}
+
+
+THERON_FORCEINLINE bool ProcessorSet::Contains(const uint32_t processor) const
+{
+    if (processor < MAX_PROCESSORS)
+    {
+        return (mWords[processor >> 5] & (1UL << (processor & 31))) != 0;
+    }
+
+    return false;
+}
+
+
+THERON_FORCEINLINE bool ProcessorSet::Empty() const
+{
+    for (uint32_t index = 0; index < WORD_COUNT; ++index)
+    {
+        if (mWords[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+inline uint32_t ProcessorSet::Count() const
+{
+    uint32_t count(0);
+    for (uint32_t index = 0; index < WORD_COUNT; ++index)
+    {
+        // Count the set bits of the word, clearing the lowest each time.
+        uint32_t word(mWords[index]);
+        while (word)
+        {
+            word &= word - 1;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+
+} // namespace Theron
+
+
+#endif // THERON_PROCESSORSET_H
@@ -0,0 +1,79 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_SCHEDULERSTRATEGY_H
+#define THERON_SCHEDULERSTRATEGY_H
+
+
+/**
+\file SchedulerStrategy.h
+Defines the SchedulerStrategy enumerated type.
+*/
+
+
+namespace Theron
+{
+
+
+/**
+\brief Enumerates the available worker thread scheduling strategies.
+
+Each \ref Theron::Framework contains a pool of worker threads that are used to execute
+the actors hosted in the framework. Actors that have received messages are scheduled for
+processing by pushing their mailboxes onto a work queue serviced by the worker threads.
+
+This enum defines the available values of the \ref Theron::Framework::Parameters::mSchedulerStrategy "mSchedulerStrategy"
+member of the \ref Theron::Framework::Parameters structure, which selects the organization of
+the work queues within the framework.
+
+The default strategy is \ref SCHEDULER_STRATEGY_SHARED. With this strategy, all worker threads
+service a single work queue shared by the whole framework. Each worker thread also has a private
+single-item queue which it uses to hold the last actor messaged by the handler it is executing,
+allowing message handoffs between pairs of actors to bypass the shared queue. The shared queue
+is simple and fair, but because it is protected by a single lock it becomes a point of contention
+when many worker threads are busy.
+
+SCHEDULER_STRATEGY_WORK_STEALING gives each worker thread its own double-ended work queue.
+Actors messaged by a handler are pushed to the queue of the worker thread executing the handler,
+which pops them in last-in-first-out order to make the best use of its caches. Worker threads that
+run out of work steal actors from the other end of the queues of other worker threads. The shared
+queue is then used only for messages sent from outside the framework's worker threads, such as
+messages sent by non-actor code via \ref Theron::Framework::Send. This strategy scales better on
+machines with many cores, at the cost of weaker fairness between actors.
+
+SCHEDULER_STRATEGY_NUMA partitions the work queues by NUMA processor node. Each worker thread
+is bound to a single node of those enabled by \ref Theron::Framework::Parameters::mNodeMask "mNodeMask",
+with the threads spread over the nodes in turn. Actors messaged by a handler are pushed to the
+work queue of the node of the worker thread executing the handler, and actors messaged from
+outside the worker threads are pushed to the work queue of the node on which the sending thread
+is running. Worker threads only take work from the queues of other nodes once the queue of their
+own node is empty, and allocate the memory for the messages they send from memory local to their
+node. This keeps actors, and the messages they exchange, within a node where possible. On systems
+without NUMA support, or when NUMA support is disabled via \ref THERON_NUMA, there is a single
+node and this strategy behaves much like SCHEDULER_STRATEGY_SHARED.
+
+SCHEDULER_STRATEGY_PARTITIONED shares nothing between the worker threads. Each worker thread owns
+a fixed partition of the actors, by the index of their mailboxes, and is the only thread that ever
+processes them. Actors bound to a worker thread with \ref Theron::Actor::SetWorkerThread belong to
+the partition of that thread instead. Actors messaged by a handler in the partition of the worker
+thread executing it go straight to that thread's private work queue. Actors in other partitions
+are passed to their owning threads through single-producer, single-consumer rings, one for each
+pair of worker threads, and actors messaged from outside the worker threads through a lock-free
+inbox per thread, so scheduling an actor never takes a lock. Each worker thread is pinned to a
+distinct processor, where processor affinity is supported. This trades away all load balancing,
+since a busy partition can't be helped by idle threads, for the best cache locality and the lowest
+latency. The number of worker threads is fixed by \ref Theron::Framework::Parameters::mThreadCount "mThreadCount",
+up to a maximum of 64; automatic scaling, \ref Theron::Framework::SetMinThreads and
+\ref Theron::Framework::SetMaxThreads don't apply, and continuations are disabled.
+*/
+enum SchedulerStrategy
+{
+    SCHEDULER_STRATEGY_SHARED = 0,      ///< Worker threads service a single work queue shared by the framework.
+    SCHEDULER_STRATEGY_WORK_STEALING,   ///< Worker threads service their own work queues and steal from each other when idle.
+    SCHEDULER_STRATEGY_NUMA,            ///< Worker threads service the work queue of their own NUMA node, and those of other nodes when idle.
+    SCHEDULER_STRATEGY_PARTITIONED      ///< Worker threads each own a fixed partition of the actors, and exchange work through lock-free rings.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_SCHEDULERSTRATEGY_H
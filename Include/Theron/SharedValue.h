@@ -0,0 +1,280 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_SHAREDVALUE_H
+#define THERON_SHAREDVALUE_H
+
+
+/**
+\file SharedValue.h
+Reference-counted message value that can be sent to many actors without being copied.
+*/
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Messages/SharedPayload.h>
+
+#if THERON_CPP11
+#include <type_traits>
+#include <utility>
+#endif // THERON_CPP11
+
+
+namespace Theron
+{
+
+
+namespace Detail
+{
+class MessageCreator;
+}
+
+
+/**
+\brief An immutable message value shared by all the messages in which it's sent.
+
+Sending a message ordinarily copies the value into a newly allocated message, so sending
+the same large value to many actors makes one copy of it per recipient. Instead, the value
+can be wrapped in a shared value, which copies it once into a reference-counted payload.
+Sending the shared value, with \ref Actor::Send or \ref Framework::Send, allocates only a
+small message header referencing the payload, which is freed when the last of the messages
+has been handled and the last shared value referencing it has been destructed.
+
+\code
+Theron::SharedValue<Frame> frame(CaptureFrame());
+for (uint32_t index = 0; index < encoderCount; ++index)
+{
+    Send(frame, mEncoders[index]);
+}
+\endcode
+
+The messages carry values of the wrapped type, so they're handled by ordinary handlers
+for that type: the handlers above receive a <code>const Frame &</code>, and all of them
+see the same object. Since the value is shared between threads it can't be modified
+after construction.
+
+Shared values can be copied and assigned freely; copies reference the same payload.
+A default-constructed shared value is null, and sending it fails.
+*/
+template <class ValueType>
+class SharedValue
+{
+public:
+
+    friend class Detail::MessageCreator;
+
+    /**
+    \brief Default constructor.
+    Constructs a null shared value, which references no payload.
+    */
+    inline SharedValue();
+
+    /**
+    \brief Constructs a shared value holding a copy of the given value.
+    */
+    inline explicit SharedValue(const ValueType &value);
+
+#if THERON_CPP11
+
+    /**
+    \brief Constructs a shared value into which the given value is moved.
+    Available in C++11 builds (see \ref THERON_CPP11).
+    */
+    inline explicit SharedValue(ValueType &&value);
+
+#endif // THERON_CPP11
+
+    /**
+    \brief Copy constructor.
+    The copy references the same value.
+    */
+    inline SharedValue(const SharedValue &other);
+
+    /**
+    \brief Destructor.
+    Releases the reference to the value, which is destroyed once no messages or shared values reference it.
+    */
+    inline ~SharedValue();
+
+    /**
+    \brief Assignment operator.
+    Releases the reference to the current value, and references the value of the other shared value instead.
+    */
+    inline SharedValue &operator=(const SharedValue &other);
+
+    /**
+    \brief Returns true if the shared value is null.
+    */
+    inline bool IsNull() const;
+
+    /**
+    \brief Gets the shared value.
+    \note The shared value must not be null.
+    */
+    inline const ValueType &Value() const;
+
+private:
+
+    Detail::SharedPayload<ValueType> *mPayload;     ///< Reference-counted payload holding the value, or null.
+};
+
+
+template <class ValueType>
+THERON_FORCEINLINE SharedValue<ValueType>::SharedValue() : mPayload(0)
+{
+}
+
+
+template <class ValueType>
+inline SharedValue<ValueType>::SharedValue(const ValueType &value) :
+  mPayload(Detail::SharedPayload<ValueType>::Create(value))
+{
+    THERON_ASSERT_MSG(mPayload, "Failed to allocate shared message value");
+}
+
+
+#if THERON_CPP11
+
+template <class ValueType>
+inline SharedValue<ValueType>::SharedValue(ValueType &&value) :
+  mPayload(Detail::SharedPayload<ValueType>::Emplace(std::move(value)))
+{
+    THERON_ASSERT_MSG(mPayload, "Failed to allocate shared message value");
+}
+
+#endif // THERON_CPP11
+
+
+template <class ValueType>
+THERON_FORCEINLINE SharedValue<ValueType>::SharedValue(const SharedValue &other) : mPayload(other.mPayload)
+{
+    if (mPayload)
+    {
+        mPayload->Reference();
+    }
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE SharedValue<ValueType>::~SharedValue()
+{
+    if (mPayload)
+    {
+        mPayload->Release();
+    }
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE SharedValue<ValueType> &SharedValue<ValueType>::operator=(const SharedValue &other)
+{
+    // Reference the new payload first in case both reference the same one.
+    if (other.mPayload)
+    {
+        other.mPayload->Reference();
+    }
+
+    if (mPayload)
+    {
+        mPayload->Release();
+    }
+
+    mPayload = other.mPayload;
+    return *this;
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE bool SharedValue<ValueType>::IsNull() const
+{
+    return (mPayload == 0);
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE const ValueType &SharedValue<ValueType>::Value() const
+{
+    THERON_ASSERT(mPayload);
+    return mPayload->Value();
+}
+
+
+namespace Detail
+{
+
+
+/**
+Shared value type in which a message value of the given type is sent to many recipients,
+wrapping plain values and passing through values that are already shared.
+*/
+template <class ValueType>
+struct SharedValueOf
+{
+    typedef SharedValue<ValueType> Type;
+
+    inline static Type Make(const ValueType &value)
+    {
+        return Type(value);
+    }
+};
+
+
+template <class ValueType>
+struct SharedValueOf<SharedValue<ValueType> >
+{
+    typedef SharedValue<ValueType> Type;
+
+    inline static Type Make(const Type &value)
+    {
+        return value;
+    }
+};
+
+
+} // namespace Detail
+
+
+#if THERON_CPP11
+
+namespace Detail
+{
+
+
+/**
+Type of the value of a message sent by moving or forwarding a plain value of the given type.
+Undefined for shared values, so that the forwarding overloads of Send don't accept them and
+they're sent as references to their payloads instead.
+*/
+template <class ValueType>
+struct MovableMessageValue
+{
+    typedef ValueType Type;
+};
+
+
+template <class ValueType>
+struct MovableMessageValue<SharedValue<ValueType> >
+{
+};
+
+
+/**
+Type of the value of a message sent by forwarding an argument of the given type,
+whatever its constness and reference type.
+*/
+template <class ArgType>
+struct MovedMessageValue : public MovableMessageValue<typename std::remove_cv<typename std::remove_reference<ArgType>::type>::type>
+{
+};
+
+
+} // namespace Detail
+
+#endif // THERON_CPP11
+
+
+} // namespace Theron
+
+
+#endif // THERON_SHAREDVALUE_H
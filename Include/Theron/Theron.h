@@ -10,7 +10,9 @@ All-inclusive wrapper header that includes all public headers.
 
 
 #include <Theron/Actor.h>
+#include <Theron/ActorPriority.h>
 #include <Theron/Address.h>
+#include <Theron/AddressGroup.h>
 #include <Theron/Align.h>
 #include <Theron/AllocatorManager.h>
 #include <Theron/Assert.h>
@@ -21,8 +23,14 @@ All-inclusive wrapper header that includes all public headers.
 #include <Theron/EndPoint.h>
 #include <Theron/Framework.h>
 #include <Theron/IAllocator.h>
+#include <Theron/OverflowPolicy.h>
+#include <Theron/ProcessorSet.h>
 #include <Theron/Receiver.h>
 #include <Theron/Register.h>
+#include <Theron/SchedulerStrategy.h>
+#include <Theron/SharedValue.h>
+#include <Theron/ThreadPlacement.h>
+#include <Theron/WorkerPool.h>
 #include <Theron/YieldStrategy.h>
 
 
@@ -0,0 +1,60 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_THREADPLACEMENT_H
+#define THERON_THREADPLACEMENT_H
+
+
+/**
+\file ThreadPlacement.h
+Defines the ThreadPlacement enumerated type.
+*/
+
+
+namespace Theron
+{
+
+
+/**
+\brief Enumerates the available policies for placing worker threads on processors.
+
+This enum defines the available values of the \ref Theron::Framework::Parameters::mThreadPlacement "mThreadPlacement"
+member of the \ref Theron::Framework::Parameters structure, and of the corresponding member of
+the \ref Theron::WorkerPool::Parameters structure.
+
+The default placement is \ref THREAD_PLACEMENT_SHARED. With this placement, all the worker threads
+are given the same node and processor affinity masks, within which the operating system is free
+to move them from processor to processor.
+
+THREAD_PLACEMENT_PINNED pins each worker thread to a distinct logical processor, so the caches
+it warms stay warm and actors handed from one handler to the next on the same thread stay on the
+same core. The processors are taken in turn from an order built from the processor topology the
+system reports: the first logical processor of each physical core comes before any second
+hardware thread of a core, and the cores that share a last-level cache are taken together, so
+the worker threads spread over whole cores before doubling up on hyperthreads and neighbouring
+workers share caches. Processors named in \ref Theron::Framework::Parameters::mReservedProcessors "mReservedProcessors",
+or among the first 32 in \ref Theron::Framework::Parameters::mReservedProcessorMask "mReservedProcessorMask",
+such as those set aside for interrupt handling, and processors outside the affinity of the
+process, are skipped. Where a \ref Theron::Framework::Parameters::mProcessorSet "processor set"
+is given, only the processors in the set are used. If there are more worker threads than processors,
+the order is reused from the start.
+
+\note Pinned placement is currently supported under Linux, where the topology is read from
+/sys/devices/system/cpu, and has no effect elsewhere. Pinned threads otherwise ignore the
+NUMA node and processor masks, but stay within any placement made by the scheduling strategy:
+where \ref Theron::SCHEDULER_STRATEGY_NUMA "SCHEDULER_STRATEGY_NUMA" or
+\ref Theron::SCHEDULER_STRATEGY_PARTITIONED "SCHEDULER_STRATEGY_PARTITIONED" binds a thread to a
+node or to particular processors, the thread is pinned to the next processor of the order within
+them, and if the order contains none of them the strategy's own placement is used. Each framework places its threads starting from the same processor,
+so frameworks sharing a machine should reserve each other's processors, or share a
+\ref Theron::WorkerPool.
+*/
+enum ThreadPlacement
+{
+    THREAD_PLACEMENT_SHARED = 0,        ///< Worker threads share the same affinity masks, and may migrate between processors.
+    THREAD_PLACEMENT_PINNED             ///< Worker threads are each pinned to a distinct processor, in topology order.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_THREADPLACEMENT_H
@@ -0,0 +1,275 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_WORKERPOOL_H
+#define THERON_WORKERPOOL_H
+
+
+/**
+\file WorkerPool.h
+Pool of worker threads shared by several frameworks.
+*/
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/ProcessorSet.h>
+#include <Theron/ThreadPlacement.h>
+
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Scheduler/PoolScheduler.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Condition.h>
+#include <Theron/Detail/Threading/Lock.h>
+#include <Theron/Detail/Threading/Mutex.h>
+#include <Theron/Detail/Threading/Thread.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+
+
+class Framework;
+
+
+/**
+\brief A pool of worker threads shared by several \ref Framework "frameworks".
+
+By default each framework creates its own worker threads, so a process hosting several
+frameworks for the sake of isolation ends up with several thread pools, each sized for
+its own peak load and mostly idle. Instead, the frameworks can be attached to a single
+worker pool, which is sized once for the process. The frameworks keep their own actors,
+directories and fallback handlers; only the threads that process them are shared.
+
+\code
+Theron::WorkerPool pool(Theron::WorkerPool::Parameters(8));
+
+Theron::Framework::Parameters frontParams;
+frontParams.mWorkerPool = &pool;
+frontParams.mWorkerPoolWeight = 3;
+
+Theron::Framework::Parameters backParams;
+backParams.mWorkerPool = &pool;
+
+Theron::Framework front(frontParams);
+Theron::Framework back(backParams);
+\endcode
+
+Each attached framework has its own work queue. The worker threads visit the queues of
+the attached frameworks in turn, processing up to the weight of each framework's
+attachment in mailboxes before moving on to the next one that has work. So while all the
+frameworks are busy, their shares of the pool are in proportion to their weights.
+
+A framework attached to a pool has no worker threads of its own: the thread count, yield
+strategy, scheduler strategy, affinity masks and thread priority in its parameters are
+ignored in favour of those of the pool, and its thread limits can't be changed. Its
+blocking threads, if it has any, are still its own.
+
+\note A worker pool must outlive all the frameworks attached to it.
+*/
+class WorkerPool
+{
+public:
+
+    friend class Framework;
+    friend class Detail::PoolScheduler;
+
+    /**
+    \brief Parameters structure that can be passed to the WorkerPool constructor.
+    */
+    struct Parameters
+    {
+        /**
+        \brief Constructor.
+        \param threadCount Number of worker threads in the pool.
+        \param nodeMask Bitfield mask specifying the NUMA node affinity of the worker threads.
+        \param processorMask Bitfield mask specifying the processor affinity of the worker threads within each enabled NUMA node.
+        \param priority Relative scheduling priority of the worker threads (range -1.0 to 1.0, 0.0 means "normal").
+        \param threadPlacement Enum value specifying how the worker threads are placed on processors.
+        \param reservedProcessorMask Bitfield mask specifying logical processors on which pinned worker threads aren't placed.
+        */
+        inline explicit Parameters(
+            const uint32_t threadCount = 16,
+            const uint32_t nodeMask = 0x1,
+            const uint32_t processorMask = 0xFFFFFFFF,
+            const float priority = 0.0f,
+            const ThreadPlacement threadPlacement = THREAD_PLACEMENT_SHARED,
+            const uint32_t reservedProcessorMask = 0) :
+          mThreadCount(threadCount),
+          mNodeMask(nodeMask),
+          mProcessorMask(processorMask),
+          mThreadPriority(priority),
+          mThreadPlacement(threadPlacement),
+          mReservedProcessorMask(reservedProcessorMask),
+          mReservedProcessors(),
+          mProcessorSet()
+        {
+        }
+
+        uint32_t mThreadCount;          ///< The number of worker threads in the pool.
+        uint32_t mNodeMask;             ///< 32-bit mask specifying the NUMA processor nodes upon which the worker threads execute.
+        uint32_t mProcessorMask;        ///< 32-bit mask specifying the subset of the processors in each NUMA processor node upon which the worker threads execute.
+        float mThreadPriority;          ///< Number between -1.0 and 1.0 indicating the relative scheduling priority of the worker threads.
+        ThreadPlacement mThreadPlacement;   ///< Member of \ref ThreadPlacement specifying how the worker threads are placed on processors.
+        uint32_t mReservedProcessorMask;    ///< 32-bit mask specifying the first 32 logical processors on which pinned worker threads aren't placed.
+        ProcessorSet mReservedProcessors;   ///< Set of logical processors on which pinned worker threads aren't placed, in addition to those in the mask.
+        ProcessorSet mProcessorSet;     ///< Set of logical processors upon which the worker threads execute, overriding the masks if not empty.
+    };
+
+    /**
+    Maximum number of frameworks that can be attached to a pool at once.
+    */
+    static const uint32_t MAX_FRAMEWORKS = 64;
+
+    /**
+    \brief Constructor.
+    Creates the worker threads of the pool, which sleep until frameworks attached to the pool have work.
+    */
+    explicit WorkerPool(const Parameters &params = Parameters());
+
+    /**
+    \brief Destructor.
+    Stops the worker threads of the pool and waits for them to terminate.
+    \note All the frameworks attached to the pool must have been destructed first.
+    */
+    ~WorkerPool();
+
+    /**
+    \brief Gets the number of worker threads in the pool.
+    */
+    inline uint32_t GetNumThreads() const;
+
+    /**
+    \brief Gets the number of frameworks currently attached to the pool.
+    */
+    inline uint32_t GetNumFrameworks() const;
+
+private:
+
+    /**
+    State of a worker thread of the pool.
+    */
+    struct THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) WorkerThread
+    {
+        WorkerPool *mPool;              ///< Pool owning the thread.
+        uint32_t mIndex;                ///< Index of the thread within the pool.
+        uint32_t mFramework;            ///< Index of the attached framework the thread is currently serving.
+        uint32_t mCredit;               ///< Number of mailboxes the thread may still process from that framework.
+        uint32_t mProcessor;            ///< Logical processor to which the thread is pinned, or ANY_PROCESSOR.
+        Detail::Atomic::UInt32 mEpoch;  ///< Odd while the thread may be touching the scheduler of an attached framework.
+        Detail::Thread mThread;         ///< The thread itself.
+
+    } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+    /**
+    Value of the processor of threads that aren't pinned to a single processor.
+    */
+    static const uint32_t ANY_PROCESSOR = 0xFFFFFFFF;
+
+    WorkerPool(const WorkerPool &other);
+    WorkerPool &operator=(const WorkerPool &other);
+
+    /**
+    Attaches a framework to the pool, returning a scheduler that processes its mailboxes using the pool.
+    The scheduler is detached from the pool again when it's released.
+    */
+    Detail::IScheduler *Attach(
+        Detail::FallbackHandlerCollection *const fallbackHandlers,
+        IAllocator *const messageAllocator,
+        Detail::MailboxContext *const sharedMailboxContext,
+        const uint32_t weight,
+        const uint32_t messagesPerVisit,
+        const uint32_t continuationDepth);
+
+    /**
+    Detaches the scheduler of a framework from the pool, waiting for the worker threads to let go of it.
+    */
+    void Detach(Detail::PoolScheduler *const scheduler);
+
+    /**
+    Wakes waiting worker threads, if any, up to the number of mailboxes pushed to an attached framework's queue.
+    */
+    inline void Wake(const uint32_t count = 1);
+
+    /**
+    Wakes the timer thread, after a timer was started with no other timers pending.
+    */
+    void WakeTimerThread();
+
+    /**
+    Pops a mailbox from the queue of an attached framework, in weighted turn.
+    */
+    Detail::Mailbox *Pop(WorkerThread *const thread, Detail::PoolScheduler *&scheduler);
+
+    /**
+    Returns true if the queue of any attached framework may hold mailboxes.
+    */
+    bool HasWork() const;
+
+    static void WorkerThreadEntryPoint(void *const context);
+    void WorkerThreadProc(WorkerThread *const thread);
+
+    static void TimerThreadEntryPoint(void *const context);
+    void TimerThreadProc();
+
+    const Parameters mParams;                                           ///< Copy of the parameters of the pool.
+    bool mRunning;                                                      ///< Used to signal the threads to terminate.
+    WorkerThread *mThreads;                                             ///< Array of worker threads.
+    Detail::Atomic::UInt32 mWaitingThreads;                             ///< Number of worker threads waiting for work.
+    Detail::Condition mWorkCondition;                                   ///< Condition on which idle worker threads wait.
+    Detail::Mutex mAttachLock;                                          ///< Serializes attaching, detaching and servicing timers.
+    Detail::Atomic::UInt32 mFrameworkCount;                             ///< Number of attached frameworks.
+    Detail::Atomic::UInt32 mSchedulerLimit;                             ///< One more than the highest index of an attached framework.
+    Detail::Atomic::Pointer<Detail::PoolScheduler> mSchedulers[MAX_FRAMEWORKS];     ///< Schedulers of the attached frameworks.
+    bool mTimerWoken;                                                   ///< Set when the timer thread is woken early.
+    Detail::Condition mTimerCondition;                                  ///< Condition on which the timer thread sleeps.
+    Detail::Thread mTimerThread;                                        ///< Thread that services the timers of the attached frameworks.
+};
+
+
+THERON_FORCEINLINE uint32_t WorkerPool::GetNumThreads() const
+{
+    return mParams.mThreadCount;
+}
+
+
+THERON_FORCEINLINE uint32_t WorkerPool::GetNumFrameworks() const
+{
+    return mFrameworkCount.Load();
+}
+
+
+THERON_FORCEINLINE void WorkerPool::Wake(const uint32_t count)
+{
+    // The caller has counted the pushed mailboxes with a full barrier, so either a thread that
+    // is about to wait sees the mailboxes or we see the thread waiting. Waiting threads hold the
+    // lock from before announcing themselves until they wait, so the pulses can't be missed.
+    const uint32_t waitingThreads(mWaitingThreads.Load());
+    if (waitingThreads)
+    {
+        const uint32_t wakeCount(count < waitingThreads ? count : waitingThreads);
+
+        Detail::Lock lock(mWorkCondition.GetMutex());
+        for (uint32_t wake = 0; wake < wakeCount; ++wake)
+        {
+            mWorkCondition.Pulse();
+        }
+    }
+}
+
+
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_WORKERPOOL_H
@@ -62,6 +62,12 @@ in combination with processor affinity masks, like YIELD_STRATEGY_SPIN. It's adv
 YIELD_STRATEGY_SPIN is that any other threads running on the same cores are less likely to
 be starved.
 
+YIELD_STRATEGY_PARK is an alternative to YIELD_STRATEGY_CONDITION that also blocks idle threads,
+but parks each thread on its own private futex (on Linux) rather than a shared condition variable.
+Threads pushing work only make a system call when a thread is actually parked, and then wake
+exactly one specific thread, preferring one recently run on the same NUMA node. This avoids the
+cost of signalling on every send, and the thundering herds caused by waking every waiting thread.
+
 When choosing a yield strategy it pays to consider how important low-latency responses are to your
 application. In most applications latencies of a few milliseconds are not significant, and the
 default strategy is a reasonable choice.
@@ -71,6 +77,7 @@ enum YieldStrategy
     YIELD_STRATEGY_CONDITION = 0,       ///< Threads wait on condition variables when no work is available.
     YIELD_STRATEGY_HYBRID,              ///< Threads spin for a while, then yield to other threads, when no work is available.
     YIELD_STRATEGY_SPIN,                ///< Threads busy-wait, without yielding, when no work is available.
+    YIELD_STRATEGY_PARK,                ///< Threads park on private futexes, woken individually, when no work is available.
 
     // Legacy section
     YIELD_STRATEGY_BLOCKING = 0,        ///< Deprecated - use YIELD_STRATEGY_CONDITION.
@@ -10,6 +10,8 @@
 
 #include <Theron/Theron.h>
 
+#include <Theron/Detail/Messages/MessageTypeId.h>
+#include <Theron/Detail/Threading/ProcessorTopology.h>
 #include <Theron/Detail/Threading/Utils.h>
 
 #include "TestFramework/TestSuite.h"
@@ -35,6 +37,7 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsStrategy);
         TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsPriorityOne);
         TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsPriorityMinusOne);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsSchedulerStrategy);
         TESTFRAMEWORK_REGISTER_TEST(ConstructActor);
         TESTFRAMEWORK_REGISTER_TEST(ConstructMultipleActors);
         TESTFRAMEWORK_REGISTER_TEST(ConstructAddress);
@@ -45,6 +48,21 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(RegisterHandler);
         TESTFRAMEWORK_REGISTER_TEST(SendHandledMessageInBlockingFramework);
         TESTFRAMEWORK_REGISTER_TEST(SendHandledMessageInNonBlockingFramework);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessageInQueueingFrameworks);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessageInPartitionedFramework);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessagesInPooledFrameworks);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessagesWithPinnedThreads);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessagesWithProcessorSets);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessagesInSchedulerGroups);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessageInParkingFramework);
+        TESTFRAMEWORK_REGISTER_TEST(SendToManyActorsInHandler);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesToActorsOfEachPriority);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesToBoundActors);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesToBlockingActors);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesAfterDelays);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesToBoundedMailboxes);
+        TESTFRAMEWORK_REGISTER_TEST(WaitForIdleFramework);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesByContinuation);
         TESTFRAMEWORK_REGISTER_TEST(CreateActorInFunction);
         TESTFRAMEWORK_REGISTER_TEST(SendMessageToReceiverInFunction);
         TESTFRAMEWORK_REGISTER_TEST(SendMessageFromNullAddressInFunction);
@@ -53,6 +71,10 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(ReceiveReplyInFunction);
         TESTFRAMEWORK_REGISTER_TEST(CatchReplyInFunction);
         TESTFRAMEWORK_REGISTER_TEST(SendNonPODMessageInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendMovedAndEmplacedMessages);
+        TESTFRAMEWORK_REGISTER_TEST(SendSharedValueToManyActors);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToManyAddresses);
+        TESTFRAMEWORK_REGISTER_TEST(PublishToAddressGroup);
         TESTFRAMEWORK_REGISTER_TEST(SendPointerMessageInFunction);
         TESTFRAMEWORK_REGISTER_TEST(SendConstPointerMessageInFunction);
         TESTFRAMEWORK_REGISTER_TEST(CreateDerivedActor);
@@ -61,7 +83,10 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(ActorTemplate);
         TESTFRAMEWORK_REGISTER_TEST(OneHandlerAtATime);
         TESTFRAMEWORK_REGISTER_TEST(MultipleHandlersForMessageType);
+        TESTFRAMEWORK_REGISTER_TEST(HandlersForManyMessageTypes);
+        TESTFRAMEWORK_REGISTER_TEST(GenerateMessageTypeIds);
         TESTFRAMEWORK_REGISTER_TEST(MessageArrivalOrder);
+        TESTFRAMEWORK_REGISTER_TEST(MessageArrivalOrderWithMessagesPerVisit);
         TESTFRAMEWORK_REGISTER_TEST(SendAddressAsMessage);
         TESTFRAMEWORK_REGISTER_TEST(SendMessageToDefaultHandlerInFunction);
         TESTFRAMEWORK_REGISTER_TEST(RegisterHandlerFromHandler);
@@ -76,6 +101,7 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(GetNumQueuedMessagesInFunction);
         TESTFRAMEWORK_REGISTER_TEST(UseBlindDefaultHandler);
         TESTFRAMEWORK_REGISTER_TEST(IsHandlerRegisteredInHandler);
+        TESTFRAMEWORK_REGISTER_TEST(DeregisterReceiverHandler);
         TESTFRAMEWORK_REGISTER_TEST(SetFallbackHandler);
         TESTFRAMEWORK_REGISTER_TEST(HandleUndeliveredMessageSentInFunction);
         TESTFRAMEWORK_REGISTER_TEST(HandleUnhandledMessageSentInFunction);
@@ -89,7 +115,9 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(MultipleFrameworks);
         TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkWithParameters);
         TESTFRAMEWORK_REGISTER_TEST(ThreadCountApi);
+        TESTFRAMEWORK_REGISTER_TEST(AutoScalingThreadCount);
         TESTFRAMEWORK_REGISTER_TEST(EventCounterApi);
+        TESTFRAMEWORK_REGISTER_TEST(PerNodeEventCounterApi);
         TESTFRAMEWORK_REGISTER_TEST(ConstructEndPoint);
         TESTFRAMEWORK_REGISTER_TEST(TieFrameworkToEndPoint);
         TESTFRAMEWORK_REGISTER_TEST(TieActorsToEndPoint);
@@ -152,6 +180,13 @@ public:
         Theron::Framework framework(params);
     }
 
+    inline static void ConstructFrameworkParamsSchedulerStrategy()
+    {
+        Theron::Framework::Parameters params(16, 0x1, 0xFFFF, Theron::YIELD_STRATEGY_CONDITION, 0.0f, Theron::SCHEDULER_STRATEGY_WORK_STEALING);
+        params.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_WORK_STEALING;
+        Theron::Framework framework(params);
+    }
+
     inline static void ConstructActor()
     {
         Theron::Framework framework;
@@ -178,81 +213,995 @@ public:
         const Theron::Address address(actor.GetAddress());
         const Theron::Address copied(address);
 
-        Check(address != Theron::Address::Null(), "Actor address should be null");
-        Check(copied != Theron::Address::Null(), "Copied actor address should be null");
-        Check(copied == address, "Address not copied correctly");
+        Check(address != Theron::Address::Null(), "Actor address should be null");
+        Check(copied != Theron::Address::Null(), "Copied actor address should be null");
+        Check(copied == address, "Address not copied correctly");
+    }
+
+    inline static void AssignAddress()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        const Theron::Address address(actor.GetAddress());
+        Theron::Address assigned;
+
+        Check(address != Theron::Address::Null(), "Actor address should be null");
+
+        assigned = address;
+        Check(assigned != Theron::Address::Null(), "Copied actor address should be null");
+        Check(assigned == address, "Address not copied correctly");
+    }
+
+    inline static void GetActorFramework()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        Theron::Framework &actorFramework(actor.GetFramework());
+        Check(&actorFramework == &framework, "Actor framework incorrect");
+    }
+
+    inline static void GetActorAddress()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        const Theron::Address address(actor.GetAddress());
+        Check(address != Theron::Address::Null(), "Actor address should not be null");
+    }
+
+    inline static void RegisterHandler()
+    {
+        Theron::Framework framework;
+        Registrar<int> actor(framework);
+    }
+
+    inline static void SendHandledMessageInBlockingFramework()
+    {
+        Theron::Framework::Parameters params;
+        params.mYieldStrategy = Theron::YIELD_STRATEGY_CONDITION;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+        Replier<int> actor(framework);
+
+        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(int(1), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(int(2), receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void SendHandledMessageInNonBlockingFramework()
+    {
+        Theron::Framework::Parameters params;
+        params.mYieldStrategy = Theron::YIELD_STRATEGY_HYBRID;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+        Replier<int> actor(framework);
+
+        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(int(1), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(int(2), receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void SendHandledMessageInQueueingFrameworks()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        // Scheduler strategies whose worker threads keep work pushed from within a thread local to it.
+        const Theron::SchedulerStrategy strategies[] =
+        {
+            Theron::SCHEDULER_STRATEGY_WORK_STEALING,
+            Theron::SCHEDULER_STRATEGY_NUMA
+        };
+
+        for (uint32_t strategyIndex = 0; strategyIndex < sizeof(strategies) / sizeof(strategies[0]); ++strategyIndex)
+        {
+            const Theron::SchedulerStrategy strategy(strategies[strategyIndex]);
+
+            Theron::Framework::Parameters blockingParams;
+            blockingParams.mSchedulerStrategy = strategy;
+
+            Theron::Framework::Parameters nonBlockingParams;
+            nonBlockingParams.mSchedulerStrategy = strategy;
+            nonBlockingParams.mYieldStrategy = Theron::YIELD_STRATEGY_HYBRID;
+
+            Theron::Framework blockingFramework(blockingParams);
+            Theron::Framework nonBlockingFramework(nonBlockingParams);
+
+            Theron::Receiver receiver;
+            IntCatcher catcher;
+            receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+            // Build chains of actors so that worker threads push work to their own queues or nodes.
+            Forwarder blockingActor0(blockingFramework, receiver.GetAddress());
+            Forwarder blockingActor1(blockingFramework, blockingActor0.GetAddress());
+            Forwarder blockingActor2(blockingFramework, blockingActor1.GetAddress());
+
+            Forwarder nonBlockingActor0(nonBlockingFramework, receiver.GetAddress());
+            Forwarder nonBlockingActor1(nonBlockingFramework, nonBlockingActor0.GetAddress());
+            Forwarder nonBlockingActor2(nonBlockingFramework, nonBlockingActor1.GetAddress());
+
+            for (int index = 0; index < 100; ++index)
+            {
+                blockingFramework.Send(index, receiver.GetAddress(), blockingActor2.GetAddress());
+                nonBlockingFramework.Send(index, receiver.GetAddress(), nonBlockingActor2.GetAddress());
+            }
+
+            uint32_t outstandingCount(200);
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+
+#if THERON_ENABLE_COUNTERS
+
+            Theron::Framework *const frameworks[2] = { &blockingFramework, &nonBlockingFramework };
+            for (uint32_t frameworkIndex = 0; frameworkIndex < 2; ++frameworkIndex)
+            {
+                Theron::Framework &framework(*frameworks[frameworkIndex]);
+
+                // Once the framework is idle every stolen mailbox has been popped, and so counted as processed.
+                // Only the message counts of the last visits may still be added, so later reads never go down.
+                Check(framework.WaitIdle(), "WaitIdle failed");
+
+                const uint32_t steals(framework.GetCounterValue(Theron::Detail::COUNTER_STEALS));
+                const uint32_t processedBefore(framework.GetCounterValue(Theron::Detail::COUNTER_MESSAGES_PROCESSED));
+
+                Check(processedBefore > 0, "Messages not counted as processed");
+
+                if (strategy == Theron::SCHEDULER_STRATEGY_WORK_STEALING)
+                {
+                    Check(steals <= processedBefore, "More mailboxes stolen than processed");
+                }
+
+                if (strategy == Theron::SCHEDULER_STRATEGY_NUMA)
+                {
+                    // Every node with worker threads should have an entry, and together they should
+                    // account for the messages processed by the framework.
+                    uint32_t counterValues[32];
+                    const uint32_t nodeCount(framework.GetPerNodeCounterValues(Theron::Detail::COUNTER_MESSAGES_PROCESSED, counterValues, 32));
+                    Check(nodeCount > 0, "GetPerNodeCounterValues failed");
+
+                    uint32_t messagesProcessed(0);
+                    for (uint32_t index = 0; index < nodeCount; ++index)
+                    {
+                        messagesProcessed += counterValues[index];
+                    }
+
+                    const uint32_t processedAfter(framework.GetCounterValue(Theron::Detail::COUNTER_MESSAGES_PROCESSED));
+                    Check(messagesProcessed >= processedBefore && messagesProcessed <= processedAfter, "GetPerNodeCounterValues failed");
+                }
+            }
+
+#endif // THERON_ENABLE_COUNTERS
+
+        }
+    }
+
+    inline static void SendHandledMessageInPartitionedFramework()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework::Parameters blockingParams(4);
+        blockingParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_PARTITIONED;
+
+        Theron::Framework::Parameters nonBlockingParams(4);
+        nonBlockingParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_PARTITIONED;
+        nonBlockingParams.mYieldStrategy = Theron::YIELD_STRATEGY_HYBRID;
+
+        Theron::Framework blockingFramework(blockingParams);
+        Theron::Framework nonBlockingFramework(nonBlockingParams);
+
+        // The threads own the partitions, so their number can't be changed.
+        blockingFramework.SetMaxThreads(1);
+        Check(blockingFramework.GetMaxThreads() == 4, "Partitioned thread count changed");
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        // Build chains of actors spanning all the partitions, so that worker threads push work
+        // both to their own queues and to the rings of other threads.
+        Forwarder blockingActor0(blockingFramework, receiver.GetAddress());
+        Forwarder blockingActor1(blockingFramework, blockingActor0.GetAddress());
+        Forwarder blockingActor2(blockingFramework, blockingActor1.GetAddress());
+        Forwarder blockingActor3(blockingFramework, blockingActor2.GetAddress());
+        Forwarder blockingActor4(blockingFramework, blockingActor3.GetAddress());
+
+        Forwarder nonBlockingActor0(nonBlockingFramework, receiver.GetAddress());
+        Forwarder nonBlockingActor1(nonBlockingFramework, nonBlockingActor0.GetAddress());
+        Forwarder nonBlockingActor2(nonBlockingFramework, nonBlockingActor1.GetAddress());
+        Forwarder nonBlockingActor3(nonBlockingFramework, nonBlockingActor2.GetAddress());
+        Forwarder nonBlockingActor4(nonBlockingFramework, nonBlockingActor3.GetAddress());
+
+        // Bound actors join the partition of their thread.
+        blockingActor2.SetWorkerThread(0);
+        nonBlockingActor2.SetWorkerThread(3);
+
+        for (int index = 0; index < 100; ++index)
+        {
+            blockingFramework.Send(index, receiver.GetAddress(), blockingActor4.GetAddress());
+            nonBlockingFramework.Send(index, receiver.GetAddress(), nonBlockingActor4.GetAddress());
+        }
+
+        uint32_t outstandingCount(200);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+    }
+
+    inline static void SendHandledMessagesInPooledFrameworks()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::WorkerPool pool(Theron::WorkerPool::Parameters(4));
+
+        Theron::Framework::Parameters heavyParams;
+        heavyParams.mWorkerPool = &pool;
+        heavyParams.mWorkerPoolWeight = 3;
+
+        Theron::Framework::Parameters lightParams;
+        lightParams.mWorkerPool = &pool;
+        lightParams.mContinuationDepth = 4;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        // A framework attached and detached again before the others frees its slot in the pool.
+        {
+            Theron::Framework transientFramework(heavyParams);
+            Forwarder transientActor(transientFramework, receiver.GetAddress());
+
+            Check(pool.GetNumFrameworks() == 1, "Framework not attached to pool");
+
+            transientFramework.SendAfter(0, receiver.GetAddress(), transientActor.GetAddress(), 10);
+            receiver.Wait();
+        }
+
+        Check(pool.GetNumFrameworks() == 0, "Framework not detached from pool");
+
+        Theron::Framework heavyFramework(heavyParams);
+        Theron::Framework lightFramework(lightParams);
+
+        Check(pool.GetNumFrameworks() == 2, "Frameworks not attached to pool");
+
+        // The threads belong to the pool, so their number can't be changed by the frameworks.
+        heavyFramework.SetMaxThreads(1);
+        Check(heavyFramework.GetNumThreads() == 4, "Pooled thread count wrong");
+        Check(heavyFramework.GetMaxThreads() == 4, "Pooled thread count changed");
+
+        // Build chains of actors that cross between the frameworks, so the pool's threads
+        // process the mailboxes of both in turn.
+        Forwarder heavyActor0(heavyFramework, receiver.GetAddress());
+        Forwarder lightActor0(lightFramework, heavyActor0.GetAddress());
+        Forwarder heavyActor1(heavyFramework, lightActor0.GetAddress());
+        Forwarder lightActor1(lightFramework, heavyActor1.GetAddress());
+
+        for (int index = 0; index < 100; ++index)
+        {
+            heavyFramework.Send(index, receiver.GetAddress(), lightActor1.GetAddress());
+            lightFramework.Send(index, receiver.GetAddress(), heavyActor1.GetAddress());
+        }
+
+        uint32_t outstandingCount(200);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        Check(heavyFramework.WaitIdle(), "Pooled framework not idle");
+        Check(lightFramework.WaitIdle(), "Pooled framework not idle");
+    }
+
+    inline static void SendHandledMessagesWithPinnedThreads()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        // The placement order, where available, names each usable processor once.
+        const uint32_t maxCount(Theron::Detail::ProcessorTopology::MAX_PROCESSORS);
+        std::vector<uint32_t> order(maxCount);
+        Theron::ProcessorSet reserved;
+        reserved.AddMask(0x1);
+        reserved.Add(40);
+
+        const uint32_t orderCount(Theron::Detail::ProcessorTopology::GetPlacementOrder(&order[0], maxCount, reserved, Theron::ProcessorSet()));
+
+        for (uint32_t first = 0; first < orderCount; ++first)
+        {
+            Check(!reserved.Contains(order[first]), "Reserved processor placed");
+            for (uint32_t second = first + 1; second < orderCount; ++second)
+            {
+                Check(order[first] != order[second], "Processor placed twice");
+            }
+        }
+
+        // More threads than processors, so the placement order wraps. Reserving every
+        // processor we might be given leaves the threads unpinned, which must also work.
+        Theron::Framework::Parameters pinnedParams(8);
+        pinnedParams.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+        pinnedParams.mReservedProcessorMask = 0x1;
+
+        Theron::Framework::Parameters reservedParams(2);
+        reservedParams.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+        reservedParams.mReservedProcessorMask = 0xFFFFFFFF;
+
+        // Strategies that place threads themselves keep pinned threads within their placement.
+        Theron::Framework::Parameters partitionedParams(4);
+        partitionedParams.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+        partitionedParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_PARTITIONED;
+
+        Theron::Framework::Parameters numaParams(4);
+        numaParams.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+        numaParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_NUMA;
+
+        Theron::WorkerPool::Parameters poolParams(4);
+        poolParams.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+        poolParams.mReservedProcessors = reserved;
+
+        Theron::WorkerPool pool(poolParams);
+
+        Theron::Framework::Parameters pooledParams;
+        pooledParams.mWorkerPool = &pool;
+
+        Theron::Framework pinnedFramework(pinnedParams);
+        Theron::Framework reservedFramework(reservedParams);
+        Theron::Framework partitionedFramework(partitionedParams);
+        Theron::Framework numaFramework(numaParams);
+        Theron::Framework pooledFramework(pooledParams);
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        Forwarder pooledActor(pooledFramework, receiver.GetAddress());
+        Forwarder numaActor(numaFramework, pooledActor.GetAddress());
+        Forwarder partitionedActor(partitionedFramework, numaActor.GetAddress());
+        Forwarder reservedActor(reservedFramework, partitionedActor.GetAddress());
+        Forwarder pinnedActor(pinnedFramework, reservedActor.GetAddress());
+
+        for (int index = 0; index < 100; ++index)
+        {
+            pinnedFramework.Send(index, receiver.GetAddress(), pinnedActor.GetAddress());
+        }
+
+        uint32_t outstandingCount(100);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // Threads started later, beyond the initial count, are pinned in turn too.
+        pinnedFramework.SetMinThreads(12);
+        pinnedFramework.Send(0, receiver.GetAddress(), pinnedActor.GetAddress());
+        receiver.Wait();
+
+        Check(pinnedFramework.WaitIdle(), "Pinned framework not idle");
+    }
+
+    inline static void SendHandledMessagesWithProcessorSets()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::ProcessorSet listed;
+        Check(listed.Empty(), "Default processor set not empty");
+        Check(listed.AddList("0-3,8,100-163"), "Processor list not parsed");
+        Check(listed.Count() == 69, "Processor set count wrong");
+        Check(listed.Contains(3) && listed.Contains(8) && listed.Contains(163), "Listed processor missing");
+        Check(!listed.Contains(4) && !listed.Contains(164), "Unlisted processor present");
+
+        Theron::ProcessorSet malformed;
+        Check(!malformed.AddList("0-3,x"), "Malformed processor list parsed");
+        Check(!malformed.AddList("5-2"), "Reversed processor range parsed");
+        Check(!malformed.AddList("1024"), "Processor beyond the maximum parsed");
+
+        Theron::ProcessorSet high;
+        high.AddRange(160, 200);
+        high.Add(0);
+        high.Intersect(listed);
+        Check(high.Count() == 5, "Processor set intersection wrong");
+
+        // Include the first processor, which always exists, and processors beyond the first 32,
+        // which typically don't here but must be accepted.
+        Theron::ProcessorSet processorSet;
+        processorSet.AddList("0,40-47,500");
+
+        Theron::Framework::Parameters sharedParams(4);
+        sharedParams.mProcessorSet = processorSet;
+
+        Theron::Framework::Parameters partitionedParams(4);
+        partitionedParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_PARTITIONED;
+        partitionedParams.mProcessorSet = processorSet;
+
+        Theron::Framework::Parameters pinnedParams(4);
+        pinnedParams.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+        pinnedParams.mProcessorSet = processorSet;
+
+        Theron::WorkerPool::Parameters poolParams(2);
+        poolParams.mProcessorSet = processorSet;
+
+        Theron::WorkerPool pool(poolParams);
+
+        Theron::Framework::Parameters pooledParams;
+        pooledParams.mWorkerPool = &pool;
+
+        Theron::Framework sharedFramework(sharedParams);
+        Theron::Framework partitionedFramework(partitionedParams);
+        Theron::Framework pinnedFramework(pinnedParams);
+        Theron::Framework pooledFramework(pooledParams);
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        Forwarder pooledActor(pooledFramework, receiver.GetAddress());
+        Forwarder pinnedActor(pinnedFramework, pooledActor.GetAddress());
+        Forwarder partitionedActor(partitionedFramework, pinnedActor.GetAddress());
+        Forwarder sharedActor(sharedFramework, partitionedActor.GetAddress());
+
+        for (int index = 0; index < 100; ++index)
+        {
+            sharedFramework.Send(index, receiver.GetAddress(), sharedActor.GetAddress());
+        }
+
+        uint32_t outstandingCount(100);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        Check(sharedFramework.WaitIdle(), "Framework not idle");
+    }
+
+    inline static void SendHandledMessagesInSchedulerGroups()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::ProcessorSet firstProcessor;
+        firstProcessor.Add(0);
+
+        // Pinned groups without their own processors are pinned after the main worker threads.
+        Theron::Framework::Parameters params(1);
+        params.mContinuationDepth = 4;
+        params.mThreadPlacement = Theron::THREAD_PLACEMENT_PINNED;
+
+        const uint32_t ingest(params.AddSchedulerGroup(Theron::Framework::SchedulerGroupParameters("ingest", 2, firstProcessor)));
+        const uint32_t analytics(params.AddSchedulerGroup(Theron::Framework::SchedulerGroupParameters("analytics", 3)));
+
+        Check(ingest == 1 && analytics == 2, "Scheduler groups numbered wrongly");
+
+        Theron::Framework framework(params);
+
+        Check(framework.GetNumSchedulerGroups() == 2, "Scheduler group count wrong");
+        Check(framework.GetSchedulerGroup("analytics") == analytics, "Scheduler group not found by name");
+        Check(framework.GetSchedulerGroup("reporting") == 0, "Unknown scheduler group found by name");
+        Check(framework.GetNumSchedulerGroupThreads(0) == 1, "Default group thread count wrong");
+        Check(framework.GetNumSchedulerGroupThreads(ingest) == 2, "Scheduler group thread count wrong");
+        Check(framework.GetNumSchedulerGroupThreads(analytics) == 3, "Scheduler group thread count wrong");
+        Check(framework.GetNumSchedulerGroupThreads(3) == 0, "Unknown scheduler group has threads");
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        Forwarder analyticsActor(framework, receiver.GetAddress(), analytics);
+        Forwarder ingestActor(framework, analyticsActor.GetAddress(), ingest);
+        Forwarder defaultActor(framework, ingestActor.GetAddress());
+
+        Check(ingestActor.GetSchedulerGroup() == ingest, "Actor not assigned to scheduler group");
+        Check(defaultActor.GetSchedulerGroup() == 0, "Actor not assigned to default group");
+
+        // Hold the framework's only main worker thread. The groups have their own threads,
+        // so messages sent between actors in the groups are still processed.
+        Gate gate(framework, receiver.GetAddress());
+        framework.Send(0, receiver.GetAddress(), gate.GetAddress());
+
+        while (!gate.mEntered)
+        {
+            Theron::Detail::Utils::SleepThread(1);
+        }
+
+        for (int index = 0; index < 100; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), ingestActor.GetAddress());
+        }
+
+        uint32_t outstandingCount(100);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        gate.mOpen = true;
+        receiver.Wait();
+
+        // Chains crossing all the groups, with continuations, are processed in turn by each.
+        for (int index = 0; index < 100; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), defaultActor.GetAddress());
+        }
+
+        outstandingCount = 100;
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        Check(framework.WaitIdle(), "Framework not idle");
+    }
+
+    inline static void SendHandledMessageInParkingFramework()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework::Parameters sharedParams;
+        sharedParams.mYieldStrategy = Theron::YIELD_STRATEGY_PARK;
+
+        Theron::Framework::Parameters workStealingParams;
+        workStealingParams.mYieldStrategy = Theron::YIELD_STRATEGY_PARK;
+        workStealingParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_WORK_STEALING;
+
+        Theron::Framework::Parameters numaParams;
+        numaParams.mYieldStrategy = Theron::YIELD_STRATEGY_PARK;
+        numaParams.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_NUMA;
+
+        Theron::Framework sharedFramework(sharedParams);
+        Theron::Framework workStealingFramework(workStealingParams);
+        Theron::Framework numaFramework(numaParams);
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        // Build chains of actors so that parked worker threads are repeatedly woken.
+        Forwarder sharedActor0(sharedFramework, receiver.GetAddress());
+        Forwarder sharedActor1(sharedFramework, sharedActor0.GetAddress());
+
+        Forwarder workStealingActor0(workStealingFramework, receiver.GetAddress());
+        Forwarder workStealingActor1(workStealingFramework, workStealingActor0.GetAddress());
+
+        Forwarder numaActor0(numaFramework, receiver.GetAddress());
+        Forwarder numaActor1(numaFramework, numaActor0.GetAddress());
+
+        for (int index = 0; index < 100; ++index)
+        {
+            sharedFramework.Send(index, receiver.GetAddress(), sharedActor1.GetAddress());
+            workStealingFramework.Send(index, receiver.GetAddress(), workStealingActor1.GetAddress());
+            numaFramework.Send(index, receiver.GetAddress(), numaActor1.GetAddress());
+        }
+
+        uint32_t outstandingCount(300);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+    }
+
+    inline static void SendToManyActorsInHandler()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework::Parameters singleParams;
+        singleParams.mThreadCount = 1;
+
+        Theron::Framework singleFramework(singleParams);
+        Theron::Framework multiFramework;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        // Fan out to more actors than fit in the local queue of a worker thread.
+        Broadcaster singleBroadcaster(singleFramework);
+        Broadcaster multiBroadcaster(multiFramework);
+
+        Forwarder *singleForwarders[Broadcaster::MAX_TARGETS];
+        Forwarder *multiForwarders[Broadcaster::MAX_TARGETS];
+
+        for (Theron::uint32_t index = 0; index < Broadcaster::MAX_TARGETS; ++index)
+        {
+            singleForwarders[index] = new Forwarder(singleFramework, receiver.GetAddress());
+            multiForwarders[index] = new Forwarder(multiFramework, receiver.GetAddress());
+
+            singleFramework.Send(singleForwarders[index]->GetAddress(), receiver.GetAddress(), singleBroadcaster.GetAddress());
+            multiFramework.Send(multiForwarders[index]->GetAddress(), receiver.GetAddress(), multiBroadcaster.GetAddress());
+        }
+
+        for (int index = 0; index < 10; ++index)
+        {
+            singleFramework.Send(index, receiver.GetAddress(), singleBroadcaster.GetAddress());
+            multiFramework.Send(index, receiver.GetAddress(), multiBroadcaster.GetAddress());
+        }
+
+        uint32_t outstandingCount(2 * 10 * Broadcaster::MAX_TARGETS);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        for (Theron::uint32_t index = 0; index < Broadcaster::MAX_TARGETS; ++index)
+        {
+            delete singleForwarders[index];
+            delete multiForwarders[index];
+        }
+    }
+
+    inline static void SendMessagesToActorsOfEachPriority()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        IntReplier lowReplier(framework, 0, Theron::ACTOR_PRIORITY_LOW);
+        IntReplier normalReplier(framework);
+        IntReplier highReplier(framework, 0, Theron::ACTOR_PRIORITY_HIGH);
+
+        Check(lowReplier.GetPriority() == Theron::ACTOR_PRIORITY_LOW, "GetPriority failed");
+        Check(normalReplier.GetPriority() == Theron::ACTOR_PRIORITY_NORMAL, "GetPriority failed");
+        Check(highReplier.GetPriority() == Theron::ACTOR_PRIORITY_HIGH, "GetPriority failed");
+
+        // Lower priority actors must still be served while higher priority actors are busy.
+        for (int index = 0; index < 100; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), lowReplier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), normalReplier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), highReplier.GetAddress());
+        }
+
+        uint32_t outstandingCount(300);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // Changing the priority at runtime takes effect on the next send.
+        lowReplier.SetPriority(Theron::ACTOR_PRIORITY_HIGH);
+        Check(lowReplier.GetPriority() == Theron::ACTOR_PRIORITY_HIGH, "SetPriority failed");
+
+        framework.Send(int(0), receiver.GetAddress(), lowReplier.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void SendMessagesToBoundActors()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework(2);
+        Theron::Receiver receiver;
+
+        IntReplier firstReplier(framework);
+        IntReplier secondReplier(framework);
+        IntReplier strayReplier(framework);
+
+        Check(firstReplier.GetWorkerThread() == Theron::Actor::ANY_WORKER_THREAD, "GetWorkerThread failed");
+
+        firstReplier.SetWorkerThread(0);
+        secondReplier.SetWorkerThread(1);
+
+        // Binding to a worker thread that doesn't exist leaves the actor effectively unbound.
+        strayReplier.SetWorkerThread(99);
+
+        Check(firstReplier.GetWorkerThread() == 0, "SetWorkerThread failed");
+        Check(secondReplier.GetWorkerThread() == 1, "SetWorkerThread failed");
+
+        // A forwarder bound to one thread sends to a forwarder bound to the other, via its inbox.
+        Forwarder secondForwarder(framework, receiver.GetAddress());
+        Forwarder firstForwarder(framework, secondForwarder.GetAddress());
+
+        firstForwarder.SetWorkerThread(0);
+        secondForwarder.SetWorkerThread(1);
+
+        for (int index = 0; index < 100; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), firstReplier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), secondReplier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), strayReplier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), firstForwarder.GetAddress());
+        }
+
+        uint32_t outstandingCount(400);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        firstReplier.SetWorkerThread(Theron::Actor::ANY_WORKER_THREAD);
+        Check(firstReplier.GetWorkerThread() == Theron::Actor::ANY_WORKER_THREAD, "SetWorkerThread failed");
+
+        framework.Send(int(0), receiver.GetAddress(), firstReplier.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void SendMessagesToBlockingActors()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework::Parameters params;
+        params.mThreadCount = 2;
+        params.mBlockingThreadCount = 4;
+
+        Theron::Framework framework(params);
+        Theron::Framework plainFramework(2);
+        Theron::Receiver receiver;
+
+        Check(framework.GetMaxBlockingThreads() == 4, "GetMaxBlockingThreads failed");
+        Check(framework.GetNumBlockingThreads() > 0, "GetNumBlockingThreads failed");
+        Check(plainFramework.GetNumBlockingThreads() == 0, "GetNumBlockingThreads failed");
+
+        IntReplier blockingReplier(framework);
+        IntReplier replier(framework);
+        IntReplier plainReplier(plainFramework);
+
+        Check(blockingReplier.IsBlocking() == false, "IsBlocking failed");
+
+        blockingReplier.SetBlocking(true);
+
+        // Actors marked as blocking in frameworks without blocking threads are processed as normal.
+        plainReplier.SetBlocking(true);
+
+        Check(blockingReplier.IsBlocking(), "SetBlocking failed");
+
+        // Messages pass from the main worker threads to the blocking threads and back again.
+        Forwarder lastForwarder(framework, receiver.GetAddress());
+        Forwarder blockingForwarder(framework, lastForwarder.GetAddress());
+        Forwarder firstForwarder(framework, blockingForwarder.GetAddress());
+        blockingForwarder.SetBlocking(true);
+
+        for (int index = 0; index < 100; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), blockingReplier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), replier.GetAddress());
+            framework.Send(index, receiver.GetAddress(), firstForwarder.GetAddress());
+            plainFramework.Send(index, receiver.GetAddress(), plainReplier.GetAddress());
+        }
+
+        uint32_t outstandingCount(400);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        blockingReplier.SetBlocking(false);
+        Check(blockingReplier.IsBlocking() == false, "SetBlocking failed");
+    }
+
+    inline static void SendMessagesAfterDelays()
+    {
+        typedef DelayedReplier<int> IntDelayedReplier;
+
+        Theron::Receiver receiver;
+
+        {
+            Theron::Framework framework(2);
+            IntDelayedReplier replier(framework);
+
+            // Many one-shot timers with a spread of delays, some of them started by an actor.
+            for (int index = 0; index < 1000; ++index)
+            {
+                Check(framework.SendAfter(index, receiver.GetAddress(), receiver.GetAddress(), index % 50) != 0, "SendAfter failed");
+                framework.Send(index, receiver.GetAddress(), replier.GetAddress());
+            }
+
+            uint32_t outstandingCount(2000);
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+
+            // A pending timer can be cancelled once only, and its message isn't sent.
+            const uint32_t timer(framework.SendAfter(0, receiver.GetAddress(), receiver.GetAddress(), 100000));
+            Check(framework.CancelTimer(timer), "CancelTimer failed");
+            Check(framework.CancelTimer(timer) == false, "CancelTimer failed");
+
+            // A periodic timer keeps sending until it's cancelled.
+            const uint32_t periodicTimer(framework.SendEvery(0, receiver.GetAddress(), receiver.GetAddress(), 2));
+            Check(periodicTimer != 0, "SendEvery failed");
+
+            outstandingCount = 3;
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+
+            Check(framework.CancelTimer(periodicTimer), "CancelTimer failed");
+
+            // Timers still pending when the framework is destroyed are discarded.
+            framework.SendAfter(0, receiver.GetAddress(), receiver.GetAddress(), 100000);
+        }
+
+        // Any message of the periodic timer sent before it was cancelled is consumed.
+        if (const uint32_t count = receiver.Count())
+        {
+            receiver.Consume(count);
+        }
+    }
+
+    inline static void SendMessagesToBoundedMailboxes()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        const Theron::OverflowPolicy policies[4] =
+        {
+            Theron::OVERFLOW_POLICY_REJECT,
+            Theron::OVERFLOW_POLICY_DROP_OLDEST,
+            Theron::OVERFLOW_POLICY_DROP_NEWEST,
+            Theron::OVERFLOW_POLICY_FALLBACK
+        };
+
+        // Whether sends to a full mailbox succeed, and the last message received, with each policy.
+        const bool accepted[4] = { false, true, true, false };
+        const int lastMessages[4] = { 3, 6, 3, 3 };
+
+        for (Theron::uint32_t index = 0; index < 4; ++index)
+        {
+            Theron::Framework framework(1);
+            Theron::Receiver receiver;
+            IntCatcher catcher;
+            FallbackHandler fallbackHandler;
+
+            receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+            framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+            Gate gate(framework, receiver.GetAddress());
+            Check(gate.GetMailboxCapacity() == 0, "GetMailboxCapacity failed");
+
+            gate.SetMailboxCapacity(4, policies[index]);
+            Check(gate.GetMailboxCapacity() == 4, "SetMailboxCapacity failed");
+            Check(gate.GetOverflowPolicy() == policies[index], "SetMailboxCapacity failed");
+
+            // The gate holds on to the first message while its mailbox fills up.
+            framework.Send(0, receiver.GetAddress(), gate.GetAddress());
+            while (!gate.mEntered)
+            {
+                Theron::Detail::Utils::SleepThread(1);
+            }
+
+            for (int message = 1; message <= 3; ++message)
+            {
+                Check(framework.Send(message, receiver.GetAddress(), gate.GetAddress()), "Send failed");
+            }
+
+            Check(framework.GetMailboxPressure(gate.GetAddress()) == 100, "GetMailboxPressure failed");
+            Check(framework.GetMailboxPressure(receiver.GetAddress()) == 0, "GetMailboxPressure failed");
+
+            for (int message = 4; message <= 6; ++message)
+            {
+                Check(framework.Send(message, receiver.GetAddress(), gate.GetAddress()) == accepted[index], "Overflow policy failed");
+            }
+
+            gate.mOpen = true;
+
+            // Only the first message and three others are ever delivered.
+            uint32_t outstandingCount(4);
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+
+            Check(catcher.mMessage == lastMessages[index], "Overflow policy failed");
+
+            if (policies[index] == Theron::OVERFLOW_POLICY_FALLBACK)
+            {
+                Check(fallbackHandler.mAddress == receiver.GetAddress(), "Overflow policy failed");
+            }
+        }
     }
 
-    inline static void AssignAddress()
+    inline static void WaitForIdleFramework()
     {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        const Theron::Address address(actor.GetAddress());
-        Theron::Address assigned;
+        // A framework with no actors is idle straight away.
+        {
+            Theron::Framework framework(2);
+            Check(framework.WaitIdle(0), "WaitIdle failed");
+        }
 
-        Check(address != Theron::Address::Null(), "Actor address should be null");
+        // Actors that send messages to themselves keep the framework busy until they stop.
+        {
+            Theron::Framework framework(2);
+            Countdown countdownA(framework);
+            Countdown countdownB(framework);
+            Countdown *const countdowns[2] = { &countdownA, &countdownB };
 
-        assigned = address;
-        Check(assigned != Theron::Address::Null(), "Copied actor address should be null");
-        Check(assigned == address, "Address not copied correctly");
-    }
+            for (Theron::uint32_t index = 0; index < 2; ++index)
+            {
+                framework.Send(1000, Theron::Address::Null(), countdowns[index]->GetAddress());
+            }
 
-    inline static void GetActorFramework()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        Theron::Framework &actorFramework(actor.GetFramework());
-        Check(&actorFramework == &framework, "Actor framework incorrect");
-    }
+            Check(framework.WaitIdle(), "WaitIdle failed");
 
-    inline static void GetActorAddress()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        const Theron::Address address(actor.GetAddress());
-        Check(address != Theron::Address::Null(), "Actor address should not be null");
-    }
+            for (Theron::uint32_t index = 0; index < 2; ++index)
+            {
+                Check(countdowns[index]->mCount == 1001, "WaitIdle returned before the framework was idle");
+            }
+        }
 
-    inline static void RegisterHandler()
-    {
-        Theron::Framework framework;
-        Registrar<int> actor(framework);
-    }
+        // A message held by an actor keeps the framework busy until the wait times out.
+        {
+            Theron::Framework framework(1);
+            Theron::Receiver receiver;
+            Gate gate(framework, receiver.GetAddress());
 
-    inline static void SendHandledMessageInBlockingFramework()
-    {
-        Theron::Framework::Parameters params;
-        params.mYieldStrategy = Theron::YIELD_STRATEGY_CONDITION;
+            framework.Send(0, receiver.GetAddress(), gate.GetAddress());
+            while (!gate.mEntered)
+            {
+                Theron::Detail::Utils::SleepThread(1);
+            }
 
-        Theron::Framework framework(params);
-        Theron::Receiver receiver;
-        Replier<int> actor(framework);
+            Check(!framework.WaitIdle(10), "WaitIdle returned while a message was being processed");
 
-        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
-        framework.Send(int(1), receiver.GetAddress(), actor.GetAddress());
-        framework.Send(int(2), receiver.GetAddress(), actor.GetAddress());
+            gate.mOpen = true;
+            Check(framework.WaitIdle(), "WaitIdle failed");
 
-        receiver.Wait();
-        receiver.Wait();
-        receiver.Wait();
+            receiver.Wait();
+        }
     }
 
-    inline static void SendHandledMessageInNonBlockingFramework()
+    inline static void SendMessagesByContinuation()
     {
-        Theron::Framework::Parameters params;
-        params.mYieldStrategy = Theron::YIELD_STRATEGY_HYBRID;
+        typedef Catcher<int> IntCatcher;
+        typedef Catcher<const char *> StringCatcher;
+        typedef Sequencer<int> IntSequencer;
 
+        Theron::Framework::Parameters params(2);
+        params.mContinuationDepth = 4;
         Theron::Framework framework(params);
-        Theron::Receiver receiver;
-        Replier<int> actor(framework);
 
-        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
-        framework.Send(int(1), receiver.GetAddress(), actor.GetAddress());
-        framework.Send(int(2), receiver.GetAddress(), actor.GetAddress());
+        // A chain of actors longer than the continuation depth passes a message all the way along.
+        {
+            Theron::Receiver receiver;
+            IntCatcher catcher;
+            receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
 
-        receiver.Wait();
-        receiver.Wait();
-        receiver.Wait();
+            Forwarder forwarder0(framework, receiver.GetAddress());
+            Forwarder forwarder1(framework, forwarder0.GetAddress());
+            Forwarder forwarder2(framework, forwarder1.GetAddress());
+            Forwarder forwarder3(framework, forwarder2.GetAddress());
+            Forwarder forwarder4(framework, forwarder3.GetAddress());
+            Forwarder forwarder5(framework, forwarder4.GetAddress());
+            Forwarder forwarder6(framework, forwarder5.GetAddress());
+            Forwarder forwarder7(framework, forwarder6.GetAddress());
+
+            framework.Send(8, receiver.GetAddress(), forwarder7.GetAddress());
+            receiver.Wait();
+
+            Check(catcher.mMessage == 0, "Message passed by continuation incorrectly");
+        }
+
+        // Each message sent to one of two actors in turn claims it as a continuation, displacing
+        // the other, and the messages received by each actor still arrive in order.
+        {
+            Theron::Receiver receiver;
+            StringCatcher catcher;
+            receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+
+            IntSequencer sequencerA(framework);
+            IntSequencer sequencerB(framework);
+            Alternator alternator(framework, sequencerA.GetAddress(), sequencerB.GetAddress());
+
+            for (int count = 0; count < 10; ++count)
+            {
+                framework.Send(8, receiver.GetAddress(), alternator.GetAddress());
+            }
+
+            Check(framework.WaitIdle(), "WaitIdle failed");
+
+            framework.Send(true, receiver.GetAddress(), sequencerA.GetAddress());
+            receiver.Wait();
+            Check(catcher.mMessage == IntSequencer::GOOD, "Message arrival order wrong with continuations");
+
+            framework.Send(true, receiver.GetAddress(), sequencerB.GetAddress());
+            receiver.Wait();
+            Check(catcher.mMessage == IntSequencer::GOOD, "Message arrival order wrong with continuations");
+        }
     }
 
     inline static void CreateActorInFunction()
@@ -355,6 +1304,211 @@ public:
         Check(catcher.mMessage == vectorMessage, "Reply message is wrong");
     }
 
+    inline static void SendMovedAndEmplacedMessages()
+    {
+#if THERON_CPP11
+        typedef Catcher<std::string> StringCatcher;
+
+        Theron::Framework framework;
+        BufferSummer actor(framework);
+
+        Theron::Receiver receiver;
+        StringCatcher catcher;
+        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+
+        // The actor replies with a string as long as the buffer, unless the buffer was copied.
+        TrackedBuffer buffer(100);
+        Check(framework.Send(std::move(buffer), receiver.GetAddress(), actor.GetAddress()), "Send failed");
+
+        receiver.Wait();
+        Check(catcher.mMessage == std::string(100, 'x'), "Moved message was copied");
+
+        Check(framework.Emplace<TrackedBuffer>(receiver.GetAddress(), actor.GetAddress(), 50u), "Emplace failed");
+
+        receiver.Wait();
+        Check(catcher.mMessage == std::string(50, 'x'), "Emplaced message was copied");
+
+        // Const values are still copied.
+        const TrackedBuffer constBuffer(10);
+        framework.Send(constBuffer, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.mMessage.empty(), "Const message not copied");
+#endif // THERON_CPP11
+    }
+
+    inline static void SendSharedValueToManyActors()
+    {
+        typedef const IntVectorMessage *LocationMessage;
+        typedef Catcher<LocationMessage> LocationCatcher;
+
+        static const Theron::uint32_t ACTOR_COUNT = 8;
+
+        Theron::Framework framework;
+        ValueLocator *actors[ACTOR_COUNT];
+
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            actors[index] = new ValueLocator(framework);
+        }
+
+        Theron::Receiver receiver;
+        LocationCatcher catcher;
+        receiver.RegisterHandler(&catcher, &LocationCatcher::Catch);
+
+        IntVectorMessage values(1000, 5);
+        Theron::SharedValue<IntVectorMessage> shared(values);
+
+        Check(!shared.IsNull(), "Shared value is null");
+        Check(&shared.Value() != &values, "Shared value not copied");
+
+        // Each actor replies with the location of the value it received, which is the shared copy.
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            Check(framework.Send(shared, receiver.GetAddress(), actors[index]->GetAddress()), "Send failed");
+        }
+
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            receiver.Wait();
+            Check(catcher.mMessage == &shared.Value(), "Shared value was copied");
+        }
+
+        // Copies of the shared value reference the same value; null values can't be sent.
+        Theron::SharedValue<IntVectorMessage> copy;
+        Check(copy.IsNull(), "Default-constructed shared value not null");
+        Check(!framework.Send(copy, receiver.GetAddress(), actors[0]->GetAddress()), "Sent null shared value");
+
+        copy = shared;
+        Check(&copy.Value() == &shared.Value(), "Copied shared value has a different value");
+
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            delete actors[index];
+        }
+    }
+
+    inline static void SendMessageToManyAddresses()
+    {
+        typedef const IntVectorMessage *LocationMessage;
+        typedef Catcher<LocationMessage> LocationCatcher;
+
+        // More actors than are scheduled in a single batch.
+        static const Theron::uint32_t ACTOR_COUNT = 40;
+
+        Theron::Framework framework;
+        ValueLocator *actors[ACTOR_COUNT];
+        Theron::Address addresses[ACTOR_COUNT];
+
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            actors[index] = new ValueLocator(framework);
+            addresses[index] = actors[index]->GetAddress();
+        }
+
+        Theron::Receiver receiver;
+        LocationCatcher catcher;
+        receiver.RegisterHandler(&catcher, &LocationCatcher::Catch);
+
+        const IntVectorMessage values(100, 3);
+        const Theron::uint32_t sent(framework.Send(values, receiver.GetAddress(), addresses, addresses + ACTOR_COUNT));
+        Check(sent == ACTOR_COUNT, "Multicast message not delivered to all addresses");
+
+        // Every actor receives the same copy of the value.
+        LocationMessage location(0);
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            receiver.Wait();
+
+            Check(catcher.mMessage != &values, "Multicast message not copied");
+            Check(location == 0 || catcher.mMessage == location, "Multicast message copied more than once");
+            location = catcher.mMessage;
+        }
+
+        // Messages to single addresses, empty ranges and groups are sent too.
+        Check(framework.Send(values, receiver.GetAddress(), addresses, addresses + 1) == 1, "Multicast to one address failed");
+        receiver.Wait();
+
+        Check(framework.Send(values, receiver.GetAddress(), addresses, addresses) == 0, "Multicast to no addresses sent");
+
+        Theron::AddressGroup group;
+        group.Add(addresses[0]);
+        group.Add(addresses[1]);
+        group.Add(addresses[2]);
+
+        Check(group.Count() == 3, "Address group count wrong");
+        Check(group.Remove(addresses[1]), "Address group remove failed");
+        Check(!group.Contains(addresses[1]), "Address group contains removed address");
+        Check(*group.Begin() == addresses[0] && *(group.End() - 1) == addresses[2], "Address group order wrong");
+
+        Check(framework.Send(values, receiver.GetAddress(), group) == 2, "Multicast to group failed");
+        receiver.Wait(2);
+
+        for (Theron::uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            delete actors[index];
+        }
+    }
+
+    inline static void PublishToAddressGroup()
+    {
+        typedef const IntVectorMessage *LocationMessage;
+        typedef Catcher<LocationMessage> LocationCatcher;
+
+        static const Theron::uint32_t SUBSCRIBER_COUNT = 20;
+        static const Theron::uint32_t SETUP_COUNT = 5;
+
+        Theron::WorkerPool pool(Theron::WorkerPool::Parameters(4));
+
+        // Publish with each scheduling strategy, whose queues each push batches their own way.
+        for (Theron::uint32_t setup = 0; setup < SETUP_COUNT; ++setup)
+        {
+            Theron::Framework::Parameters params(4);
+            if (setup < 4)
+            {
+                params.mSchedulerStrategy = static_cast<Theron::SchedulerStrategy>(setup);
+            }
+            else
+            {
+                params.mWorkerPool = &pool;
+            }
+
+            Theron::Framework framework(params);
+
+            Theron::Receiver receiver;
+            LocationCatcher catcher;
+            receiver.RegisterHandler(&catcher, &LocationCatcher::Catch);
+
+            Publisher publisher(framework, receiver.GetAddress());
+            ValueLocator *subscribers[SUBSCRIBER_COUNT];
+
+            for (Theron::uint32_t index = 0; index < SUBSCRIBER_COUNT; ++index)
+            {
+                subscribers[index] = new ValueLocator(framework);
+                framework.Send(subscribers[index]->GetAddress(), receiver.GetAddress(), publisher.GetAddress());
+            }
+
+            framework.Send(IntVectorMessage(10, 1), receiver.GetAddress(), publisher.GetAddress());
+
+            // The subscribers report the location of the value they received, via the publisher.
+            LocationMessage location(0);
+            for (Theron::uint32_t index = 0; index < SUBSCRIBER_COUNT; ++index)
+            {
+                receiver.Wait();
+
+                Check(location == 0 || catcher.mMessage == location, "Published message copied more than once");
+                location = catcher.mMessage;
+            }
+
+            Check(publisher.mPublishedCount == SUBSCRIBER_COUNT, "Published message not delivered to all subscribers");
+
+            for (Theron::uint32_t index = 0; index < SUBSCRIBER_COUNT; ++index)
+            {
+                delete subscribers[index];
+            }
+        }
+    }
+
     inline static void SendPointerMessageInFunction()
     {
         typedef float * PointerMessage;
@@ -513,6 +1667,49 @@ public:
         Check(catcher.mMessage == 9, "Count is wrong");
     }
 
+    inline static void HandlersForManyMessageTypes()
+    {
+        typedef Catcher<int> CountCatcher;
+
+        Theron::Framework framework;
+        TypeSorter actor(framework);
+
+        Theron::Receiver receiver;
+        CountCatcher catcher;
+        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
+
+        // Each handled type adds a different digit, as does the unhandled unsigned int.
+        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(float(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(double(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(char(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(0u, receiver.GetAddress(), actor.GetAddress());
+
+        // Get the total, which also deregisters the second int handler.
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.mMessage == 111111, "Total is wrong");
+
+        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.mMessage == 111112, "Deregistered handler was executed");
+    }
+
+    inline static void GenerateMessageTypeIds()
+    {
+        const uint32_t intId(Theron::Detail::MessageTypeId<int>::Get());
+        const uint32_t floatId(Theron::Detail::MessageTypeId<float>::Get());
+        const uint32_t stringId(Theron::Detail::MessageTypeId<std::string>::Get());
+
+        Check(intId != 0 && floatId != 0 && stringId != 0, "Type ID not allocated");
+        Check(intId != floatId && intId != stringId && floatId != stringId, "Type IDs not unique");
+        Check(Theron::Detail::MessageTypeId<int>::Get() == intId, "Type ID not stable");
+        Check(Theron::Detail::MessageTypeId<unsigned int>::Get() != intId, "Type ID shared by different types");
+    }
+
     inline static void MessageArrivalOrder()
     {
         typedef Catcher<const char *> StringCatcher;
@@ -549,6 +1746,44 @@ public:
         Check(catcher.mMessage == IntSequencer::BAD, "Sequencer status is wrong");
     }
 
+    inline static void MessageArrivalOrderWithMessagesPerVisit()
+    {
+        typedef Catcher<const char *> StringCatcher;
+        typedef Catcher<Theron::uint32_t> CountCatcher;
+        typedef Sequencer<int> IntSequencer;
+
+        Theron::Framework::Parameters params;
+        params.mMessagesPerVisit = 4;
+
+        Theron::Framework framework(params);
+        IntSequencer actor(framework);
+        MessageQueueCounter counter(framework);
+
+        Theron::Receiver receiver;
+        StringCatcher catcher;
+        CountCatcher countCatcher;
+        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+        receiver.RegisterHandler(&countCatcher, &CountCatcher::Catch);
+
+        // Send enough messages that the actor is visited more than once.
+        for (int index = 0; index < 10; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), actor.GetAddress());
+        }
+
+        // Get the validity value.
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.mMessage == IntSequencer::GOOD, "Sequencer status is wrong");
+
+        // The queued message count still includes the message being processed.
+        framework.Send(0, receiver.GetAddress(), counter.GetAddress());
+
+        receiver.Wait();
+        Check(countCatcher.mMessage == 1, "GetNumQueuedMessages failed");
+    }
+
     inline static void SendAddressAsMessage()
     {
         typedef Catcher<Theron::Address> AddressCatcher;
@@ -833,15 +2068,38 @@ public:
         Check(accumulator.Pop() == true, "Bad registration check result 13");
         Check(accumulator.Pop() == false, "Bad registration check result 14");
 
-        // DeregisterHandler(this, &HandlerChecker::Check);
-        Check(accumulator.Pop() == true, "Bad registration check result 15");
-        Check(accumulator.Pop() == true, "Bad registration check result 16");
-        Check(accumulator.Pop() == false, "Bad registration check result 17");
+        // DeregisterHandler(this, &HandlerChecker::Check);
+        Check(accumulator.Pop() == true, "Bad registration check result 15");
+        Check(accumulator.Pop() == true, "Bad registration check result 16");
+        Check(accumulator.Pop() == false, "Bad registration check result 17");
+
+        // DeregisterHandler(this, &HandlerChecker::Check);
+        Check(accumulator.Pop() == false, "Bad registration check result 18");
+        Check(accumulator.Pop() == true, "Bad registration check result 19");
+        Check(accumulator.Pop() == false, "Bad registration check result 20");
+    }
+
+    inline static void DeregisterReceiverHandler()
+    {
+        typedef Catcher<int> IntCatcher;
+        typedef Accumulator<int> IntAccumulator;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        IntCatcher catcher;
+        IntAccumulator accumulator;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+        receiver.RegisterHandler(&accumulator, &IntAccumulator::Catch);
+
+        // The handlers accept the same message type, so are told apart by object type.
+        receiver.DeregisterHandler(&accumulator, &IntAccumulator::Catch);
 
-        // DeregisterHandler(this, &HandlerChecker::Check);
-        Check(accumulator.Pop() == false, "Bad registration check result 18");
-        Check(accumulator.Pop() == true, "Bad registration check result 19");
-        Check(accumulator.Pop() == false, "Bad registration check result 20");
+        framework.Send(int(5), receiver.GetAddress(), receiver.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.mMessage == 5, "Remaining handler not called");
+        Check(accumulator.Size() == 0, "Deregistered handler called");
     }
 
     inline static void SetFallbackHandler()
@@ -1175,6 +2433,66 @@ public:
         Check(framework.GetPeakThreads() >= framework.GetNumThreads(), "GetPeakThreads failed");
     }
 
+    inline static void AutoScalingThreadCount()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework::Parameters params(2);
+        params.mAutoScaling = true;
+
+        Theron::Framework framework(params);
+
+        // With automatic scaling the limits are independent of the target thread count.
+        Check(framework.GetMinThreads() == 1, "GetMinThreads failed");
+        Check(framework.GetMaxThreads() == 2, "GetMaxThreads failed");
+
+        framework.SetMaxThreads(8);
+        Check(framework.GetMaxThreads() == 8, "GetMaxThreads failed");
+        Check(framework.GetMinThreads() == 1, "GetMinThreads failed");
+
+        // Send a burst of messages to many actors, giving the pool a chance to grow.
+        const uint32_t ACTOR_COUNT = 32;
+        IntReplier *repliers[ACTOR_COUNT];
+
+        for (uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            repliers[index] = new IntReplier(framework);
+        }
+
+        Theron::Receiver receiver;
+        for (uint32_t round = 0; round < 100; ++round)
+        {
+            for (uint32_t index = 0; index < ACTOR_COUNT; ++index)
+            {
+                framework.Send(int(0), receiver.GetAddress(), repliers[index]->GetAddress());
+            }
+        }
+
+        uint32_t outstandingCount(100 * ACTOR_COUNT);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        for (uint32_t index = 0; index < ACTOR_COUNT; ++index)
+        {
+            delete repliers[index];
+        }
+
+        Theron::Detail::Utils::SleepThread(50);
+
+        Check(framework.GetNumThreads() >= 1, "GetNumThreads failed");
+        Check(framework.GetPeakThreads() <= 8, "GetPeakThreads failed");
+
+        // Conflicting limits are resolved in favor of the later call.
+        framework.SetMinThreads(12);
+        Check(framework.GetMinThreads() == 12, "GetMinThreads failed");
+        Check(framework.GetMaxThreads() == 12, "GetMaxThreads failed");
+
+        Theron::Detail::Utils::SleepThread(50);
+        Check(framework.GetNumThreads() == 12, "GetNumThreads failed");
+    }
+
     inline static void EventCounterApi()
     {
 #if THERON_ENABLE_COUNTERS
@@ -1233,6 +2551,39 @@ public:
 #endif
     }
 
+    inline static void PerNodeEventCounterApi()
+    {
+#if THERON_ENABLE_COUNTERS
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework::Parameters params;
+        params.mSchedulerStrategy = Theron::SCHEDULER_STRATEGY_NUMA;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        IntReplier replier(framework);
+        framework.Send(int(0), receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+
+        // Every node with worker threads should have an entry, and together they should
+        // account for the message processed by the framework.
+        uint32_t counterValues[32];
+        const uint32_t nodeCount(framework.GetPerNodeCounterValues(Theron::Detail::COUNTER_MESSAGES_PROCESSED, counterValues, 32));
+        Check(nodeCount > 0, "GetPerNodeCounterValues failed");
+
+        uint32_t messagesProcessed(0);
+        for (uint32_t index = 0; index < nodeCount; ++index)
+        {
+            messagesProcessed += counterValues[index];
+        }
+
+        Check(messagesProcessed == framework.GetCounterValue(Theron::Detail::COUNTER_MESSAGES_PROCESSED), "GetPerNodeCounterValues failed");
+#endif
+    }
+
     inline static void ConstructEndPoint()
     {
         // Should be able to use endpoints even if networking is disabled.
@@ -1371,6 +2722,9 @@ public:
         receiver.Wait();
     }
 
+    // Public so that it can be registered with THERON_REGISTER_MESSAGE outside the class.
+    typedef std::vector<Theron::uint32_t> IntVectorMessage;
+
 private:
 
     class TrivialActor : public Theron::Actor
@@ -1407,7 +2761,11 @@ private:
     {
     public:
 
-        inline explicit Replier(Theron::Framework &framework, const char *const name = 0) : Theron::Actor(framework, name)
+        inline explicit Replier(
+            Theron::Framework &framework,
+            const char *const name = 0,
+            const Theron::ActorPriority priority = Theron::ACTOR_PRIORITY_NORMAL) :
+          Theron::Actor(framework, name, priority)
         {
             RegisterHandler(this, &Replier::Handler);
         }
@@ -1420,6 +2778,24 @@ private:
         }
     };
 
+    template <class MessageType>
+    class DelayedReplier : public Theron::Actor
+    {
+    public:
+
+        inline explicit DelayedReplier(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &DelayedReplier::Handler);
+        }
+
+    private:
+
+        inline void Handler(const MessageType &message, const Theron::Address from)
+        {
+            SendAfter(message, from, 1);
+        }
+    };
+
     template <class MessageType>
     class DefaultReplier : public Theron::Actor
     {
@@ -1606,6 +2982,62 @@ private:
         int mCount;
     };
 
+    class TypeSorter : public Theron::Actor
+    {
+    public:
+
+        inline TypeSorter(Theron::Framework &framework) : Theron::Actor(framework), mTotal(0)
+        {
+            RegisterHandler(this, &TypeSorter::HandleInt);
+            RegisterHandler(this, &TypeSorter::HandleFloat);
+            RegisterHandler(this, &TypeSorter::HandleIntAgain);
+            RegisterHandler(this, &TypeSorter::HandleDouble);
+            RegisterHandler(this, &TypeSorter::HandleChar);
+            RegisterHandler(this, &TypeSorter::GetValue);
+            SetDefaultHandler(this, &TypeSorter::DefaultHandler);
+        }
+
+    private:
+
+        inline void HandleInt(const int &/*message*/, const Theron::Address /*from*/)
+        {
+            mTotal += 1;
+        }
+
+        inline void HandleIntAgain(const int &/*message*/, const Theron::Address /*from*/)
+        {
+            mTotal += 10;
+        }
+
+        inline void HandleFloat(const float &/*message*/, const Theron::Address /*from*/)
+        {
+            mTotal += 100;
+        }
+
+        inline void HandleDouble(const double &/*message*/, const Theron::Address /*from*/)
+        {
+            mTotal += 1000;
+        }
+
+        inline void HandleChar(const char &/*message*/, const Theron::Address /*from*/)
+        {
+            mTotal += 10000;
+        }
+
+        inline void GetValue(const bool &/*message*/, const Theron::Address from)
+        {
+            DeregisterHandler(this, &TypeSorter::HandleIntAgain);
+            Send(mTotal, from);
+        }
+
+        inline void DefaultHandler(const Theron::Address /*from*/)
+        {
+            mTotal += 100000;
+        }
+
+        int mTotal;
+    };
+
     template <class CountType>
     class Sequencer : public Theron::Actor
     {
@@ -2010,8 +3442,6 @@ private:
         Theron::Address mAddress;
     };
 
-    typedef std::vector<Theron::uint32_t> IntVectorMessage;
-
     class SomeOtherBaseclass
     {
     public:
@@ -2090,7 +3520,9 @@ private:
     {
     public:
 
-        inline Forwarder(Theron::Framework &framework, const Theron::Address next) : Theron::Actor(framework), mNext(next)
+        inline Forwarder(Theron::Framework &framework, const Theron::Address next, const uint32_t schedulerGroup = 0) :
+          Theron::Actor(framework, 0, Theron::ACTOR_PRIORITY_NORMAL, schedulerGroup),
+          mNext(next)
         {
             RegisterHandler(this, &Forwarder::Forward);
         }
@@ -2104,6 +3536,242 @@ private:
 
         const Theron::Address mNext;
     };
+
+    class Gate : public Theron::Actor
+    {
+    public:
+
+        inline Gate(Theron::Framework &framework, const Theron::Address next) :
+          Theron::Actor(framework),
+          mEntered(false),
+          mOpen(false),
+          mNext(next)
+        {
+            RegisterHandler(this, &Gate::Forward);
+        }
+
+        volatile bool mEntered;
+        volatile bool mOpen;
+
+    private:
+
+        inline void Forward(const int &message, const Theron::Address /*from*/)
+        {
+            // Hold on to messages until the gate is opened.
+            mEntered = true;
+            while (!mOpen)
+            {
+                Theron::Detail::Utils::SleepThread(1);
+            }
+
+            Send(message, mNext);
+        }
+
+        const Theron::Address mNext;
+    };
+
+    class Alternator : public Theron::Actor
+    {
+    public:
+
+        inline Alternator(Theron::Framework &framework, const Theron::Address first, const Theron::Address second) :
+          Theron::Actor(framework),
+          mFirst(first),
+          mSecond(second),
+          mNextValue(0)
+        {
+            RegisterHandler(this, &Alternator::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address /*from*/)
+        {
+            // Send the given number of consecutive values to each of the two actors in turn.
+            for (int count = 0; count < message; ++count)
+            {
+                Send(mNextValue, mFirst);
+                Send(mNextValue, mSecond);
+                ++mNextValue;
+            }
+        }
+
+        const Theron::Address mFirst;
+        const Theron::Address mSecond;
+        int mNextValue;
+    };
+
+    class Countdown : public Theron::Actor
+    {
+    public:
+
+        inline explicit Countdown(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
+        {
+            RegisterHandler(this, &Countdown::Handler);
+        }
+
+        Theron::uint32_t mCount;
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address /*from*/)
+        {
+            // Count the message and send the next one to ourselves, until the count runs down.
+            ++mCount;
+            if (message > 0)
+            {
+                Send(message - 1, GetAddress());
+            }
+        }
+    };
+
+    class Broadcaster : public Theron::Actor
+    {
+    public:
+
+        static const Theron::uint32_t MAX_TARGETS = 40;
+
+        inline explicit Broadcaster(Theron::Framework &framework) : Theron::Actor(framework), mTargetCount(0)
+        {
+            RegisterHandler(this, &Broadcaster::AddTarget);
+            RegisterHandler(this, &Broadcaster::Broadcast);
+        }
+
+    private:
+
+        inline void AddTarget(const Theron::Address &target, const Theron::Address /*from*/)
+        {
+            if (mTargetCount < MAX_TARGETS)
+            {
+                mTargets[mTargetCount++] = target;
+            }
+        }
+
+        inline void Broadcast(const int &message, const Theron::Address /*from*/)
+        {
+            for (Theron::uint32_t index = 0; index < mTargetCount; ++index)
+            {
+                Send(message, mTargets[index]);
+            }
+        }
+
+        Theron::uint32_t mTargetCount;
+        Theron::Address mTargets[MAX_TARGETS];
+    };
+
+    class ValueLocator : public Theron::Actor
+    {
+    public:
+
+        inline explicit ValueLocator(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &ValueLocator::Locate);
+        }
+
+    private:
+
+        inline void Locate(const IntVectorMessage &message, const Theron::Address from)
+        {
+            const IntVectorMessage *const location(&message);
+            Send(location, from);
+        }
+    };
+
+    class Publisher : public Theron::Actor
+    {
+    public:
+
+        inline Publisher(Theron::Framework &framework, const Theron::Address &reportTo) :
+          Theron::Actor(framework),
+          mPublishedCount(0),
+          mReportTo(reportTo)
+        {
+            RegisterHandler(this, &Publisher::Subscribe);
+            RegisterHandler(this, &Publisher::Publish);
+            RegisterHandler(this, &Publisher::Report);
+        }
+
+        Theron::uint32_t mPublishedCount;
+
+    private:
+
+        inline void Subscribe(const Theron::Address &subscriber, const Theron::Address /*from*/)
+        {
+            mSubscribers.Add(subscriber);
+        }
+
+        inline void Publish(const IntVectorMessage &message, const Theron::Address /*from*/)
+        {
+            mPublishedCount = Send(message, mSubscribers);
+        }
+
+        inline void Report(const IntVectorMessage *const &location, const Theron::Address /*from*/)
+        {
+            Send(location, mReportTo);
+        }
+
+        Theron::Address mReportTo;
+        Theron::AddressGroup mSubscribers;
+    };
+
+#if THERON_CPP11
+
+    class TrackedBuffer
+    {
+    public:
+
+        inline explicit TrackedBuffer(const Theron::uint32_t size) : mValues(size, 1), mCopied(false)
+        {
+        }
+
+        inline TrackedBuffer(const TrackedBuffer &other) : mValues(other.mValues), mCopied(true)
+        {
+        }
+
+        inline TrackedBuffer(TrackedBuffer &&other) : mValues(std::move(other.mValues)), mCopied(other.mCopied)
+        {
+        }
+
+        std::vector<int> mValues;
+        bool mCopied;
+
+    private:
+
+        TrackedBuffer &operator=(const TrackedBuffer &other);
+    };
+
+    class BufferSummer : public Theron::Actor
+    {
+    public:
+
+        inline BufferSummer(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &BufferSummer::Sum);
+        }
+
+    private:
+
+        inline void Sum(const TrackedBuffer &message, const Theron::Address from)
+        {
+            // Buffers that were copied on the way count as empty.
+            std::string::size_type total(0);
+            if (message.mCopied)
+            {
+                Send(std::string(), from);
+                return;
+            }
+
+            for (std::vector<int>::size_type index = 0; index < message.mValues.size(); ++index)
+            {
+                total += static_cast<std::string::size_type>(message.mValues[index]);
+            }
+
+            // Reply with a string of that length, constructed in the message.
+            Emplace<std::string>(from, total, 'x');
+        }
+    };
+
+#endif // THERON_CPP11
 };
 
 
@@ -9,7 +9,11 @@ namespace Theron
 {
 
 
-Actor::Actor(Framework &framework, const char *const name) :
+Actor::Actor(
+    Framework &framework,
+    const char *const name,
+    const ActorPriority priority,
+    const uint32_t schedulerGroup) :
   mAddress(),
   mFramework(&framework),
   mMessageHandlers(),
@@ -19,6 +23,13 @@ Actor::Actor(Framework &framework, const char *const name) :
 {
     // Claim an available directory index and mailbox for this actor.
     mFramework->RegisterActor(this, name);
+
+    // The mailbox may have been used by an earlier actor, so always reset its scheduling options.
+    SetPriority(priority);
+    SetWorkerThread(ANY_WORKER_THREAD);
+    SetBlocking(false);
+    SetSchedulerGroup(schedulerGroup);
+    SetMailboxCapacity(0);
 }
 
 
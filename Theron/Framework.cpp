@@ -11,15 +11,23 @@
 #include <Theron/Framework.h>
 #include <Theron/IAllocator.h>
 #include <Theron/Receiver.h>
+#include <Theron/WorkerPool.h>
 
 #include <Theron/Detail/Directory/StaticDirectory.h>
 #include <Theron/Detail/Scheduler/BlockingMonitor.h>
 #include <Theron/Detail/Scheduler/MailboxQueue.h>
 #include <Theron/Detail/Scheduler/NonBlockingMonitor.h>
+#include <Theron/Detail/Scheduler/ParkingMonitor.h>
+#include <Theron/Detail/Scheduler/PartitionedQueue.h>
 #include <Theron/Detail/Scheduler/Scheduler.h>
+#include <Theron/Detail/Scheduler/NumaQueue.h>
+#include <Theron/Detail/Scheduler/WorkStealingQueue.h>
 #include <Theron/Detail/Network/Index.h>
 #include <Theron/Detail/Network/NameGenerator.h>
 #include <Theron/Detail/Strings/String.h>
+#include <Theron/Detail/Threading/Clock.h>
+#include <Theron/Detail/Threading/Lock.h>
+#include <Theron/Detail/Threading/ProcessorTopology.h>
 #include <Theron/Detail/Threading/Utils.h>
 
 
@@ -35,11 +43,99 @@ namespace Theron
 
 void Framework::Initialize()
 {
-    mScheduler = CreateScheduler();
+    // The worker threads of both thread pools wake the idle monitor as they empty mailboxes.
+    // The schedulers copy the pointer from their shared contexts to the worker thread contexts.
+    mSharedMailboxContext.mIdleMonitor = &mIdleMonitor;
+    mBlockingMailboxContext.mIdleMonitor = &mIdleMonitor;
+
+    // Frameworks attached to a worker pool share its threads instead of creating their own.
+    if (mParams.mWorkerPool)
+    {
+        mScheduler = mParams.mWorkerPool->Attach(
+            &mFallbackHandlers,
+            &mMessageAllocator,
+            &mSharedMailboxContext,
+            mParams.mWorkerPoolWeight,
+            mParams.mMessagesPerVisit,
+            mParams.mContinuationDepth);
+    }
+    else
+    {
+        // The placement order is built once, and shared with the scheduler groups that use the
+        // framework's processors, so that each pool of threads is pinned to its own processors.
+        mPlacementOrder = CreatePlacementOrder(mParams.mProcessorSet, mPlacementCount);
+        mScheduler = CreateScheduler();
+    }
 
     // Set up the scheduler.
     mScheduler->Initialize(mParams.mThreadCount);
 
+    // Set up the scheduler of the blocking threads, if requested.
+    // The blocking threads are expected to spend much of their time blocked, so sleep when
+    // idle rather than spinning, and their number is always scaled with the load. They aren't
+    // pinned, so they don't compete with the worker threads for pinned processors.
+    if (mParams.mBlockingThreadCount)
+    {
+        mBlockingScheduler = CreateScheduler< Detail::MailboxQueue<Detail::BlockingMonitor> >(
+            &mBlockingMailboxContext,
+            YIELD_STRATEGY_CONDITION,
+            Placement(),
+            mParams.mProcessorSet,
+            true,
+            mParams.mContinuationDepth);
+
+        mBlockingScheduler->Initialize(mParams.mBlockingThreadCount);
+    }
+
+    // Set up the schedulers of the scheduler groups, if any were declared.
+    if (mParams.mSchedulerGroupCount)
+    {
+        IAllocator *const allocator(AllocatorManager::GetCache());
+        void *const groupMemory(allocator->AllocateAligned(
+            sizeof(SchedulerGroup) * mParams.mSchedulerGroupCount,
+            THERON_CACHELINE_ALIGNMENT));
+
+        THERON_ASSERT_MSG(groupMemory, "Failed to allocate scheduler groups");
+        mSchedulerGroups = reinterpret_cast<SchedulerGroup *>(groupMemory);
+
+        // Groups using the framework's processors are pinned to the processors following those
+        // of the main worker threads, and of earlier groups, in the framework's placement order.
+        uint32_t placementOffset(mParams.mThreadCount);
+
+        for (uint32_t index = 0; index < mParams.mSchedulerGroupCount; ++index)
+        {
+            const SchedulerGroupParameters &groupParams(mParams.mSchedulerGroups[index]);
+            SchedulerGroup *const group(new (mSchedulerGroups + index) SchedulerGroup());
+            const uint32_t threadCount(groupParams.mThreadCount ? groupParams.mThreadCount : 1);
+
+            group->mName = Detail::String(groupParams.mName);
+            group->mMailboxContext.mIdleMonitor = &mIdleMonitor;
+            group->mPlacementOrder = 0;
+            group->mPlacementCount = 0;
+
+            // Groups without their own processor set use those of the framework.
+            if (groupParams.mProcessorSet.Empty())
+            {
+                group->mScheduler = CreateSchedulerGroupScheduler(
+                    &group->mMailboxContext,
+                    Placement(mPlacementOrder, mPlacementCount, placementOffset),
+                    mParams.mProcessorSet);
+
+                placementOffset += threadCount;
+            }
+            else
+            {
+                group->mPlacementOrder = CreatePlacementOrder(groupParams.mProcessorSet, group->mPlacementCount);
+                group->mScheduler = CreateSchedulerGroupScheduler(
+                    &group->mMailboxContext,
+                    Placement(group->mPlacementOrder, group->mPlacementCount, 0),
+                    groupParams.mProcessorSet);
+            }
+
+            group->mScheduler->Initialize(threadCount);
+        }
+    }
+
     // Set up the default fallback handler, which catches and reports undelivered messages.
     SetFallbackHandler(&mDefaultFallbackHandler, &Detail::DefaultFallbackHandler::Handle);
      
@@ -62,62 +158,334 @@ void Framework::Release()
     // Deregister the framework.
     Detail::StaticDirectory<Framework>::Deregister(mIndex);
 
+    // Discard any pending timers, so no more messages are sent by them.
+    // Timers are always serviced by the main scheduler.
+    mScheduler->StopTimers();
+
+    // Wait for all the messages in flight to be processed, to avoid memory leaks.
+    // This covers both thread pools, since the actors processed by each can send
+    // messages to actors processed by the other.
+    WaitIdle();
+
+    // All the thread pools are released before any is destroyed.
+    // A scheduler attached to a worker pool is detached from it when released.
     mScheduler->Release();
+
+    if (mSchedulerGroups)
+    {
+        IAllocator *const allocator(AllocatorManager::GetCache());
+
+        for (uint32_t index = 0; index < mParams.mSchedulerGroupCount; ++index)
+        {
+            mSchedulerGroups[index].mScheduler->Release();
+        }
+
+        for (uint32_t index = 0; index < mParams.mSchedulerGroupCount; ++index)
+        {
+            DestroyScheduler(mSchedulerGroups[index].mScheduler);
+
+            if (mSchedulerGroups[index].mPlacementOrder)
+            {
+                allocator->Free(mSchedulerGroups[index].mPlacementOrder);
+            }
+
+            mSchedulerGroups[index].~SchedulerGroup();
+        }
+
+        allocator->Free(mSchedulerGroups);
+        mSchedulerGroups = 0;
+    }
+
+    if (mBlockingScheduler)
+    {
+        mBlockingScheduler->Release();
+        DestroyScheduler(mBlockingScheduler);
+        mBlockingScheduler = 0;
+    }
+
     DestroyScheduler(mScheduler);
     mScheduler = 0;
+
+    if (mPlacementOrder)
+    {
+        AllocatorManager::GetCache()->Free(mPlacementOrder);
+        mPlacementOrder = 0;
+        mPlacementCount = 0;
+    }
 }
 
 
-Detail::IScheduler *Framework::CreateScheduler()
+bool Framework::WaitIdle(const uint32_t milliseconds)
 {
-    typedef Detail::MailboxQueue<Detail::BlockingMonitor> BlockingQueue;
-    typedef Detail::MailboxQueue<Detail::NonBlockingMonitor> NonBlockingQueue;
+    const uint64_t ticksPerSecond(Detail::Clock::GetFrequency());
+    const uint64_t start(Detail::Clock::GetTicks());
 
-    typedef Detail::Scheduler<BlockingQueue> BlockingScheduler;
-    typedef Detail::Scheduler<NonBlockingQueue> NonBlockingScheduler;
+    Detail::Lock lock(mIdleMonitor.GetMutex());
 
-    IAllocator *const allocator(AllocatorManager::GetCache());
-    void *schedulerMemory(0);
+    while (true)
+    {
+        // Arm the monitor before checking, so a worker thread that retires the last message
+        // after we check is sure to see it armed and wake us. The check takes the locks of
+        // the schedulers, so we don't hold our own lock while making it.
+        mIdleMonitor.Arm();
 
-    if (mParams.mYieldStrategy == YIELD_STRATEGY_CONDITION)
+        lock.Unlock();
+        const bool idle(IsIdle());
+        lock.Relock();
+
+        if (idle)
+        {
+            return true;
+        }
+
+        uint32_t timeout(milliseconds);
+        if (milliseconds != 0xFFFFFFFF && ticksPerSecond)
+        {
+            const uint64_t elapsed((Detail::Clock::GetTicks() - start) * 1000 / ticksPerSecond);
+            if (elapsed >= milliseconds)
+            {
+                return false;
+            }
+
+            timeout = milliseconds - static_cast<uint32_t>(elapsed);
+        }
+
+        // Only wait if no worker thread has disarmed the monitor since we armed it.
+        // A worker thread that disarms it after this point has to wait for the lock,
+        // which we release atomically when we start waiting, so its wakeup isn't lost.
+        if (mIdleMonitor.IsArmed())
+        {
+            mIdleMonitor.Wait(lock, timeout);
+        }
+    }
+}
+
+
+bool Framework::IsIdle() const
+{
+    // Every message is counted as sent before it's pushed, and counted as retired after it's
+    // processed. The counts only ever increase, and the retired counts are stored with release
+    // semantics and all read with acquire loads, so by reading all the retired counts before any
+    // of the sent counts we can't see a message retired without also seeing it sent. If the
+    // totals are equal then there was a moment, between the reads, when no messages were in flight.
+    const uint32_t groupCount(mSchedulerGroups ? mParams.mSchedulerGroupCount : 0);
+
+    uint32_t retired(mScheduler->GetMessagesRetired());
+    if (mBlockingScheduler)
     {
-        schedulerMemory = allocator->AllocateAligned(
-            sizeof(BlockingScheduler),
-            THERON_CACHELINE_ALIGNMENT);
+        retired += mBlockingScheduler->GetMessagesRetired();
     }
-    else
+
+    for (uint32_t index = 0; index < groupCount; ++index)
     {
-        schedulerMemory = allocator->AllocateAligned(
-            sizeof(NonBlockingScheduler),
-            THERON_CACHELINE_ALIGNMENT);
+        retired += mSchedulerGroups[index].mScheduler->GetMessagesRetired();
     }
 
-    THERON_ASSERT_MSG(schedulerMemory, "Failed to allocate scheduler");
+    uint32_t sent(mScheduler->GetMessagesSent());
+    if (mBlockingScheduler)
+    {
+        sent += mBlockingScheduler->GetMessagesSent();
+    }
 
+    for (uint32_t index = 0; index < groupCount; ++index)
+    {
+        sent += mSchedulerGroups[index].mScheduler->GetMessagesSent();
+    }
+
+    sent += mSharedMessagesSent.Load();
+
+    return (sent == retired);
+}
+
+
+uint32_t Framework::GetSchedulerGroup(const char *const name) const
+{
+    if (name == 0 || mSchedulerGroups == 0)
+    {
+        return 0;
+    }
+
+    // Pooled strings are compared by address, so pool the name before comparing it.
+    const Detail::String groupName(name);
+    for (uint32_t index = 0; index < mParams.mSchedulerGroupCount; ++index)
+    {
+        if (mSchedulerGroups[index].mName == groupName)
+        {
+            return index + 1;
+        }
+    }
+
+    return 0;
+}
+
+
+Detail::IScheduler *Framework::CreateScheduler()
+{
     if (mParams.mYieldStrategy == YIELD_STRATEGY_CONDITION)
     {
-        return new (schedulerMemory) BlockingScheduler(
-            &mMailboxes,
-            &mFallbackHandlers,
-            &mMessageAllocator,
+        return CreateSchedulerWithMonitor<Detail::BlockingMonitor>();
+    }
+
+    if (mParams.mYieldStrategy == YIELD_STRATEGY_PARK)
+    {
+        return CreateSchedulerWithMonitor<Detail::ParkingMonitor>();
+    }
+
+    return CreateSchedulerWithMonitor<Detail::NonBlockingMonitor>();
+}
+
+
+template <class MonitorType>
+Detail::IScheduler *Framework::CreateSchedulerWithMonitor()
+{
+    if (mParams.mSchedulerStrategy == SCHEDULER_STRATEGY_WORK_STEALING)
+    {
+        return CreateScheduler< Detail::WorkStealingQueue<MonitorType> >(
             &mSharedMailboxContext,
-            mParams.mNodeMask,
-            mParams.mProcessorMask,
-            mParams.mThreadPriority,
-            mParams.mYieldStrategy);
+            mParams.mYieldStrategy,
+            Placement(mPlacementOrder, mPlacementCount, 0),
+            mParams.mProcessorSet,
+            mParams.mAutoScaling,
+            mParams.mContinuationDepth);
     }
-    else
+
+    if (mParams.mSchedulerStrategy == SCHEDULER_STRATEGY_NUMA)
     {
-        return new (schedulerMemory) NonBlockingScheduler(
-            &mMailboxes,
-            &mFallbackHandlers,
-            &mMessageAllocator,
+        return CreateScheduler< Detail::NumaQueue<MonitorType> >(
             &mSharedMailboxContext,
-            mParams.mNodeMask,
-            mParams.mProcessorMask,
-            mParams.mThreadPriority,
-            mParams.mYieldStrategy);
+            mParams.mYieldStrategy,
+            Placement(mPlacementOrder, mPlacementCount, 0),
+            mParams.mProcessorSet,
+            mParams.mAutoScaling,
+            mParams.mContinuationDepth);
+    }
+
+    // Partitioned threads can't be added or removed once they own mailboxes, and never process
+    // the mailboxes of other partitions, so automatic scaling and continuations are disabled.
+    if (mParams.mSchedulerStrategy == SCHEDULER_STRATEGY_PARTITIONED)
+    {
+        return CreateScheduler< Detail::PartitionedQueue<MonitorType> >(
+            &mSharedMailboxContext,
+            mParams.mYieldStrategy,
+            Placement(mPlacementOrder, mPlacementCount, 0),
+            mParams.mProcessorSet,
+            false,
+            0);
+    }
+
+    return CreateScheduler< Detail::MailboxQueue<MonitorType> >(
+        &mSharedMailboxContext,
+        mParams.mYieldStrategy,
+        Placement(mPlacementOrder, mPlacementCount, 0),
+        mParams.mProcessorSet,
+        mParams.mAutoScaling,
+        mParams.mContinuationDepth);
+}
+
+
+template <class QueueType>
+Detail::IScheduler *Framework::CreateScheduler(
+    Detail::MailboxContext *const sharedMailboxContext,
+    const YieldStrategy yieldStrategy,
+    const Placement &placement,
+    const ProcessorSet &processorSet,
+    const bool autoScaling,
+    const uint32_t continuationDepth)
+{
+    typedef Detail::Scheduler<QueueType> SchedulerType;
+
+    IAllocator *const allocator(AllocatorManager::GetCache());
+    void *const schedulerMemory(allocator->AllocateAligned(
+        sizeof(SchedulerType),
+        THERON_CACHELINE_ALIGNMENT));
+
+    THERON_ASSERT_MSG(schedulerMemory, "Failed to allocate scheduler");
+
+    return new (schedulerMemory) SchedulerType(
+        &mMailboxes,
+        &mFallbackHandlers,
+        &mMessageAllocator,
+        sharedMailboxContext,
+        mParams.mNodeMask,
+        mParams.mProcessorMask,
+        processorSet,
+        mParams.mThreadPriority,
+        placement.mOrder,
+        placement.mCount,
+        placement.mOffset,
+        yieldStrategy,
+        mParams.mMessagesPerVisit,
+        continuationDepth,
+        autoScaling);
+}
+
+
+Detail::IScheduler *Framework::CreateSchedulerGroupScheduler(
+    Detail::MailboxContext *const sharedMailboxContext,
+    const Placement &placement,
+    const ProcessorSet &processorSet)
+{
+    // The threads of a group share a single queue, and their number is fixed.
+    if (mParams.mYieldStrategy == YIELD_STRATEGY_CONDITION)
+    {
+        return CreateScheduler< Detail::MailboxQueue<Detail::BlockingMonitor> >(
+            sharedMailboxContext,
+            mParams.mYieldStrategy,
+            placement,
+            processorSet,
+            false,
+            mParams.mContinuationDepth);
+    }
+
+    if (mParams.mYieldStrategy == YIELD_STRATEGY_PARK)
+    {
+        return CreateScheduler< Detail::MailboxQueue<Detail::ParkingMonitor> >(
+            sharedMailboxContext,
+            mParams.mYieldStrategy,
+            placement,
+            processorSet,
+            false,
+            mParams.mContinuationDepth);
     }
+
+    return CreateScheduler< Detail::MailboxQueue<Detail::NonBlockingMonitor> >(
+        sharedMailboxContext,
+        mParams.mYieldStrategy,
+        placement,
+        processorSet,
+        false,
+        mParams.mContinuationDepth);
+}
+
+
+uint32_t *Framework::CreatePlacementOrder(const ProcessorSet &processorSet, uint32_t &count) const
+{
+    count = 0;
+
+    if (mParams.mThreadPlacement != THREAD_PLACEMENT_PINNED)
+    {
+        return 0;
+    }
+
+    IAllocator *const allocator(AllocatorManager::GetCache());
+    const uint32_t maxCount(Detail::ProcessorTopology::MAX_PROCESSORS);
+
+    uint32_t *const order(reinterpret_cast<uint32_t *>(allocator->Allocate(sizeof(uint32_t) * maxCount)));
+    THERON_ASSERT_MSG(order, "Failed to allocate processor placement order");
+
+    // The mask is a convenience for reserving processors among the first 32.
+    ProcessorSet reservedProcessors(mParams.mReservedProcessors);
+    reservedProcessors.AddMask(mParams.mReservedProcessorMask);
+
+    // If the topology can't be read the threads fall back to the affinity masks.
+    count = Detail::ProcessorTopology::GetPlacementOrder(order, maxCount, reservedProcessors, processorSet);
+    if (count == 0)
+    {
+        allocator->Free(order);
+        return 0;
+    }
+
+    return order;
 }
 
 
@@ -163,6 +531,7 @@ void Framework::RegisterActor(Actor *const actor, const char *const name)
     // Name the mailbox and register the actor.
     mailbox.Lock();
     mailbox.SetName(mailboxName);
+    mailbox.SetIndex(mailboxIndex);
     mailbox.RegisterActor(actor);
     mailbox.Unlock();
 
@@ -208,24 +577,115 @@ void Framework::DeregisterActor(Actor *const actor)
     const uint32_t mailboxIndex(address.AsInteger());
     Detail::Mailbox &mailbox(mMailboxes.GetEntry(mailboxIndex));
 
-    // If the entry is pinned then we have to wait for it to be unpinned.
-    bool deregistered(false);
+    mailbox.Lock();
+    mailbox.DeregisterActor();
+    mailbox.Unlock();
+
+    // Worker threads pin the mailbox before getting the registered actor, so while the mailbox
+    // is pinned a worker thread may still be using the actor, and we have to wait for it to be unpinned.
     uint32_t backoff(0);
+    while (mailbox.IsPinned())
+    {
+        Detail::Utils::Backoff(backoff);
+    }
+}
+
 
-    while (!deregistered)
+bool Framework::SendBounded(
+    Detail::MailboxContext *const mailboxContext,
+    Detail::Mailbox &mailbox,
+    const uint32_t capacity,
+    Detail::IMessage *const message)
+{
+    bool schedule(false);
+
+    // Mailboxes that drop their oldest messages are pushed and popped under the lock, so that
+    // a sender finding the mailbox full can remove the oldest queued message to make room.
+    // The policy is checked again under the lock, since the actor may have changed it.
+    if (mailbox.GetOverflowPolicy() == OVERFLOW_POLICY_DROP_OLDEST)
     {
         mailbox.Lock();
 
-        if (!mailbox.IsPinned())
+        if (mailbox.DropsOldest())
         {
-            mailbox.DeregisterActor();
-            deregistered = true;
+            Detail::IMessage *discarded(0);
+            if (mailbox.Reserve(mailbox.GetCapacity(), schedule))
+            {
+                CountSent(mailboxContext);
+                mailbox.PushReserved(message);
+            }
+            else if ((discarded = mailbox.PopOldest()) != 0)
+            {
+                // The arriving message takes the place of the oldest one, which was counted as sent.
+                mailbox.PushReserved(message);
+            }
+            else
+            {
+                // If the only counted message is being processed then the arriving message is discarded instead.
+                discarded = message;
+            }
+
+            mailbox.Unlock();
+
+            if (schedule)
+            {
+                Schedule(mailboxContext, &mailbox);
+            }
+
+            if (discarded)
+            {
+                Detail::MessageCreator::Destroy(&mMessageAllocator, discarded);
+            }
+
+            return true;
         }
 
         mailbox.Unlock();
+    }
 
-        Detail::Utils::Backoff(backoff);
+    // The message is counted as sent only once it's sure to be pushed, but before it's pushed.
+    if (mailbox.Reserve(capacity, schedule))
+    {
+        CountSent(mailboxContext);
+        mailbox.PushReserved(message);
+
+        if (schedule)
+        {
+            Schedule(mailboxContext, &mailbox);
+        }
+
+        return true;
     }
+
+    // The mailbox is full, so it isn't empty, and is already scheduled or being processed.
+    bool delivered(false);
+
+    switch (mailbox.GetOverflowPolicy())
+    {
+        case OVERFLOW_POLICY_DROP_OLDEST:
+        case OVERFLOW_POLICY_DROP_NEWEST:
+        {
+            // The arriving message is dropped silently. A mailbox changed to drop its oldest
+            // messages since we checked is treated the same way, rather than locked now.
+            delivered = true;
+            break;
+        }
+
+        case OVERFLOW_POLICY_FALLBACK:
+        {
+            mFallbackHandlers.Handle(message);
+            break;
+        }
+
+        case OVERFLOW_POLICY_REJECT:
+        default:
+        {
+            break;
+        }
+    }
+
+    Detail::MessageCreator::Destroy(&mMessageAllocator, message);
+    return delivered;
 }
 
 
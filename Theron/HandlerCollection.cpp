@@ -13,7 +13,10 @@ namespace Detail
 HandlerCollection::HandlerCollection() :
   mHandlers(),
   mNewHandlers(),
-  mHandlersDirty(false)
+  mHandlersDirty(false),
+  mTypeEntries(0),
+  mTypeEntryMask(0),
+  mIndexedHandlers(0)
 {
 }
 
@@ -59,6 +62,98 @@ void HandlerCollection::UpdateHandlers()
         mNewHandlers.Remove(handler);
         mHandlers.Insert(handler);
     }
+
+    BuildIndex();
+}
+
+
+void HandlerCollection::BuildIndex()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    FreeIndex();
+
+    uint32_t handlerCount(0);
+    MessageHandlerList::Iterator handlers(mHandlers.GetIterator());
+    while (handlers.Next())
+    {
+        ++handlerCount;
+    }
+
+    if (handlerCount == 0)
+    {
+        return;
+    }
+
+    // Size the hash table to at least twice the number of handlers, and so of message types.
+    uint32_t entryCount(4);
+    while (entryCount < handlerCount * 2)
+    {
+        entryCount <<= 1;
+    }
+
+    // The table and the array of handlers it indexes are allocated together.
+    const uint32_t tableSize(static_cast<uint32_t>(sizeof(TypeEntry)) * entryCount);
+    const uint32_t arraySize(static_cast<uint32_t>(sizeof(IMessageHandler *)) * handlerCount);
+
+    void *const memory(allocator->Allocate(tableSize + arraySize));
+    THERON_ASSERT_MSG(memory, "Failed to allocate message handler index");
+
+    mTypeEntries = reinterpret_cast<TypeEntry *>(memory);
+    mTypeEntryMask = entryCount - 1;
+    mIndexedHandlers = reinterpret_cast<IMessageHandler **>(reinterpret_cast<char *>(memory) + tableSize);
+
+    for (uint32_t index = 0; index < entryCount; ++index)
+    {
+        mTypeEntries[index].mTypeId = 0;
+        mTypeEntries[index].mFirst = 0;
+        mTypeEntries[index].mCount = 0;
+    }
+
+    // Count the handlers registered for each message type.
+    handlers = mHandlers.GetIterator();
+    while (handlers.Next())
+    {
+        const uint32_t typeId(handlers.Get()->GetMessageTypeId());
+        TypeEntry *const entry(FindEntry(typeId));
+
+        entry->mTypeId = typeId;
+        ++entry->mCount;
+    }
+
+    // Give each message type a contiguous range of the handler array.
+    uint32_t first(0);
+    for (uint32_t index = 0; index < entryCount; ++index)
+    {
+        mTypeEntries[index].mFirst = first;
+        first += mTypeEntries[index].mCount;
+        mTypeEntries[index].mCount = 0;
+    }
+
+    // Fill in the ranges, keeping the handlers of each type in the order of the list.
+    handlers = mHandlers.GetIterator();
+    while (handlers.Next())
+    {
+        IMessageHandler *const handler(handlers.Get());
+        TypeEntry *const entry(FindEntry(handler->GetMessageTypeId()));
+
+        mIndexedHandlers[entry->mFirst + entry->mCount++] = handler;
+    }
+}
+
+
+void HandlerCollection::FreeIndex()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    if (mTypeEntries)
+    {
+        allocator->Free(mTypeEntries);
+
+        mTypeEntries = 0;
+        mTypeEntryMask = 0;
+        mIndexedHandlers = 0;
+    }
 }
 
 
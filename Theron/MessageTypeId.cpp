@@ -0,0 +1,33 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Detail/Messages/MessageTypeId.h>
+#include <Theron/Detail/Threading/Lock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+Mutex MessageTypeIdBase::smMutex;
+uint32_t MessageTypeIdBase::smCount = 0;
+
+
+uint32_t MessageTypeIdBase::Allocate(volatile uint32_t &id)
+{
+    Lock lock(smMutex);
+
+    // Another thread may have allocated the ID while we waited for the lock.
+    if (id == 0)
+    {
+        id = ++smCount;
+    }
+
+    return id;
+}
+
+
+} // namespace Detail
+} // namespace Theron
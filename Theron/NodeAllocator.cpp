@@ -0,0 +1,75 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <new>
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Allocators/NodeAllocator.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+NodeAllocator::Static NodeAllocator::mStatic;
+
+
+NodeAllocator::Static::Static() : mLock(), mNodeLimit(0)
+{
+    for (uint32_t node = 0; node < MAX_NODES; ++node)
+    {
+        mAllocators[node] = 0;
+    }
+}
+
+
+NodeAllocator *NodeAllocator::GetAllocator(const uint32_t node)
+{
+    if (node >= MAX_NODES)
+    {
+        return 0;
+    }
+
+    mStatic.mLock.Lock();
+
+    NodeAllocator *allocator(mStatic.mAllocators[node]);
+    if (allocator == 0)
+    {
+        // The arena is allocated on the node and holds the allocator object itself.
+        // It's never freed, since blocks allocated from it can outlive any framework.
+        // Utils::AllocOnNode returns zero in builds without NUMA support.
+        void *const arena(Utils::AllocOnNode(node, ARENA_SIZE));
+        if (arena)
+        {
+            if (THERON_ALIGNED(arena, PAGE_SIZE))
+            {
+                allocator = new (arena) NodeAllocator(node, reinterpret_cast<uint8_t *>(arena));
+                mStatic.mAllocators[node] = allocator;
+
+                if (node >= mStatic.mNodeLimit)
+                {
+                    mStatic.mNodeLimit = node + 1;
+                }
+            }
+            else
+            {
+                Utils::FreeOnNode(arena, ARENA_SIZE);
+            }
+        }
+    }
+
+    mStatic.mLock.Unlock();
+
+    return allocator;
+}
+
+
+} // namespace Detail
+} // namespace Theron
@@ -0,0 +1,379 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <new>
+
+#include <Theron/Actor.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/WorkerPool.h>
+
+#include <Theron/Detail/Handlers/IMessageHandler.h>
+#include <Theron/Detail/Scheduler/MailboxProcessor.h>
+#include <Theron/Detail/Scheduler/PoolScheduler.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+PoolScheduler::PoolScheduler(
+    WorkerPool *const pool,
+    FallbackHandlerCollection *const fallbackHandlers,
+    IAllocator *const messageAllocator,
+    MailboxContext *const sharedMailboxContext,
+    const uint32_t threadCount,
+    const uint32_t nodeMask,
+    const uint32_t weight,
+    const uint32_t messagesPerVisit,
+    const uint32_t continuationDepth) :
+  mPool(pool),
+  mFallbackHandlers(fallbackHandlers),
+  mMessageAllocator(messageAllocator),
+  mSharedMailboxContext(sharedMailboxContext),
+  mThreadCount(threadCount),
+  mNodeMask(nodeMask),
+  mWeight(weight),
+  mMessagesPerVisit(messagesPerVisit),
+  mContinuationDepth(continuationDepth),
+  mSlots(0),
+  mQueueDepth(),
+  mQueueLock(),
+  mQueue(),
+  mTimers()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    for (uint32_t counter = 0; counter < (uint32_t) MAX_COUNTERS; ++counter)
+    {
+        Counting::Reset(mSharedCounters[counter].mValue, counter);
+    }
+
+    // Set up a context for each worker thread of the pool.
+    // The contexts live as long as the scheduler, so are valid for as long as it's attached.
+    void *const slotMemory(allocator->AllocateAligned(sizeof(WorkerSlot) * mThreadCount, THERON_CACHELINE_ALIGNMENT));
+    THERON_ASSERT_MSG(slotMemory, "Failed to allocate worker thread contexts");
+
+    mSlots = reinterpret_cast<WorkerSlot *>(slotMemory);
+    for (uint32_t thread = 0; thread < mThreadCount; ++thread)
+    {
+        WorkerSlot *const slot(new (mSlots + thread) WorkerSlot());
+
+        for (uint32_t counter = 0; counter < (uint32_t) MAX_COUNTERS; ++counter)
+        {
+            Counting::Reset(slot->mCounters[counter].mValue, counter);
+        }
+
+        MailboxContext &mailboxContext(slot->mWorkerContext.mMailboxContext);
+
+        slot->mWorkerContext.mMessageCache.SetAllocator(mMessageAllocator);
+        mailboxContext.mMessageAllocator = &slot->mWorkerContext.mMessageCache;
+        mailboxContext.mFallbackHandlers = mFallbackHandlers;
+        mailboxContext.mScheduler = this;
+        mailboxContext.mQueueContext = slot->mCounters;
+        mailboxContext.mMessagesPerVisit = mMessagesPerVisit;
+        mailboxContext.mContinuationDepth = mContinuationDepth;
+        mailboxContext.mIdleMonitor = mSharedMailboxContext->mIdleMonitor;
+    }
+}
+
+
+PoolScheduler::~PoolScheduler()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    for (uint32_t thread = 0; thread < mThreadCount; ++thread)
+    {
+        mSlots[thread].~WorkerSlot();
+    }
+
+    allocator->Free(mSlots);
+}
+
+
+void PoolScheduler::Initialize(const uint32_t /*threadCount*/)
+{
+    // Set up the shared mailbox context, used by threads that aren't worker threads of the pool.
+    mSharedMailboxContext->mMessageAllocator = mMessageAllocator;
+    mSharedMailboxContext->mFallbackHandlers = mFallbackHandlers;
+    mSharedMailboxContext->mScheduler = this;
+    mSharedMailboxContext->mQueueContext = mSharedCounters;
+    mSharedMailboxContext->mMessagesPerVisit = mMessagesPerVisit;
+}
+
+
+void PoolScheduler::Release()
+{
+    // The framework has stopped its timers and waited for its messages to be processed,
+    // so the work queue is empty. Once detached no worker thread of the pool touches the
+    // scheduler, so it can be destroyed.
+    mTimers.Close();
+    mPool->Detach(this);
+
+    THERON_ASSERT(mQueue.Empty());
+}
+
+
+Mailbox *PoolScheduler::Pop(const uint32_t thread)
+{
+    Mailbox *mailbox(0);
+
+    if (!Empty())
+    {
+        mQueueLock.Lock();
+
+        if (!mQueue.Empty())
+        {
+            mailbox = mQueue.Pop();
+            mQueueDepth.mValue.Decrement();
+        }
+
+        mQueueLock.Unlock();
+
+        // The first message of each visit is counted when the mailbox is popped.
+        if (mailbox)
+        {
+            Counting::Increment(mSlots[thread].mCounters[COUNTER_MESSAGES_PROCESSED].mValue);
+        }
+    }
+
+    return mailbox;
+}
+
+
+void PoolScheduler::Process(const uint32_t thread, Mailbox *const mailbox)
+{
+    THERON_ASSERT(thread < mThreadCount);
+    MailboxProcessor::Process(&mSlots[thread].mWorkerContext, mailbox);
+}
+
+
+void PoolScheduler::BeginHandler(MailboxContext *const mailboxContext, IMessageHandler *const messageHandler)
+{
+    mailboxContext->mPredictedSendCount = messageHandler->GetPredictedSendCount();
+    mailboxContext->mSendCount = 0;
+}
+
+
+void PoolScheduler::EndHandler(MailboxContext *const mailboxContext, IMessageHandler *const messageHandler)
+{
+    messageHandler->ReportSendCount(mailboxContext->mSendCount);
+}
+
+
+void PoolScheduler::Schedule(MailboxContext *const mailboxContext, Mailbox *const mailbox)
+{
+    // The depth is incremented with a full barrier before the pool checks for waiting threads.
+    mQueueLock.Lock();
+    mQueue.Push(mailbox);
+    mQueueDepth.mValue.Increment();
+    mQueueLock.Unlock();
+
+    Counting::Increment(GetCounters(mailboxContext)[COUNTER_SHARED_PUSHES].mValue);
+    ++mailboxContext->mSendCount;
+
+    mPool->Wake();
+}
+
+
+void PoolScheduler::ScheduleBatch(MailboxContext *const mailboxContext, Mailbox *const *const mailboxes, const uint32_t count)
+{
+    mQueueLock.Lock();
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        mQueue.Push(mailboxes[index]);
+        mQueueDepth.mValue.Increment();
+    }
+
+    mQueueLock.Unlock();
+
+    Counting::Add(GetCounters(mailboxContext)[COUNTER_SHARED_PUSHES].mValue, count);
+    mailboxContext->mSendCount += count;
+
+    mPool->Wake(count);
+}
+
+
+void PoolScheduler::EndVisit(MailboxContext *const mailboxContext, const uint32_t messageCount)
+{
+    Aligned<Atomic::UInt32> *const counters(GetCounters(mailboxContext));
+
+    Counting::Add(counters[COUNTER_MESSAGES_PROCESSED].mValue, messageCount - 1);
+    Counting::Increment(counters[COUNTER_MAILBOX_VISITS].mValue);
+    Counting::Raise(counters[COUNTER_MESSAGES_PER_VISIT_MAX].mValue, messageCount);
+}
+
+
+uint32_t PoolScheduler::StartTimer(Timer *const timer)
+{
+    bool wasEmpty(false);
+    const uint32_t handle(mTimers.Start(timer, wasEmpty));
+
+    // The timer thread of the pool only wakes every tick while timers are pending.
+    if (handle && wasEmpty)
+    {
+        mPool->WakeTimerThread();
+    }
+
+    return handle;
+}
+
+
+bool PoolScheduler::CancelTimer(const uint32_t handle)
+{
+    return mTimers.Cancel(handle);
+}
+
+
+void PoolScheduler::StopTimers()
+{
+    mTimers.Close();
+}
+
+
+uint32_t PoolScheduler::GetMessagesSent() const
+{
+    uint32_t count(0);
+
+    // The slots are fixed for the life of the pool, so no lock is needed to visit them.
+    // The acquire loads order the reads with later reads by the caller.
+    for (uint32_t thread = 0; thread < mThreadCount; ++thread)
+    {
+        count += mSlots[thread].mWorkerContext.mMailboxContext.mMessagesSent.LoadAcquire();
+    }
+
+    return count;
+}
+
+
+uint32_t PoolScheduler::GetMessagesRetired() const
+{
+    uint32_t count(0);
+
+    for (uint32_t thread = 0; thread < mThreadCount; ++thread)
+    {
+        count += mSlots[thread].mWorkerContext.mMailboxContext.mMessagesRetired.LoadAcquire();
+    }
+
+    return count;
+}
+
+
+void PoolScheduler::SetMaxThreads(const uint32_t /*count*/)
+{
+    // The threads belong to the pool, and are shared with the other attached frameworks.
+}
+
+
+void PoolScheduler::SetMinThreads(const uint32_t /*count*/)
+{
+}
+
+
+uint32_t PoolScheduler::GetMaxThreads() const
+{
+    return mThreadCount;
+}
+
+
+uint32_t PoolScheduler::GetMinThreads() const
+{
+    return mThreadCount;
+}
+
+
+uint32_t PoolScheduler::GetNumThreads() const
+{
+    return mThreadCount;
+}
+
+
+uint32_t PoolScheduler::GetPeakThreads() const
+{
+    return mThreadCount;
+}
+
+
+void PoolScheduler::ResetCounters()
+{
+    for (uint32_t counter = 0; counter < (uint32_t) MAX_COUNTERS; ++counter)
+    {
+        Counting::Reset(mSharedCounters[counter].mValue, counter);
+
+        for (uint32_t thread = 0; thread < mThreadCount; ++thread)
+        {
+            Counting::Reset(mSlots[thread].mCounters[counter].mValue, counter);
+        }
+    }
+}
+
+
+uint32_t PoolScheduler::GetCounterValue(const uint32_t counter) const
+{
+    uint32_t accumulator(Counting::Get(mSharedCounters[counter].mValue));
+
+    for (uint32_t thread = 0; thread < mThreadCount; ++thread)
+    {
+        Counting::Accumulate(mSlots[thread].mCounters[counter].mValue, counter, accumulator);
+    }
+
+    return accumulator;
+}
+
+
+uint32_t PoolScheduler::GetPerThreadCounterValues(
+    const uint32_t counter,
+    uint32_t *const perThreadCounts,
+    const uint32_t maxCounts) const
+{
+    uint32_t itemCount(0);
+
+    // The value in the shared context comes first, as for the other schedulers.
+    perThreadCounts[itemCount++] = Counting::Get(mSharedCounters[counter].mValue);
+
+    for (uint32_t thread = 0; itemCount < maxCounts && thread < mThreadCount; ++thread)
+    {
+        perThreadCounts[itemCount++] = Counting::Get(mSlots[thread].mCounters[counter].mValue);
+    }
+
+    return itemCount;
+}
+
+
+uint32_t PoolScheduler::GetPerNodeCounterValues(
+    const uint32_t counter,
+    uint32_t *const perNodeCounts,
+    const uint32_t maxCounts) const
+{
+    // The threads of the pool aren't bound to individual nodes, so like the threads of the
+    // other schedulers they are counted against the lowest node they may run on.
+    uint32_t node(0);
+    while (node < 31 && (mNodeMask & (1UL << node)) == 0)
+    {
+        ++node;
+    }
+
+    if (node >= maxCounts || mThreadCount == 0)
+    {
+        return 0;
+    }
+
+    for (uint32_t index = 0; index < node; ++index)
+    {
+        perNodeCounts[index] = 0;
+    }
+
+    perNodeCounts[node] = Counting::Get(mSlots[0].mCounters[counter].mValue);
+    for (uint32_t thread = 1; thread < mThreadCount; ++thread)
+    {
+        Counting::Accumulate(mSlots[thread].mCounters[counter].mValue, counter, perNodeCounts[node]);
+    }
+
+    return node + 1;
+}
+
+
+} // namespace Detail
+} // namespace Theron
@@ -0,0 +1,232 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <stdio.h>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/ProcessorTopology.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4996)  // function or variable may be unsafe
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+uint32_t ProcessorTopology::GetPlacementOrder(
+    uint32_t *const processors,
+    const uint32_t maxCount,
+    const ProcessorSet &reserved,
+    const ProcessorSet &processorSet)
+{
+    uint32_t count(0);
+
+#if defined(__linux__)
+
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    bool *const online(reinterpret_cast<bool *>(allocator->Allocate(sizeof(bool) * MAX_PROCESSORS)));
+    Processor *const table(reinterpret_cast<Processor *>(allocator->Allocate(sizeof(Processor) * MAX_PROCESSORS)));
+
+    THERON_ASSERT_MSG(online && table, "Failed to allocate processor table");
+
+    if (!ReadList("/sys/devices/system/cpu/online", online, MAX_PROCESSORS))
+    {
+        allocator->Free(online);
+        allocator->Free(table);
+        return 0;
+    }
+
+    // Processors outside the affinity of the process, such as those excluded from a container, are skipped.
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    const bool hasAffinity(sched_getaffinity(0, sizeof(affinity), &affinity) == 0);
+
+    char path[128];
+    uint32_t tableSize(0);
+    uint32_t groupCount(0);
+
+    for (uint32_t index = 0; index < MAX_PROCESSORS; ++index)
+    {
+        if (!online[index])
+        {
+            continue;
+        }
+
+        if (reserved.Contains(index) ||
+            (!processorSet.Empty() && !processorSet.Contains(index)) ||
+            (hasAffinity && index < CPU_SETSIZE && !CPU_ISSET(index, &affinity)))
+        {
+            continue;
+        }
+
+        Processor &processor(table[tableSize]);
+        processor.mIndex = index;
+        processor.mPackage = 0;
+        processor.mCore = index;
+
+        sprintf(path, "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", index);
+        ReadValue(path, processor.mPackage);
+
+        sprintf(path, "/sys/devices/system/cpu/cpu%u/topology/core_id", index);
+        ReadValue(path, processor.mCore);
+
+        // The last-level cache is identified by the lowest processor sharing it. Without
+        // cache information the processors of each package are assumed to share one.
+        processor.mCache = MAX_PROCESSORS + processor.mPackage;
+
+        sprintf(path, "/sys/devices/system/cpu/cpu%u/cache/index3/shared_cpu_list", index);
+        ReadValue(path, processor.mCache);
+
+        // Rank the processor among the hardware threads of its core seen so far, and
+        // number its cache in order of first appearance.
+        processor.mRank = 0;
+        processor.mGroup = groupCount;
+
+        for (uint32_t other = 0; other < tableSize; ++other)
+        {
+            if (table[other].mPackage == processor.mPackage && table[other].mCore == processor.mCore)
+            {
+                ++processor.mRank;
+            }
+
+            if (table[other].mCache == processor.mCache)
+            {
+                processor.mGroup = table[other].mGroup;
+            }
+        }
+
+        if (processor.mGroup == groupCount)
+        {
+            ++groupCount;
+        }
+
+        ++tableSize;
+    }
+
+    // Insertion sort into placement order; the table is small and this runs once per framework.
+    for (uint32_t index = 1; index < tableSize; ++index)
+    {
+        const Processor processor(table[index]);
+
+        uint32_t position(index);
+        while (position > 0 && Precedes(processor, table[position - 1]))
+        {
+            table[position] = table[position - 1];
+            --position;
+        }
+
+        table[position] = processor;
+    }
+
+    while (count < tableSize && count < maxCount)
+    {
+        processors[count] = table[count].mIndex;
+        ++count;
+    }
+
+    allocator->Free(online);
+    allocator->Free(table);
+
+#else
+
+    (void) processors;
+    (void) maxCount;
+    (void) reservedMask;
+    (void) processorSet;
+
+#endif
+
+    return count;
+}
+
+
+bool ProcessorTopology::ReadValue(const char *const path, uint32_t &value)
+{
+    FILE *const file(fopen(path, "r"));
+    if (file == 0)
+    {
+        return false;
+    }
+
+    unsigned int readValue(0);
+    const bool read(fscanf(file, "%u", &readValue) == 1);
+    fclose(file);
+
+    if (read)
+    {
+        value = readValue;
+    }
+
+    return read;
+}
+
+
+bool ProcessorTopology::ReadList(const char *const path, bool *const processors, const uint32_t maxCount)
+{
+    FILE *const file(fopen(path, "r"));
+    if (file == 0)
+    {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < maxCount; ++index)
+    {
+        processors[index] = false;
+    }
+
+    // Each entry is a single processor or an inclusive range, separated by commas.
+    unsigned int first(0);
+    while (fscanf(file, "%u", &first) == 1)
+    {
+        unsigned int last(first);
+
+        int separator(fgetc(file));
+        if (separator == '-')
+        {
+            if (fscanf(file, "%u", &last) != 1)
+            {
+                break;
+            }
+
+            separator = fgetc(file);
+        }
+
+        for (uint32_t index = first; index <= last && index < maxCount; ++index)
+        {
+            processors[index] = true;
+        }
+
+        if (separator != ',')
+        {
+            break;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
@@ -0,0 +1,388 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <new>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/IAllocator.h>
+#include <Theron/WorkerPool.h>
+
+#include <Theron/Detail/Scheduler/TimerWheel.h>
+#include <Theron/Detail/Threading/ProcessorTopology.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+namespace Theron
+{
+
+
+WorkerPool::WorkerPool(const Parameters &params) :
+  mParams(params),
+  mRunning(true),
+  mThreads(0),
+  mWaitingThreads(0),
+  mWorkCondition(),
+  mAttachLock(),
+  mFrameworkCount(0),
+  mSchedulerLimit(0),
+  mTimerWoken(false),
+  mTimerCondition(),
+  mTimerThread()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    void *const threadMemory(allocator->AllocateAligned(
+        sizeof(WorkerThread) * mParams.mThreadCount,
+        THERON_CACHELINE_ALIGNMENT));
+
+    THERON_ASSERT_MSG(threadMemory, "Failed to allocate worker threads");
+    mThreads = reinterpret_cast<WorkerThread *>(threadMemory);
+
+    // Work out the processors to which the worker threads are pinned, if they're pinned.
+    // If the topology can't be read the threads fall back to the affinity masks.
+    uint32_t *placementOrder(0);
+    uint32_t placementCount(0);
+
+    if (mParams.mThreadPlacement == THREAD_PLACEMENT_PINNED)
+    {
+        const uint32_t maxCount(Detail::ProcessorTopology::MAX_PROCESSORS);
+
+        placementOrder = reinterpret_cast<uint32_t *>(allocator->Allocate(sizeof(uint32_t) * maxCount));
+        THERON_ASSERT_MSG(placementOrder, "Failed to allocate processor placement order");
+
+        // The mask is a convenience for reserving processors among the first 32.
+        ProcessorSet reservedProcessors(mParams.mReservedProcessors);
+        reservedProcessors.AddMask(mParams.mReservedProcessorMask);
+
+        placementCount = Detail::ProcessorTopology::GetPlacementOrder(placementOrder, maxCount, reservedProcessors, mParams.mProcessorSet);
+    }
+
+    for (uint32_t index = 0; index < mParams.mThreadCount; ++index)
+    {
+        WorkerThread *const thread(new (mThreads + index) WorkerThread());
+
+        thread->mPool = this;
+        thread->mIndex = index;
+        thread->mFramework = 0;
+        thread->mCredit = 0;
+        thread->mProcessor = placementCount ? placementOrder[index % placementCount] : ANY_PROCESSOR;
+
+        if (!thread->mThread.Start(WorkerThreadEntryPoint, thread))
+        {
+            THERON_FAIL_MSG("Failed to start worker thread");
+        }
+    }
+
+    if (placementOrder)
+    {
+        allocator->Free(placementOrder);
+    }
+
+    if (!mTimerThread.Start(TimerThreadEntryPoint, this))
+    {
+        THERON_FAIL_MSG("Failed to start timer thread");
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    THERON_ASSERT_MSG(mFrameworkCount.Load() == 0, "WorkerPool destroyed while frameworks are still attached");
+
+    {
+        Detail::Lock lock(mWorkCondition.GetMutex());
+        mRunning = false;
+        mWorkCondition.PulseAll();
+    }
+
+    WakeTimerThread();
+    mTimerThread.Join();
+
+    for (uint32_t index = 0; index < mParams.mThreadCount; ++index)
+    {
+        mThreads[index].mThread.Join();
+        mThreads[index].~WorkerThread();
+    }
+
+    allocator->Free(mThreads);
+}
+
+
+Detail::IScheduler *WorkerPool::Attach(
+    Detail::FallbackHandlerCollection *const fallbackHandlers,
+    IAllocator *const messageAllocator,
+    Detail::MailboxContext *const sharedMailboxContext,
+    const uint32_t weight,
+    const uint32_t messagesPerVisit,
+    const uint32_t continuationDepth)
+{
+    IAllocator *const allocator(AllocatorManager::GetCache());
+
+    void *const schedulerMemory(allocator->AllocateAligned(
+        sizeof(Detail::PoolScheduler),
+        THERON_CACHELINE_ALIGNMENT));
+
+    THERON_ASSERT_MSG(schedulerMemory, "Failed to allocate scheduler");
+
+    // A framework with zero weight would never be served.
+    Detail::PoolScheduler *const scheduler = new (schedulerMemory) Detail::PoolScheduler(
+        this,
+        fallbackHandlers,
+        messageAllocator,
+        sharedMailboxContext,
+        mParams.mThreadCount,
+        mParams.mNodeMask,
+        weight ? weight : 1,
+        messagesPerVisit,
+        continuationDepth);
+
+    Detail::Lock lock(mAttachLock);
+
+    uint32_t index(0);
+    while (index < MAX_FRAMEWORKS && mSchedulers[index].Load())
+    {
+        ++index;
+    }
+
+    THERON_ASSERT_MSG(index < MAX_FRAMEWORKS, "Too many frameworks attached to WorkerPool");
+
+    mSchedulers[index].Store(scheduler);
+    if (index >= mSchedulerLimit.Load())
+    {
+        mSchedulerLimit.Store(index + 1);
+    }
+
+    mFrameworkCount.Increment();
+
+    return scheduler;
+}
+
+
+void WorkerPool::Detach(Detail::PoolScheduler *const scheduler)
+{
+    {
+        Detail::Lock lock(mAttachLock);
+
+        uint32_t index(0);
+        while (index < MAX_FRAMEWORKS && mSchedulers[index].Load() != scheduler)
+        {
+            ++index;
+        }
+
+        THERON_ASSERT(index < MAX_FRAMEWORKS);
+        mSchedulers[index].Store(0);
+
+        // Shrink the range of indices scanned by the worker threads.
+        uint32_t limit(mSchedulerLimit.Load());
+        while (limit > 0 && mSchedulers[limit - 1].Load() == 0)
+        {
+            --limit;
+        }
+
+        mSchedulerLimit.Store(limit);
+        mFrameworkCount.Decrement();
+    }
+
+    // Worker threads only touch the schedulers of attached frameworks while their epochs are
+    // odd. A thread whose epoch is even, or has moved on since we detached the scheduler, can
+    // no longer hold a pointer to it.
+    for (uint32_t index = 0; index < mParams.mThreadCount; ++index)
+    {
+        Detail::Atomic::UInt32 &epoch(mThreads[index].mEpoch);
+        const uint32_t start(epoch.Load());
+
+        uint32_t backoff(0);
+        while ((start & 1) && epoch.Load() == start)
+        {
+            Detail::Utils::Backoff(backoff);
+        }
+    }
+}
+
+
+void WorkerPool::WakeTimerThread()
+{
+    Detail::Lock lock(mTimerCondition.GetMutex());
+    mTimerWoken = true;
+    mTimerCondition.Pulse();
+}
+
+
+Detail::Mailbox *WorkerPool::Pop(WorkerThread *const thread, Detail::PoolScheduler *&scheduler)
+{
+    const uint32_t limit(mSchedulerLimit.Load());
+    uint32_t index(thread->mFramework);
+    uint32_t credit(thread->mCredit);
+
+    // Visit the attached frameworks in turn, taking up to the weight of each in mailboxes
+    // before moving on. The framework served last is tried again after all the others.
+    for (uint32_t probe = 0; probe <= limit; ++probe)
+    {
+        if (index >= limit)
+        {
+            index = 0;
+        }
+
+        if (Detail::PoolScheduler *const candidate = mSchedulers[index].Load())
+        {
+            if (credit == 0)
+            {
+                credit = candidate->GetWeight();
+            }
+
+            if (Detail::Mailbox *const mailbox = candidate->Pop(thread->mIndex))
+            {
+                if (--credit == 0)
+                {
+                    ++index;
+                }
+
+                thread->mFramework = index;
+                thread->mCredit = credit;
+
+                scheduler = candidate;
+                return mailbox;
+            }
+        }
+
+        credit = 0;
+        ++index;
+    }
+
+    thread->mFramework = index;
+    thread->mCredit = 0;
+
+    return 0;
+}
+
+
+bool WorkerPool::HasWork() const
+{
+    const uint32_t limit(mSchedulerLimit.Load());
+    for (uint32_t index = 0; index < limit; ++index)
+    {
+        Detail::PoolScheduler *const scheduler(mSchedulers[index].Load());
+        if (scheduler && !scheduler->Empty())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void WorkerPool::WorkerThreadEntryPoint(void *const context)
+{
+    WorkerThread *const thread(reinterpret_cast<WorkerThread *>(context));
+    thread->mPool->WorkerThreadProc(thread);
+}
+
+
+void WorkerPool::WorkerThreadProc(WorkerThread *const thread)
+{
+    // Threads pinned to a single processor ignore the affinity masks, as do threads given a processor set.
+    if (thread->mProcessor != ANY_PROCESSOR)
+    {
+        Detail::Utils::SetThreadProcessor(thread->mProcessor);
+    }
+    else if (!mParams.mProcessorSet.Empty())
+    {
+        Detail::Utils::SetThreadProcessors(mParams.mProcessorSet);
+    }
+    else
+    {
+        Detail::Utils::SetThreadAffinity(mParams.mNodeMask, mParams.mProcessorMask);
+    }
+
+    Detail::Utils::SetThreadRelativePriority(mParams.mThreadPriority);
+
+    while (mRunning)
+    {
+        // Make the epoch odd while we may hold a pointer to an attached scheduler.
+        thread->mEpoch.Increment();
+
+        Detail::PoolScheduler *scheduler(0);
+        Detail::Mailbox *const mailbox(Pop(thread, scheduler));
+        if (mailbox)
+        {
+            scheduler->Process(thread->mIndex, mailbox);
+        }
+
+        thread->mEpoch.Increment();
+
+        if (mailbox)
+        {
+            continue;
+        }
+
+        // Announce that we're waiting before checking for work, so either we see work
+        // pushed after our last check or the pushing thread sees us waiting.
+        Detail::Lock lock(mWorkCondition.GetMutex());
+        mWaitingThreads.Increment();
+
+        thread->mEpoch.Increment();
+        const bool hasWork(HasWork());
+        thread->mEpoch.Increment();
+
+        if (mRunning && !hasWork)
+        {
+            mWorkCondition.Wait(lock);
+        }
+
+        mWaitingThreads.Decrement();
+    }
+}
+
+
+void WorkerPool::TimerThreadEntryPoint(void *const context)
+{
+    WorkerPool *const pool(reinterpret_cast<WorkerPool *>(context));
+    pool->TimerThreadProc();
+}
+
+
+void WorkerPool::TimerThreadProc()
+{
+    while (mRunning)
+    {
+        bool pending(false);
+
+        // Holding the lock keeps the schedulers attached while we service their timers.
+        {
+            Detail::Lock lock(mAttachLock);
+
+            const uint32_t limit(mSchedulerLimit.Load());
+            for (uint32_t index = 0; index < limit; ++index)
+            {
+                if (Detail::PoolScheduler *const scheduler = mSchedulers[index].Load())
+                {
+                    scheduler->ServiceTimers();
+                    pending = pending || scheduler->TimersPending();
+                }
+            }
+        }
+
+        // Wake every tick while timers are pending, and otherwise sleep until a timer is started.
+        Detail::Lock lock(mTimerCondition.GetMutex());
+        if (!mTimerWoken)
+        {
+            if (pending)
+            {
+                mTimerCondition.Wait(lock, Detail::TimerWheel::TICK_MILLISECONDS);
+            }
+            else
+            {
+                mTimerCondition.Wait(lock);
+            }
+        }
+
+        mTimerWoken = false;
+    }
+}
+
+
+} // namespace Theron
@@ -75,6 +75,8 @@ public:
     // Constructor.
     Worker(Theron::Framework &framework) : Theron::Actor(framework)
     {
+        // Workers block while reading files, so are processed by the blocking threads.
+        SetBlocking(true);
         RegisterHandler(this, &Worker::Handler);
     }
 
@@ -164,11 +166,13 @@ private:
 int main(int argc, char *argv[])
 {
     // Theron::Framework objects can be constructed with parameters.
-    // We create a framework with n worker threads, where n is the number of
-    // files we wish to be able to read concurrently. We also restrict the
-    // worker threads (arbitrarily) to the first two processor cores.
+    // We create a framework with up to n blocking threads, where n is the number of
+    // files we wish to be able to read concurrently. The blocking workers are processed
+    // by these, leaving the two main worker threads free for the dispatcher. We also
+    // restrict the worker threads (arbitrarily) to the first two processor cores.
     Theron::Framework::Parameters frameworkParams;
-    frameworkParams.mThreadCount = MAX_FILES;
+    frameworkParams.mThreadCount = 2;
+    frameworkParams.mBlockingThreadCount = MAX_FILES;
     frameworkParams.mProcessorMask = (1UL << 0) | (1UL << 1);
     Theron::Framework framework(frameworkParams);
 